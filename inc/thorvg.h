@@ -365,6 +365,26 @@ public:
      */
     Result blend(BlendMethod method) const noexcept;
 
+    /**
+     * @brief Sets whether the paint object is rendered through its own raster cache.
+     *
+     * When the cache is enabled, the paint and its descendants are rasterized once into an offscreen image,
+     * and the subsequent drawings just blend that image on the target as long as the paint is translated or its opacity is changed only.
+     * The image is rasterized again whenever any of the descendants is changed, the paint is scaled, rotated or skewed, or it's moved by a fraction of a pixel.
+     * This is beneficial for the complex paints that move around the canvas without changing their shapes.
+     *
+     * @param[in] on If @c true, the paint is cached. The default value is @c false.
+     *
+     * @retval Result::Success when succeed.
+     *
+     * @note The paint is blended with its opacity as a group.
+     * @note The cache is ignored if the paint is a clipper or clipped, or it exceeds the canvas. Currently, only the software engine supports it.
+     * @see SwCanvas::cacheBudget()
+     *
+     * @note Experimental API
+     */
+    Result cache(bool on) noexcept;
+
     /**
      * @brief Gets the axis-aligned bounding box of the paint object.
      *
@@ -1595,6 +1615,41 @@ public:
         Individual   ///< Allocate designated memory pool that is only used by current instance.
     };
 
+    /**
+     * @brief Enumeration specifying the methods of the raster stage behavior policy.
+     *
+     * @note Experimental API
+     */
+    enum class RasterPolicy : uint8_t
+    {
+        Default = 0, ///< Rasterizes the paints one by one on the calling thread during Canvas::draw().
+        Banded       ///< Records the raster commands during Canvas::draw(), then runs them by horizontal bands across the task threads.
+    };
+
+    /**
+     * @brief Enumeration specifying the instruction sets of the raster kernels of the software engine.
+     *
+     * @note Experimental API
+     */
+    enum class Simd : uint8_t
+    {
+        Default = 0, ///< The best instruction set supported by the cpu, unless the THORVG_SIMD environment variable limits it.
+        None,        ///< The portable C kernels.
+        Sse41,       ///< Up to SSE4.1 on x86.
+        Avx2,        ///< Up to AVX2 on x86.
+        Neon         ///< NEON on arm, if the library is built with the vector option.
+    };
+
+    /**
+     * @brief A data structure representing a rectangular region of the target buffer.
+     *
+     * @note Experimental API
+     */
+    struct Region
+    {
+        int32_t x, y, w, h;
+    };
+
     /**
      * @brief Sets the drawing target for the rasterization.
      *
@@ -1640,6 +1695,122 @@ public:
     */
     Result mempool(MempoolPolicy policy) noexcept;
 
+    /**
+     * @brief Sets the sw engine raster stage behavior policy.
+     *
+     * By default, the paints are rasterized one by one on the thread that calls Canvas::draw(),
+     * only the preparation stage of the paints is distributed to the task threads.
+     * With @c RasterPolicy::Banded, the canvas splits the target buffer into horizontal bands
+     * and rasterizes them in parallel, which is beneficial for the large targets.
+     * The drawing order of the paints is kept within each band, so the result is identical to the default.
+     *
+     * @param[in] policy The method specifying the raster stage behavior. The default value is @c RasterPolicy::Default.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition If the canvas is in the middle of the drawing.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note The banded rasterization takes effect only when the engine is initialized with the task threads,
+     *       and the canvas is not drawn on one of them.
+     * @note Experimental API
+    */
+    Result raster(RasterPolicy policy) noexcept;
+
+    /**
+     * @brief Sets whether the canvas redraws only the damaged regions of the target buffer.
+     *
+     * When the partial redraw is enabled, the canvas keeps track of the regions that were drawn by the paints.
+     * On Canvas::draw(), only the regions covered by the updated, added or removed paints are cleared and redrawn,
+     * while the rest of the target buffer keeps the content of the previous drawing.
+     * The whole target is redrawn after enabling it or changing the target buffer.
+     *
+     * @param[in] on If @c true, only the damaged regions are redrawn. The default value is @c false.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition If the canvas is in the middle of the drawing.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note The damaged regions are always cleared before they are redrawn, thus Canvas::clear() doesn't clear the target buffer in this mode.
+     * @note The target buffer should not be modified by the user between the drawings.
+     * @see SwCanvas::damages()
+     *
+     * @note Experimental API
+     */
+    Result partial(bool on) noexcept;
+
+    /**
+     * @brief Retrieves the regions of the target buffer that were redrawn by the last Canvas::draw().
+     *
+     * The regions don't overlap each other, so only these regions need to be presented to the display.
+     *
+     * @param[out] regions Optional. A pointer to the array of the redrawn regions.
+     *
+     * @return The number of the redrawn regions. It's always zero if the partial redraw is disabled.
+     *
+     * @note The regions are valid until the next Canvas::draw() is called.
+     * @see SwCanvas::partial()
+     *
+     * @note Experimental API
+     */
+    uint32_t damages(const Region** regions) const noexcept;
+
+    /**
+     * @brief Retrieves how many times the shapes reused their rasterized coverage instead of generating it again.
+     *
+     * When a shape is only moved by the whole pixels, the canvas moves its coverage (the run-length encoded spans)
+     * along with it, otherwise the coverage is generated again on the update. The counts are accumulated since the canvas was created.
+     *
+     * @param[out] reused Optional. The number of the shape updates that moved the previous coverage.
+     * @param[out] generated Optional. The number of the shape updates that generated the coverage.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::MemoryCorruption When casting in the internal function implementation failed.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note The counts are valid after Canvas::sync().
+     *
+     * @note Experimental API
+     */
+    Result stats(uint32_t* reused, uint32_t* generated) const noexcept;
+
+    /**
+     * @brief Sets the memory budget for the raster caches of the paints.
+     *
+     * The cached images of the paints drawn by this canvas share the budget.
+     * When a new cache exceeds it, the least recently drawn caches are released first,
+     * and the paints which can't get their caches within the budget are drawn without them.
+     *
+     * @param[in] size The budget in bytes. The default value is 32MB.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition If the canvas is in the middle of the drawing.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @see Paint::cache()
+     *
+     * @note Experimental API
+     */
+    Result cacheBudget(uint32_t size) noexcept;
+
+    /**
+     * @brief Limits the instruction sets of the raster kernels of the software engine.
+     *
+     * By default, the engine chooses the kernels of the best instruction set the cpu supports on its initialization.
+     * This limits them for all the canvases, i.e. to compare the kernels or to work around a platform issue.
+     * The result of the drawing is identical regardless of the instruction set.
+     *
+     * @param[in] limit The highest instruction set of the raster kernels. The default value is @c Simd::Default.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::NonSupport In case the software engine is not supported.
+     *
+     * @note It precedes the THORVG_SIMD environment variable, and it's kept until it's called again.
+     * @warning Do not call it while any canvas is drawing.
+     *
+     * @note Experimental API
+     */
+    static Result simd(Simd limit) noexcept;
+
     /**
      * @brief Creates a new SwCanvas object.
      * @return A new SwCanvas object.
@@ -394,6 +394,28 @@ typedef enum {
 } Tvg_Mempool_Policy;
 
 
+/**
+ * \brief Enumeration specifying the methods of the raster stage behavior policy.
+ *
+ * \note Experimental API
+ */
+typedef enum {
+    TVG_RASTER_POLICY_DEFAULT = 0, ///< Rasterizes the paints one by one on the calling thread during the drawing.
+    TVG_RASTER_POLICY_BANDED       ///< Records the raster commands during the drawing, then runs them by horizontal bands across the task threads.
+} Tvg_Raster_Policy;
+
+
+/**
+ * \brief A data structure representing a rectangular region of the canvas target buffer.
+ *
+ * \note Experimental API
+ */
+typedef struct
+{
+    int32_t x, y, w, h;
+} Tvg_Region;
+
+
 /**
  * \brief Enumeration specifying the methods of combining the 8-bit color channels into 32-bit color.
  */
@@ -486,6 +508,90 @@ TVG_API Tvg_Result tvg_swcanvas_set_target(Tvg_Canvas* canvas, uint32_t* buffer,
 */
 TVG_API Tvg_Result tvg_swcanvas_set_mempool(Tvg_Canvas* canvas, Tvg_Mempool_Policy policy);
 
+
+/*!
+* \brief Sets the software engine raster stage behavior policy.
+*
+* By default, the paints are rasterized one by one on the thread that calls tvg_canvas_draw().
+* With @c TVG_RASTER_POLICY_BANDED, the canvas splits the target buffer into horizontal bands
+* and rasterizes them in parallel across the task threads. The result is identical to the default.
+*
+* \param[in] canvas The Tvg_Canvas object of which the raster stage behavior is to be specified.
+* \param[in] policy The method specifying the raster stage behavior. The default value is @c TVG_RASTER_POLICY_DEFAULT.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENTS An invalid canvas pointer passed.
+* \retval TVG_RESULT_INSUFFICIENT_CONDITION The canvas is in the middle of the drawing.
+* \retval TVG_RESULT_NOT_SUPPORTED The software engine is not supported.
+*
+* \note Experimental API
+*/
+TVG_API Tvg_Result tvg_swcanvas_set_raster_policy(Tvg_Canvas* canvas, Tvg_Raster_Policy policy);
+
+
+/*!
+* \brief Sets whether the software engine redraws only the damaged regions of the target buffer.
+*
+* When it's enabled, only the regions covered by the updated, added or removed paints are cleared and redrawn,
+* while the rest of the target buffer keeps the content of the previous drawing.
+* The whole target is redrawn after enabling it or changing the target buffer.
+*
+* \param[in] canvas The Tvg_Canvas object of which the redraw behavior is to be specified.
+* \param[in] on If @c true, only the damaged regions are redrawn. The default value is @c false.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENTS An invalid canvas pointer passed.
+* \retval TVG_RESULT_INSUFFICIENT_CONDITION The canvas is in the middle of the drawing.
+* \retval TVG_RESULT_NOT_SUPPORTED The software engine is not supported.
+*
+* \note The damaged regions are always cleared before they are redrawn, thus tvg_canvas_clear() doesn't clear the target buffer in this mode.
+* \see tvg_swcanvas_get_damages()
+* \note Experimental API
+*/
+TVG_API Tvg_Result tvg_swcanvas_set_partial(Tvg_Canvas* canvas, bool on);
+
+
+/*!
+* \brief Retrieves the regions of the target buffer that were redrawn by the last tvg_canvas_draw().
+*
+* The regions don't overlap each other, so only these regions need to be presented to the display.
+*
+* \param[in] canvas The Tvg_Canvas object of which the redrawn regions are to be retrieved.
+* \param[out] regions Optional. A pointer to the array of the redrawn regions.
+* \param[out] cnt The number of the redrawn regions.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENTS An invalid canvas pointer or @p cnt passed.
+*
+* \note The regions are valid until the next tvg_canvas_draw() is called.
+* \see tvg_swcanvas_set_partial()
+* \note Experimental API
+*/
+TVG_API Tvg_Result tvg_swcanvas_get_damages(const Tvg_Canvas* canvas, const Tvg_Region** regions, uint32_t* cnt);
+
+
+/*!
+* \brief Sets the memory budget for the raster caches of the paints drawn by the canvas.
+*
+* When a new cache exceeds the budget, the least recently drawn caches are released first.
+*
+* \param[in] canvas The Tvg_Canvas object of which the cache budget is to be specified.
+* \param[in] size The budget in bytes. The default value is 32MB.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INVALID_ARGUMENTS An invalid canvas pointer passed.
+* \retval TVG_RESULT_INSUFFICIENT_CONDITION The canvas is in the middle of the drawing.
+* \retval TVG_RESULT_NOT_SUPPORTED The software engine is not supported.
+*
+* \see tvg_paint_set_cache()
+* \note Experimental API
+*/
+TVG_API Tvg_Result tvg_swcanvas_set_cache_budget(Tvg_Canvas* canvas, uint32_t size);
+
 /** \} */   // end defgroup ThorVGCapi_SwCanvas
 
 
@@ -1007,6 +1113,24 @@ TVG_API Tvg_Result tvg_paint_set_blend_method(const Tvg_Paint* paint, Tvg_Blend_
 TVG_API Tvg_Result tvg_paint_get_blend_method(const Tvg_Paint* paint, Tvg_Blend_Method* method);
 
 
+/**
+ * @brief Sets whether the paint object is rendered through its own raster cache.
+ *
+ * When the cache is enabled, the paint and its descendants are rasterized once into an offscreen image,
+ * which is reused as long as the paint is translated by the whole pixels or its opacity is changed only.
+ *
+ * \param[in] paint The Tvg_Paint object to be cached.
+ * \param[in] on If @c true, the paint is cached. The default value is @c false.
+ *
+ * \return Tvg_Result enumeration.
+ * \retval TVG_RESULT_INVALID_ARGUMENT In case a @c nullptr is passed as the argument.
+ *
+ * \see tvg_swcanvas_set_cache_budget()
+ * @note Experimental API
+ */
+TVG_API Tvg_Result tvg_paint_set_cache(Tvg_Paint* paint, bool on);
+
+
 /** \} */   // end defgroup ThorVGCapi_Paint
 
 /**
@@ -2368,6 +2492,26 @@ TVG_API Tvg_Animation* tvg_lottie_animation_new();
 TVG_API Tvg_Result tvg_lottie_animation_override(Tvg_Animation* animation, const char* slot);
 
 
+/*!
+* \brief Save the loaded animation as the precompiled binary data. (Experimental API)
+*
+* The saved data can be loaded through tvg_picture_load() much faster than the original Lottie json.
+*
+* \param[in] animation The Tvg_Animation object to save.
+* \param[in] path The file path to save the binary data. The ".lotb" extension is recommended.
+*
+* \return Tvg_Result enumeration.
+* \retval TVG_RESULT_SUCCESS Succeed.
+* \retval TVG_RESULT_INSUFFICIENT_CONDITION In case the animation is not loaded.
+* \retval TVG_RESULT_INVALID_ARGUMENT An invalid Tvg_Animation pointer or the @p path is @c nullptr.
+* \retval TVG_RESULT_UNKNOWN In case the data could not be written to the given @p path.
+* \retval TVG_RESULT_NOT_SUPPORTED The Lottie Animation is not supported.
+*
+* \note The binary data is bound to the engine version which generated it.
+*/
+TVG_API Tvg_Result tvg_lottie_animation_save(Tvg_Animation* animation, const char* path);
+
+
 /** \} */   // end addtogroup ThorVGCapi_LottieAnimation
 
 
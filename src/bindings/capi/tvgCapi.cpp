@@ -75,6 +75,35 @@ TVG_API Tvg_Result tvg_swcanvas_set_mempool(Tvg_Canvas* canvas, Tvg_Mempool_Poli
 }
 
 
+TVG_API Tvg_Result tvg_swcanvas_set_raster_policy(Tvg_Canvas* canvas, Tvg_Raster_Policy policy)
+{
+    if (!canvas) return TVG_RESULT_INVALID_ARGUMENT;
+    return (Tvg_Result) reinterpret_cast<SwCanvas*>(canvas)->raster(static_cast<SwCanvas::RasterPolicy>(policy));
+}
+
+
+TVG_API Tvg_Result tvg_swcanvas_set_partial(Tvg_Canvas* canvas, bool on)
+{
+    if (!canvas) return TVG_RESULT_INVALID_ARGUMENT;
+    return (Tvg_Result) reinterpret_cast<SwCanvas*>(canvas)->partial(on);
+}
+
+
+TVG_API Tvg_Result tvg_swcanvas_get_damages(const Tvg_Canvas* canvas, const Tvg_Region** regions, uint32_t* cnt)
+{
+    if (!canvas || !cnt) return TVG_RESULT_INVALID_ARGUMENT;
+    *cnt = reinterpret_cast<const SwCanvas*>(canvas)->damages(reinterpret_cast<const SwCanvas::Region**>(regions));
+    return TVG_RESULT_SUCCESS;
+}
+
+
+TVG_API Tvg_Result tvg_swcanvas_set_cache_budget(Tvg_Canvas* canvas, uint32_t size)
+{
+    if (!canvas) return TVG_RESULT_INVALID_ARGUMENT;
+    return (Tvg_Result) reinterpret_cast<SwCanvas*>(canvas)->cacheBudget(size);
+}
+
+
 TVG_API Tvg_Result tvg_swcanvas_set_target(Tvg_Canvas* canvas, uint32_t* buffer, uint32_t stride, uint32_t w, uint32_t h, Tvg_Colorspace cs)
 {
     if (!canvas) return TVG_RESULT_INVALID_ARGUMENT;
@@ -237,6 +266,13 @@ TVG_API Tvg_Result tvg_paint_get_blend_method(const Tvg_Paint* paint, Tvg_Blend_
 }
 
 
+TVG_API Tvg_Result tvg_paint_set_cache(Tvg_Paint* paint, bool on)
+{
+    if (!paint) return TVG_RESULT_INVALID_ARGUMENT;
+    return (Tvg_Result) reinterpret_cast<Paint*>(paint)->cache(on);
+}
+
+
 TVG_API Tvg_Result tvg_paint_get_identifier(const Tvg_Paint* paint, Tvg_Identifier* identifier)
 {
     if (!paint || !identifier) return TVG_RESULT_INVALID_ARGUMENT;
@@ -798,6 +834,16 @@ TVG_API Tvg_Result tvg_lottie_animation_override(Tvg_Animation* animation, const
     return TVG_RESULT_NOT_SUPPORTED;
 }
 
+
+TVG_API Tvg_Result tvg_lottie_animation_save(Tvg_Animation* animation, const char* path)
+{
+#ifdef THORVG_LOTTIE_LOADER_SUPPORT
+    if (!animation) return TVG_RESULT_INVALID_ARGUMENT;
+    return (Tvg_Result) reinterpret_cast<LottieAnimation*>(animation)->save(path);
+#endif
+    return TVG_RESULT_NOT_SUPPORTED;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -128,7 +128,7 @@ bool WebpLoader::read()
 
     if (!data || w == 0 || h == 0) return false;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -111,7 +111,7 @@ bool JpgLoader::read()
 
     if (!decoder || w == 0 || h == 0) return false;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
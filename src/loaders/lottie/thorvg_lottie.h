@@ -35,6 +35,40 @@ public:
      */
     Result override(const char* slot) noexcept;
 
+    /**
+     * @brief Saves the loaded animation as the precompiled binary data.
+     *
+     * The saved data can be loaded through Picture::load() much faster than the original Lottie JSON,
+     * since it skips the parsing and the preparation of the animation.
+     *
+     * @param[in] path The file path to save the binary data. The ".lotb" extension is recommended.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the animation is not loaded.
+     * @retval Result::InvalidArguments In case the @p path is @c nullptr.
+     * @retval Result::Unknown In case the data could not be written to the given @p path.
+     *
+     * @note The binary data is bound to the engine version which generated it.
+     * @note Experimental API
+     */
+    Result save(const char* path) noexcept;
+
+    /**
+     * @brief Retrieves the statistics of the static contents, which are built once and kept over the frames.
+     *
+     * @param[out] layers The number of the layers.
+     * @param[out] staticLayers The number of the layers without any animated properties.
+     * @param[out] objects The number of the objects within the layers.
+     * @param[out] staticObjects The number of the objects without any animated properties.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the animation is not loaded.
+     *
+     * @note Any of the parameters can be @c nullptr if the value is not needed.
+     * @note Experimental API
+     */
+    Result stats(uint32_t* layers, uint32_t* staticLayers, uint32_t* objects, uint32_t* staticObjects) noexcept;
+
     /**
      * @brief Creates a new LottieAnimation object.
      *
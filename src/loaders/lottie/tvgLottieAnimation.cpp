@@ -50,6 +50,30 @@ Result LottieAnimation::override(const char* slot) noexcept
 }
 
 
+Result LottieAnimation::save(const char* path) noexcept
+{
+    if (!path) return Result::InvalidArguments;
+
+    auto loader = static_cast<LottieLoader*>(pImpl->picture->pImpl->loader);
+    if (!loader) return Result::InsufficientCondition;
+
+    if (loader->save(path)) return Result::Success;
+
+    return Result::Unknown;
+}
+
+
+Result LottieAnimation::stats(uint32_t* layers, uint32_t* staticLayers, uint32_t* objects, uint32_t* staticObjects) noexcept
+{
+    auto loader = static_cast<LottieLoader*>(pImpl->picture->pImpl->loader);
+    if (!loader) return Result::InsufficientCondition;
+
+    if (loader->stats(layers, staticLayers, objects, staticObjects)) return Result::Success;
+
+    return Result::InsufficientCondition;
+}
+
+
 unique_ptr<LottieAnimation> LottieAnimation::gen() noexcept
 {
     return unique_ptr<LottieAnimation>(new LottieAnimation);
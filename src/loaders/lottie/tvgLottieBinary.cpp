@@ -0,0 +1,1284 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "tvgStr.h"
+#include "tvgLottieModel.h"
+#include "tvgLottieBinary.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define LOTTIE_BINARY_SIGNATURE "ThorLOTB"
+#define LOTTIE_BINARY_SIGNATURE_LENGTH 8
+#define LOTTIE_BINARY_VERSION 1
+
+struct LottieBinaryHeader
+{
+    char signature[LOTTIE_BINARY_SIGNATURE_LENGTH];
+    uint16_t version;
+    uint8_t layout[6];       //sizes of the raw data, to detect the binaries of the other builds
+    uint32_t w, h;
+    float startFrame, endFrame;
+    float frameRate;
+};
+
+
+struct Writer
+{
+    Array<uint8_t> buffer;
+    Array<LottieObject*> objects;   //written objects in order, the slots refer to them
+    LottieComposition* comp;
+};
+
+
+struct Reader
+{
+    const uint8_t* ptr;
+    const uint8_t* end;
+    Array<LottieObject*> objects;   //read objects in order, the slots refer to them
+    Array<LottieLayer*> references; //the layers referring to the assets
+    LottieComposition* comp;
+    bool invalid = false;
+};
+
+
+static void _layout(uint8_t* layout)
+{
+    layout[0] = sizeof(void*);
+    layout[1] = sizeof(LottieScalarFrame<float>);
+    layout[2] = sizeof(LottieScalarFrame<Point>);
+    layout[3] = sizeof(LottieVectorFrame<Point>);
+    layout[4] = sizeof(LottieScalarFrame<TextDocument>);
+    layout[5] = sizeof(Fill::ColorStop);
+}
+
+
+/* Writing */
+
+static void _write(Writer& w, const void* data, uint32_t size)
+{
+    if (size == 0) return;
+    if (w.buffer.count + size > w.buffer.reserved) w.buffer.reserve((w.buffer.count + size) * 2);
+    memcpy(w.buffer.data + w.buffer.count, data, size);
+    w.buffer.count += size;
+}
+
+
+template<typename T>
+static void _write(Writer& w, const T& value)
+{
+    _write(w, &value, sizeof(T));
+}
+
+
+//null is 0, others are the length + 1
+static void _writeString(Writer& w, const char* str)
+{
+    uint32_t len = str ? strlen(str) + 1 : 0;
+    _write(w, len);
+    if (len > 1) _write(w, str, len - 1);
+}
+
+
+static LottieInterpolator* _index(Writer& w, LottieInterpolator* interpolator)
+{
+    if (!interpolator) return nullptr;
+    for (uint32_t i = 0; i < w.comp->interpolators.count; ++i) {
+        if (w.comp->interpolators[i] == interpolator) return reinterpret_cast<LottieInterpolator*>(uintptr_t(i + 1));
+    }
+    return nullptr;
+}
+
+
+//the keyframes as they are, but the interpolators in their indices
+template<typename F>
+static void _writeFrames(Writer& w, Array<F>* frames)
+{
+    uint32_t cnt = frames ? frames->count : 0;
+    _write(w, cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto frame = (*frames)[i];
+        frame.interpolator = _index(w, frame.interpolator);
+        _write(w, frame);
+    }
+}
+
+
+template<typename T>
+static void _write(Writer& w, LottieGenericProperty<T>& prop)
+{
+    _write(w, prop.value);
+    _writeFrames(w, prop.frames);
+}
+
+
+static void _write(Writer& w, LottiePosition& prop)
+{
+    _write(w, prop.value);
+    _writeFrames(w, prop.frames);
+}
+
+
+static void _write(Writer& w, const PathSet& pathset)
+{
+    _write(w, pathset.pts, sizeof(Point) * pathset.ptsCnt);
+    _write(w, pathset.cmds, sizeof(PathCommand) * pathset.cmdsCnt);
+}
+
+
+static void _write(Writer& w, LottiePathSet& prop)
+{
+    _write(w, prop.value.ptsCnt);
+    _write(w, prop.value.cmdsCnt);
+    _write(w, prop.value);
+    _writeFrames(w, prop.frames);
+    if (!prop.frames) return;
+    for (auto p = prop.frames->begin(); p < prop.frames->end(); ++p) {
+        _write(w, p->value);
+    }
+}
+
+
+static void _write(Writer& w, LottieColorStop& prop)
+{
+    _write(w, prop.count);
+    _writeFrames(w, prop.frames);
+    if (!prop.frames) {
+        _write(w, prop.value.data, sizeof(Fill::ColorStop) * prop.count);
+        return;
+    }
+    for (auto p = prop.frames->begin(); p < prop.frames->end(); ++p) {
+        _write(w, p->value.data, sizeof(Fill::ColorStop) * prop.count);
+    }
+}
+
+
+static void _write(Writer& w, LottieTextDoc& prop)
+{
+    //the strings follow
+    auto value = prop.value;
+    value.text = value.name = nullptr;
+    _write(w, &value, sizeof(TextDocument));
+    _writeString(w, prop.value.text);
+    _writeString(w, prop.value.name);
+    _writeFrames(w, prop.frames);
+    if (!prop.frames) return;
+    for (auto p = prop.frames->begin(); p < prop.frames->end(); ++p) {
+        _writeString(w, p->value.text);
+        _writeString(w, p->value.name);
+    }
+}
+
+
+static void _write(Writer& w, LottieStroke* stroke)
+{
+    _write(w, stroke->width);
+    _write(w, uint8_t(stroke->dashattr ? 1 : 0));
+    if (stroke->dashattr) {
+        for (int i = 0; i < 3; ++i) _write(w, stroke->dashattr->value[i]);
+    }
+    _write(w, stroke->miterLimit);
+    _write(w, stroke->cap);
+    _write(w, stroke->join);
+}
+
+
+static void _write(Writer& w, LottieGradient* gradient)
+{
+    _write(w, gradient->start);
+    _write(w, gradient->end);
+    _write(w, gradient->height);
+    _write(w, gradient->angle);
+    _write(w, gradient->opacity);
+    _write(w, gradient->colorStops);
+    _write(w, gradient->id);
+}
+
+
+static void _write(Writer& w, LottieObject* obj);
+
+
+static void _write(Writer& w, LottieLayer* layer)
+{
+    //the unknown kinds (camera, audio, etc) are updated as the shape layers
+    _write(w, layer->type > LottieLayer::Text ? LottieLayer::Shape : layer->type);
+
+    //the referred asset is attached on the build
+    uint32_t cnt = layer->refId ? 0 : layer->children.count;
+    _write(w, cnt);
+    for (uint32_t i = 0; i < cnt; ++i) _write(w, layer->children[i]);
+    _write(w, layer->reqFragment);
+
+    _write(w, layer->matte.type);
+    _write(w, uint8_t(layer->matte.target ? 1 : 0));
+    if (layer->matte.target) _write(w, static_cast<LottieObject*>(layer->matte.target));
+
+    _write(w, uint8_t(layer->transform ? 1 : 0));
+    if (layer->transform) _write(w, static_cast<LottieObject*>(layer->transform));
+
+    _write(w, layer->masks.count);
+    for (auto m = layer->masks.begin(); m < layer->masks.end(); ++m) {
+        _write(w, (*m)->pathset);
+        _write(w, (*m)->opacity);
+        _write(w, (*m)->method);
+        _write(w, (*m)->inverse);
+    }
+
+    _write(w, layer->blendMethod);
+    _write(w, layer->timeRemap);
+    _write(w, layer->color);
+    _write(w, layer->timeStretch);
+    _write(w, layer->w);
+    _write(w, layer->h);
+    _write(w, layer->inFrame);
+    _write(w, layer->outFrame);
+    _write(w, layer->startFrame);
+    _writeString(w, layer->refId);
+    _write(w, layer->pid);
+    _write(w, layer->id);
+    _write(w, layer->autoOrient);
+    _write(w, layer->matteSrc);
+    _write(w, layer->remapped);
+}
+
+
+static void _write(Writer& w, LottieObject* obj)
+{
+    w.objects.push(obj);
+
+    _write(w, obj->type);
+    _writeString(w, obj->name);
+    _write(w, obj->statical);
+    _write(w, obj->hidden);
+
+    switch (obj->type) {
+        case LottieObject::Layer: {
+            _write(w, static_cast<LottieLayer*>(obj));
+            break;
+        }
+        case LottieObject::Group: {
+            auto group = static_cast<LottieGroup*>(obj);
+            _write(w, group->children.count);
+            for (auto c = group->children.begin(); c < group->children.end(); ++c) _write(w, *c);
+            _write(w, group->reqFragment);
+            break;
+        }
+        case LottieObject::Transform: {
+            auto transform = static_cast<LottieTransform*>(obj);
+            _write(w, transform->position);
+            _write(w, transform->rotation);
+            _write(w, transform->scale);
+            _write(w, transform->anchor);
+            _write(w, transform->opacity);
+            _write(w, uint8_t(transform->coords ? 1 : 0));
+            if (transform->coords) {
+                _write(w, transform->coords->x);
+                _write(w, transform->coords->y);
+            }
+            _write(w, uint8_t(transform->rotationEx ? 1 : 0));
+            if (transform->rotationEx) {
+                _write(w, transform->rotationEx->x);
+                _write(w, transform->rotationEx->y);
+            }
+            break;
+        }
+        case LottieObject::SolidFill: {
+            auto fill = static_cast<LottieSolidFill*>(obj);
+            _write(w, fill->color);
+            _write(w, fill->opacity);
+            _write(w, fill->rule);
+            break;
+        }
+        case LottieObject::SolidStroke: {
+            auto stroke = static_cast<LottieSolidStroke*>(obj);
+            _write(w, stroke->color);
+            _write(w, stroke->opacity);
+            _write(w, static_cast<LottieStroke*>(stroke));
+            break;
+        }
+        case LottieObject::GradientFill: {
+            auto fill = static_cast<LottieGradientFill*>(obj);
+            _write(w, static_cast<LottieGradient*>(fill));
+            _write(w, fill->rule);
+            break;
+        }
+        case LottieObject::GradientStroke: {
+            auto stroke = static_cast<LottieGradientStroke*>(obj);
+            _write(w, static_cast<LottieGradient*>(stroke));
+            _write(w, static_cast<LottieStroke*>(stroke));
+            break;
+        }
+        case LottieObject::Rect: {
+            auto rect = static_cast<LottieRect*>(obj);
+            _write(w, rect->direction);
+            _write(w, rect->position);
+            _write(w, rect->size);
+            _write(w, rect->radius);
+            break;
+        }
+        case LottieObject::Ellipse: {
+            auto ellipse = static_cast<LottieEllipse*>(obj);
+            _write(w, ellipse->direction);
+            _write(w, ellipse->position);
+            _write(w, ellipse->size);
+            break;
+        }
+        case LottieObject::Path: {
+            auto path = static_cast<LottiePath*>(obj);
+            _write(w, path->direction);
+            _write(w, path->pathset);
+            break;
+        }
+        case LottieObject::Polystar: {
+            auto star = static_cast<LottiePolyStar*>(obj);
+            _write(w, star->direction);
+            _write(w, star->position);
+            _write(w, star->innerRadius);
+            _write(w, star->outerRadius);
+            _write(w, star->innerRoundness);
+            _write(w, star->outerRoundness);
+            _write(w, star->rotation);
+            _write(w, star->ptsCnt);
+            _write(w, star->type == LottiePolyStar::Star ? LottiePolyStar::Star : LottiePolyStar::Polygon);
+            break;
+        }
+        case LottieObject::Image: {
+            auto image = static_cast<LottieImage*>(obj);
+            _write(w, image->size);
+            _writeString(w, image->mimeType);
+            if (image->size > 0) _write(w, image->b64Data, image->size);
+            else _writeString(w, image->path);
+            break;
+        }
+        case LottieObject::Trimpath: {
+            auto trimpath = static_cast<LottieTrimpath*>(obj);
+            _write(w, trimpath->start);
+            _write(w, trimpath->end);
+            _write(w, trimpath->offset);
+            _write(w, trimpath->type == LottieTrimpath::Individual ? LottieTrimpath::Individual : LottieTrimpath::Simultaneous);
+            break;
+        }
+        case LottieObject::Text: {
+            auto text = static_cast<LottieText*>(obj);
+            _write(w, text->doc);
+            _write(w, text->spacing);
+            break;
+        }
+        case LottieObject::Repeater: {
+            auto repeater = static_cast<LottieRepeater*>(obj);
+            _write(w, repeater->copies);
+            _write(w, repeater->offset);
+            _write(w, repeater->position);
+            _write(w, repeater->rotation);
+            _write(w, repeater->scale);
+            _write(w, repeater->anchor);
+            _write(w, repeater->startOpacity);
+            _write(w, repeater->endOpacity);
+            _write(w, repeater->inorder);
+            break;
+        }
+        case LottieObject::RoundedCorner: {
+            _write(w, static_cast<LottieRoundedCorner*>(obj)->radius);
+            break;
+        }
+        default: break;
+    }
+}
+
+
+static void _write(Writer& w, LottieFont* font)
+{
+    _writeString(w, font->name);
+    _writeString(w, font->family);
+    _writeString(w, font->style);
+    _write(w, font->ascent);
+    _write(w, font->origin > LottieFont::Embedded ? LottieFont::Local : font->origin);
+    _write(w, font->chars.count);
+    for (auto c = font->chars.begin(); c < font->chars.end(); ++c) {
+        auto glyph = *c;
+        _writeString(w, glyph->code);
+        _write(w, glyph->width);
+        _write(w, glyph->size);
+        _write(w, glyph->children.count);
+        for (auto p = glyph->children.begin(); p < glyph->children.end(); ++p) _write(w, *p);
+    }
+}
+
+
+static void _write(Writer& w, LottieSlot* slot)
+{
+    _writeString(w, slot->sid);
+    _write(w, slot->type);
+    _write(w, slot->pairs.count);
+    for (auto pair = slot->pairs.begin(); pair < slot->pairs.end(); ++pair) {
+        uint32_t idx = 0;
+        while (idx < w.objects.count && w.objects[idx] != pair->obj) ++idx;
+        _write(w, idx);
+    }
+}
+
+
+/* Reading */
+
+static bool _read(Reader& r, void* data, uint32_t size)
+{
+    if (r.invalid || size > uint32_t(r.end - r.ptr)) {
+        r.invalid = true;
+        return false;
+    }
+    if (size == 0) return true;
+    memcpy(data, r.ptr, size);
+    r.ptr += size;
+    return true;
+}
+
+
+template<typename T>
+static bool _read(Reader& r, T& value)
+{
+    return _read(r, &value, sizeof(T));
+}
+
+
+//the raw bytes are not trustworthy as a bool
+static bool _read(Reader& r, bool& value)
+{
+    uint8_t raw = 0;
+    if (!_read(r, raw)) return false;
+    value = (raw != 0);
+    return true;
+}
+
+
+//the enumerators must be in the range [first, last]
+template<typename T>
+static bool _read(Reader& r, T& value, T first, T last)
+{
+    if (!_read(r, value)) return false;
+    if (value < first || value > last) {
+        r.invalid = true;
+        return false;
+    }
+    return true;
+}
+
+
+static void _normalize(bool& value)
+{
+    auto raw = reinterpret_cast<uint8_t*>(&value);
+    *raw = (*raw != 0);
+}
+
+
+template<typename T>
+static void _normalize(LottieScalarFrame<T>& frame)
+{
+    _normalize(frame.hold);
+}
+
+
+template<typename T>
+static void _normalize(LottieVectorFrame<T>& frame)
+{
+    _normalize(frame.hold);
+    _normalize(frame.hasTangent);
+}
+
+
+static char* _readString(Reader& r)
+{
+    uint32_t len;
+    if (!_read(r, len) || len == 0) return nullptr;
+    if (len - 1 > uint32_t(r.end - r.ptr)) {
+        r.invalid = true;
+        return nullptr;
+    }
+    auto str = strDuplicate((const char*)r.ptr, len - 1);
+    r.ptr += len - 1;
+    return str;
+}
+
+
+//the items of the count must be in the data
+static bool _count(Reader& r, uint32_t& cnt, uint32_t size)
+{
+    if (_read(r, cnt) && (size == 0 || cnt <= uint32_t(r.end - r.ptr) / size)) return true;
+    r.invalid = true;
+    cnt = 0;
+    return false;
+}
+
+
+template<typename F>
+static Array<F>* _readFrames(Reader& r, Array<F>* frames)
+{
+    uint32_t cnt;
+    if (!_count(r, cnt, sizeof(F)) || cnt == 0) return nullptr;
+
+    frames->reserve(cnt);
+    _read(r, frames->data, sizeof(F) * cnt);
+    frames->count = cnt;
+
+    for (auto p = frames->begin(); p < frames->end(); ++p) {
+        _normalize(*p);
+        auto idx = reinterpret_cast<uintptr_t>(p->interpolator);
+        if (idx > r.comp->interpolators.count) {
+            r.invalid = true;
+            idx = 0;
+        }
+        p->interpolator = idx ? r.comp->interpolators[idx - 1] : nullptr;
+        //the keyframes are searched in order
+        if (std::isnan(p->no) || (p > frames->begin() && p->no < (p - 1)->no)) r.invalid = true;
+    }
+    return frames;
+}
+
+
+template<typename T>
+static void _read(Reader& r, LottieGenericProperty<T>& prop)
+{
+    _read(r, prop.value);
+    prop.frames = new Array<LottieScalarFrame<T>>;
+    if (!_readFrames(r, prop.frames)) {
+        delete(prop.frames);
+        prop.frames = nullptr;
+    }
+}
+
+
+static void _read(Reader& r, LottiePosition& prop)
+{
+    _read(r, prop.value);
+    prop.frames = new Array<LottieVectorFrame<Point>>;
+    if (!_readFrames(r, prop.frames)) {
+        delete(prop.frames);
+        prop.frames = nullptr;
+    }
+}
+
+
+static void _read(Reader& r, PathSet& pathset)
+{
+    if (pathset.ptsCnt > uint32_t(r.end - r.ptr) / sizeof(Point)) r.invalid = true;
+    if (pathset.cmdsCnt > uint32_t(r.end - r.ptr) / sizeof(PathCommand)) r.invalid = true;
+
+    if (r.invalid) {
+        pathset = PathSet();
+        return;
+    }
+
+    pathset.pts = pathset.ptsCnt ? static_cast<Point*>(malloc(sizeof(Point) * pathset.ptsCnt)) : nullptr;
+    _read(r, pathset.pts, sizeof(Point) * pathset.ptsCnt);
+    pathset.cmds = pathset.cmdsCnt ? static_cast<PathCommand*>(malloc(sizeof(PathCommand) * pathset.cmdsCnt)) : nullptr;
+    _read(r, pathset.cmds, sizeof(PathCommand) * pathset.cmdsCnt);
+
+    if (r.invalid) return;
+
+    //the commands must consume the points exactly
+    uint32_t ptsCnt = 0;
+    for (uint32_t i = 0; i < pathset.cmdsCnt; ++i) {
+        switch (pathset.cmds[i]) {
+            case PathCommand::Close: break;
+            case PathCommand::MoveTo:
+            case PathCommand::LineTo: ptsCnt += 1; break;
+            case PathCommand::CubicTo: ptsCnt += 3; break;
+            default: r.invalid = true; return;
+        }
+    }
+    if (ptsCnt != pathset.ptsCnt) r.invalid = true;
+}
+
+
+static void _read(Reader& r, LottiePathSet& prop)
+{
+    _read(r, prop.value.ptsCnt);
+    _read(r, prop.value.cmdsCnt);
+    _read(r, prop.value);
+
+    auto frames = static_cast<Array<LottieScalarFrame<PathSet>>*>(calloc(1, sizeof(Array<LottieScalarFrame<PathSet>>)));
+    if (!_readFrames(r, frames)) {
+        free(frames);
+        return;
+    }
+    //the paths are not valid yet
+    for (auto p = frames->begin(); p < frames->end(); ++p) {
+        p->value.pts = nullptr;
+        p->value.cmds = nullptr;
+    }
+    prop.frames = frames;
+    for (auto p = frames->begin(); p < frames->end(); ++p) {
+        _read(r, p->value);
+        //the points are interpolated with the next keyframe's
+        if (p > frames->begin() && p->value.ptsCnt < (p - 1)->value.ptsCnt) r.invalid = true;
+    }
+}
+
+
+static Fill::ColorStop* _readColorStops(Reader& r, uint16_t cnt)
+{
+    if (cnt == 0 || cnt > uint32_t(r.end - r.ptr) / sizeof(Fill::ColorStop)) {
+        if (cnt > 0) r.invalid = true;
+        return nullptr;
+    }
+    auto data = static_cast<Fill::ColorStop*>(malloc(sizeof(Fill::ColorStop) * cnt));
+    _read(r, data, sizeof(Fill::ColorStop) * cnt);
+    return data;
+}
+
+
+static void _read(Reader& r, LottieColorStop& prop)
+{
+    _read(r, prop.count);
+    prop.populated = true;
+
+    auto frames = static_cast<Array<LottieScalarFrame<ColorStop>>*>(calloc(1, sizeof(Array<LottieScalarFrame<ColorStop>>)));
+    if (!_readFrames(r, frames)) {
+        free(frames);
+        prop.value.data = _readColorStops(r, prop.count);
+        prop.value.count = prop.count;
+        return;
+    }
+    for (auto p = frames->begin(); p < frames->end(); ++p) {
+        p->value.data = nullptr;
+        p->value.input = nullptr;
+    }
+    prop.frames = frames;
+    for (auto p = frames->begin(); p < frames->end(); ++p) {
+        p->value.data = _readColorStops(r, prop.count);
+        p->value.count = prop.count;
+    }
+}
+
+
+static void _read(Reader& r, LottieTextDoc& prop)
+{
+    _read(r, &prop.value, sizeof(TextDocument));
+    _normalize(prop.value.stroke.render);
+    prop.value.text = _readString(r);
+    prop.value.name = _readString(r);
+
+    prop.frames = new Array<LottieScalarFrame<TextDocument>>;
+    if (!_readFrames(r, prop.frames)) {
+        delete(prop.frames);
+        prop.frames = nullptr;
+        return;
+    }
+    for (auto p = prop.frames->begin(); p < prop.frames->end(); ++p) {
+        _normalize(p->value.stroke.render);
+        p->value.text = nullptr;
+        p->value.name = nullptr;
+    }
+    for (auto p = prop.frames->begin(); p < prop.frames->end(); ++p) {
+        p->value.text = _readString(r);
+        p->value.name = _readString(r);
+    }
+}
+
+
+static void _read(Reader& r, LottieStroke* stroke)
+{
+    _read(r, stroke->width);
+    uint8_t dashattr = 0;
+    _read(r, dashattr);
+    if (dashattr) {
+        for (int i = 0; i < 3; ++i) _read(r, stroke->dash(i));
+    }
+    _read(r, stroke->miterLimit);
+    _read(r, stroke->cap, StrokeCap::Square, StrokeCap::Butt);
+    _read(r, stroke->join, StrokeJoin::Bevel, StrokeJoin::Miter);
+}
+
+
+static void _read(Reader& r, LottieGradient* gradient)
+{
+    _read(r, gradient->start);
+    _read(r, gradient->end);
+    _read(r, gradient->height);
+    _read(r, gradient->angle);
+    _read(r, gradient->opacity);
+    _read(r, gradient->colorStops);
+    _read(r, gradient->id);
+}
+
+
+static LottieObject* _readObject(Reader& r);
+
+
+//the builder casts the children by the kind of their parent
+static bool _acceptable(LottieGroup* parent, LottieObject* child)
+{
+    if (parent->type == LottieObject::Group) return child->type != LottieObject::Layer;
+
+    switch (static_cast<LottieLayer*>(parent)->type) {
+        case LottieLayer::Precomp: return child->type == LottieObject::Layer;
+        case LottieLayer::Text: return child->type == LottieObject::Text;
+        default: return child->type != LottieObject::Layer;
+    }
+}
+
+
+static bool _readChildren(Reader& r, LottieGroup* group)
+{
+    uint32_t cnt;
+    if (!_count(r, cnt, 1)) return false;
+    group->children.reserve(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto child = _readObject(r);
+        if (!child) return false;
+        group->children.push(child);
+        if (!_acceptable(group, child)) return false;
+    }
+    return _read(r, group->reqFragment);
+}
+
+
+static LottieLayer* _readLayer(Reader& r, LottieLayer* layer)
+{
+    auto ret = _read(r, layer->type, LottieLayer::Precomp, LottieLayer::Text) && _readChildren(r, layer);
+
+    uint8_t exist = 0;
+    ret &= _read(r, layer->matte.type, CompositeMethod::None, CompositeMethod::DifferenceMask) && _read(r, exist);
+    if (ret && exist) {
+        auto target = _readObject(r);
+        if (target && target->type == LottieObject::Layer) layer->matte.target = static_cast<LottieLayer*>(target);
+        else ret = false;
+        if (!layer->matte.target) delete(target);
+    }
+
+    exist = 0;
+    if (ret) _read(r, exist);
+    if (ret && exist) {
+        auto transform = _readObject(r);
+        if (transform && transform->type == LottieObject::Transform) layer->transform = static_cast<LottieTransform*>(transform);
+        else ret = false;
+        if (!layer->transform) delete(transform);
+    }
+
+    uint32_t cnt = 0;
+    if (ret) ret = _count(r, cnt, 1);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        auto mask = new LottieMask;
+        layer->masks.push(mask);
+        _read(r, mask->pathset);
+        _read(r, mask->opacity);
+        _read(r, mask->method, CompositeMethod::None, CompositeMethod::DifferenceMask);
+        _read(r, mask->inverse);
+    }
+
+    if (!ret) r.invalid = true;
+
+    _read(r, layer->blendMethod, BlendMethod::Normal, BlendMethod::SoftLight);
+    _read(r, layer->timeRemap);
+    _read(r, layer->color);
+    _read(r, layer->timeStretch);
+    _read(r, layer->w);
+    _read(r, layer->h);
+    _read(r, layer->inFrame);
+    _read(r, layer->outFrame);
+    _read(r, layer->startFrame);
+    layer->refId = _readString(r);
+
+    //the referring layers borrow the asset children, they never own any.
+    if (layer->refId) {
+        if (!layer->children.empty()) {
+            for (auto p = layer->children.begin(); p < layer->children.end(); ++p) delete(*p);
+            layer->children.clear();
+            r.invalid = true;
+        }
+        r.references.push(layer);
+    }
+
+    _read(r, layer->pid);
+    _read(r, layer->id);
+    _read(r, layer->autoOrient);
+    _read(r, layer->matteSrc);
+    _read(r, layer->remapped);
+
+    layer->comp = r.comp;
+
+    return layer;
+}
+
+
+static LottieObject* _generate(LottieObject::Type type)
+{
+    switch (type) {
+        case LottieObject::Layer: return new LottieLayer;
+        case LottieObject::Group: return new LottieGroup;
+        case LottieObject::Transform: return new LottieTransform;
+        case LottieObject::SolidFill: return new LottieSolidFill;
+        case LottieObject::SolidStroke: return new LottieSolidStroke;
+        case LottieObject::GradientFill: return new LottieGradientFill;
+        case LottieObject::GradientStroke: return new LottieGradientStroke;
+        case LottieObject::Rect: return new LottieRect;
+        case LottieObject::Ellipse: return new LottieEllipse;
+        case LottieObject::Path: return new LottiePath;
+        case LottieObject::Polystar: return new LottiePolyStar;
+        case LottieObject::Image: return new LottieImage;
+        case LottieObject::Trimpath: return new LottieTrimpath;
+        case LottieObject::Text: return new LottieText;
+        case LottieObject::Repeater: return new LottieRepeater;
+        case LottieObject::RoundedCorner: return new LottieRoundedCorner;
+        default: return nullptr;
+    }
+}
+
+
+static LottieObject* _readObject(Reader& r)
+{
+    LottieObject::Type type;
+    if (!_read(r, type)) return nullptr;
+
+    auto obj = _generate(type);
+    if (!obj) {
+        r.invalid = true;
+        return nullptr;
+    }
+    obj->type = type;
+    r.objects.push(obj);
+
+    obj->name = _readString(r);
+    _read(r, obj->statical);
+    _read(r, obj->hidden);
+
+    switch (type) {
+        case LottieObject::Layer: {
+            _readLayer(r, static_cast<LottieLayer*>(obj));
+            break;
+        }
+        case LottieObject::Group: {
+            if (!_readChildren(r, static_cast<LottieGroup*>(obj))) r.invalid = true;
+            break;
+        }
+        case LottieObject::Transform: {
+            auto transform = static_cast<LottieTransform*>(obj);
+            _read(r, transform->position);
+            _read(r, transform->rotation);
+            _read(r, transform->scale);
+            _read(r, transform->anchor);
+            _read(r, transform->opacity);
+            uint8_t exist = 0;
+            _read(r, exist);
+            if (exist) {
+                transform->coords = new LottieTransform::SeparateCoord;
+                _read(r, transform->coords->x);
+                _read(r, transform->coords->y);
+            }
+            exist = 0;
+            _read(r, exist);
+            if (exist) {
+                transform->rotationEx = new LottieTransform::RotationEx;
+                _read(r, transform->rotationEx->x);
+                _read(r, transform->rotationEx->y);
+            }
+            break;
+        }
+        case LottieObject::SolidFill: {
+            auto fill = static_cast<LottieSolidFill*>(obj);
+            _read(r, fill->color);
+            _read(r, fill->opacity);
+            _read(r, fill->rule, FillRule::Winding, FillRule::EvenOdd);
+            break;
+        }
+        case LottieObject::SolidStroke: {
+            auto stroke = static_cast<LottieSolidStroke*>(obj);
+            _read(r, stroke->color);
+            _read(r, stroke->opacity);
+            _read(r, static_cast<LottieStroke*>(stroke));
+            break;
+        }
+        case LottieObject::GradientFill: {
+            auto fill = static_cast<LottieGradientFill*>(obj);
+            _read(r, static_cast<LottieGradient*>(fill));
+            _read(r, fill->rule, FillRule::Winding, FillRule::EvenOdd);
+            break;
+        }
+        case LottieObject::GradientStroke: {
+            auto stroke = static_cast<LottieGradientStroke*>(obj);
+            _read(r, static_cast<LottieGradient*>(stroke));
+            _read(r, static_cast<LottieStroke*>(stroke));
+            break;
+        }
+        case LottieObject::Rect: {
+            auto rect = static_cast<LottieRect*>(obj);
+            _read(r, rect->direction);
+            _read(r, rect->position);
+            _read(r, rect->size);
+            _read(r, rect->radius);
+            break;
+        }
+        case LottieObject::Ellipse: {
+            auto ellipse = static_cast<LottieEllipse*>(obj);
+            _read(r, ellipse->direction);
+            _read(r, ellipse->position);
+            _read(r, ellipse->size);
+            break;
+        }
+        case LottieObject::Path: {
+            auto path = static_cast<LottiePath*>(obj);
+            _read(r, path->direction);
+            _read(r, path->pathset);
+            break;
+        }
+        case LottieObject::Polystar: {
+            auto star = static_cast<LottiePolyStar*>(obj);
+            _read(r, star->direction);
+            _read(r, star->position);
+            _read(r, star->innerRadius);
+            _read(r, star->outerRadius);
+            _read(r, star->innerRoundness);
+            _read(r, star->outerRoundness);
+            _read(r, star->rotation);
+            _read(r, star->ptsCnt);
+            _read(r, star->type, LottiePolyStar::Star, LottiePolyStar::Polygon);
+            break;
+        }
+        case LottieObject::Image: {
+            auto image = static_cast<LottieImage*>(obj);
+            _read(r, image->size);
+            image->mimeType = _readString(r);
+            if (image->size > 0) {
+                if (image->size > uint32_t(r.end - r.ptr)) {
+                    image->size = 0;
+                    r.invalid = true;
+                    break;
+                }
+                image->b64Data = static_cast<char*>(malloc(image->size));
+                _read(r, image->b64Data, image->size);
+            } else image->path = _readString(r);
+            image->idx = r.comp->imageCnt++;
+            break;
+        }
+        case LottieObject::Trimpath: {
+            auto trimpath = static_cast<LottieTrimpath*>(obj);
+            _read(r, trimpath->start);
+            _read(r, trimpath->end);
+            _read(r, trimpath->offset);
+            _read(r, trimpath->type, LottieTrimpath::Individual, LottieTrimpath::Simultaneous);
+            break;
+        }
+        case LottieObject::Text: {
+            auto text = static_cast<LottieText*>(obj);
+            _read(r, text->doc);
+            _read(r, text->spacing);
+            break;
+        }
+        case LottieObject::Repeater: {
+            auto repeater = static_cast<LottieRepeater*>(obj);
+            _read(r, repeater->copies);
+            _read(r, repeater->offset);
+            _read(r, repeater->position);
+            _read(r, repeater->rotation);
+            _read(r, repeater->scale);
+            _read(r, repeater->anchor);
+            _read(r, repeater->startOpacity);
+            _read(r, repeater->endOpacity);
+            _read(r, repeater->inorder);
+            break;
+        }
+        case LottieObject::RoundedCorner: {
+            _read(r, static_cast<LottieRoundedCorner*>(obj)->radius);
+            break;
+        }
+        default: break;
+    }
+    return obj;
+}
+
+
+static LottieFont* _readFont(Reader& r)
+{
+    auto font = new LottieFont;
+    font->name = _readString(r);
+    font->family = _readString(r);
+    font->style = _readString(r);
+    _read(r, font->ascent);
+    _read(r, font->origin, LottieFont::Local, LottieFont::Embedded);
+
+    //the text layers look up the fonts by their names
+    if (!font->name) r.invalid = true;
+
+    uint32_t cnt = 0;
+    _count(r, cnt, 1);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        auto glyph = new LottieGlyph;
+        font->chars.push(glyph);
+        glyph->code = _readString(r);
+        _read(r, glyph->width);
+        _read(r, glyph->size);
+        if (!glyph->code) {
+            r.invalid = true;
+            break;
+        }
+        glyph->len = strlen(glyph->code);
+        uint32_t cnt2 = 0;
+        _count(r, cnt2, 1);
+        for (uint32_t j = 0; j < cnt2; ++j) {
+            auto child = _readObject(r);
+            if (!child) break;
+            glyph->children.push(child);
+            //the glyph outlines are the groups of the paths
+            if (child->type != LottieObject::Group) r.invalid = true;
+            else {
+                auto group = static_cast<LottieGroup*>(child);
+                for (auto p = group->children.begin(); p < group->children.end(); ++p) {
+                    if ((*p)->type != LottieObject::Path) r.invalid = true;
+                }
+            }
+            if (r.invalid) break;
+        }
+    }
+    return font;
+}
+
+
+//the slot overriding casts the objects by the slot type
+static bool _acceptable(LottieProperty::Type type, LottieObject* obj)
+{
+    switch (type) {
+        case LottieProperty::Type::ColorStop: return obj->type == LottieObject::GradientFill || obj->type == LottieObject::GradientStroke;
+        case LottieProperty::Type::Color: return obj->type == LottieObject::SolidFill || obj->type == LottieObject::SolidStroke;
+        case LottieProperty::Type::TextDoc: return obj->type == LottieObject::Text;
+        default: return true;
+    }
+}
+
+
+static bool _readSlot(Reader& r)
+{
+    auto sid = _readString(r);
+    LottieProperty::Type type;
+    uint32_t cnt = 0;
+    _read(r, type, LottieProperty::Type::Point, LottieProperty::Type::TextDoc);
+    _count(r, cnt, sizeof(uint32_t));
+
+    if (!sid) r.invalid = true;
+
+    LottieSlot* slot = nullptr;
+
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        uint32_t idx;
+        if (!_read(r, idx) || idx >= r.objects.count || !_acceptable(type, r.objects[idx])) {
+            r.invalid = true;
+            break;
+        }
+        if (slot) slot->pairs.push({r.objects[idx]});
+        else slot = new LottieSlot(sid, r.objects[idx], type);
+    }
+
+    if (slot) r.comp->slots.push(slot);
+    else free(sid);
+
+    return !r.invalid;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+bool LottieBinary::verify(const char* data, uint32_t size)
+{
+    if (size < sizeof(LottieBinaryHeader)) return false;
+    return !memcmp(data, LOTTIE_BINARY_SIGNATURE, LOTTIE_BINARY_SIGNATURE_LENGTH);
+}
+
+
+bool LottieBinary::header(const char* data, uint32_t size, float& w, float& h, float& frameCnt, float& frameRate)
+{
+    if (!verify(data, size)) return false;
+
+    LottieBinaryHeader header;
+    memcpy(&header, data, sizeof(LottieBinaryHeader));
+
+    uint8_t layout[sizeof(header.layout)];
+    _layout(layout);
+
+    if (header.version != LOTTIE_BINARY_VERSION || memcmp(header.layout, layout, sizeof(layout))) {
+        TVGERR("LOTTIE", "The binary was generated by another version of the engine!");
+        return false;
+    }
+
+    w = static_cast<float>(header.w);
+    h = static_cast<float>(header.h);
+    frameCnt = header.endFrame - header.startFrame;
+    frameRate = header.frameRate;
+
+    return true;
+}
+
+
+LottieComposition* LottieBinary::read(const char* data, uint32_t size)
+{
+    float w, h, frameCnt, frameRate;
+    if (!header(data, size, w, h, frameCnt, frameRate)) return nullptr;
+
+    LottieBinaryHeader header;
+    memcpy(&header, data, sizeof(LottieBinaryHeader));
+
+    auto comp = new LottieComposition;
+    comp->w = header.w;
+    comp->h = header.h;
+    comp->startFrame = header.startFrame;
+    comp->endFrame = header.endFrame;
+    comp->frameRate = header.frameRate;
+
+    Reader r;
+    r.ptr = reinterpret_cast<const uint8_t*>(data) + sizeof(LottieBinaryHeader);
+    r.end = reinterpret_cast<const uint8_t*>(data) + size;
+    r.comp = comp;
+
+    comp->version = _readString(r);
+    comp->name = _readString(r);
+
+    //interpolators
+    uint32_t cnt = 0;
+    _count(r, cnt, sizeof(Point) * 2);
+    comp->interpolators.reserve(cnt);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        auto key = _readString(r);
+        Point inTangent, outTangent;
+        _read(r, inTangent);
+        _read(r, outTangent);
+        auto interpolator = static_cast<LottieInterpolator*>(malloc(sizeof(LottieInterpolator)));
+        interpolator->set(key ? key : "", inTangent, outTangent);
+        comp->interpolators.push(interpolator);
+        free(key);
+    }
+
+    //assets, the precomps or the images
+    cnt = 0;
+    _count(r, cnt, 1);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        if (auto asset = _readObject(r)) {
+            comp->assets.push(asset);
+            if (!asset->name) r.invalid = true;
+            else if (asset->type == LottieObject::Layer) {
+                if (static_cast<LottieLayer*>(asset)->type != LottieLayer::Precomp) r.invalid = true;
+            } else if (asset->type != LottieObject::Image) r.invalid = true;
+        }
+    }
+
+    //root layer
+    auto root = _readObject(r);
+    if (root && root->type == LottieObject::Layer) comp->root = static_cast<LottieLayer*>(root);
+    else {
+        delete(root);
+        r.invalid = true;
+    }
+    if (comp->root && comp->root->type != LottieLayer::Precomp) r.invalid = true;
+
+    //the referred assets must be of the kinds of the referring layers
+    for (auto p = r.references.begin(); p < r.references.end() && !r.invalid; ++p) {
+        auto layer = *p;
+        for (auto a = comp->assets.begin(); a < comp->assets.end(); ++a) {
+            if (strcmp(layer->refId, (*a)->name)) continue;
+            if (layer->type == LottieLayer::Precomp && (*a)->type != LottieObject::Layer) r.invalid = true;
+            if (layer->type == LottieLayer::Image && (*a)->type != LottieObject::Image) r.invalid = true;
+            break;
+        }
+    }
+
+    //fonts
+    cnt = 0;
+    _count(r, cnt, 1);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        comp->fonts.push(_readFont(r));
+    }
+
+    //slots
+    cnt = 0;
+    _count(r, cnt, 1);
+    for (uint32_t i = 0; i < cnt && !r.invalid; ++i) {
+        _readSlot(r);
+    }
+
+    if (r.invalid) {
+        TVGERR("LOTTIE", "The binary is corrupted!");
+        delete(comp);
+        return nullptr;
+    }
+
+    return comp;
+}
+
+
+bool LottieBinary::write(LottieComposition* comp, const char* path)
+{
+    if (!comp || !comp->root || !path) return false;
+
+    LottieBinaryHeader header;
+    memset(&header, 0x00, sizeof(LottieBinaryHeader));
+    memcpy(header.signature, LOTTIE_BINARY_SIGNATURE, LOTTIE_BINARY_SIGNATURE_LENGTH);
+    header.version = LOTTIE_BINARY_VERSION;
+    _layout(header.layout);
+    header.w = comp->w;
+    header.h = comp->h;
+    header.startFrame = comp->startFrame;
+    header.endFrame = comp->endFrame;
+    header.frameRate = comp->frameRate;
+
+    Writer w;
+    w.comp = comp;
+
+    _write(w, header);
+    _writeString(w, comp->version);
+    _writeString(w, comp->name);
+
+    //interpolators
+    _write(w, comp->interpolators.count);
+    for (auto i = comp->interpolators.begin(); i < comp->interpolators.end(); ++i) {
+        _writeString(w, (*i)->key);
+        _write(w, (*i)->inTangent);
+        _write(w, (*i)->outTangent);
+    }
+
+    //assets
+    _write(w, comp->assets.count);
+    for (auto a = comp->assets.begin(); a < comp->assets.end(); ++a) {
+        _write(w, *a);
+    }
+
+    //root layer
+    _write(w, static_cast<LottieObject*>(comp->root));
+
+    //fonts
+    _write(w, comp->fonts.count);
+    for (auto f = comp->fonts.begin(); f < comp->fonts.end(); ++f) {
+        _write(w, *f);
+    }
+
+    //slots
+    _write(w, comp->slots.count);
+    for (auto s = comp->slots.begin(); s < comp->slots.end(); ++s) {
+        _write(w, *s);
+    }
+
+    auto f = fopen(path, "wb");
+    if (!f) return false;
+    auto ret = (fwrite(w.buffer.data, 1, w.buffer.count, f) == w.buffer.count);
+    fclose(f);
+
+    return ret;
+}
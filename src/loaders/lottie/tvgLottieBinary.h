@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef _TVG_LOTTIE_BINARY_H_
+#define _TVG_LOTTIE_BINARY_H_
+
+#include "tvgCommon.h"
+
+struct LottieComposition;
+
+/* The precompiled lottie composition, a load-time cache of the lottie data rather than an interchange format.
+   The keyframes are stored in their memory layout, so that they are loaded by the bulk copies without parsing,
+   thus the data is bound to the build of the engine. The composition owns its copies, it's never used in place
+   since the composition could be shared by the animations and outlive the loaded data. */
+struct LottieBinary
+{
+    static bool verify(const char* data, uint32_t size);
+    static bool header(const char* data, uint32_t size, float& w, float& h, float& frameCnt, float& frameRate);
+    static LottieComposition* read(const char* data, uint32_t size);
+    static bool write(LottieComposition* comp, const char* path);
+};
+
+#endif //_TVG_LOTTIE_BINARY_H_
@@ -26,6 +26,7 @@
 #include "tvgMath.h"
 #include "tvgPaint.h"
 #include "tvgShape.h"
+#include "tvgFill.h"
 #include "tvgInlist.h"
 #include "tvgLottieModel.h"
 #include "tvgLottieBuilder.h"
@@ -57,6 +58,8 @@ struct RenderContext
 
     Shape* propagator = nullptr;
     Shape* merging = nullptr;  //merging shapes if possible (if shapes have same properties)
+    LottieBuilder* builder = nullptr;
+    LottieRenderScene* rscene = nullptr;  //retained paints of the layer
     LottieObject** begin = nullptr; //iteration entry point
     RenderRepeater* repeater = nullptr;
     float roundness = 0.0f;
@@ -64,7 +67,7 @@ struct RenderContext
     bool reqFragment = false;  //requirment to fragment the render context
     bool allowMerging = true;  //individual trimpath doesn't allow merging shapes
 
-    RenderContext()
+    RenderContext(LottieBuilder* builder, LottieRenderScene* rscene) : builder(builder), rscene(rscene)
     {
         propagator = Shape::gen().release();
     }
@@ -83,14 +86,290 @@ struct RenderContext
             *repeater = *rhs.repeater;
         }
         roundness = rhs.roundness;
+        builder = rhs.builder;
+        rscene = rhs.rscene;
     }
 };
 
 
 static void _updateChildren(LottieGroup* parent, float frameNo, Inlist<RenderContext>& contexts);
-static void _updateLayer(LottieLayer* root, LottieLayer* layer, float frameNo);
+static void _updateLayer(LottieBuilder* builder, LottieRenderScene* parent, LottieLayer* layer, float frameNo);
 static bool _buildComposition(LottieComposition* comp, LottieGroup* parent);
 
+
+/* The paints are retained across the frames. A frame update matches the paints to the retained ones
+   in the drawing order, and changes only the properties which differ from the last frame, so that
+   the renderer can skip or take the partial update of the unchanged data. */
+
+template<typename T>
+static void _swap(Array<T>& lhs, Array<T>& rhs)
+{
+    auto data = lhs.data;
+    auto count = lhs.count;
+    auto reserved = lhs.reserved;
+
+    lhs.data = rhs.data;
+    lhs.count = rhs.count;
+    lhs.reserved = rhs.reserved;
+
+    rhs.data = data;
+    rhs.count = count;
+    rhs.reserved = reserved;
+}
+
+
+static bool _equal(const Fill* lhs, const Fill* rhs)
+{
+    if (lhs == rhs) return true;
+    if (!lhs || !rhs || lhs->identifier() != rhs->identifier()) return false;
+
+    auto l = lhs->pImpl;
+    auto r = rhs->pImpl;
+
+    if (l->spread != r->spread || l->cnt != r->cnt) return false;
+    if (l->cnt > 0 && memcmp(l->colorStops, r->colorStops, sizeof(Fill::ColorStop) * l->cnt)) return false;
+    if (!l->transform != !r->transform) return false;
+    if (l->transform && memcmp(l->transform, r->transform, sizeof(Matrix))) return false;
+
+    if (lhs->identifier() == TVG_CLASS_ID_LINEAR) {
+        auto l = static_cast<const LinearGradient*>(lhs)->pImpl;
+        auto r = static_cast<const LinearGradient*>(rhs)->pImpl;
+        return (l->x1 == r->x1 && l->y1 == r->y1 && l->x2 == r->x2 && l->y2 == r->y2);
+    }
+
+    auto l2 = static_cast<const RadialGradient*>(lhs)->pImpl;
+    auto r2 = static_cast<const RadialGradient*>(rhs)->pImpl;
+    return (l2->cx == r2->cx && l2->cy == r2->cy && l2->r == r2->r && l2->fx == r2->fx && l2->fy == r2->fy && l2->fr == r2->fr);
+}
+
+
+static void _transform(Paint* paint, const Matrix& m)
+{
+    auto pm = PP(paint)->transform();
+    if (pm ? !memcmp(pm, &m, sizeof(Matrix)) : mathIdentity(&m)) return;
+    paint->transform(m);
+}
+
+
+//The paint is newly attached, its render data must be fully updated at the place.
+static void _attach(Paint* paint)
+{
+    auto p = PP(paint);
+    p->renderFlag |= (RenderUpdateFlag::All & ~RenderUpdateFlag::Transform);
+    if (p->rTransform) p->renderFlag |= RenderUpdateFlag::Transform;
+}
+
+
+static void _composite(Paint* paint, Paint* target, CompositeMethod method)
+{
+    auto cur = PP(paint)->compData;
+    if (cur ? (cur->target == target && cur->method == method) : !target) return;
+
+    if (target) _attach(target);
+    PP(paint)->composite(paint, target, method);
+}
+
+
+//Place the paint at the next child of the scene, the children are replaced only if they are changed.
+static void _push(LottieRenderScene* rscene, Paint* paint)
+{
+    auto& paints = rscene->scene->paints();
+
+    if (rscene->cursor != paints.end()) {
+        auto itr = rscene->cursor++;
+        auto prev = *itr;
+        if (prev == paint) return;
+        PP(paint)->ref();
+        *itr = paint;
+        if (PP(prev)->unref() == 0) delete(prev);
+    } else {
+        PP(paint)->ref();
+        paints.push_back(paint);
+    }
+
+    _attach(paint);
+}
+
+
+static LottieRenderShape* _slot(Array<LottieRenderShape*>& slots, uint32_t idx)
+{
+    if (idx == slots.count) slots.push(new LottieRenderShape);
+    return slots[idx];
+}
+
+
+//Begin to build the shape on the current frame, the last path is kept aside for the comparison.
+static Shape* _begin(LottieRenderShape* slot)
+{
+    auto shape = P(slot->shape);
+
+    slot->flag = shape->flag;
+    slot->rule = shape->rs.rule;
+    if (shape->rs.stroke) slot->join = shape->rs.stroke->join;
+
+    _swap(slot->cmds, shape->rs.path.cmds);
+    _swap(slot->pts, shape->rs.path.pts);
+    shape->rs.path.cmds.clear();
+    shape->rs.path.pts.clear();
+
+    return slot->shape;
+}
+
+
+//The path update is requested only if the path has been changed since the last frame.
+static void _end(LottieRenderShape* slot)
+{
+    auto shape = P(slot->shape);
+    auto& path = shape->rs.path;
+
+    auto changed = (slot->flag & RenderUpdateFlag::Path) || (shape->rs.rule != slot->rule);
+    if (!changed) {
+        if (path.cmds.count != slot->cmds.count || path.pts.count != slot->pts.count) changed = true;
+        else if (path.cmds.count > 0 && memcmp(path.cmds.data, slot->cmds.data, sizeof(PathCommand) * path.cmds.count)) changed = true;
+        else if (path.pts.count > 0 && memcmp(path.pts.data, slot->pts.data, sizeof(Point) * path.pts.count)) changed = true;
+    }
+
+    if (changed) shape->flag |= RenderUpdateFlag::Path;
+    else shape->flag &= ~RenderUpdateFlag::Path;
+
+    if (shape->rs.stroke && shape->rs.stroke->join != slot->join) shape->flag |= RenderUpdateFlag::Stroke;
+}
+
+
+static void _sync(RenderStroke* dst, const RenderStroke* src, uint8_t& flag)
+{
+    if (!_equal(dst->fill, src->fill)) {
+        delete(dst->fill);
+        dst->fill = src->fill ? src->fill->duplicate() : nullptr;
+        flag |= (RenderUpdateFlag::Stroke | RenderUpdateFlag::GradientStroke);
+    }
+
+    if (dst->dashCnt != src->dashCnt) {
+        free(dst->dashPattern);
+        dst->dashPattern = (src->dashCnt > 0) ? static_cast<float*>(malloc(sizeof(float) * src->dashCnt)) : nullptr;
+        dst->dashCnt = src->dashCnt;
+        flag |= RenderUpdateFlag::Stroke;
+    } else if (src->dashCnt > 0 && memcmp(dst->dashPattern, src->dashPattern, sizeof(float) * src->dashCnt)) {
+        flag |= RenderUpdateFlag::Stroke;
+    }
+    if (src->dashCnt > 0) memcpy(dst->dashPattern, src->dashPattern, sizeof(float) * src->dashCnt);
+
+    if (dst->width != src->width || memcmp(dst->color, src->color, sizeof(dst->color)) || dst->dashOffset != src->dashOffset ||
+        dst->miterlimit != src->miterlimit || dst->cap != src->cap || dst->strokeFirst != src->strokeFirst ||
+        dst->trim.begin != src->trim.begin || dst->trim.end != src->trim.end) {
+        dst->width = src->width;
+        memcpy(dst->color, src->color, sizeof(dst->color));
+        dst->dashOffset = src->dashOffset;
+        dst->miterlimit = src->miterlimit;
+        dst->cap = src->cap;
+        dst->strokeFirst = src->strokeFirst;
+        dst->trim = src->trim;
+        flag |= RenderUpdateFlag::Stroke;
+    }
+
+    //compared at the end of the frame, the join could be overridden.
+    dst->join = src->join;
+}
+
+
+//Update the shape with the properties of the propagator, only the changes raise the update flags.
+static void _sync(Shape* shape, Shape* propagator, const Matrix* transform, uint8_t opacity)
+{
+    auto dst = P(shape);
+    auto& rs = dst->rs;
+    auto& src = P(propagator)->rs;
+
+    //compared at the end of the frame, the rule could be overridden.
+    rs.rule = src.rule;
+
+    if (memcmp(rs.color, src.color, sizeof(rs.color))) {
+        memcpy(rs.color, src.color, sizeof(rs.color));
+        dst->flag |= RenderUpdateFlag::Color;
+    }
+
+    if (!_equal(rs.fill, src.fill)) {
+        delete(rs.fill);
+        rs.fill = src.fill ? src.fill->duplicate() : nullptr;
+        dst->flag |= RenderUpdateFlag::Gradient;
+    }
+
+    if (src.stroke) {
+        if (!rs.stroke) {
+            rs.stroke = new RenderStroke();
+            dst->flag |= RenderUpdateFlag::Stroke;
+        }
+        _sync(rs.stroke, src.stroke, dst->flag);
+    } else if (rs.stroke) {
+        delete(rs.stroke);
+        rs.stroke = nullptr;
+        dst->flag |= RenderUpdateFlag::Stroke;
+    }
+
+    Matrix m;
+    if (transform) m = *transform;
+    else if (auto pm = PP(propagator)->transform()) m = *pm;
+    else mathIdentity(&m);
+    _transform(shape, m);
+
+    shape->opacity(opacity);
+}
+
+
+//Detach the children which haven't been placed on the current frame, and release the unused shapes.
+static void _flush(LottieRenderScene* rscene)
+{
+    auto& paints = rscene->scene->paints();
+
+    while (rscene->cursor != paints.end()) {
+        auto paint = *rscene->cursor;
+        rscene->cursor = paints.erase(rscene->cursor);
+        if (PP(paint)->unref() == 0) delete(paint);
+    }
+
+    for (uint32_t i = 0; i < rscene->shapeCnt; ++i) {
+        _end(rscene->shapes[i]);
+    }
+
+    while (rscene->shapes.count > rscene->shapeCnt) {
+        delete(rscene->shapes.last());
+        rscene->shapes.pop();
+    }
+}
+
+
+//The retained paints of the layer. A layer referred several times on a frame has the paints per reference.
+static LottieRenderScene* _retain(LottieBuilder* builder, LottieLayerState* state)
+{
+    if (state->serial != builder->serial) {
+        if (state->serial == 0) builder->retained.push(state);
+        state->serial = builder->serial;
+        state->instanceCnt = 0;
+    }
+
+    if (state->instanceCnt == state->instances.count) {
+        auto rscene = new LottieRenderScene;
+        rscene->scene = Scene::gen().release();
+        PP(rscene->scene)->ref();
+        state->instances.push(rscene);
+    }
+
+    auto rscene = state->instances[state->instanceCnt++];
+    rscene->cursor = rscene->scene->paints().begin();
+    rscene->shapeCnt = 0;
+
+    return rscene;
+}
+
+
+//A scratch path which is copied to the repeated shapes.
+static Shape* _scratch(LottieRenderScene* rscene)
+{
+    if (!rscene->path) rscene->path = Shape::gen().release();
+    P(rscene->path)->rs.path.cmds.clear();
+    P(rscene->path)->rs.path.pts.clear();
+    return rscene->path;
+}
+
 static void _rotateX(Matrix* m, float degree)
 {
     if (degree == 0.0f) return;
@@ -158,26 +437,30 @@ static bool _updateTransform(LottieTransform* transform, float frameNo, bool aut
 }
 
 
-static void _updateTransform(LottieLayer* layer, float frameNo)
+static void _updateTransform(LottieBuilder* builder, LottieLayer* layer, float frameNo)
 {
-    if (!layer || mathEqual(layer->cache.frameNo, frameNo)) return;
+    if (!layer) return;
+
+    auto& cache = builder->states[layer->idx].cache;
+    if (mathEqual(cache.frameNo, frameNo)) return;
 
     auto transform = layer->transform;
     auto parent = layer->parent;
 
-    if (parent) _updateTransform(parent, frameNo);
+    if (parent) _updateTransform(builder, parent, frameNo);
 
-    auto& matrix = layer->cache.matrix;
+    auto& matrix = cache.matrix;
 
-    _updateTransform(transform, frameNo, layer->autoOrient, matrix, layer->cache.opacity);
+    _updateTransform(transform, frameNo, layer->autoOrient, matrix, cache.opacity);
 
     if (parent) {
-        if (!mathIdentity((const Matrix*) &parent->cache.matrix)) {
-            if (mathIdentity((const Matrix*) &matrix)) layer->cache.matrix = parent->cache.matrix;
-            else layer->cache.matrix = mathMultiply(&parent->cache.matrix, &matrix);
+        auto& pmatrix = builder->states[parent->idx].cache.matrix;
+        if (!mathIdentity((const Matrix*) &pmatrix)) {
+            if (mathIdentity((const Matrix*) &matrix)) cache.matrix = pmatrix;
+            else cache.matrix = mathMultiply(&pmatrix, &matrix);
         }
     }
-    layer->cache.frameNo = frameNo;
+    cache.frameNo = frameNo;
 }
 
 
@@ -210,10 +493,6 @@ static void _updateGroup(LottieGroup* parent, LottieObject** child, float frameN
 
     if (group->children.empty()) return;
 
-    //Prepare render data
-    group->scene = parent->scene;
-    group->reqFragment |= ctx->reqFragment;
-
     Inlist<RenderContext> contexts;
     contexts.back(new RenderContext(*ctx));
 
@@ -313,33 +592,32 @@ static Shape* _updateGradientFill(TVG_UNUSED LottieGroup* parent, LottieObject**
 }
 
 
-static Shape* _draw(LottieGroup* parent, RenderContext* ctx)
+static Shape* _draw(RenderContext* ctx)
 {
     if (ctx->allowMerging && ctx->merging) return ctx->merging;
 
-    auto shape = cast<Shape>(ctx->propagator->duplicate());
-    ctx->merging = shape.get();
-    parent->scene->push(std::move(shape));
+    auto rscene = ctx->rscene;
+    auto shape = _begin(_slot(rscene->shapes, rscene->shapeCnt++));
+    _sync(shape, ctx->propagator, nullptr, PP(ctx->propagator)->opacity);
+    _push(rscene, shape);
+    ctx->merging = shape;
 
     return ctx->merging;
 }
 
 
-//OPTIMIZE: path?
-static void _repeat(LottieGroup* parent, unique_ptr<Shape> path, RenderContext* ctx)
+static void _repeat(Shape* path, RenderContext* ctx)
 {
     auto repeater = ctx->repeater;
+    auto rscene = ctx->rscene;
+    auto pm = PP(ctx->propagator)->transform();
 
-    Array<Shape*> shapes(repeater->cnt);
-
-    for (int i = 0; i < repeater->cnt; ++i) {
+    //push repeat shapes in order.
+    for (int n = 0; n < repeater->cnt; ++n) {
+        auto i = repeater->inorder ? n : (repeater->cnt - 1 - n);
         auto multiplier = repeater->offset + static_cast<float>(i);
 
-        auto shape = static_cast<Shape*>(ctx->propagator->duplicate());
-        P(shape)->rs.path = P(path.get())->rs.path;
-
         auto opacity = repeater->interpOpacity ? mathLerp<uint8_t>(repeater->startOpacity, repeater->endOpacity, static_cast<float>(i + 1) / repeater->cnt) : repeater->startOpacity;
-        shape->opacity(opacity);
 
         Matrix m;
         mathIdentity(&m);
@@ -347,27 +625,19 @@ static void _repeat(LottieGroup* parent, unique_ptr<Shape> path, RenderContext*
         mathScale(&m, powf(repeater->scale.x * 0.01f, multiplier), powf(repeater->scale.y * 0.01f, multiplier));
         mathRotate(&m, repeater->rotation * multiplier);
         mathTranslateR(&m, -repeater->anchor.x, -repeater->anchor.y);
+        if (pm) m = mathMultiply(&m, pm);
 
-        auto pm = PP(shape)->transform();
-        shape->transform(pm ? mathMultiply(&m, pm) : m);
+        auto shape = _begin(_slot(rscene->shapes, rscene->shapeCnt++));
+        _sync(shape, ctx->propagator, &m, opacity);
+        P(shape)->rs.path.cmds = P(path)->rs.path.cmds;
+        P(shape)->rs.path.pts = P(path)->rs.path.pts;
 
         if (ctx->roundness > 1.0f && P(shape)->rs.stroke) {
             TVGERR("LOTTIE", "FIXME: Path roundesss should be applied properly!");
             P(shape)->rs.stroke->join = StrokeJoin::Round;
         }
 
-        shapes.push(shape);
-    }
-
-    //push repeat shapes in order.
-    if (repeater->inorder) {
-        for (auto shape = shapes.begin(); shape < shapes.end(); ++shape) {
-            parent->scene->push(cast(*shape));
-        }
-    } else {
-        for (auto shape = shapes.end() - 1; shape >= shapes.begin(); --shape) {
-            parent->scene->push(cast(*shape));
-        }
+        _push(rscene, shape);
     }
 }
 
@@ -414,7 +684,7 @@ static void _appendRect(Shape* shape, float x, float y, float w, float h, float
     }
 }
 
-static void _updateRect(LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
+static void _updateRect(TVG_UNUSED LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
 {
     auto rect = static_cast<LottieRect*>(*child);
 
@@ -429,11 +699,11 @@ static void _updateRect(LottieGroup* parent, LottieObject** child, float frameNo
     }
 
     if (ctx->repeater) {
-        auto path = Shape::gen();
-        _appendRect(path.get(), position.x - size.x * 0.5f, position.y - size.y * 0.5f, size.x, size.y, roundness);
-        _repeat(parent, std::move(path), ctx);
+        auto path = _scratch(ctx->rscene);
+        _appendRect(path, position.x - size.x * 0.5f, position.y - size.y * 0.5f, size.x, size.y, roundness);
+        _repeat(path, ctx);
     } else {
-        auto merging = _draw(parent, ctx);
+        auto merging = _draw(ctx);
         _appendRect(merging, position.x - size.x * 0.5f, position.y - size.y * 0.5f, size.x, size.y, roundness);
         if (rect->direction == 2) merging->fill(FillRule::EvenOdd);
     }
@@ -463,7 +733,7 @@ static void _appendCircle(Shape* shape, float cx, float cy, float rx, float ry)
     shape->appendPath(commands, commandsSize, points, pointsSize);
 }
 
-static void _updateEllipse(LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
+static void _updateEllipse(TVG_UNUSED LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
 {
     auto ellipse = static_cast<LottieEllipse*>(*child);
 
@@ -471,30 +741,28 @@ static void _updateEllipse(LottieGroup* parent, LottieObject** child, float fram
     auto size = ellipse->size(frameNo);
 
     if (ctx->repeater) {
-        auto path = Shape::gen();
-        _appendCircle(path.get(), position.x, position.y, size.x * 0.5f, size.y * 0.5f);
-        _repeat(parent, std::move(path), ctx);
+        auto path = _scratch(ctx->rscene);
+        _appendCircle(path, position.x, position.y, size.x * 0.5f, size.y * 0.5f);
+        _repeat(path, ctx);
     } else {
-        auto merging = _draw(parent, ctx);
+        auto merging = _draw(ctx);
         _appendCircle(merging, position.x, position.y, size.x * 0.5f, size.y * 0.5f);
         if (ellipse->direction == 2) merging->fill(FillRule::EvenOdd);
     }
 }
 
 
-static void _updatePath(LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
+static void _updatePath(TVG_UNUSED LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
 {
     auto path = static_cast<LottiePath*>(*child);
 
     if (ctx->repeater) {
-        auto p = Shape::gen();
+        auto p = _scratch(ctx->rscene);
         path->pathset(frameNo, P(p)->rs.path.cmds, P(p)->rs.path.pts);
-        _repeat(parent, std::move(p), ctx);
+        _repeat(p, ctx);
     } else {
-        auto merging = _draw(parent, ctx);
-        if (path->pathset(frameNo, P(merging)->rs.path.cmds, P(merging)->rs.path.pts)) {
-            P(merging)->update(RenderUpdateFlag::Path);
-        }
+        auto merging = _draw(ctx);
+        path->pathset(frameNo, P(merging)->rs.path.cmds, P(merging)->rs.path.pts);
         if (ctx->roundness > 1.0f && P(merging)->rs.stroke) {
             TVGERR("LOTTIE", "FIXME: Path roundesss should be applied properly!");
             P(merging)->rs.stroke->join = StrokeJoin::Round;
@@ -504,7 +772,7 @@ static void _updatePath(LottieGroup* parent, LottieObject** child, float frameNo
 }
 
 
-static void _updateText(LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, TVG_UNUSED RenderContext* ctx)
+static void _updateText(TVG_UNUSED LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
 {
     auto text = static_cast<LottieText*>(*child);
     auto& doc = text->doc(frameNo);
@@ -520,10 +788,11 @@ static void _updateText(LottieGroup* parent, LottieObject** child, float frameNo
     //text string
     while (*p != '\0') {
         //find the glyph
-        for (auto g = text->font->chars.begin(); g < text->font->chars.end(); ++g) {
+        auto g = text->font->chars.begin();
+        for (; g < text->font->chars.end(); ++g) {
             auto glyph = *g;
             //draw matched glyphs
-            if (!strncmp(glyph->code, p, glyph->len)) {
+            if (glyph->len > 0 && !strncmp(glyph->code, p, glyph->len)) {
                 //TODO: caching?
                 auto shape = Shape::gen();
                 for (auto g = glyph->children.begin(); g < glyph->children.end(); ++g) {
@@ -559,6 +828,8 @@ static void _updateText(LottieGroup* parent, LottieObject** child, float frameNo
                 break;
             }
         }
+        //no glyph for the character, skip it
+        if (g == text->font->chars.end()) ++p;
     }
 
     //text layout position
@@ -573,7 +844,7 @@ static void _updateText(LottieGroup* parent, LottieObject** child, float frameNo
     scene->translate(layout.x, layout.y);
     scene->scale(scale);
 
-    parent->scene->push(std::move(scene));
+    _push(ctx->rscene, scene.release());
 }
 
 
@@ -769,24 +1040,23 @@ static void _updatePolystar(LottieGroup* parent, LottieObject** child, float fra
     auto identity = mathIdentity((const Matrix*)&matrix);
 
     if (ctx->repeater) {
-        auto p = Shape::gen();
-        if (star->type == LottiePolyStar::Star) _updateStar(parent, star, identity ? nullptr : &matrix, frameNo, p.get());
-        else _updatePolygon(parent, star, identity  ? nullptr : &matrix, frameNo, p.get());
-        _repeat(parent, std::move(p), ctx);
+        auto p = _scratch(ctx->rscene);
+        if (star->type == LottiePolyStar::Star) _updateStar(parent, star, identity ? nullptr : &matrix, frameNo, p);
+        else _updatePolygon(parent, star, identity  ? nullptr : &matrix, frameNo, p);
+        _repeat(p, ctx);
     } else {
-        auto merging = _draw(parent, ctx);
+        auto merging = _draw(ctx);
         if (star->type == LottiePolyStar::Star) _updateStar(parent, star, identity ? nullptr : &matrix, frameNo, merging);
         else _updatePolygon(parent, star, identity  ? nullptr : &matrix, frameNo, merging);
-        P(merging)->update(RenderUpdateFlag::Path);
         if (star->direction == 2) merging->fill(FillRule::EvenOdd);
     }
 }
 
 
-static void _updateImage(LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
+static void _updateImage(TVG_UNUSED LottieGroup* parent, LottieObject** child, float frameNo, TVG_UNUSED Inlist<RenderContext>& contexts, RenderContext* ctx)
 {
     auto image = static_cast<LottieImage*>(*child);
-    auto picture = image->picture;
+    auto& picture = ctx->builder->images[image->idx];
 
     if (!picture) {
         picture = Picture::gen().release();
@@ -797,28 +1067,29 @@ static void _updateImage(LottieGroup* parent, LottieObject** child, float frameN
         if (image->size > 0) {
             if (picture->load((const char*)image->b64Data, image->size, image->mimeType) != Result::Success) {
                 delete(picture);
+                picture = nullptr;
                 return;
             }
         } else {
             if (picture->load(image->path) != Result::Success) {
                 delete(picture);
+                picture = nullptr;
                 return;
             }
         }
 
         TaskScheduler::async(true);
 
-        image->picture = picture;
         PP(picture)->ref();
     }
 
     if (ctx->propagator) {
         if (auto matrix = PP(ctx->propagator)->transform()) {
-            picture->transform(*matrix);
+            _transform(picture, *matrix);
         }
         picture->opacity(PP(ctx->propagator)->opacity);
     }
-    parent->scene->push(cast<Picture>(picture));
+    _push(ctx->rscene, picture);
 }
 
 
@@ -949,56 +1220,60 @@ static void _updateChildren(LottieGroup* parent, float frameNo, Inlist<RenderCon
 }
 
 
-static void _updatePrecomp(LottieLayer* precomp, float frameNo)
+static void _updatePrecomp(LottieBuilder* builder, LottieLayer* precomp, LottieRenderScene* rscene, float frameNo)
 {
     if (precomp->children.empty()) return;
 
+    auto state = &builder->states[precomp->idx];
+
     frameNo = precomp->remap(frameNo);
 
     for (auto child = precomp->children.end() - 1; child >= precomp->children.begin(); --child) {
-        _updateLayer(precomp, static_cast<LottieLayer*>(*child), frameNo);
+        _updateLayer(builder, rscene, static_cast<LottieLayer*>(*child), frameNo);
     }
 
     //clip the layer viewport
     if (precomp->w > 0 && precomp->h > 0) {
-        auto clipper = Shape::gen().release();
-        clipper->appendRect(0, 0, static_cast<float>(precomp->w), static_cast<float>(precomp->h));
-        clipper->transform(precomp->cache.matrix);
-
-        //TODO: remove the intermediate scene....
-        auto cscene = Scene::gen();
-        cscene->composite(cast(clipper), CompositeMethod::ClipPath);
-        cscene->push(cast(precomp->scene));
-        precomp->scene = cscene.release();
+        if (!rscene->viewport) {
+            rscene->clipper = Shape::gen().release();
+            rscene->clipper->appendRect(0, 0, static_cast<float>(precomp->w), static_cast<float>(precomp->h));
+
+            //TODO: remove the intermediate scene....
+            rscene->viewport = Scene::gen().release();
+            PP(rscene->viewport)->ref();
+            rscene->viewport->composite(cast(rscene->clipper), CompositeMethod::ClipPath);
+            rscene->viewport->push(cast(rscene->scene));
+        }
+        _transform(rscene->clipper, state->cache.matrix);
+        state->scene = rscene->viewport;
     }
 }
 
 
-static void _updateSolid(LottieLayer* layer)
+static void _updateSolid(LottieLayerState* state, LottieLayer* layer, LottieRenderScene* rscene)
 {
-    auto shape = Shape::gen();
+    auto shape = _begin(_slot(rscene->shapes, rscene->shapeCnt++));
     shape->appendRect(0, 0, static_cast<float>(layer->w), static_cast<float>(layer->h));
-    shape->fill(layer->color.rgb[0], layer->color.rgb[1], layer->color.rgb[2], layer->cache.opacity);
-    layer->scene->push(std::move(shape));
+    shape->fill(layer->color.rgb[0], layer->color.rgb[1], layer->color.rgb[2], state->cache.opacity);
+    _push(rscene, shape);
 }
 
 
-static void _updateMaskings(LottieLayer* layer, float frameNo)
+static void _updateMaskings(LottieLayerState* state, LottieLayer* layer, LottieRenderScene* rscene, float frameNo)
 {
-    if (layer->masks.count == 0) return;
-
     //maskings
     Shape* pmask = nullptr;
     auto pmethod = CompositeMethod::AlphaMask;
 
-    for (auto m = layer->masks.begin(); m < layer->masks.end(); ++m) {
-        auto mask = static_cast<LottieMask*>(*m);
-        auto shape = Shape::gen().release();
+    for (uint32_t i = 0; i < layer->masks.count; ++i) {
+        auto mask = layer->masks[i];
+        auto slot = _slot(rscene->masks, i);
+        auto shape = _begin(slot);
         shape->fill(255, 255, 255, mask->opacity(frameNo));
-        shape->transform(layer->cache.matrix);
-        if (mask->pathset(frameNo, P(shape)->rs.path.cmds, P(shape)->rs.path.pts)) {
-            P(shape)->update(RenderUpdateFlag::Path);
-        }
+        _transform(shape, state->cache.matrix);
+        mask->pathset(frameNo, P(shape)->rs.path.cmds, P(shape)->rs.path.pts);
+        _end(slot);
+
         auto method = mask->method;
         if (pmask) {
             //false of false is true. invert.
@@ -1007,13 +1282,13 @@ static void _updateMaskings(LottieLayer* layer, float frameNo)
             } else if (pmethod == CompositeMethod::DifferenceMask && pmethod == method) {
                 method = CompositeMethod::IntersectMask;
             }
-            pmask->composite(cast<Shape>(shape), method);
+            _composite(pmask, shape, method);
         } else {
             if (method == CompositeMethod::SubtractMask) method = CompositeMethod::InvAlphaMask;
             else if (method == CompositeMethod::AddMask) method = CompositeMethod::AlphaMask;
             else if (method == CompositeMethod::IntersectMask) method = CompositeMethod::AlphaMask;
             else if (method == CompositeMethod::DifferenceMask) method = CompositeMethod::AlphaMask;   //does this correct?
-            layer->scene->composite(cast<Shape>(shape), method);
+            _composite(state->scene, shape, method);
         }
         pmethod = mask->method;
         pmask = shape;
@@ -1021,64 +1296,67 @@ static void _updateMaskings(LottieLayer* layer, float frameNo)
 }
 
 
-static bool _updateMatte(LottieLayer* root, LottieLayer* layer, float frameNo)
+static bool _updateMatte(LottieBuilder* builder, LottieRenderScene* parent, LottieLayer* layer, float frameNo)
 {
     auto target = layer->matte.target;
     if (!target) return true;
 
-    _updateLayer(root, target, frameNo);
+    _updateLayer(builder, parent, target, frameNo);
+
+    //matte target is not exist. alpha blending definitely bring an invisible result
+    if (!builder->states[target->idx].scene && (layer->matte.type == CompositeMethod::AlphaMask || layer->matte.type == CompositeMethod::LumaMask)) return false;
 
-    if (target->scene) {
-        layer->scene->composite(cast(target->scene), layer->matte.type);
-    } else  if (layer->matte.type == CompositeMethod::AlphaMask || layer->matte.type == CompositeMethod::LumaMask) {
-        //matte target is not exist. alpha blending definitely bring an invisible result
-        delete(layer->scene);
-        layer->scene = nullptr;
-        return false;
-    }
     return true;
 }
 
 
-static void _updateLayer(LottieLayer* root, LottieLayer* layer, float frameNo)
+static void _updateLayer(LottieBuilder* builder, LottieRenderScene* parent, LottieLayer* layer, float frameNo)
 {
-    layer->scene = nullptr;
+    auto state = &builder->states[layer->idx];
+    state->scene = nullptr;
 
     //visibility
     if (frameNo < layer->inFrame || frameNo >= layer->outFrame) return;
 
-    _updateTransform(layer, frameNo);
+    _updateTransform(builder, layer, frameNo);
 
     //full transparent scene. no need to perform
-    if (layer->type != LottieLayer::Null && layer->cache.opacity == 0) return;
+    if (layer->type != LottieLayer::Null && state->cache.opacity == 0) return;
+
+    if (layer->matte.target && layer->masks.count > 0) TVGERR("LOTTIE", "FIXME: Matte + Masking??");
+
+    if (!_updateMatte(builder, parent, layer, frameNo)) return;
 
     //Prepare render data
-    layer->scene = Scene::gen().release();
+    auto rscene = _retain(builder, state);
+    state->scene = rscene->scene;
 
     //ignore opacity when Null layer?
-    if (layer->type != LottieLayer::Null) layer->scene->opacity(layer->cache.opacity);
+    if (layer->type != LottieLayer::Null) state->scene->opacity(state->cache.opacity);
 
-    layer->scene->transform(layer->cache.matrix);
+    _transform(state->scene, state->cache.matrix);
 
-    if (layer->matte.target && layer->masks.count > 0) TVGERR("LOTTIE", "FIXME: Matte + Masking??");
-
-    if (!_updateMatte(root, layer, frameNo)) return;
+    auto matte = layer->matte.target ? builder->states[layer->matte.target->idx].scene : nullptr;
 
-    _updateMaskings(layer, frameNo);
+    if (layer->masks.count > 0) _updateMaskings(state, layer, rscene, frameNo);
+    else if (matte) _composite(state->scene, matte, layer->matte.type);
+    else _composite(state->scene, nullptr, CompositeMethod::None);
 
     switch (layer->type) {
         case LottieLayer::Precomp: {
-            _updatePrecomp(layer, frameNo);
+            _updatePrecomp(builder, layer, rscene, frameNo);
             break;
         }
         case LottieLayer::Solid: {
-            _updateSolid(layer);
+            _updateSolid(state, layer, rscene);
             break;
         }
         default: {
+            //the static contents were built already.
+            if (rscene->baked) break;
             if (!layer->children.empty()) {
                 Inlist<RenderContext> contexts;
-                contexts.back(new RenderContext);
+                contexts.back(new RenderContext(builder, rscene));
                 _updateChildren(layer, frameNo, contexts);
                 contexts.free();
             }
@@ -1086,10 +1364,16 @@ static void _updateLayer(LottieLayer* root, LottieLayer* layer, float frameNo)
         }
     }
 
-    layer->scene->blend(layer->blendMethod);
+    //keep the static contents as they are.
+    if (rscene->baked) rscene->cursor = rscene->scene->paints().end();
+    else _flush(rscene);
+
+    rscene->baked = layer->invariant;
+
+    state->scene->blend(layer->blendMethod);
 
     //the given matte source was composited by the target earlier.
-    if (!layer->matteSrc) root->scene->push(cast(layer->scene));
+    if (!layer->matteSrc) _push(parent, state->scene);
 }
 
 
@@ -1112,12 +1396,25 @@ static void _buildReference(LottieComposition* comp, LottieLayer* layer)
 }
 
 
+//The transform of a layer is updated after its parent's, the parenting must not be circular.
+static void _attachParent(LottieLayer* child, LottieLayer* parent)
+{
+    for (auto p = parent; p; p = p->parent) {
+        if (p == child) {
+            TVGERR("LOTTIE", "Circular parenting of the layer(%d)", child->id);
+            return;
+        }
+    }
+    child->parent = parent;
+}
+
+
 static void _bulidHierarchy(LottieGroup* parent, LottieLayer* child)
 {
     if (child->pid == -1) return;
 
     if (child->matte.target && child->pid == child->matte.target->id) {
-        child->parent = child->matte.target;
+        _attachParent(child, child->matte.target);
         return;
     }
 
@@ -1125,11 +1422,11 @@ static void _bulidHierarchy(LottieGroup* parent, LottieLayer* child)
         auto parent = static_cast<LottieLayer*>(*p);
         if (child == parent) continue;
         if (child->pid == parent->id) {
-            child->parent = parent;
+            _attachParent(child, parent);
             break;
         }
         if (parent->matte.target && parent->matte.target->id == child->pid) {
-            child->parent = parent->matte.target;
+            _attachParent(child, parent->matte.target);
             break;
         }
     }
@@ -1156,6 +1453,66 @@ static void _attachFont(LottieComposition* comp, LottieLayer* parent)
 }
 
 
+//The slots could override the objects at any time.
+static bool _slotted(LottieComposition* comp, LottieObject* obj)
+{
+    for (auto s = comp->slots.begin(); s < comp->slots.end(); ++s) {
+        for (auto pair = (*s)->pairs.begin(); pair < (*s)->pairs.end(); ++pair) {
+            if (pair->obj == obj) return true;
+        }
+    }
+
+    if (obj->type != LottieObject::Group && obj->type != LottieObject::Layer) return false;
+
+    auto group = static_cast<LottieGroup*>(obj);
+    for (auto c = group->children.begin(); c < group->children.end(); ++c) {
+        if (_slotted(comp, *c)) return true;
+    }
+    return false;
+}
+
+
+//Count the objects which keep the same values while the layer is visible.
+static void _census(LottieComposition* comp, LottieGroup* group, float begin, float end)
+{
+    for (auto c = group->children.begin(); c < group->children.end(); ++c) {
+        auto child = *c;
+        if (child->type == LottieObject::Group) {
+            _census(comp, static_cast<LottieGroup*>(child), begin, end);
+        } else {
+            ++comp->stats.objects;
+            if (child->constant(begin, end)) ++comp->stats.constants;
+        }
+    }
+}
+
+
+//The contents of the shape layer could be built once if they don't change while the layer is visible.
+static void _buildInvariant(LottieComposition* comp, LottieLayer* layer)
+{
+    if (layer->type != LottieLayer::Shape && layer->type != LottieLayer::Text) return;
+
+    _census(comp, layer, layer->inFrame, layer->outFrame);
+
+    layer->invariant = layer->constant(layer->inFrame, layer->outFrame) && !_slotted(comp, layer);
+
+    ++comp->stats.layers;
+    if (layer->invariant) ++comp->stats.invariants;
+}
+
+
+//The fragmenting of the render context is required by the nested groups as well.
+static void _buildFragment(LottieGroup* parent)
+{
+    for (auto c = parent->children.begin(); c < parent->children.end(); ++c) {
+        if ((*c)->type != LottieObject::Group) continue;
+        auto group = static_cast<LottieGroup*>(*c);
+        group->reqFragment |= parent->reqFragment;
+        _buildFragment(group);
+    }
+}
+
+
 static bool _buildComposition(LottieComposition* comp, LottieGroup* parent)
 {
     if (parent->children.count == 0) return false;
@@ -1174,12 +1531,19 @@ static bool _buildComposition(LottieComposition* comp, LottieGroup* parent)
             //precomp referencing
             if (child->matte.target->refId) _buildReference(comp, child->matte.target);
             child->statical &= child->matte.target->statical;
+            _buildInvariant(comp, child->matte.target);
+            _buildFragment(child->matte.target);
+            child->matte.target->idx = comp->layerCnt++;
         }
         _bulidHierarchy(parent, child);
 
         //attach the necessary font data
         if (child->type == LottieLayer::Text) _attachFont(comp, child);
 
+        _buildInvariant(comp, child);
+        _buildFragment(child);
+        child->idx = comp->layerCnt++;
+
         child->statical &= parent->statical;
         parent->statical &= child->statical;
     }
@@ -1191,19 +1555,75 @@ static bool _buildComposition(LottieComposition* comp, LottieGroup* parent)
 /* External Class Implementation                                        */
 /************************************************************************/
 
+thread_local LottieCursors* LottieCursors::bound = nullptr;
+
+
+LottieBuilder::~LottieBuilder()
+{
+    clear();
+    if (!initiated) delete(scene);
+}
+
+
+void LottieBuilder::clear()
+{
+    //the layer scenes are referred by the root scene also.
+    if (scene) scene->clear();
+
+    delete[](states);
+    states = nullptr;
+
+    for (uint32_t i = 0; i < imageCnt; ++i) {
+        if (images[i] && PP(images[i])->unref() == 0) delete(images[i]);
+    }
+    free(images);
+    images = nullptr;
+    imageCnt = 0;
+
+    retained.clear();
+    cursors.hints.clear();
+    serial = 0;
+}
+
+
 bool LottieBuilder::update(LottieComposition* comp, float frameNo)
 {
+    if (!scene) return false;
+
     frameNo += comp->startFrame;
     if (frameNo < comp->startFrame) frameNo = comp->startFrame;
     if (frameNo >= comp->endFrame) frameNo = (comp->endFrame - 1);
 
     //update children layers
     auto root = comp->root;
-    root->scene->clear();
+    ++serial;
+
+    LottieRenderScene rscene;
+    rscene.scene = scene;
+    rscene.cursor = scene->paints().begin();
+
+    cursors.cnt = &comp->propertyCnt;
+    LottieCursors::bound = &cursors;
 
     for (auto child = root->children.end() - 1; child >= root->children.begin(); --child) {
-        _updateLayer(root, static_cast<LottieLayer*>(*child), frameNo);
+        _updateLayer(this, &rscene, static_cast<LottieLayer*>(*child), frameNo);
+    }
+
+    LottieCursors::bound = nullptr;
+
+    _flush(&rscene);
+    rscene.scene = nullptr;   //the root scene is owned by the picture
+
+    //release the render data of the layers which are not referred on this frame
+    for (auto s = retained.begin(); s < retained.end(); ++s) {
+        auto state = *s;
+        auto cnt = (state->serial == serial) ? state->instanceCnt : 0;
+        while (state->instances.count > cnt) {
+            delete(state->instances.last());
+            state->instances.pop();
+        }
     }
+
     return true;
 }
 
@@ -1212,15 +1632,30 @@ void LottieBuilder::build(LottieComposition* comp)
 {
     if (!comp) return;
 
-    comp->root->scene = Scene::gen().release();
-    if (!comp->root->scene) return;
+    //rebuild on the scene which might have been handed over to the picture already.
+    clear();
 
-    _buildComposition(comp, comp->root);
+    if (!scene) {
+        scene = Scene::gen().release();
+        if (!scene) return;
+
+        //viewport clip
+        auto clip = Shape::gen();
+        clip->appendRect(0, 0, static_cast<float>(comp->w), static_cast<float>(comp->h));
+        scene->composite(std::move(clip), CompositeMethod::ClipPath);
+    }
+
+    states = new LottieLayerState[comp->layerCnt];
+    imageCnt = comp->imageCnt;
+    images = static_cast<Picture**>(calloc(imageCnt, sizeof(Picture*)));
 
-    if (!update(comp, 0)) return;
+    update(comp, 0);
+}
+
+
+void LottieBuilder::prepare(LottieComposition* comp)
+{
+    if (!comp) return;
 
-    //viewport clip
-    auto clip = Shape::gen();
-    clip->appendRect(0, 0, static_cast<float>(comp->w), static_cast<float>(comp->h));
-    comp->root->scene->composite(std::move(clip), CompositeMethod::ClipPath);
+    _buildComposition(comp, comp->root);
 }
@@ -24,13 +24,33 @@
 #define _TVG_LOTTIE_BUILDER_H_
 
 #include "tvgCommon.h"
+#include "tvgArray.h"
+#include "tvgLottieProperty.h"
 
 struct LottieComposition;
+struct LottieLayerState;
 
+//Builds the scene of an animation. The composition could be shared, thus the render states are kept here.
 struct LottieBuilder
 {
+    Scene* scene = nullptr;                  //root scene
+    LottieLayerState* states = nullptr;      //render states of the layers, in the order of LottieLayer::idx
+    Picture** images = nullptr;              //image data, in the order of LottieImage::idx
+    Array<LottieLayerState*> retained;       //layers which have retained the render data
+    LottieCursors cursors;                   //keyframes found last on the properties
+    uint32_t imageCnt = 0;
+    uint32_t serial = 0;                     //serial of the frame updates
+    bool initiated = false;                  //the root scene is handed over to the picture
+
+    ~LottieBuilder();
+
     bool update(LottieComposition* comp, float progress);
     void build(LottieComposition* comp);
+
+    static void prepare(LottieComposition* comp);
+
+private:
+    void clear();
 };
 
 #endif //_TVG_LOTTIE_BUILDER_H
\ No newline at end of file
@@ -24,7 +24,9 @@
 #include "tvgLottieModel.h"
 #include "tvgLottieParser.h"
 #include "tvgLottieBuilder.h"
+#include "tvgLottieBinary.h"
 #include "tvgStr.h"
+#include "tvgLock.h"
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
@@ -47,6 +49,176 @@ static float _str2float(const char* str, int len)
 }
 
 
+/* The animations of the same lottie data share a composition. A composition doesn't change once it's
+   prepared (except by the slots, see LottieLoader::override()), the frame updates are performed on the
+   render states of each animation. */
+static Key _key;
+static Array<LottieComposition*> _compositions;
+
+
+//FNV-1a
+static uint64_t _hash(const char* content, uint32_t size, const char* dirName)
+{
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (uint32_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<uint8_t>(content[i])) * 1099511628211ULL;
+    }
+
+    //the external resources are relative to the directory
+    if (dirName) {
+        for (auto p = dirName; *p; ++p) {
+            hash = (hash ^ static_cast<uint8_t>(*p)) * 1099511628211ULL;
+        }
+    }
+    return hash;
+}
+
+
+//MurmurHash64A, independent of the hash key, confirms a hit along with the size instead of a copy of the source.
+static uint64_t _digest(const char* content, uint32_t size)
+{
+    const uint64_t m = 0xc6a4a7935bd1e995ULL;
+    const int r = 47;
+
+    uint64_t hash = 0x9e3779b97f4a7c15ULL ^ (size * m);
+    auto end = content + (size & ~7);
+
+    for (auto p = content; p < end; p += 8) {
+        uint64_t k;
+        memcpy(&k, p, 8);
+        k *= m;
+        k ^= k >> r;
+        k *= m;
+        hash ^= k;
+        hash *= m;
+    }
+
+    auto tail = reinterpret_cast<const uint8_t*>(end);
+    switch (size & 7) {
+        case 7: hash ^= uint64_t(tail[6]) << 48; TVG_FALLTHROUGH
+        case 6: hash ^= uint64_t(tail[5]) << 40; TVG_FALLTHROUGH
+        case 5: hash ^= uint64_t(tail[4]) << 32; TVG_FALLTHROUGH
+        case 4: hash ^= uint64_t(tail[3]) << 24; TVG_FALLTHROUGH
+        case 3: hash ^= uint64_t(tail[2]) << 16; TVG_FALLTHROUGH
+        case 2: hash ^= uint64_t(tail[1]) << 8; TVG_FALLTHROUGH
+        case 1: hash ^= uint64_t(tail[0]); hash *= m;
+    }
+
+    hash ^= hash >> r;
+    hash *= m;
+    hash ^= hash >> r;
+    return hash;
+}
+
+
+//the hash narrows down the candidates, the digest and the size decide the identity.
+static bool _same(const LottieComposition* comp, uint64_t digest, uint32_t size, const char* dirName)
+{
+    if (comp->source.size != size || comp->source.digest != digest) return false;
+    if (!comp->source.dirName || !dirName) return comp->source.dirName == dirName;
+    return !strcmp(comp->source.dirName, dirName);
+}
+
+
+static LottieComposition* _findFromCache(uint64_t hashkey, uint64_t digest, uint32_t size, const char* dirName)
+{
+    for (auto c = _compositions.begin(); c < _compositions.end(); ++c) {
+        if ((*c)->hashkey == hashkey && _same(*c, digest, size, dirName)) {
+            ++(*c)->sharing;
+            return *c;
+        }
+    }
+    return nullptr;
+}
+
+
+static void _uncache(LottieComposition* comp)
+{
+    for (auto c = _compositions.begin(); c < _compositions.end(); ++c) {
+        if (*c != comp) continue;
+        *c = _compositions.last();
+        _compositions.pop();
+        break;
+    }
+    comp->hashkey = 0;
+
+    free(comp->source.dirName);
+    comp->source.dirName = nullptr;
+    comp->source.digest = 0;
+    comp->source.size = 0;
+}
+
+
+static LottieComposition* _parse(const char* content, uint32_t size, const char* dirName)
+{
+    LottieComposition* comp = nullptr;
+
+    //the precompiled data
+    if (LottieBinary::verify(content, size)) {
+        comp = LottieBinary::read(content, size);
+    } else {
+        //the content is parsed in place, keep it intact for the later parsing.
+        auto data = strDuplicate(content, size);
+
+        LottieParser parser(data, dirName);
+        if (parser.parse()) comp = parser.comp;
+
+        free(data);
+    }
+
+    if (comp) {
+        LottieBuilder::prepare(comp);
+        comp->sharing = 1;
+    }
+    return comp;
+}
+
+
+static LottieComposition* _acquire(const char* content, uint32_t size, const char* dirName)
+{
+    auto hashkey = _hash(content, size, dirName);
+    auto digest = _digest(content, size);
+
+    {
+        ScopedLock lock(_key);
+        if (auto comp = _findFromCache(hashkey, digest, size, dirName)) return comp;
+    }
+
+    //no lock during the parsing, the other data could be loaded at the same time.
+    auto comp = _parse(content, size, dirName);
+    if (!comp) return nullptr;
+
+    ScopedLock lock(_key);
+
+    //the same data has been loaded in the meantime
+    if (auto cached = _findFromCache(hashkey, digest, size, dirName)) {
+        delete(comp);
+        return cached;
+    }
+    comp->hashkey = hashkey;
+    comp->source.digest = digest;
+    comp->source.size = size;
+    if (dirName) comp->source.dirName = strDuplicate(dirName, strlen(dirName));
+    _compositions.push(comp);
+
+    return comp;
+}
+
+
+static void _release(LottieComposition* comp)
+{
+    if (!comp) return;
+
+    {
+        ScopedLock lock(_key);
+        if (--comp->sharing > 0) return;
+        if (comp->hashkey) _uncache(comp);
+    }
+    delete(comp);
+}
+
+
 void LottieLoader::run(unsigned tid)
 {
     //update frame
@@ -54,14 +226,38 @@ void LottieLoader::run(unsigned tid)
         builder->update(comp, frameNo);
     //initial loading
     } else {
-        LottieParser parser(content, dirName);
-        if (!parser.parse()) return;
-        comp = parser.comp;
+        comp = _acquire(content, size, dirName);
         builder->build(comp);
     }
 }
 
 
+//The slots change the composition, thus the animation takes its own one.
+bool LottieLoader::privatize()
+{
+    {
+        ScopedLock lock(_key);
+        if (comp->hashkey == 0) return true;
+        if (comp->sharing == 1) {
+            _uncache(comp);
+            return true;
+        }
+    }
+
+    auto comp = _parse(content, size, dirName);
+    if (!comp) return false;
+
+    _release(this->comp);
+    this->comp = comp;
+
+    //rebuild the render states on the current root scene.
+    builder->build(comp);
+    builder->update(comp, frameNo);
+
+    return true;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -79,9 +275,9 @@ LottieLoader::~LottieLoader()
     if (copy) free((char*)content);
     free(dirName);
 
-    //TODO: correct position?
-    delete(comp);
+    //the render data first, they refer to the composition.
     delete(builder);
+    _release(comp);
 }
 
 
@@ -101,6 +297,14 @@ bool LottieLoader::header()
         }
     }
 
+    //The precompiled data has the animation info in its header.
+    if (LottieBinary::verify(content, size)) {
+        auto frameRate = 0.0f;
+        if (!LottieBinary::header(content, size, w, h, frameCnt, frameRate) || frameRate < FLT_EPSILON) return false;
+        frameDuration = frameCnt / frameRate;
+        return true;
+    }
+
     //Quickly validate the given Lottie file without parsing in order to get the animation info.
     auto startFrame = 0.0f;
     auto endFrame = 0.0f;
@@ -205,9 +409,11 @@ bool LottieLoader::open(const char* data, uint32_t size, const std::string& rpat
     }
 
     if (copy) {
-        content = (char*)malloc(size);
+        auto content = (char*)malloc(size + 1);
         if (!content) return false;
-        memcpy((char*)content, data, size);
+        memcpy(content, data, size);
+        content[size] = '\0';
+        this->content = content;
     } else content = data;
 
     this->size = size;
@@ -223,7 +429,8 @@ bool LottieLoader::open(const char* data, uint32_t size, const std::string& rpat
 
 bool LottieLoader::open(const string& path)
 {
-    auto f = fopen(path.c_str(), "r");
+    //the precompiled data is binary
+    auto f = fopen(path.c_str(), "rb");
     if (!f) return false;
 
     fseek(f, 0, SEEK_END);
@@ -285,7 +492,7 @@ bool LottieLoader::read()
     //the loading has been already completed
     if (comp || !LoadModule::read()) return true;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -295,19 +502,23 @@ Paint* LottieLoader::paint()
 {
     this->done();
     if (!comp) return nullptr;
-    comp->initiated = true;
-    return comp->root->scene;
+    builder->initiated = true;
+    return builder->scene;
 }
 
 
 bool LottieLoader::override(const char* slot)
 {
+    this->done();
+
     if (!comp || comp->slots.count == 0) return false;
 
     auto success = true;
 
     //override slots
     if (slot) {
+        if (!privatize()) return false;
+
         //TODO: Crashed, does this necessary?
         auto temp = strdup(slot);
 
@@ -339,6 +550,31 @@ bool LottieLoader::override(const char* slot)
 }
 
 
+bool LottieLoader::save(const char* path)
+{
+    this->done();
+
+    if (!comp) return false;
+
+    return LottieBinary::write(comp, path);
+}
+
+
+bool LottieLoader::stats(uint32_t* layers, uint32_t* staticLayers, uint32_t* objects, uint32_t* staticObjects)
+{
+    this->done();
+
+    if (!comp) return false;
+
+    if (layers) *layers = comp->stats.layers;
+    if (staticLayers) *staticLayers = comp->stats.invariants;
+    if (objects) *objects = comp->stats.objects;
+    if (staticObjects) *staticObjects = comp->stats.constants;
+
+    return true;
+}
+
+
 bool LottieLoader::frame(float no)
 {
     //no meaing to update if frame diff is less then 1ms
@@ -348,7 +584,8 @@ bool LottieLoader::frame(float no)
 
     this->frameNo = no;
 
-    TaskScheduler::request(this);
+    //the frame update is on the critical path of the rendering, unlike the loading.
+    TaskScheduler::request(this, TaskPriority::High);
 
     return true;
 }
@@ -55,6 +55,8 @@ public:
     bool read() override;
     Paint* paint() override;
     bool override(const char* slot);
+    bool save(const char* path);
+    bool stats(uint32_t* layers, uint32_t* staticLayers, uint32_t* objects, uint32_t* staticObjects);
 
     //Frame Controls
     bool frame(float no) override;
@@ -65,6 +67,7 @@ public:
 
 private:
     bool header();
+    bool privatize();
     void clear();
     void run(unsigned tid) override;
 };
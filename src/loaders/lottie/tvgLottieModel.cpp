@@ -39,10 +39,6 @@ LottieImage::~LottieImage()
 {
     free(b64Data);
     free(mimeType);
-
-    if (picture && PP(picture)->unref() == 0) {
-        delete(picture);
-    }
 }
 
 
@@ -162,6 +158,46 @@ void LottieGroup::prepare(LottieObject::Type type)
 }
 
 
+bool LottieGroup::constant(float begin, float end)
+{
+    for (auto c = children.begin(); c < children.end(); ++c) {
+        if (!(*c)->constant(begin, end)) return false;
+    }
+    return true;
+}
+
+
+LottieRenderShape::LottieRenderShape()
+{
+    shape = Shape::gen().release();
+    PP(shape)->ref();
+}
+
+
+LottieRenderShape::~LottieRenderShape()
+{
+    if (PP(shape)->unref() == 0) delete(shape);
+}
+
+
+LottieRenderScene::~LottieRenderScene()
+{
+    for (auto s = shapes.begin(); s < shapes.end(); ++s) delete(*s);
+    for (auto m = masks.begin(); m < masks.end(); ++m) delete(*m);
+    delete(path);
+    if (viewport && PP(viewport)->unref() == 0) delete(viewport);
+    if (scene && PP(scene)->unref() == 0) delete(scene);
+}
+
+
+LottieLayerState::~LottieLayerState()
+{
+    for (auto i = instances.begin(); i < instances.end(); ++i) {
+        delete(*i);
+    }
+}
+
+
 LottieLayer::~LottieLayer()
 {
     if (refId) {
@@ -196,7 +232,7 @@ void LottieLayer::prepare()
 
 float LottieLayer::remap(float frameNo)
 {
-    if (timeRemap.frames || timeRemap.value) {
+    if (remapped) {
         frameNo = comp->frameAtTime(timeRemap(frameNo));
     } else {
         frameNo -= startFrame;
@@ -207,8 +243,6 @@ float LottieLayer::remap(float frameNo)
 
 LottieComposition::~LottieComposition()
 {
-    if (!initiated && root) delete(root->scene);
-
     delete(root);
     free(version);
     free(name);
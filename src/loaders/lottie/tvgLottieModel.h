@@ -74,6 +74,13 @@ struct LottieStroke
         return false;
     }
 
+    bool constant(float begin, float end)
+    {
+        if (!width.constant(begin, end)) return false;
+        if (!dashattr) return true;
+        return dashattr->value[0].constant(begin, end) && dashattr->value[1].constant(begin, end) && dashattr->value[2].constant(begin, end);
+    }
+
     LottieFloat width = 0.0f;
     DashAttr* dashattr = nullptr;
     float miterLimit = 0;
@@ -130,6 +137,12 @@ struct LottieObject
         TVGERR("LOTTIE", "Unsupported slot type");
     }
 
+    //the object keeps the same values within the frame range [begin, end)
+    virtual bool constant(TVG_UNUSED float begin, TVG_UNUSED float end)
+    {
+        return statical;
+    }
+
     char* name = nullptr;
     Type type;
     bool statical = true;      //no keyframes
@@ -186,6 +199,12 @@ struct LottieText : LottieObject
     void prepare()
     {
         LottieObject::type = LottieObject::Text;
+        statical = !(doc.frames || spacing.frames);
+    }
+
+    bool constant(float begin, float end) override
+    {
+        return doc.constant(begin, end) && spacing.constant(begin, end);
     }
 
     void override(LottieObject* prop) override
@@ -195,7 +214,7 @@ struct LottieText : LottieObject
     }
 
     LottieTextDoc doc;
-    LottieFont* font;
+    LottieFont* font = nullptr;
     LottieFloat spacing = 0.0f;  //letter spacing
 };
 
@@ -210,6 +229,11 @@ struct LottieTrimpath : LottieObject
         if (start.frames || end.frames || offset.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return start.constant(begin, end) && this->end.constant(begin, end) && offset.constant(begin, end);
+    }
+
     void segment(float frameNo, float& start, float& end);
 
     LottieFloat start = 0.0f;
@@ -233,6 +257,12 @@ struct LottieRoundedCorner : LottieObject
         LottieObject::type = LottieObject::RoundedCorner;
         if (radius.frames) statical = false;
     }
+
+    bool constant(float begin, float end) override
+    {
+        return radius.constant(begin, end);
+    }
+
     LottieFloat radius = 0.0f;
 };
 
@@ -245,6 +275,11 @@ struct LottiePath : LottieShape
         if (pathset.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return pathset.constant(begin, end);
+    }
+
     LottiePathSet pathset;
 };
 
@@ -257,6 +292,11 @@ struct LottieRect : LottieShape
         if (position.frames || size.frames || radius.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return position.constant(begin, end) && size.constant(begin, end) && radius.constant(begin, end);
+    }
+
     LottiePosition position = Point{0.0f, 0.0f};
     LottiePoint size = Point{0.0f, 0.0f};
     LottieFloat radius = 0.0f;       //rounded corner radius
@@ -273,6 +313,12 @@ struct LottiePolyStar : LottieShape
         if (position.frames || innerRadius.frames || outerRadius.frames || innerRoundness.frames || outerRoundness.frames || rotation.frames || ptsCnt.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return position.constant(begin, end) && innerRadius.constant(begin, end) && outerRadius.constant(begin, end) && innerRoundness.constant(begin, end) &&
+               outerRoundness.constant(begin, end) && rotation.constant(begin, end) && ptsCnt.constant(begin, end);
+    }
+
     LottiePosition position = Point{0.0f, 0.0f};
     LottieFloat innerRadius = 0.0f;
     LottieFloat outerRadius = 0.0f;
@@ -292,6 +338,11 @@ struct LottieEllipse : LottieShape
         if (position.frames || size.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return position.constant(begin, end) && size.constant(begin, end);
+    }
+
     LottiePosition position = Point{0.0f, 0.0f};
     LottiePoint size = Point{0.0f, 0.0f};
 };
@@ -325,6 +376,14 @@ struct LottieTransform : LottieObject
         }
     }
 
+    bool constant(float begin, float end) override
+    {
+        if (!position.constant(begin, end) || !rotation.constant(begin, end) || !scale.constant(begin, end) || !anchor.constant(begin, end) || !opacity.constant(begin, end)) return false;
+        if (coords && (!coords->x.constant(begin, end) || !coords->y.constant(begin, end))) return false;
+        if (rotationEx && (!rotationEx->x.constant(begin, end) || !rotationEx->y.constant(begin, end))) return false;
+        return true;
+    }
+
     LottiePosition position = Point{0.0f, 0.0f};
     LottieFloat rotation = 0.0f;           //z rotation
     LottiePoint scale = Point{100.0f, 100.0f};
@@ -351,6 +410,11 @@ struct LottieSolidStroke : LottieSolid, LottieStroke
         if (color.frames || opacity.frames || LottieStroke::dynamic()) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return color.constant(begin, end) && opacity.constant(begin, end) && LottieStroke::constant(begin, end);
+    }
+
     void override(LottieObject* prop) override
     {
         this->color = static_cast<LottieSolid*>(prop)->color;
@@ -367,6 +431,11 @@ struct LottieSolidFill : LottieSolid
         if (color.frames || opacity.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return color.constant(begin, end) && opacity.constant(begin, end);
+    }
+
     void override(LottieObject* prop) override
     {
         this->color = static_cast<LottieSolid*>(prop)->color;
@@ -450,6 +519,7 @@ struct LottieGradient : LottieObject
         }
 
         color.data = output.data;
+        color.count = output.count;
         output.data = nullptr;
 
         color.input->reset();
@@ -474,6 +544,12 @@ struct LottieGradient : LottieObject
         return false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return start.constant(begin, end) && this->end.constant(begin, end) && height.constant(begin, end) && angle.constant(begin, end) &&
+               opacity.constant(begin, end) && colorStops.constant(begin, end);
+    }
+
     Fill* fill(float frameNo);
 
     LottiePoint start = Point{0.0f, 0.0f};
@@ -512,6 +588,11 @@ struct LottieGradientStroke : LottieGradient, LottieStroke
         if (LottieGradient::prepare() || LottieStroke::dynamic()) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return LottieGradient::constant(begin, end) && LottieStroke::constant(begin, end);
+    }
+
     void override(LottieObject* prop) override
     {
         this->colorStops = static_cast<LottieGradient*>(prop)->colorStops;
@@ -528,8 +609,7 @@ struct LottieImage : LottieObject
     };
     char* mimeType = nullptr;
     uint32_t size = 0;
-
-    Picture* picture = nullptr;   //tvg render data
+    uint32_t idx = 0;             //index of the image data of the animations
 
     ~LottieImage();
 
@@ -548,6 +628,12 @@ struct LottieRepeater : LottieObject
         if (copies.frames || offset.frames || position.frames || rotation.frames || scale.frames || anchor.frames || startOpacity.frames || endOpacity.frames) statical = false;
     }
 
+    bool constant(float begin, float end) override
+    {
+        return copies.constant(begin, end) && offset.constant(begin, end) && position.constant(begin, end) && rotation.constant(begin, end) &&
+               scale.constant(begin, end) && anchor.constant(begin, end) && startOpacity.constant(begin, end) && endOpacity.constant(begin, end);
+    }
+
     LottieFloat copies = 0.0f;
     LottieFloat offset = 0.0f;
 
@@ -562,6 +648,59 @@ struct LottieRepeater : LottieObject
 };
 
 
+//A shape recycled across the frames, it keeps the path of the last frame to detect the change.
+struct LottieRenderShape
+{
+    LottieRenderShape();
+    ~LottieRenderShape();
+
+    Shape* shape;
+    Array<PathCommand> cmds;   //path of the last frame
+    Array<Point> pts;
+    uint8_t flag;              //update flags not consumed by the renderer yet
+    FillRule rule;             //fill rule of the last frame
+    StrokeJoin join;           //stroke join of the last frame
+};
+
+
+//tvg paints of a layer, retained across the frames.
+struct LottieRenderScene
+{
+    ~LottieRenderScene();
+
+    Scene* scene = nullptr;                  //layer scene
+    Scene* viewport = nullptr;               //clipping scene of the precomp viewport
+    Shape* clipper = nullptr;                //viewport clipper, owned by the viewport
+    Shape* path = nullptr;                   //scratch path of the repeaters
+    Array<LottieRenderShape*> shapes;        //shapes in the drawing order
+    Array<LottieRenderShape*> masks;         //mask shapes in the masking order
+    list<Paint*>::iterator cursor;           //next child of the scene to be matched on the current frame
+    uint32_t shapeCnt = 0;                   //shapes in use on the current frame
+    bool baked = false;                      //the contents are built for good
+};
+
+
+//Render states of a layer. The composition is shared by the animations, each animation has its own states.
+struct LottieLayerState
+{
+    ~LottieLayerState();
+
+    //cached data
+    struct {
+        float frameNo = -1.0f;
+        Matrix matrix;
+        uint8_t opacity;
+    } cache;
+
+    Scene* scene = nullptr;                  //tvg render data of the current frame
+
+    //retained render data, one per reference of the layer on a frame. (ex: a precomp asset referred several times)
+    Array<LottieRenderScene*> instances;
+    uint32_t instanceCnt = 0;                //instances in use on the current frame
+    uint32_t serial = 0;                     //frame serial of the instanceCnt
+};
+
+
 struct LottieGroup : LottieObject
 {
     virtual ~LottieGroup()
@@ -570,8 +709,8 @@ struct LottieGroup : LottieObject
     }
 
     void prepare(LottieObject::Type type = LottieObject::Group);
+    bool constant(float begin, float end) override;
 
-    Scene* scene = nullptr;               //tvg render data
     Array<LottieObject*> children;
 
     bool reqFragment = false;   //requirment to fragment the render context
@@ -616,17 +755,13 @@ struct LottieLayer : LottieGroup
     char* refId = nullptr;      //pre-composition reference.
     int16_t pid = -1;           //id of the parent layer.
     int16_t id = -1;            //id of the current layer.
-
-    //cached data
-    struct {
-        float frameNo = -1.0f;
-        Matrix matrix;
-        uint8_t opacity;
-    } cache;
+    uint32_t idx = 0;           //index of the render states of the animations
 
     Type type = Null;
     bool autoOrient = false;
     bool matteSrc = false;
+    bool remapped = false;      //the time remapping is given.
+    bool invariant = false;     //the contents don't change while the layer is visible.
 };
 
 
@@ -749,7 +884,26 @@ struct LottieComposition
     Array<LottieInterpolator*> interpolators;
     Array<LottieFont*> fonts;
     Array<LottieSlot*> slots;
-    bool initiated = false;
+    uint32_t layerCnt = 0;           //layers to be rendered
+    uint32_t imageCnt = 0;           //image assets
+    atomic<uint32_t> propertyCnt{0}; //properties looked up by the keyframe cursors (see LottieCursors)
+
+    //shared by the animations of the same source
+    uint64_t hashkey = 0;
+    struct {
+        uint64_t digest = 0;         //second hash of the source to confirm a cache hit
+        char* dirName = nullptr;
+        uint32_t size = 0;
+    } source;
+    uint32_t sharing = 0;            //reference count
+
+    //diagnostics of the static contents, which are built once and kept over the frames
+    struct {
+        uint32_t layers = 0;
+        uint32_t invariants = 0;     //layers of the static contents
+        uint32_t objects = 0;
+        uint32_t constants = 0;      //objects of the static values within the layer range
+    } stats;
 };
 
 #endif //_TVG_LOTTIE_MODEL_H_
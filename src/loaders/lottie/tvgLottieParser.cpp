@@ -857,6 +857,7 @@ LottieImage* LottieParser::parseImage(const char* data, const char* subPath, boo
 {
     //Used for Image Asset
     auto image = new LottieImage;
+    image->idx = comp->imageCnt++;
 
     //embeded image resource. should start with "data:"
     //header look like "data:image/png;base64," so need to skip till ','.
@@ -1011,6 +1012,7 @@ LottieObject* LottieParser::parseGroup()
 void LottieParser::parseTimeRemap(LottieLayer* layer)
 {
     parseProperty(layer->timeRemap);
+    layer->remapped = true;
 }
 
 
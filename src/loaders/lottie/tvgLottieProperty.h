@@ -23,6 +23,7 @@
 #ifndef _TVG_LOTTIE_PROPERTY_H_
 #define _TVG_LOTTIE_PROPERTY_H_
 
+#include <atomic>
 #include "tvgCommon.h"
 #include "tvgArray.h"
 #include "tvgMath.h"
@@ -48,6 +49,7 @@ struct ColorStop
 {
     Fill::ColorStop* data = nullptr;
     Array<float>* input = nullptr;
+    uint16_t count = 0;     //populated colorstop count
 };
 
 
@@ -132,6 +134,11 @@ struct LottieScalarFrame
         }
         return mathLerp(value, next->value, t);
     }
+
+    bool still() const
+    {
+        return true;
+    }
 };
 
 
@@ -175,6 +182,12 @@ struct LottieVectorFrame
         return -bezAngleAt(bz, t);
     }
 
+    //no detour between the same values
+    bool still() const
+    {
+        return !hasTangent || (mathZero(outTangent.x) && mathZero(outTangent.y) && mathZero(inTangent.x) && mathZero(inTangent.y));
+    }
+
     void prepare(LottieVectorFrame* next)
     {
         Bezier bz = {value, value + outTangent, next->value + inTangent, next->value};
@@ -201,13 +214,131 @@ uint32_t bsearch(T* frames, float frameNo)
 }
 
 
+template<typename T>
+static inline bool _same(const T& lhs, const T& rhs)
+{
+    return !memcmp(&lhs, &rhs, sizeof(T));
+}
+
+
+static inline bool _same(const PathSet& lhs, const PathSet& rhs)
+{
+    if (lhs.ptsCnt != rhs.ptsCnt || lhs.cmdsCnt != rhs.cmdsCnt) return false;
+    if (memcmp(lhs.cmds, rhs.cmds, sizeof(PathCommand) * lhs.cmdsCnt)) return false;
+    return !memcmp(lhs.pts, rhs.pts, sizeof(Point) * lhs.ptsCnt);
+}
+
+
+static inline bool _same(const ColorStop& lhs, const ColorStop& rhs)
+{
+    if (lhs.count != rhs.count) return false;
+    if (lhs.count == 0) return true;
+    if (!lhs.data || !rhs.data) return lhs.data == rhs.data;
+    return !memcmp(lhs.data, rhs.data, sizeof(Fill::ColorStop) * lhs.count);
+}
+
+
+static inline bool _sameStr(const char* lhs, const char* rhs)
+{
+    if (!lhs || !rhs) return lhs == rhs;
+    return !strcmp(lhs, rhs);
+}
+
+
+//field by field, the paddings are not initialized
+static inline bool _same(const TextDocument& lhs, const TextDocument& rhs)
+{
+    if (!_sameStr(lhs.text, rhs.text) || !_sameStr(lhs.name, rhs.name)) return false;
+    if (lhs.height != rhs.height || lhs.shift != rhs.shift || lhs.size != rhs.size) return false;
+    if (memcmp(&lhs.color, &rhs.color, sizeof(RGB24))) return false;
+    if (memcmp(&lhs.bbox.pos, &rhs.bbox.pos, sizeof(Point)) || memcmp(&lhs.bbox.size, &rhs.bbox.size, sizeof(Point))) return false;
+    if (lhs.stroke.render != rhs.stroke.render || lhs.stroke.width != rhs.stroke.width) return false;
+    if (memcmp(&lhs.stroke.color, &rhs.stroke.color, sizeof(RGB24))) return false;
+    return lhs.justify == rhs.justify && lhs.tracking == rhs.tracking;
+}
+
+
+//Check the keyframes hold the same value within the frame range [begin, end), the keyframes out of the range don't matter.
+template<typename T>
+bool stationary(T* frames, float begin, float end)
+{
+    if (!frames) return true;
+
+    decltype(frames->data) ref = nullptr;
+
+    for (auto frame = frames->begin(); frame < frames->end(); ++frame) {
+        if (frame + 1 < frames->end() && (frame + 1)->no <= begin) continue;
+        if (frame > frames->begin() && (frame - 1)->no >= end) break;
+        if (!frame->still()) return false;
+        if (!ref) ref = frame;
+        else if (!_same(ref->value, frame->value)) return false;
+    }
+    return true;
+}
+
+
 struct LottieProperty
 {
     enum class Type : uint8_t { Point = 0, Float, Opacity, Color, PathSet, ColorStop, Position, TextDoc, Invalid };
+    LottieProperty() {}
     virtual ~LottieProperty() {}
+
+    //the id is not a part of the value
+    LottieProperty(TVG_UNUSED const LottieProperty& rhs) {}
+    LottieProperty& operator=(TVG_UNUSED const LottieProperty& rhs) { return *this; }
+
+    atomic<uint32_t> id{0};        //slot in the cursors of the animations (see LottieCursors), 0 if not given yet
+};
+
+
+//The keyframe indices found last, one per property. The model could be shared by the animations,
+//so the builder of each keeps its own cursors and binds them to the thread while it updates a frame.
+struct LottieCursors
+{
+    Array<uint32_t> hints;
+    atomic<uint32_t>* cnt = nullptr;          //the ids given in the composition
+
+    static thread_local LottieCursors* bound;
+
+    uint32_t& operator[](LottieProperty& prop)
+    {
+        auto id = prop.id.load(memory_order_relaxed);
+        if (id == 0) {
+            auto next = cnt->fetch_add(1, memory_order_relaxed) + 1;
+            //the other animation may have given one meanwhile
+            if (prop.id.compare_exchange_strong(id, next, memory_order_relaxed)) id = next;
+        }
+        if (id > hints.count) {
+            hints.reserve(id + id / 2);
+            memset(hints.data + hints.count, 0x00, sizeof(uint32_t) * (id - hints.count));
+            hints.count = id;
+        }
+        return hints[id - 1];
+    }
 };
 
 
+//Find the keyframe of the frame number, same as bsearch(). The frames are mostly played in order,
+//so the keyframe found last and the next one are tried first, the binary search is for the jumps.
+template<typename T>
+uint32_t lookup(T* frames, float frameNo, LottieProperty& prop)
+{
+    auto cursors = LottieCursors::bound;
+    if (!cursors) return bsearch(frames, frameNo);
+
+    auto& cursor = (*cursors)[prop];
+    for (auto idx = cursor; idx <= cursor + 1 && idx + 1 < frames->count; ++idx) {
+        auto frame = frames->data + idx;
+        if (frameNo < frame->no && !mathEqual(frameNo, frame->no)) break;
+        if (frameNo > (frame + 1)->no || mathEqual(frameNo, (frame + 1)->no)) continue;
+        //ambiguous among the keyframes of the same frame number
+        if (idx > 0 && mathEqual(frameNo, (frame - 1)->no)) break;
+        return (cursor = idx);
+    }
+    return (cursor = bsearch(frames, frameNo));
+}
+
+
 template<typename T>
 struct LottieGenericProperty : LottieProperty
 {
@@ -251,7 +382,7 @@ struct LottieGenericProperty : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
         if (frame->no == frameNo) return frame->value;
         return frame->interpolate(frame + 1, frameNo);
     }
@@ -267,7 +398,20 @@ struct LottieGenericProperty : LottieProperty
     }
 
     float angle(float frameNo) { return 0; }
-    void prepare() {}
+
+    bool constant(float begin = -FLT_MAX, float end = FLT_MAX)
+    {
+        return stationary(frames, begin, end);
+    }
+
+    void prepare()
+    {
+        //the keyframes of the same value are no more than the value.
+        if (!frames || !constant()) return;
+        value = frames->first().value;
+        release();
+        frames = nullptr;
+    }
 };
 
 
@@ -335,7 +479,7 @@ struct LottiePathSet : LottieProperty
             return true;
         }
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
 
         if (frame->no == frameNo) {
             copy(frame->value, cmds);
@@ -364,7 +508,27 @@ struct LottiePathSet : LottieProperty
         return true;
     }
 
-    void prepare() {}
+    bool constant(float begin = -FLT_MAX, float end = FLT_MAX)
+    {
+        return stationary(frames, begin, end);
+    }
+
+    void prepare()
+    {
+        //the keyframes of the same path are no more than the path.
+        if (!frames || !constant()) return;
+        auto first = frames->begin();
+        free(value.cmds);
+        free(value.pts);
+        value = first->value;
+        for (auto p = first + 1; p < frames->end(); ++p) {
+            free((*p).value.cmds);
+            free((*p).value.pts);
+        }
+        free(frames->data);
+        free(frames);
+        frames = nullptr;
+    }
 };
 
 
@@ -433,7 +597,7 @@ struct LottieColorStop : LottieProperty
             return;
         }
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
         if (frame->no == frameNo) {
             fill->colorStops(frame->value.data, count);
             return;
@@ -480,6 +644,11 @@ struct LottieColorStop : LottieProperty
         return *this;
     }
 
+    bool constant(float begin = -FLT_MAX, float end = FLT_MAX)
+    {
+        return stationary(frames, begin, end);
+    }
+
     void prepare() {}
 };
 
@@ -526,7 +695,7 @@ struct LottiePosition : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
         if (frame->no == frameNo) return frame->value;
         return frame->interpolate(frame + 1, frameNo);
     }
@@ -537,12 +706,23 @@ struct LottiePosition : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return 0;
         if (frameNo >= frames->last().no) return 0;
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
         return frame->angle(frame + 1, frameNo);
     }
 
+    bool constant(float begin = -FLT_MAX, float end = FLT_MAX)
+    {
+        return stationary(frames, begin, end);
+    }
+
     void prepare()
     {
+        //the keyframes of the same position are no more than the position.
+        if (frames && constant()) {
+            value = frames->first().value;
+            release();
+            frames = nullptr;
+        }
         if (!frames || frames->count < 2) return;
         for (auto frame = frames->begin() + 1; frame < frames->end(); ++frame) {
             (frame - 1)->prepare(frame);
@@ -605,7 +785,7 @@ struct LottieTextDoc : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + bsearch(frames, frameNo);
+        auto frame = frames->data + lookup(frames, frameNo, *this);
         return frame->value;
     }
 
@@ -623,6 +803,11 @@ struct LottieTextDoc : LottieProperty
         return *this;
     }
 
+    bool constant(float begin = -FLT_MAX, float end = FLT_MAX)
+    {
+        return stationary(frames, begin, end);
+    }
+
     void prepare() {}
 };
 
@@ -134,7 +134,7 @@ bool PngLoader::read()
 
     if (!LoadModule::read()) return true;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -3726,7 +3726,7 @@ bool SvgLoader::read()
     //the loading has been already completed in header()
     if (root || !LoadModule::read()) return true;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -47,7 +47,6 @@ size_t svgUtilURLDecode(const char *src, char** dst)
     if (length == 0) return 0;
 
     char* decoded = (char*)malloc(sizeof(char) * length + 1);
-    decoded[length] = '\0';
 
     char a, b;
     int idx =0;
@@ -65,6 +64,8 @@ size_t svgUtilURLDecode(const char *src, char** dst)
         }
     }
 
+    decoded[idx] = '\0';
+
     *dst = decoded;
-    return length + 1;
+    return idx + 1;
 }
\ No newline at end of file
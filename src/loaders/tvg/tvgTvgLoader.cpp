@@ -218,7 +218,7 @@ bool TvgLoader::read()
     //the loading has been already completed
     if (root || !LoadModule::read()) return true;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -135,7 +135,7 @@ bool WebpLoader::read()
 
     surface.cs = this->cs;
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -180,6 +180,36 @@ bool GlRenderer::endComposite(Compositor* cmp)
 }
 
 
+bool GlRenderer::beginCache(TVG_UNUSED RenderData* cache, TVG_UNUSED const RenderRegion& region)
+{
+    //TODO: Not supported yet, the paints are rendered directly.
+    return false;
+}
+
+
+bool GlRenderer::endCache(TVG_UNUSED RenderData cache)
+{
+    return false;
+}
+
+
+bool GlRenderer::renderCache(TVG_UNUSED RenderData cache, TVG_UNUSED int32_t x, TVG_UNUSED int32_t y, TVG_UNUSED uint8_t opacity)
+{
+    return false;
+}
+
+
+bool GlRenderer::cached(TVG_UNUSED RenderData cache)
+{
+    return false;
+}
+
+
+void GlRenderer::disposeCache(TVG_UNUSED RenderData cache)
+{
+}
+
+
 ColorSpace GlRenderer::colorSpace()
 {
     return ColorSpace::Unsupported;
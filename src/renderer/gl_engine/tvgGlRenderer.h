@@ -75,6 +75,12 @@ public:
     bool beginComposite(Compositor* cmp, CompositeMethod method, uint8_t opacity) override;
     bool endComposite(Compositor* cmp) override;
 
+    bool beginCache(RenderData* cache, const RenderRegion& region) override;
+    bool endCache(RenderData cache) override;
+    bool renderCache(RenderData cache, int32_t x, int32_t y, uint8_t opacity) override;
+    bool cached(RenderData cache) override;
+    void disposeCache(RenderData cache) override;
+
     static GlRenderer* gen();
     static int init(TVG_UNUSED uint32_t threads);
     static int32_t init();
@@ -24,6 +24,7 @@
 #define _TVG_SW_COMMON_H_
 
 #include "tvgCommon.h"
+#include "tvgInlist.h"
 #include "tvgRender.h"
 
 #include <algorithm>
@@ -43,10 +44,34 @@ static double timeStamp()
 #define SW_ANGLE_PI (180L << 16)
 #define SW_ANGLE_2PI (SW_ANGLE_PI << 1)
 #define SW_ANGLE_PI2 (SW_ANGLE_PI >> 1)
+#define SW_MIPMAP_LEVELS 16
 
 using SwCoord = signed long;
 using SwFixed = signed long long;
 
+//Raster kernel sets by the cpu instructions, in order of the preference
+enum class SwSimd : uint8_t {None = 0, Sse41, Avx2, Neon};
+
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+    //The kernels are compiled per instruction set and chosen at runtime (see rasterSimd()),
+    //thus the library itself must not be built with the -mavx/-msse4.1 flags.
+    #if defined(__GNUC__) || defined(__clang__)
+        #define SSE_TARGET __attribute__((target("sse4.1")))
+        #define AVX_TARGET __attribute__((target("avx2")))
+    #else
+        #define SSE_TARGET
+        #define AVX_TARGET
+    #endif
+#endif
+
+//The blending ops are specialized into the raster kernels (see _blendingKernel()),
+//-Os would otherwise leave them as the calls in every pixel loop.
+#if defined(__GNUC__) || defined(__clang__)
+    #define SW_BLEND_INLINE inline __attribute__((always_inline))
+#else
+    #define SW_BLEND_INLINE __forceinline
+#endif
+
 
 static inline float TO_FLOAT(SwCoord val)
 {
@@ -141,6 +166,22 @@ struct SwBBox
     }
 };
 
+//the gradient colors, shared by the fills (see tvgSwFill.cpp)
+struct SwColorTable
+{
+    INLIST_ITEM(SwColorTable);
+
+    uint32_t* colors;
+    uint32_t size;                 //the power of two
+    uint32_t hash;
+    uint32_t refCnt;
+    Fill::ColorStop* stops;
+    uint32_t cnt;
+    uint8_t opacity;
+    ColorSpace cs;
+    bool translucent;
+};
+
 struct SwFill
 {
     struct SwLinear {
@@ -162,7 +203,7 @@ struct SwFill
         SwRadial radial;
     };
 
-    uint32_t* ctable;
+    SwColorTable* ctable;
     FillSpread spread;
 
     bool translucent;
@@ -225,10 +266,23 @@ struct SwShape
     bool         fastTrack = false;   //Fast Track: axis-aligned rectangle without any clips?
 };
 
+//Half-resolution levels of an image source for the downscaled drawing
+struct SwMipmap
+{
+    uint32_t*    data[SW_MIPMAP_LEVELS];   //data[i] is the (i + 1)th level
+    uint32_t     w[SW_MIPMAP_LEVELS];
+    uint32_t     h[SW_MIPMAP_LEVELS];
+    uint32_t     cnt;                      //generated levels
+    const void*  source;                   //image data the levels are generated from
+    ColorSpace   cs;                       //colorspace of the source data
+};
+
 struct SwImage
 {
     SwOutline*   outline = nullptr;
     SwRleData*   rle = nullptr;
+    SwMipmap*    mipmap = nullptr;
+    SurfaceCopy* pixels = nullptr;         //not null if the source couldn't be drawn as it is, shared with its other users
     union {
         pixel_t*  data;      //system based data pointer
         uint32_t* buf32;     //for explicit 32bits channels
@@ -242,6 +296,22 @@ struct SwImage
 
     bool         direct = false;  //draw image directly (with offset)
     bool         scaled = false;  //draw scaled image
+
+    uint32_t* buf32At(SwCoord x, SwCoord y) const
+    {
+        return buf32 + (y + oy) * stride + (x + ox);
+    }
+
+    uint8_t* buf8At(SwCoord x, SwCoord y) const
+    {
+        return buf8 + (y + oy) * stride + (x + ox);
+    }
+
+    //the first byte of the pixel at (x, y) in any channel size
+    uint8_t* pixelAt(SwCoord x, SwCoord y) const
+    {
+        return buf8 + ((y + oy) * stride + (x + ox)) * channelSize;
+    }
 };
 
 typedef uint8_t(*SwMask)(uint8_t s, uint8_t d, uint8_t a);                  //src, dst, alpha
@@ -257,7 +327,9 @@ struct SwSurface : Surface
     SwAlpha alphas[4];                    //Alpha:2, InvAlpha:3, Luma:4, InvLuma:5
     SwBlender blender = nullptr;          //blender (optional)
     SwCompositor* compositor = nullptr;   //compositor (optional)
-    BlendMethod blendMethod;              //blending method (uint8_t)
+    SwCompositor* owner = nullptr;        //compositor which renders on this surface (optional)
+    BlendMethod blendMethod = BlendMethod::Normal;  //blending method (uint8_t)
+    int32_t ox = 0, oy = 0;               //offset to the buffer, the buffer of a composition covers its region only.
 
     SwAlpha alpha(CompositeMethod method)
     {
@@ -276,7 +348,19 @@ struct SwSurface : Surface
         blender = rhs->blender;
         compositor = rhs->compositor;
         blendMethod = rhs->blendMethod;
+        ox = rhs->ox;
+        oy = rhs->oy;
      }
+
+    uint32_t* buf32At(SwCoord x, SwCoord y) const
+    {
+        return buf32 + (y + oy) * stride + (x + ox);
+    }
+
+    uint8_t* buf8At(SwCoord x, SwCoord y) const
+    {
+        return buf8 + (y + oy) * stride + (x + ox);
+    }
 };
 
 struct SwCompositor : Compositor
@@ -285,14 +369,28 @@ struct SwCompositor : Compositor
     SwCompositor* recoverCmp;               //Recover compositor when composition is done
     SwImage image;
     SwBBox bbox;
+    void* buffer = nullptr;                 //region sized image buffer
+    size_t size = 0;                        //buffer size class in bytes
+    uint32_t frame = 0;                     //drawing count when the buffer was used last
     bool valid;
 };
 
+//A bump allocator of the transient buffers, they must be returned in the reverse order of the requests.
+struct SwArena
+{
+    uint8_t* data;              //current block
+    uint32_t size;              //current block size
+    uint32_t used;              //top of the current block
+    uint32_t live;              //count of the requests not returned yet
+    Array<uint8_t*> retired;    //outgrown blocks, freed once the arena is empty
+};
+
 struct SwMpool
 {
     SwOutline* outline;
     SwOutline* strokeOutline;
     SwOutline* dashOutline;
+    SwArena* arena;
     unsigned allocSize;
 };
 
@@ -368,13 +466,13 @@ static inline uint32_t opBlendPreNormal(uint32_t s, uint32_t d, TVG_UNUSED uint8
     return s + ALPHA_BLEND(d, IA(s));
 }
 
-static inline uint32_t opBlendSrcOver(uint32_t s, TVG_UNUSED uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendSrcOver(uint32_t s, TVG_UNUSED uint32_t d, TVG_UNUSED uint8_t a)
 {
     return s;
 }
 
 //TODO: BlendMethod could remove the alpha parameter.
-static inline uint32_t opBlendDifference(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendDifference(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     //if (s > d) => s - d
     //else => d - s
@@ -384,7 +482,7 @@ static inline uint32_t opBlendDifference(uint32_t s, uint32_t d, TVG_UNUSED uint
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendExclusion(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendExclusion(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     //A + B - 2AB
     auto c1 = std::min(255, C1(s) + C1(d) - std::min(255, (C1(s) * C1(d)) << 1));
@@ -393,7 +491,7 @@ static inline uint32_t opBlendExclusion(uint32_t s, uint32_t d, TVG_UNUSED uint8
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendAdd(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendAdd(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // s + d
     auto c1 = std::min(C1(s) + C1(d), 255);
@@ -402,7 +500,7 @@ static inline uint32_t opBlendAdd(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendScreen(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendScreen(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // s + d - s * d
     auto c1 = C1(s) + C1(d) - MULTIPLY(C1(s), C1(d));
@@ -412,7 +510,7 @@ static inline uint32_t opBlendScreen(uint32_t s, uint32_t d, TVG_UNUSED uint8_t
 }
 
 
-static inline uint32_t opBlendMultiply(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendMultiply(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // s * d
     auto c1 = MULTIPLY(C1(s), C1(d));
@@ -422,7 +520,7 @@ static inline uint32_t opBlendMultiply(uint32_t s, uint32_t d, TVG_UNUSED uint8_
 }
 
 
-static inline uint32_t opBlendOverlay(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendOverlay(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // if (2 * d < da) => 2 * s * d,
     // else => 1 - 2 * (1 - s) * (1 - d)
@@ -432,7 +530,7 @@ static inline uint32_t opBlendOverlay(uint32_t s, uint32_t d, TVG_UNUSED uint8_t
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendDarken(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendDarken(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // min(s, d)
     auto c1 = std::min(C1(s), C1(d));
@@ -441,7 +539,7 @@ static inline uint32_t opBlendDarken(uint32_t s, uint32_t d, TVG_UNUSED uint8_t
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendLighten(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendLighten(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // max(s, d)
     auto c1 = std::max(C1(s), C1(d));
@@ -450,7 +548,7 @@ static inline uint32_t opBlendLighten(uint32_t s, uint32_t d, TVG_UNUSED uint8_t
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendColorDodge(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendColorDodge(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // d / (1 - s)
     auto is = 0xffffffff - s;
@@ -460,7 +558,7 @@ static inline uint32_t opBlendColorDodge(uint32_t s, uint32_t d, TVG_UNUSED uint
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendColorBurn(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendColorBurn(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     // 1 - (1 - d) / s
     auto id = 0xffffffff - d;
@@ -470,7 +568,7 @@ static inline uint32_t opBlendColorBurn(uint32_t s, uint32_t d, TVG_UNUSED uint8
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendHardLight(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendHardLight(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     auto c1 = (C1(s) < 128) ? std::min(255, 2 * MULTIPLY(C1(s), C1(d))) : (255 - std::min(255, 2 * MULTIPLY(255 - C1(s), 255 - C1(d))));
     auto c2 = (C2(s) < 128) ? std::min(255, 2 * MULTIPLY(C2(s), C2(d))) : (255 - std::min(255, 2 * MULTIPLY(255 - C2(s), 255 - C2(d))));
@@ -478,7 +576,7 @@ static inline uint32_t opBlendHardLight(uint32_t s, uint32_t d, TVG_UNUSED uint8
     return JOIN(255, c1, c2, c3);
 }
 
-static inline uint32_t opBlendSoftLight(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
+static SW_BLEND_INLINE uint32_t opBlendSoftLight(uint32_t s, uint32_t d, TVG_UNUSED uint8_t a)
 {
     //(255 - 2 * s) * (d * d) + (2 * s * b)
     auto c1 = std::min(255, MULTIPLY(255 - std::min(255, 2 * C1(s)), MULTIPLY(C1(d), C1(d))) + 2 * MULTIPLY(C1(s), C1(d)));
@@ -508,7 +606,7 @@ bool mathClipBBox(const SwBBox& clipper, SwBBox& clipee);
 void shapeReset(SwShape* shape);
 bool shapePrepare(SwShape* shape, const RenderShape* rshape, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid, bool hasComposite);
 bool shapePrepared(const SwShape* shape);
-bool shapeGenRle(SwShape* shape, const RenderShape* rshape, bool antiAlias);
+bool shapeGenRle(SwShape* shape, const RenderShape* rshape, bool antiAlias, SwMpool* mpool, unsigned tid);
 void shapeDelOutline(SwShape* shape, SwMpool* mpool, uint32_t tid);
 void shapeResetStroke(SwShape* shape, const RenderShape* rshape, const Matrix* transform);
 bool shapeGenStrokeRle(SwShape* shape, const RenderShape* rshape, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid);
@@ -527,35 +625,29 @@ SwOutline* strokeExportOutline(SwStroke* stroke, SwMpool* mpool, unsigned tid);
 void strokeFree(SwStroke* stroke);
 
 bool imagePrepare(SwImage* image, const RenderMesh* mesh, const Matrix* transform, const SwBBox& clipRegion, SwBBox& renderRegion, SwMpool* mpool, unsigned tid);
-bool imageGenRle(SwImage* image, const SwBBox& renderRegion, bool antiAlias);
+bool imageGenRle(SwImage* image, const SwBBox& renderRegion, bool antiAlias, SwMpool* mpool, unsigned tid);
 void imageDelOutline(SwImage* image, SwMpool* mpool, uint32_t tid);
 void imageReset(SwImage* image);
 void imageFree(SwImage* image);
+bool imageLoad(SwImage* image, Surface* source, ColorSpace cs);
+void imageFreePixels(SwImage* image);
+bool imageGenMipmap(SwImage* image, ColorSpace cs);
+bool imageMipmap(const SwImage* image, const Matrix* transform, SwImage* level, Matrix* levelTransform);
+void imageFreeMipmap(SwImage* image);
 
 bool fillGenColorTable(SwFill* fill, const Fill* fdata, const Matrix* transform, SwSurface* surface, uint8_t opacity, bool ctable);
 void fillReset(SwFill* fill);
 void fillFree(SwFill* fill);
 
-//OPTIMIZE_ME: Skip the function pointer access
-void fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask maskOp, uint8_t opacity);                                   //composite masking ver.
-void fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask maskOp, uint8_t opacity);                     //direct masking ver.
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a);                                         //blending ver.
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a);                          //blending + BlendingMethod(op2) ver.
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity);     //matting ver.
-
-void fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask op, uint8_t a);                                             //composite masking ver.
-void fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask op, uint8_t a) ;                              //direct masking ver.
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a);                                         //blending ver.
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a);                          //blending + BlendingMethod(op2) ver.
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity);     //matting ver.
-
-SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias);
+SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias, SwMpool* mpool, unsigned tid);
 SwRleData* rleRender(const SwBBox* bbox);
+SwRleData* rleRenderHairline(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, float width, bool caps, SwMpool* mpool, unsigned tid);
 void rleFree(SwRleData* rle);
 void rleReset(SwRleData* rle);
-void rleMerge(SwRleData* rle, SwRleData* clip1, SwRleData* clip2);
-void rleClipPath(SwRleData* rle, const SwRleData* clip);
-void rleClipRect(SwRleData* rle, const SwBBox* clip);
+void rleMerge(SwRleData* rle, SwRleData* clip1, SwRleData* clip2, SwMpool* mpool, unsigned tid);
+void rleClipPath(SwRleData* rle, const SwRleData* clip, SwMpool* mpool, unsigned tid);
+void rleClipRect(SwRleData* rle, const SwBBox* clip, SwMpool* mpool, unsigned tid);
+void rleTranslate(SwRleData* rle, SwCoord x, SwCoord y);
 
 SwMpool* mpoolInit(uint32_t threads);
 bool mpoolTerm(SwMpool* mpool);
@@ -566,6 +658,8 @@ SwOutline* mpoolReqStrokeOutline(SwMpool* mpool, unsigned idx);
 void mpoolRetStrokeOutline(SwMpool* mpool, unsigned idx);
 SwOutline* mpoolReqDashOutline(SwMpool* mpool, unsigned idx);
 void mpoolRetDashOutline(SwMpool* mpool, unsigned idx);
+void* mpoolReqArena(SwMpool* mpool, unsigned idx, uint32_t size);
+void mpoolRetArena(SwMpool* mpool, unsigned idx, void* ptr);
 
 bool rasterCompositor(SwSurface* surface);
 bool rasterGradientShape(SwSurface* surface, SwShape* shape, unsigned id);
@@ -576,8 +670,10 @@ bool rasterGradientStroke(SwSurface* surface, SwShape* shape, unsigned id);
 bool rasterClear(SwSurface* surface, uint32_t x, uint32_t y, uint32_t w, uint32_t h);
 void rasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32_t len);
 void rasterGrayscale8(uint8_t *dst, uint8_t val, uint32_t offset, int32_t len);
-void rasterUnpremultiply(Surface* surface);
-void rasterPremultiply(Surface* surface);
-bool rasterConvertCS(Surface* surface, ColorSpace to);
+void rasterUnpremultiply(Surface* surface, uint32_t x, uint32_t y, uint32_t w, uint32_t h);
+bool rasterConvertible(const Surface* source, ColorSpace to);
+bool rasterConvertCS(const Surface* source, uint32_t* dst, ColorSpace to);
+SwSimd rasterSimd(SwSimd limit);
+SwSimd rasterSimd();
 
 #endif /* _TVG_SW_COMMON_H_ */
@@ -21,6 +21,7 @@
  */
 
 #include "tvgMath.h"
+#include "tvgInlist.h"
 #include "tvgSwCommon.h"
 #include "tvgFill.h"
 
@@ -28,70 +29,61 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
-#define RADIAL_A_THRESHOLD 0.0005f
 #define GRADIENT_STOP_SIZE 1024
-#define FIXPT_BITS 8
-#define FIXPT_SIZE (1<<FIXPT_BITS)
 
-/*
- * quadratic equation with the following coefficients (rx and ry defined in the _calculateCoefficients()):
- * A = a  // fill->radial.a
- * B = 2 * (dr * fr + rx * dx + ry * dy)
- * C = fr^2 - rx^2 - ry^2
- * Derivatives are computed with respect to dx.
- * This procedure aims to optimize and eliminate the need to calculate all values from the beginning
- * for consecutive x values with a constant y. The Taylor series expansions are computed as long as
- * its terms are non-zero.
- */
-static void _calculateCoefficients(const SwFill* fill, uint32_t x, uint32_t y, float& b, float& deltaB, float& det, float& deltaDet, float& deltaDeltaDet)
-{
-    auto radial = &fill->radial;
 
-    auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-    auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
+/* The color tables are shared by the fills of the same color stops, opacity, colorspace
+   and table size. They are addressed by the hash of those and alive while referenced. */
 
-    b = (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy) * radial->invA;
-    deltaB = (radial->a11 * radial->dx + radial->a21 * radial->dy) * radial->invA;
+#define GRADIENT_STOP_MIN_SIZE 64
+#define COLOR_TABLE_BUCKETS 64
 
-    auto rr = rx * rx + ry * ry;
-    auto deltaRr = 2.0f * (rx * radial->a11 + ry * radial->a21) * radial->invA;
-    auto deltaDeltaRr = 2.0f * (radial->a11 * radial->a11 + radial->a21 * radial->a21) * radial->invA;
+static Inlist<SwColorTable> _colorTables[COLOR_TABLE_BUCKETS];
+static Key _colorTableKey;
 
-    det = b * b + (rr - radial->fr * radial->fr) * radial->invA;
-    deltaDet = 2.0f * b * deltaB + deltaB * deltaB + deltaRr + deltaDeltaRr;
-    deltaDeltaDet = 2.0f * deltaB * deltaB + deltaDeltaRr;
+
+static uint32_t _hash(const Fill::ColorStop* stops, uint32_t cnt, uint8_t opacity, ColorSpace cs, uint32_t size)
+{
+    //FNV-1a
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const void* data, size_t len) {
+        auto p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; ++i) hash = (hash ^ p[i]) * 16777619u;
+    };
+    mix(stops, sizeof(Fill::ColorStop) * cnt);
+    mix(&opacity, sizeof(opacity));
+    mix(&cs, sizeof(cs));
+    mix(&size, sizeof(size));
+    return hash;
 }
 
 
-static bool _updateColorTable(SwFill* fill, const Fill* fdata, const SwSurface* surface, uint8_t opacity)
+static void _genColorTable(SwColorTable* table, const SwSurface* surface)
 {
-    if (!fill->ctable) {
-        fill->ctable = static_cast<uint32_t*>(malloc(GRADIENT_STOP_SIZE * sizeof(uint32_t)));
-        if (!fill->ctable) return false;
-    }
-
-    const Fill::ColorStop* colors;
-    auto cnt = fdata->colorStops(&colors);
-    if (cnt == 0 || !colors) return false;
+    auto colors = table->stops;
+    auto cnt = table->cnt;
+    auto opacity = table->opacity;
+    auto ctable = table->colors;
+    auto size = table->size;
 
     auto pColors = colors;
 
     auto a = MULTIPLY(pColors->a, opacity);
-    if (a < 255) fill->translucent = true;
+    if (a < 255) table->translucent = true;
 
     auto r = pColors->r;
     auto g = pColors->g;
     auto b = pColors->b;
     auto rgba = surface->join(r, g, b, a);
 
-    auto inc = 1.0f / static_cast<float>(GRADIENT_STOP_SIZE);
+    auto inc = 1.0f / static_cast<float>(size);
     auto pos = 1.5f * inc;
     uint32_t i = 0;
 
-    fill->ctable[i++] = ALPHA_BLEND(rgba | 0xff000000, a);
+    ctable[i++] = ALPHA_BLEND(rgba | 0xff000000, a);
 
-    while (pos <= pColors->offset) {
-        fill->ctable[i] = fill->ctable[i - 1];
+    while (pos <= pColors->offset && i < size) {
+        ctable[i] = ctable[i - 1];
         ++i;
         pos += inc;
     }
@@ -101,17 +93,17 @@ static bool _updateColorTable(SwFill* fill, const Fill* fdata, const SwSurface*
         auto next = curr + 1;
         auto delta = 1.0f / (next->offset - curr->offset);
         auto a2 = MULTIPLY(next->a, opacity);
-        if (!fill->translucent && a2 < 255) fill->translucent = true;
+        if (!table->translucent && a2 < 255) table->translucent = true;
 
         auto rgba2 = surface->join(next->r, next->g, next->b, a2);
 
-        while (pos < next->offset && i < GRADIENT_STOP_SIZE) {
+        while (pos < next->offset && i < size) {
             auto t = (pos - curr->offset) * delta;
             auto dist = static_cast<int32_t>(255 * t);
             auto dist2 = 255 - dist;
 
             auto color = INTERPOLATE(rgba, rgba2, dist2);
-            fill->ctable[i] = ALPHA_BLEND((color | 0xff000000), (color >> 24));
+            ctable[i] = ALPHA_BLEND((color | 0xff000000), (color >> 24));
 
             ++i;
             pos += inc;
@@ -121,11 +113,107 @@ static bool _updateColorTable(SwFill* fill, const Fill* fdata, const SwSurface*
     }
     rgba = ALPHA_BLEND((rgba | 0xff000000), a);
 
-    for (; i < GRADIENT_STOP_SIZE; ++i)
-        fill->ctable[i] = rgba;
+    for (; i < size; ++i)
+        ctable[i] = rgba;
 
     //Make sure the last color stop is represented at the end of the table
-    fill->ctable[GRADIENT_STOP_SIZE - 1] = rgba;
+    ctable[size - 1] = rgba;
+}
+
+
+static void _releaseColorTable(SwColorTable* table)
+{
+    if (!table) return;
+
+    ScopedLock lock(_colorTableKey);
+
+    if (--table->refCnt > 0) return;
+
+    _colorTables[table->hash % COLOR_TABLE_BUCKETS].remove(table);
+    free(table->stops);
+    free(table->colors);
+    free(table);
+}
+
+
+static SwColorTable* _acquireColorTable(const Fill* fdata, const SwSurface* surface, uint8_t opacity, uint32_t size)
+{
+    const Fill::ColorStop* colors;
+    auto cnt = fdata->colorStops(&colors);
+    if (cnt == 0 || !colors) return nullptr;
+
+    auto hash = _hash(colors, cnt, opacity, surface->cs, size);
+    auto bucket = &_colorTables[hash % COLOR_TABLE_BUCKETS];
+
+    ScopedLock lock(_colorTableKey);
+
+    for (auto table = bucket->head; table; table = table->next) {
+        if (table->hash != hash || table->size != size || table->cnt != cnt || table->opacity != opacity || table->cs != surface->cs) continue;
+        if (memcmp(table->stops, colors, sizeof(Fill::ColorStop) * cnt)) continue;
+        ++table->refCnt;
+        return table;
+    }
+
+    auto table = static_cast<SwColorTable*>(calloc(1, sizeof(SwColorTable)));
+    if (!table) return nullptr;
+
+    table->colors = static_cast<uint32_t*>(malloc(size * sizeof(uint32_t)));
+    table->stops = static_cast<Fill::ColorStop*>(malloc(cnt * sizeof(Fill::ColorStop)));
+    if (!table->colors || !table->stops) {
+        free(table->colors);
+        free(table->stops);
+        free(table);
+        return nullptr;
+    }
+    memcpy(table->stops, colors, cnt * sizeof(Fill::ColorStop));
+    table->cnt = cnt;
+    table->size = size;
+    table->hash = hash;
+    table->opacity = opacity;
+    table->cs = surface->cs;
+    table->refCnt = 1;
+
+    _genColorTable(table, surface);
+
+    bucket->back(table);
+
+    return table;
+}
+
+
+//The table doesn't need to be finer than the pixels the gradient spans.
+static uint32_t _colorTableSize(const SwFill* fill, const Fill* fdata)
+{
+    //the repeated positions are mapped by the period of size / (size - 1) in the table,
+    //its error is accumulated per a period thus the smaller table shifts the colors notably.
+    if (fill->spread != FillSpread::Pad) return GRADIENT_STOP_SIZE;
+
+    float extent = GRADIENT_STOP_SIZE;
+
+    if (fdata->identifier() == TVG_CLASS_ID_LINEAR) {
+        auto len = fill->linear.dx * fill->linear.dx + fill->linear.dy * fill->linear.dy;
+        if (len > FLT_EPSILON) extent = 1.0f / sqrtf(len);
+    } else {
+        auto det = fabsf(fill->radial.a11 * fill->radial.a22 - fill->radial.a12 * fill->radial.a21);
+        if (det > FLT_EPSILON) extent = fill->radial.dr / sqrtf(det);
+    }
+
+    //twice of the extent to not lose the precision of the color stop positions
+    uint32_t size = GRADIENT_STOP_MIN_SIZE;
+    while (size < GRADIENT_STOP_SIZE && static_cast<float>(size) < extent * 2.0f) size <<= 1;
+    return size;
+}
+
+
+static bool _updateColorTable(SwFill* fill, const Fill* fdata, const SwSurface* surface, uint8_t opacity, uint32_t size)
+{
+    //acquire first, the table could be shared with the previous one
+    auto table = _acquireColorTable(fdata, surface, opacity, size);
+    if (!table) return false;
+
+    _releaseColorTable(fill->ctable);
+    fill->ctable = table;
+    fill->translucent = table->translucent;
 
     return true;
 }
@@ -241,535 +329,40 @@ bool _prepareRadial(SwFill* fill, const RadialGradient* radial, const Matrix* tr
 }
 
 
-static inline uint32_t _clamp(const SwFill* fill, int32_t pos)
-{
-    switch (fill->spread) {
-        case FillSpread::Pad: {
-            if (pos >= GRADIENT_STOP_SIZE) pos = GRADIENT_STOP_SIZE - 1;
-            else if (pos < 0) pos = 0;
-            break;
-        }
-        case FillSpread::Repeat: {
-            pos = pos % GRADIENT_STOP_SIZE;
-            if (pos < 0) pos = GRADIENT_STOP_SIZE + pos;
-            break;
-        }
-        case FillSpread::Reflect: {
-            auto limit = GRADIENT_STOP_SIZE * 2;
-            pos = pos % limit;
-            if (pos < 0) pos = limit + pos;
-            if (pos >= GRADIENT_STOP_SIZE) pos = (limit - pos - 1);
-            break;
-        }
-    }
-    return pos;
-}
-
-
-static inline uint32_t _fixedPixel(const SwFill* fill, int32_t pos)
-{
-    int32_t i = (pos + (FIXPT_SIZE / 2)) >> FIXPT_BITS;
-    return fill->ctable[_clamp(fill, i)];
-}
-
-
-static inline uint32_t _pixel(const SwFill* fill, float pos)
-{
-    auto i = static_cast<int32_t>(pos * (GRADIENT_STOP_SIZE - 1) + 0.5f);
-    return fill->ctable[_clamp(fill, i)];
-}
-
-
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
 
-
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
-{
-    //edge case
-    if (fill->radial.a < RADIAL_A_THRESHOLD) {
-        auto radial = &fill->radial;
-        auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-        auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
-
-        if (opacity == 255) {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
-                auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-                *dst = opBlendNormal(_pixel(fill, x0), *dst, alpha(cmp));
-                rx += radial->a11;
-                ry += radial->a21;
-            }
-        } else {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
-                auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-                *dst = opBlendNormal(_pixel(fill, x0), *dst, MULTIPLY(opacity, alpha(cmp)));
-                rx += radial->a11;
-                ry += radial->a21;
-            }
-        }
-    } else {
-        float b, deltaB, det, deltaDet, deltaDeltaDet;
-        _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
-
-        if (opacity == 255) {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
-                *dst = opBlendNormal(_pixel(fill, sqrtf(det) - b), *dst, alpha(cmp));
-                det += deltaDet;
-                deltaDet += deltaDeltaDet;
-                b += deltaB;
-            }
-        } else {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
-                *dst = opBlendNormal(_pixel(fill, sqrtf(det) - b), *dst, MULTIPLY(opacity, alpha(cmp)));
-                det += deltaDet;
-                deltaDet += deltaDeltaDet;
-                b += deltaB;
-            }
-        }
-    }
-}
-
-
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
-{
-    if (fill->radial.a < RADIAL_A_THRESHOLD) {
-        auto radial = &fill->radial;
-        auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-        auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
-        for (uint32_t i = 0; i < len; ++i, ++dst) {
-            auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-            *dst = op(_pixel(fill, x0), *dst, a);
-            rx += radial->a11;
-            ry += radial->a21;
-        }
-    } else {
-        float b, deltaB, det, deltaDet, deltaDeltaDet;
-        _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
-
-        for (uint32_t i = 0; i < len; ++i, ++dst) {
-            *dst = op(_pixel(fill, sqrtf(det) - b), *dst, a);
-            det += deltaDet;
-            deltaDet += deltaDeltaDet;
-            b += deltaB;
-        }
-    }
-}
-
-
-void fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask maskOp, uint8_t a)
-{
-    if (fill->radial.a < RADIAL_A_THRESHOLD) {
-        auto radial = &fill->radial;
-        auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-        auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
-        for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
-            auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-            auto src = MULTIPLY(a, A(_pixel(fill, x0)));
-            *dst = maskOp(src, *dst, ~src);
-            rx += radial->a11;
-            ry += radial->a21;
-        }
-    } else {
-        float b, deltaB, det, deltaDet, deltaDeltaDet;
-        _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
-
-        for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
-            auto src = MULTIPLY(a, A(_pixel(fill, sqrtf(det) - b)));
-            *dst = maskOp(src, *dst, ~src);
-            det += deltaDet;
-            deltaDet += deltaDeltaDet;
-            b += deltaB;
-        }
-    }
-}
-
-
-void fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask maskOp, uint8_t a)
-{
-    if (fill->radial.a < RADIAL_A_THRESHOLD) {
-        auto radial = &fill->radial;
-        auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-        auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
-        for (uint32_t i = 0 ; i < len ; ++i, ++dst, ++cmp) {
-            auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-            auto src = MULTIPLY(A(A(_pixel(fill, x0))), a);
-            auto tmp = maskOp(src, *cmp, 0);
-            *dst = tmp + MULTIPLY(*dst, ~tmp);
-            rx += radial->a11;
-            ry += radial->a21;
-        }
-    } else {
-        float b, deltaB, det, deltaDet, deltaDeltaDet;
-        _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
-
-        for (uint32_t i = 0 ; i < len ; ++i, ++dst, ++cmp) {
-            auto src = MULTIPLY(A(_pixel(fill, sqrtf(det))), a);
-            auto tmp = maskOp(src, *cmp, 0);
-            *dst = tmp + MULTIPLY(*dst, ~tmp);
-            deltaDet += deltaDeltaDet;
-            b += deltaB;
-        }
-    }
-}
-
-
-void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
-{
-    if (fill->radial.a < RADIAL_A_THRESHOLD) {
-        auto radial = &fill->radial;
-        auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
-        auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
-
-        if (a == 255) {
-            for (uint32_t i = 0; i < len; ++i, ++dst) {
-                auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-                auto tmp = op(_pixel(fill, x0), *dst, 255);
-                *dst = op2(tmp, *dst, 255);
-                rx += radial->a11;
-                ry += radial->a21;
-            }
-        } else {
-            for (uint32_t i = 0; i < len; ++i, ++dst) {
-                auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
-                auto tmp = op(_pixel(fill, x0), *dst, 255);
-                auto tmp2 = op2(tmp, *dst, 255);
-                *dst = INTERPOLATE(tmp2, *dst, a);
-                rx += radial->a11;
-                ry += radial->a21;
-            }
-        }
-    } else {
-        float b, deltaB, det, deltaDet, deltaDeltaDet;
-        _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
-        if (a == 255) {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
-                auto tmp = op(_pixel(fill, sqrtf(det) - b), *dst, 255);
-                *dst = op2(tmp, *dst, 255);
-                det += deltaDet;
-                deltaDet += deltaDeltaDet;
-                b += deltaB;
-            }
-        } else {
-            for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
-                auto tmp = op(_pixel(fill, sqrtf(det) - b), *dst, 255);
-                auto tmp2 = op2(tmp, *dst, 255);
-                *dst = INTERPOLATE(tmp2, *dst, a);
-                det += deltaDet;
-                deltaDet += deltaDeltaDet;
-                b += deltaB;
-            }
-        }
-    }
-}
-
-
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
-{
-    //Rotation
-    float rx = x + 0.5f;
-    float ry = y + 0.5f;
-    float t = (fill->linear.dx * rx + fill->linear.dy * ry + fill->linear.offset) * (GRADIENT_STOP_SIZE - 1);
-    float inc = (fill->linear.dx) * (GRADIENT_STOP_SIZE - 1);
-
-    if (opacity == 255) {
-        if (mathZero(inc)) {
-            auto color = _fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE));
-            for (uint32_t i = 0; i < len; ++i, ++dst, cmp += csize) {
-                *dst = opBlendNormal(color, *dst, alpha(cmp));
-            }
-            return;
-        }
-
-        auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-        auto vMin = -vMax;
-        auto v = t + (inc * len);
-
-        //we can use fixed point math
-        if (v < vMax && v > vMin) {
-            auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-            auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-            for (uint32_t j = 0; j < len; ++j, ++dst, cmp += csize) {
-                *dst = opBlendNormal(_fixedPixel(fill, t2), *dst, alpha(cmp));
-                t2 += inc2;
-            }
-        //we have to fallback to float math
-        } else {
-            uint32_t counter = 0;
-            while (counter++ < len) {
-                *dst = opBlendNormal(_pixel(fill, t / GRADIENT_STOP_SIZE), *dst, alpha(cmp));
-                ++dst;
-                t += inc;
-                cmp += csize;
-            }
-        }
-    } else {
-        if (mathZero(inc)) {
-            auto color = _fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE));
-            for (uint32_t i = 0; i < len; ++i, ++dst, cmp += csize) {
-                *dst = opBlendNormal(color, *dst, MULTIPLY(alpha(cmp), opacity));
-            }
-            return;
-        }
-
-        auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-        auto vMin = -vMax;
-        auto v = t + (inc * len);
-
-        //we can use fixed point math
-        if (v < vMax && v > vMin) {
-            auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-            auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-            for (uint32_t j = 0; j < len; ++j, ++dst, cmp += csize) {
-                *dst = opBlendNormal(_fixedPixel(fill, t2), *dst, MULTIPLY(alpha(cmp), opacity));
-                t2 += inc2;
-            }
-        //we have to fallback to float math
-        } else {
-            uint32_t counter = 0;
-            while (counter++ < len) {
-                *dst = opBlendNormal(_pixel(fill, t / GRADIENT_STOP_SIZE), *dst, MULTIPLY(opacity, alpha(cmp)));
-                ++dst;
-                t += inc;
-                cmp += csize;
-            }
-        }
-    }
-}
-
-
-void fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask maskOp, uint8_t a)
-{
-    //Rotation
-    float rx = x + 0.5f;
-    float ry = y + 0.5f;
-    float t = (fill->linear.dx * rx + fill->linear.dy * ry + fill->linear.offset) * (GRADIENT_STOP_SIZE - 1);
-    float inc = (fill->linear.dx) * (GRADIENT_STOP_SIZE - 1);
-
-    if (mathZero(inc)) {
-        auto src = MULTIPLY(a, A(_fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE))));
-        for (uint32_t i = 0; i < len; ++i, ++dst) {
-            *dst = maskOp(src, *dst, ~src);
-        }
-        return;
-    }
-
-    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-    auto vMin = -vMax;
-    auto v = t + (inc * len);
-
-    //we can use fixed point math
-    if (v < vMax && v > vMin) {
-        auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-        auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-        for (uint32_t j = 0; j < len; ++j, ++dst) {
-            auto src = MULTIPLY(_fixedPixel(fill, t2), a);
-            *dst = maskOp(src, *dst, ~src);
-            t2 += inc2;
-        }
-    //we have to fallback to float math
-    } else {
-        uint32_t counter = 0;
-        while (counter++ < len) {
-            auto src = MULTIPLY(_pixel(fill, t / GRADIENT_STOP_SIZE), a);
-            *dst = maskOp(src, *dst, ~src);
-            ++dst;
-            t += inc;
-        }
-    }
-}
-
-
-void fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask maskOp, uint8_t a)
-{
-    //Rotation
-    float rx = x + 0.5f;
-    float ry = y + 0.5f;
-    float t = (fill->linear.dx * rx + fill->linear.dy * ry + fill->linear.offset) * (GRADIENT_STOP_SIZE - 1);
-    float inc = (fill->linear.dx) * (GRADIENT_STOP_SIZE - 1);
-
-    if (mathZero(inc)) {
-        auto src = A(_fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE)));
-        src = MULTIPLY(src, a);
-        for (uint32_t i = 0; i < len; ++i, ++dst, ++cmp) {
-            auto tmp = maskOp(src, *cmp, 0);
-            *dst = tmp + MULTIPLY(*dst, ~tmp);
-        }
-        return;
-    }
-
-    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-    auto vMin = -vMax;
-    auto v = t + (inc * len);
-
-    //we can use fixed point math
-    if (v < vMax && v > vMin) {
-        auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-        auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-        for (uint32_t j = 0; j < len; ++j, ++dst, ++cmp) {
-            auto src = MULTIPLY(a, A(_fixedPixel(fill, t2)));
-            auto tmp = maskOp(src, *cmp, 0);
-            *dst = tmp + MULTIPLY(*dst, ~tmp);
-            t2 += inc2;
-        }
-    //we have to fallback to float math
-    } else {
-        uint32_t counter = 0;
-        while (counter++ < len) {
-            auto src = MULTIPLY(A(_pixel(fill, t / GRADIENT_STOP_SIZE)), a);
-            auto tmp = maskOp(src, *cmp, 0);
-            *dst = tmp + MULTIPLY(*dst, ~tmp);
-            ++dst;
-            ++cmp;
-            t += inc;
-        }
-    }
-}
-
-
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
-{
-    //Rotation
-    float rx = x + 0.5f;
-    float ry = y + 0.5f;
-    float t = (fill->linear.dx * rx + fill->linear.dy * ry + fill->linear.offset) * (GRADIENT_STOP_SIZE - 1);
-    float inc = (fill->linear.dx) * (GRADIENT_STOP_SIZE - 1);
-
-    if (mathZero(inc)) {
-        auto color = _fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE));
-        for (uint32_t i = 0; i < len; ++i, ++dst) {
-            *dst = op(color, *dst, a);
-        }
-        return;
-    }
-
-    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-    auto vMin = -vMax;
-    auto v = t + (inc * len);
-
-    //we can use fixed point math
-    if (v < vMax && v > vMin) {
-        auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-        auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-        for (uint32_t j = 0; j < len; ++j, ++dst) {
-            *dst = op(_fixedPixel(fill, t2), *dst, a);
-            t2 += inc2;
-        }
-    //we have to fallback to float math
-    } else {
-        uint32_t counter = 0;
-        while (counter++ < len) {
-            *dst = op(_pixel(fill, t / GRADIENT_STOP_SIZE), *dst, a);
-            ++dst;
-            t += inc;
-        }
-    }
-}
-
-
-void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
-{
-    //Rotation
-    float rx = x + 0.5f;
-    float ry = y + 0.5f;
-    float t = (fill->linear.dx * rx + fill->linear.dy * ry + fill->linear.offset) * (GRADIENT_STOP_SIZE - 1);
-    float inc = (fill->linear.dx) * (GRADIENT_STOP_SIZE - 1);
-
-    if (mathZero(inc)) {
-        auto color = _fixedPixel(fill, static_cast<int32_t>(t * FIXPT_SIZE));
-        if (a == 255) {
-            for (uint32_t i = 0; i < len; ++i, ++dst) {
-                auto tmp = op(color, *dst, a);
-                *dst = op2(tmp, *dst, 255);
-            }
-        } else {
-            for (uint32_t i = 0; i < len; ++i, ++dst) {
-                auto tmp = op(color, *dst, a);
-                auto tmp2 = op2(tmp, *dst, 255);
-                *dst = INTERPOLATE(tmp2, *dst, a);
-            }
-        }
-        return;
-    }
-
-    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
-    auto vMin = -vMax;
-    auto v = t + (inc * len);
-
-    if (a == 255) {
-        //we can use fixed point math
-        if (v < vMax && v > vMin) {
-            auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-            auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-            for (uint32_t j = 0; j < len; ++j, ++dst) {
-                auto tmp = op(_fixedPixel(fill, t2), *dst, 255);
-                *dst = op2(tmp, *dst, 255);
-                t2 += inc2;
-            }
-        //we have to fallback to float math
-        } else {
-            uint32_t counter = 0;
-            while (counter++ < len) {
-                auto tmp = op(_pixel(fill, t / GRADIENT_STOP_SIZE), *dst, 255);
-                *dst = op2(tmp, *dst, 255);
-                ++dst;
-                t += inc;
-            }
-        }
-    } else {
-        //we can use fixed point math
-        if (v < vMax && v > vMin) {
-            auto t2 = static_cast<int32_t>(t * FIXPT_SIZE);
-            auto inc2 = static_cast<int32_t>(inc * FIXPT_SIZE);
-            for (uint32_t j = 0; j < len; ++j, ++dst) {
-                auto tmp = op(_fixedPixel(fill, t2), *dst, 255);
-                auto tmp2 = op2(tmp, *dst, 255);
-                *dst = INTERPOLATE(tmp2, *dst, a);
-                t2 += inc2;
-            }
-        //we have to fallback to float math
-        } else {
-            uint32_t counter = 0;
-            while (counter++ < len) {
-                auto tmp = op(_pixel(fill, t / GRADIENT_STOP_SIZE), *dst, 255);
-                auto tmp2 = op2(tmp, *dst, 255);
-                *dst = INTERPOLATE(tmp2, *dst, a);
-                ++dst;
-                t += inc;
-            }
-        }
-    }
-}
-
-
 bool fillGenColorTable(SwFill* fill, const Fill* fdata, const Matrix* transform, SwSurface* surface, uint8_t opacity, bool ctable)
 {
     if (!fill) return false;
 
     fill->spread = fdata->spread();
 
-    if (ctable) {
-        if (!_updateColorTable(fill, fdata, surface, opacity)) return false;
-    }
-
+    bool ret;
     if (fdata->identifier() == TVG_CLASS_ID_LINEAR) {
-        return _prepareLinear(fill, static_cast<const LinearGradient*>(fdata), transform);
+        ret = _prepareLinear(fill, static_cast<const LinearGradient*>(fdata), transform);
     } else if (fdata->identifier() == TVG_CLASS_ID_RADIAL) {
-        return _prepareRadial(fill, static_cast<const RadialGradient*>(fdata), transform);
+        ret = _prepareRadial(fill, static_cast<const RadialGradient*>(fdata), transform);
+    } else {
+        //LOG: What type of gradient?!
+        return false;
     }
+    if (!ret) return false;
 
-    //LOG: What type of gradient?!
+    //the transformation could have changed the proper resolution of the table
+    auto size = _colorTableSize(fill, fdata);
+    if (ctable || !fill->ctable || fill->ctable->size != size) {
+        if (!_updateColorTable(fill, fdata, surface, opacity, size)) return false;
+    }
 
-    return false;
+    return true;
 }
 
 
 void fillReset(SwFill* fill)
 {
-    if (fill->ctable) {
-        free(fill->ctable);
-        fill->ctable = nullptr;
-    }
+    //keep the table until the next one is generated, it's likely the same.
     fill->translucent = false;
 }
 
@@ -778,7 +371,7 @@ void fillFree(SwFill* fill)
 {
     if (!fill) return;
 
-    if (fill->ctable) free(fill->ctable);
+    _releaseColorTable(fill->ctable);
 
     free(fill);
 }
@@ -104,6 +104,38 @@ static bool _genOutline(SwImage* image, const RenderMesh* mesh, const Matrix* tr
 }
 
 
+//The mipmap level which is downscaled by less than half when the image is drawn with the scale factor.
+static uint32_t _mipmapLevel(float scale)
+{
+    if (scale >= 0.5f || scale <= 0.0f) return 0;
+    auto level = static_cast<uint32_t>(log2f(1.0f / scale));
+    return (level > SW_MIPMAP_LEVELS) ? SW_MIPMAP_LEVELS : level;
+}
+
+
+//2x2 box filter, the last odd column and row are repeated.
+static uint32_t* _downscale(const uint32_t* src, uint32_t sw, uint32_t sh, uint32_t stride, uint32_t w, uint32_t h)
+{
+    auto dst = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * w * h));
+    if (!dst) return nullptr;
+
+    auto p = dst;
+    for (uint32_t y = 0; y < h; ++y) {
+        auto row1 = src + (y * 2) * stride;
+        auto row2 = (y * 2 + 1 < sh) ? row1 + stride : row1;
+        for (uint32_t x = 0; x < w; ++x, ++p) {
+            auto x1 = x * 2;
+            auto x2 = (x1 + 1 < sw) ? x1 + 1 : x1;
+            auto c1 = row1[x1], c2 = row1[x2], c3 = row2[x1], c4 = row2[x2];
+            auto rb = (c1 & 0x00ff00ff) + (c2 & 0x00ff00ff) + (c3 & 0x00ff00ff) + (c4 & 0x00ff00ff) + 0x00020002;
+            auto ag = ((c1 >> 8) & 0x00ff00ff) + ((c2 >> 8) & 0x00ff00ff) + ((c3 >> 8) & 0x00ff00ff) + ((c4 >> 8) & 0x00ff00ff) + 0x00020002;
+            *p = ((rb >> 2) & 0x00ff00ff) | (((ag >> 2) & 0x00ff00ff) << 8);
+        }
+    }
+    return dst;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -120,7 +152,9 @@ bool imagePrepare(SwImage* image, const RenderMesh* mesh, const Matrix* transfor
     } else {
         auto scaleX = sqrtf((transform->e11 * transform->e11) + (transform->e21 * transform->e21));
         auto scaleY = sqrtf((transform->e22 * transform->e22) + (transform->e12 * transform->e12));
-        image->scale = (fabsf(scaleX - scaleY) > 0.01f) ? 1.0f : scaleX;
+        //The mesh is only sampled by the mipmap levels, which are chosen by the least scale factor.
+        if (mesh->triangleCnt > 0) image->scale = mathMin(scaleX, scaleY);
+        else image->scale = (fabsf(scaleX - scaleY) > 0.01f) ? 1.0f : scaleX;
 
         if (mathZero(transform->e12) && mathZero(transform->e21)) image->scaled = true;
         else image->scaled = false;
@@ -131,9 +165,9 @@ bool imagePrepare(SwImage* image, const RenderMesh* mesh, const Matrix* transfor
 }
 
 
-bool imageGenRle(SwImage* image, const SwBBox& renderRegion, bool antiAlias)
+bool imageGenRle(SwImage* image, const SwBBox& renderRegion, bool antiAlias, SwMpool* mpool, unsigned tid)
 {
-    if ((image->rle = rleRender(image->rle, image->outline, renderRegion, antiAlias))) return true;
+    if ((image->rle = rleRender(image->rle, image->outline, renderRegion, antiAlias, mpool, tid))) return true;
 
     return false;
 }
@@ -155,4 +189,162 @@ void imageReset(SwImage* image)
 void imageFree(SwImage* image)
 {
     rleFree(image->rle);
+    imageFreeMipmap(image);
+    imageFreePixels(image);
+}
+
+
+/* The image source could be shared by the other pictures, it must never be modified here.
+   Its converted copies are shared as well, the first user converts it while the others wait. */
+bool imageLoad(SwImage* image, Surface* source, ColorSpace cs)
+{
+    image->channelSize = source->channelSize;
+
+    //The source is ready to blit
+    if (!rasterConvertible(source, cs)) {
+        imageFreePixels(image);
+        image->data = source->data;
+        image->w = source->w;
+        image->h = source->h;
+        image->stride = source->stride;
+        return true;
+    }
+
+    auto pixels = image->pixels;
+
+    //Acquired already
+    if (!pixels || pixels->cs != cs) {
+        imageFreePixels(image);
+        //The mipmap levels are generated from the converted pixels
+        imageFreeMipmap(image);
+
+        ScopedLock lock(source->key);
+
+        for (pixels = source->copies; pixels; pixels = pixels->next) {
+            if (pixels->cs == cs) break;
+        }
+
+        if (pixels) {
+            pixels->ref();
+        } else {
+            pixels = new SurfaceCopy;
+            pixels->data = static_cast<uint32_t*>(malloc(sizeof(uint32_t) * source->w * source->h));
+            if (!pixels->data || !rasterConvertCS(source, pixels->data, cs)) {
+                pixels->unref();
+                return false;
+            }
+            pixels->w = source->w;
+            pixels->h = source->h;
+            pixels->cs = cs;
+            //one for the source, one for this image
+            pixels->ref();
+            pixels->next = source->copies;
+            source->copies = pixels;
+        }
+        image->pixels = pixels;
+    }
+
+    image->buf32 = pixels->data;
+    image->w = image->stride = pixels->w;
+    image->h = pixels->h;
+    return true;
+}
+
+
+void imageFreePixels(SwImage* image)
+{
+    if (!image->pixels) return;
+    image->pixels->unref();
+    image->pixels = nullptr;
+}
+
+
+//Generates the mipmap levels lazily, as many as the current scale factor requires.
+bool imageGenMipmap(SwImage* image, ColorSpace cs)
+{
+    auto level = _mipmapLevel(image->scale);
+    if (image->direct || level == 0 || image->channelSize != sizeof(uint32_t)) return true;
+
+    auto mipmap = image->mipmap;
+
+    //The source has been changed
+    if (mipmap && (mipmap->source != image->data || mipmap->cs != cs)) {
+        imageFreeMipmap(image);
+        mipmap = nullptr;
+    }
+
+    if (!mipmap) {
+        mipmap = static_cast<SwMipmap*>(calloc(1, sizeof(SwMipmap)));
+        if (!mipmap) return false;
+        mipmap->source = image->data;
+        mipmap->cs = cs;
+        image->mipmap = mipmap;
+    }
+
+    while (mipmap->cnt < level) {
+        auto src = image->buf32;
+        auto sw = image->w;
+        auto sh = image->h;
+        auto stride = image->stride;
+        if (mipmap->cnt > 0) {
+            src = mipmap->data[mipmap->cnt - 1];
+            sw = stride = mipmap->w[mipmap->cnt - 1];
+            sh = mipmap->h[mipmap->cnt - 1];
+        }
+        //No more levels
+        if (sw == 1 && sh == 1) break;
+
+        auto w = (sw + 1) / 2;
+        auto h = (sh + 1) / 2;
+        auto data = _downscale(src, sw, sh, stride, w, h);
+        if (!data) return false;
+
+        mipmap->data[mipmap->cnt] = data;
+        mipmap->w[mipmap->cnt] = w;
+        mipmap->h[mipmap->cnt] = h;
+        ++mipmap->cnt;
+    }
+    return true;
+}
+
+
+/* Retrieves the mipmap level to be sampled instead of the image.
+   The level transform maps the level coordinates to the target as the transform does the image ones. */
+bool imageMipmap(const SwImage* image, const Matrix* transform, SwImage* level, Matrix* levelTransform)
+{
+    if (!image->mipmap || image->direct || !transform) return false;
+
+    auto idx = _mipmapLevel(image->scale);
+    if (idx > image->mipmap->cnt) idx = image->mipmap->cnt;
+    if (idx == 0) return false;
+    --idx;
+
+    *level = *image;
+    level->buf32 = image->mipmap->data[idx];
+    level->w = level->stride = image->mipmap->w[idx];
+    level->h = image->mipmap->h[idx];
+    level->mipmap = nullptr;
+
+    auto sx = static_cast<float>(image->w) / static_cast<float>(level->w);
+    auto sy = static_cast<float>(image->h) / static_cast<float>(level->h);
+    level->scale = image->scale * sx;
+
+    *levelTransform = *transform;
+    levelTransform->e11 *= sx;
+    levelTransform->e21 *= sx;
+    levelTransform->e12 *= sy;
+    levelTransform->e22 *= sy;
+
+    return true;
+}
+
+
+void imageFreeMipmap(SwImage* image)
+{
+    if (!image->mipmap) return;
+    for (uint32_t i = 0; i < image->mipmap->cnt; ++i) {
+        free(image->mipmap->data[i]);
+    }
+    free(image->mipmap);
+    image->mipmap = nullptr;
 }
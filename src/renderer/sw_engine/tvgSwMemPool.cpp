@@ -27,6 +27,17 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
+#define ARENA_MIN_SIZE 65536
+#define ARENA_ALIGN 16
+
+static void _freeRetired(SwArena* arena)
+{
+    for (auto block = arena->retired.begin(); block < arena->retired.end(); ++block) {
+        free(*block);
+    }
+    arena->retired.clear();
+}
+
 
 /************************************************************************/
 /* External Class Implementation                                        */
@@ -77,6 +88,58 @@ void mpoolRetDashOutline(SwMpool* mpool, unsigned idx)
 }
 
 
+/* The transient buffers of a task are bumped in the arena of its thread, no malloc() is involved
+   once the arena is grown enough. A block is never reallocated since the earlier requests could
+   still use it, the outgrown block is retired instead and a bigger one takes over. */
+void* mpoolReqArena(SwMpool* mpool, unsigned idx, uint32_t size)
+{
+    auto arena = &mpool->arena[idx];
+
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    if (size == 0) size = ARENA_ALIGN;
+
+    if (arena->used + size > arena->size) {
+        auto blockSize = arena->size * 2;
+        if (blockSize < ARENA_MIN_SIZE) blockSize = ARENA_MIN_SIZE;
+        if (blockSize < size) blockSize = size;
+
+        auto block = static_cast<uint8_t*>(malloc(blockSize));
+        if (!block) return nullptr;
+
+        if (arena->live > 0) arena->retired.push(arena->data);
+        else free(arena->data);
+
+        arena->data = block;
+        arena->size = blockSize;
+        arena->used = 0;
+    }
+
+    auto ptr = arena->data + arena->used;
+    arena->used += size;
+    ++arena->live;
+
+    return ptr;
+}
+
+
+//Returns the buffer, the later requests must be returned already.
+void mpoolRetArena(SwMpool* mpool, unsigned idx, void* ptr)
+{
+    auto arena = &mpool->arena[idx];
+
+    if (arena->live == 0) return;
+
+    auto p = static_cast<uint8_t*>(ptr);
+    if (p >= arena->data && p < arena->data + arena->size) arena->used = p - arena->data;
+    else arena->used = 0;   //it's in a retired block, the current block has no live requests.
+
+    if (--arena->live == 0) {
+        arena->used = 0;
+        _freeRetired(arena);
+    }
+}
+
+
 SwMpool* mpoolInit(uint32_t threads)
 {
     auto allocSize = threads + 1;
@@ -85,6 +148,7 @@ SwMpool* mpoolInit(uint32_t threads)
     mpool->outline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline) * allocSize));
     mpool->strokeOutline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline) * allocSize));
     mpool->dashOutline = static_cast<SwOutline*>(calloc(1, sizeof(SwOutline) * allocSize));
+    mpool->arena = static_cast<SwArena*>(calloc(1, sizeof(SwArena) * allocSize));
     mpool->allocSize = allocSize;
 
     return mpool;
@@ -108,6 +172,11 @@ bool mpoolClear(SwMpool* mpool)
         mpool->dashOutline[i].cntrs.reset();
         mpool->dashOutline[i].types.reset();
         mpool->dashOutline[i].closed.reset();
+
+        //the arena is rewound wholesale, its block is kept for the next frame.
+        _freeRetired(&mpool->arena[i]);
+        mpool->arena[i].used = 0;
+        mpool->arena[i].live = 0;
     }
 
     return true;
@@ -120,6 +189,12 @@ bool mpoolTerm(SwMpool* mpool)
 
     mpoolClear(mpool);
 
+    for (unsigned i = 0; i < mpool->allocSize; ++i) {
+        free(mpool->arena[i].data);
+        mpool->arena[i].retired.reset();
+    }
+
+    free(mpool->arena);
     free(mpool->outline);
     free(mpool->strokeOutline);
     free(mpool->dashOutline);
@@ -28,71 +28,18 @@
     #include <stdlib.h>
 #endif
 
+#include <type_traits>
 #include "tvgMath.h"
 #include "tvgRender.h"
 #include "tvgSwCommon.h"
+#include "tvgTaskScheduler.h"
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
 /************************************************************************/
 constexpr auto DOWN_SCALE_TOLERANCE = 0.5f;
 
-struct FillLinear
-{
-    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask op, uint8_t a)
-    {
-        fillLinear(fill, dst, y, x, len, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask op, uint8_t a)
-    {
-        fillLinear(fill, dst, y, x, len, cmp, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
-    {
-        fillLinear(fill, dst, y, x, len, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
-    {
-        fillLinear(fill, dst, y, x, len, cmp, alpha, csize, opacity);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
-    {
-        fillLinear(fill, dst, y, x, len, op, op2, a);
-    }
-
-};
-
-struct FillRadial
-{
-    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask op, uint8_t a)
-    {
-        fillRadial(fill, dst, y, x, len, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask op, uint8_t a)
-    {
-        fillRadial(fill, dst, y, x, len, cmp, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
-    {
-        fillRadial(fill, dst, y, x, len, op, a);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
-    {
-        fillRadial(fill, dst, y, x, len, cmp, alpha, csize, opacity);
-    }
-
-    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
-    {
-        fillRadial(fill, dst, y, x, len, op, op2, a);
-    }
-};
+static SwSimd _simd = SwSimd::None;    //raster kernels in use, see rasterSimd()
 
 
 static inline uint8_t _alpha(uint8_t* a)
@@ -214,9 +161,70 @@ static inline SwMask _getMaskOp(CompositeMethod method)
 }
 
 
+/* The span kernels are instantiated per blending, matting and masking method so that the per pixel
+   operation is inlined into the loops instead of being called through the function pointer.
+   These choose the instance once per draw call, the kernel receives the operation as the type of its argument. */
+template<SwBlender op> using BlendOp = integral_constant<SwBlender, op>;
+template<SwMask op> using MaskingOp = integral_constant<SwMask, op>;
+
+
+template<typename Kernel>
+static bool _blendingKernel(const SwSurface* surface, Kernel kernel)
+{
+    switch (surface->blendMethod) {
+        case BlendMethod::Add: return kernel(BlendOp<opBlendAdd>());
+        case BlendMethod::Screen: return kernel(BlendOp<opBlendScreen>());
+        case BlendMethod::Multiply: return kernel(BlendOp<opBlendMultiply>());
+        case BlendMethod::Overlay: return kernel(BlendOp<opBlendOverlay>());
+        case BlendMethod::Difference: return kernel(BlendOp<opBlendDifference>());
+        case BlendMethod::Exclusion: return kernel(BlendOp<opBlendExclusion>());
+        case BlendMethod::SrcOver: return kernel(BlendOp<opBlendSrcOver>());
+        case BlendMethod::Darken: return kernel(BlendOp<opBlendDarken>());
+        case BlendMethod::Lighten: return kernel(BlendOp<opBlendLighten>());
+        case BlendMethod::ColorDodge: return kernel(BlendOp<opBlendColorDodge>());
+        case BlendMethod::ColorBurn: return kernel(BlendOp<opBlendColorBurn>());
+        case BlendMethod::HardLight: return kernel(BlendOp<opBlendHardLight>());
+        case BlendMethod::SoftLight: return kernel(BlendOp<opBlendSoftLight>());
+        default: {
+            TVGERR("SW_ENGINE", "Unsupported Blending(%d) is expected!", (int)surface->blendMethod);
+            return false;
+        }
+    }
+}
+
+
+template<typename Kernel>
+static bool _mattingKernel(SwSurface* surface, Kernel kernel)
+{
+    //See rasterCompositor()
+    auto alpha = surface->alpha(surface->compositor->method);
+    if (alpha == _alpha) return kernel(integral_constant<SwAlpha, _alpha>());
+    if (alpha == _ialpha) return kernel(integral_constant<SwAlpha, _ialpha>());
+    if (alpha == _abgrLuma) return kernel(integral_constant<SwAlpha, _abgrLuma>());
+    if (alpha == _abgrInvLuma) return kernel(integral_constant<SwAlpha, _abgrInvLuma>());
+    if (alpha == _argbLuma) return kernel(integral_constant<SwAlpha, _argbLuma>());
+    if (alpha == _argbInvLuma) return kernel(integral_constant<SwAlpha, _argbInvLuma>());
+    return false;
+}
+
+
+//the composite kernel for the add/difference, the direct one for the subtract/intersect (see _direct())
+template<typename CompositeKernel, typename DirectKernel>
+static bool _maskingKernel(const SwSurface* surface, CompositeKernel composite, DirectKernel direct)
+{
+    switch (surface->compositor->method) {
+        case CompositeMethod::AddMask: return composite(MaskingOp<_opMaskAdd>());
+        case CompositeMethod::DifferenceMask: return composite(MaskingOp<_opMaskDifference>());
+        case CompositeMethod::SubtractMask: return direct(MaskingOp<_opMaskSubtract>());
+        case CompositeMethod::IntersectMask: return direct(MaskingOp<_opMaskIntersect>());
+        default: return false;
+    }
+}
+
+
 static bool _compositeMaskImage(SwSurface* surface, const SwImage* image, const SwBBox& region)
 {
-    auto dbuffer = &surface->buf8[region.min.y * surface->stride + region.min.x];
+    auto dbuffer = surface->buf8At(region.min.x, region.min.y);
     auto sbuffer = image->buf8 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
 
     for (auto y = region.min.y; y < region.max.y; ++y) {
@@ -232,6 +240,7 @@ static bool _compositeMaskImage(SwSurface* surface, const SwImage* image, const
 }
 
 
+#include "tvgSwRasterFill.h"
 #include "tvgSwRasterTexmap.h"
 #include "tvgSwRasterC.h"
 #include "tvgSwRasterAvx.h"
@@ -311,12 +320,13 @@ static uint32_t _interpDownScaler(const uint32_t *img, uint32_t stride, uint32_t
 /* Rect                                                                 */
 /************************************************************************/
 
-static bool _rasterCompositeMaskedRect(SwSurface* surface, const SwBBox& region, SwMask maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename MaskOp>
+static bool _rasterCompositeMaskedRect(SwSurface* surface, const SwBBox& region, MaskOp maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x);   //compositor buffer
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);   //compositor buffer
     auto ialpha = 255 - a;
 
     for (uint32_t y = 0; y < h; ++y) {
@@ -330,12 +340,13 @@ static bool _rasterCompositeMaskedRect(SwSurface* surface, const SwBBox& region,
 }
 
 
-static bool _rasterDirectMaskedRect(SwSurface* surface, const SwBBox& region, SwMask maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename MaskOp>
+static bool _rasterDirectMaskedRect(SwSurface* surface, const SwBBox& region, MaskOp maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * surface->compositor->image.stride + region.min.x);   //compositor buffer
-    auto dbuffer = surface->buf8 + (region.min.y * surface->stride + region.min.x);   //destination buffer
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);   //compositor buffer
+    auto dbuffer = surface->buf8At(region.min.x, region.min.y);   //destination buffer
 
     for (uint32_t y = 0; y < h; ++y) {
         auto cmp = cbuffer;
@@ -358,27 +369,26 @@ static bool _rasterMaskedRect(SwSurface* surface, const SwBBox& region, uint8_t
 
     TVGLOG("SW_ENGINE", "Masked(%d) Rect [Region: %lu %lu %lu %lu]", (int)surface->compositor->method, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
 
-    auto maskOp = _getMaskOp(surface->compositor->method);
-    if (_direct(surface->compositor->method)) return _rasterDirectMaskedRect(surface, region, maskOp, r, g, b, a);
-    else return _rasterCompositeMaskedRect(surface, region, maskOp, r, g, b, a);
-    return false;
+    return _maskingKernel(surface,
+        [&](auto op) { return _rasterCompositeMaskedRect(surface, region, op, r, g, b, a); },
+        [&](auto op) { return _rasterDirectMaskedRect(surface, region, op, r, g, b, a); });
 }
 
 
-static bool _rasterMattedRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename Alpha>
+static bool _rasterMattedRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a, Alpha alpha)
 {
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto csize = surface->compositor->image.channelSize;
-    auto cbuffer = surface->compositor->image.buf8 + ((region.min.y * surface->compositor->image.stride + region.min.x) * csize);   //compositor buffer
-    auto alpha = surface->alpha(surface->compositor->method);
+    auto cbuffer = surface->compositor->image.pixelAt(region.min.x, region.min.y);   //compositor buffer
 
     TVGLOG("SW_ENGINE", "Matted(%d) Rect [Region: %lu %lu %u %u]", (int)surface->compositor->method, region.min.x, region.min.y, w, h);
     
     //32bits channels
     if (surface->channelSize == sizeof(uint32_t)) {
         auto color = surface->join(r, g, b, a);
-        auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf32At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = &buffer[y * surface->stride];
             auto cmp = &cbuffer[y * surface->compositor->image.stride * csize];
@@ -388,7 +398,7 @@ static bool _rasterMattedRect(SwSurface* surface, const SwBBox& region, uint8_t
         }
     //8bits grayscale
     } else if (surface->channelSize == sizeof(uint8_t)) {
-        auto buffer = surface->buf8 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf8At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = &buffer[y * surface->stride];
             auto cmp = &cbuffer[y * surface->compositor->image.stride * csize];
@@ -401,20 +411,21 @@ static bool _rasterMattedRect(SwSurface* surface, const SwBBox& region, uint8_t
 }
 
 
-static bool _rasterBlendingRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename Blender>
+static bool _rasterBlendingRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a, Blender blender)
 {
     if (surface->channelSize != sizeof(uint32_t)) return false;
 
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto color = surface->join(r, g, b, a);
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto ialpha = 255 - a;
 
     for (uint32_t y = 0; y < h; ++y) {
         auto dst = &buffer[y * surface->stride];
         for (uint32_t x = 0; x < w; ++x, ++dst) {
-            *dst = surface->blender(color, *dst, ialpha);
+            *dst = blender(color, *dst, ialpha);
         }
     }
     return true;
@@ -424,9 +435,12 @@ static bool _rasterBlendingRect(SwSurface* surface, const SwBBox& region, uint8_
 static bool _rasterTranslucentRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
 #if defined(THORVG_AVX_VECTOR_SUPPORT)
-    return avxRasterTranslucentRect(surface, region, r, g, b, a);
+    if (_simd == SwSimd::Avx2) return avxRasterTranslucentRect(surface, region, r, g, b, a);
+    if (_simd == SwSimd::Sse41) return sseRasterTranslucentRect(surface, region, r, g, b, a);
+    return cRasterTranslucentRect(surface, region, r, g, b, a);
 #elif defined(THORVG_NEON_VECTOR_SUPPORT)
-    return neonRasterTranslucentRect(surface, region, r, g, b, a);
+    if (_simd == SwSimd::Neon) return neonRasterTranslucentRect(surface, region, r, g, b, a);
+    return cRasterTranslucentRect(surface, region, r, g, b, a);
 #else
     return cRasterTranslucentRect(surface, region, r, g, b, a);
 #endif
@@ -441,16 +455,17 @@ static bool _rasterSolidRect(SwSurface* surface, const SwBBox& region, uint8_t r
     //32bits channels
     if (surface->channelSize == sizeof(uint32_t)) {
         auto color = surface->join(r, g, b, 255);
-        auto buffer = surface->buf32 + (region.min.y * surface->stride);
+        auto buffer = surface->buf32At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
-            rasterPixel32(buffer + y * surface->stride, color, region.min.x, w);
+            rasterPixel32(buffer + y * surface->stride, color, 0, w);
         }
         return true;
     }
     //8bits grayscale
     if (surface->channelSize == sizeof(uint8_t)) {
+        auto buffer = surface->buf8At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
-            rasterGrayscale8(surface->buf8, 255, (y + region.min.y) * surface->stride + region.min.x, w);
+            rasterGrayscale8(buffer, 255, y * surface->stride, w);
         }
         return true;
     }
@@ -461,10 +476,10 @@ static bool _rasterSolidRect(SwSurface* surface, const SwBBox& region, uint8_t r
 static bool _rasterRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterMattedRect(surface, region, r, g, b, a);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterMattedRect(surface, region, r, g, b, a, op); });
         else return _rasterMaskedRect(surface, region, r, g, b, a);
     } else if (_blending(surface)) {
-        return _rasterBlendingRect(surface, region, r, g, b, a);
+        return _blendingKernel(surface, [&](auto op) { return _rasterBlendingRect(surface, region, r, g, b, a, op); });
     } else {
         if (a == 255) return _rasterSolidRect(surface, region, r, g, b);
         else return _rasterTranslucentRect(surface, region, r, g, b, a);
@@ -477,15 +492,14 @@ static bool _rasterRect(SwSurface* surface, const SwBBox& region, uint8_t r, uin
 /* Rle                                                                  */
 /************************************************************************/
 
-static bool _rasterCompositeMaskedRle(SwSurface* surface, SwRleData* rle, SwMask maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename MaskOp>
+static bool _rasterCompositeMaskedRle(SwSurface* surface, SwRleData* rle, MaskOp maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
     auto span = rle->spans;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto cstride = surface->compositor->image.stride;
     uint8_t src;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto cmp = &cbuffer[span->y * cstride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
         if (span->coverage == 255) src = a;
         else src = MULTIPLY(a, span->coverage);
         auto ialpha = 255 - src;
@@ -497,16 +511,15 @@ static bool _rasterCompositeMaskedRle(SwSurface* surface, SwRleData* rle, SwMask
 }
 
 
-static bool _rasterDirectMaskedRle(SwSurface* surface, SwRleData* rle, SwMask maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename MaskOp>
+static bool _rasterDirectMaskedRle(SwSurface* surface, SwRleData* rle, MaskOp maskOp, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
     auto span = rle->spans;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto cstride = surface->compositor->image.stride;
     uint8_t src;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto cmp = &cbuffer[span->y * cstride + span->x];
-        auto dst = &surface->buf8[span->y * surface->stride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        auto dst = surface->buf8At(span->x, span->y);
         if (span->coverage == 255) src = a;
         else src = MULTIPLY(a, span->coverage);
         for (auto x = 0; x < span->len; ++x, ++cmp, ++dst) {
@@ -525,29 +538,34 @@ static bool _rasterMaskedRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint
     //8bit masking channels composition
     if (surface->channelSize != sizeof(uint8_t)) return false;
 
-    auto maskOp = _getMaskOp(surface->compositor->method);
-    if (_direct(surface->compositor->method)) return _rasterDirectMaskedRle(surface, rle, maskOp, r, g, b, a);
-    else return _rasterCompositeMaskedRle(surface, rle, maskOp, r, g, b, a);
-    return false;
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    if (_simd == SwSimd::Avx2) return avxRasterMaskedRle(surface, rle, _getMaskOp(surface->compositor->method), a);
+#endif
+    return _maskingKernel(surface,
+        [&](auto op) { return _rasterCompositeMaskedRle(surface, rle, op, r, g, b, a); },
+        [&](auto op) { return _rasterDirectMaskedRle(surface, rle, op, r, g, b, a); });
 }
 
 
-static bool _rasterMattedRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename Alpha>
+static bool _rasterMattedRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a, Alpha alpha)
 {
     TVGLOG("SW_ENGINE", "Matted(%d) Rle", (int)surface->compositor->method);
 
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    if (_simd == SwSimd::Avx2) return avxRasterMattedRle(surface, rle, r, g, b, a);
+#endif
+
     auto span = rle->spans;
-    auto cbuffer = surface->compositor->image.buf8;
     auto csize = surface->compositor->image.channelSize;
-    auto alpha = surface->alpha(surface->compositor->method);
 
     //32bit channels
     if (surface->channelSize == sizeof(uint32_t)) {
         uint32_t src;
         auto color = surface->join(r, g, b, a);
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf32[span->y * surface->stride + span->x];
-            auto cmp = &cbuffer[(span->y * surface->compositor->image.stride + span->x) * csize];
+            auto dst = surface->buf32At(span->x, span->y);
+            auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
             if (span->coverage == 255) src = color;
             else src = ALPHA_BLEND(color, span->coverage);
             for (uint32_t x = 0; x < span->len; ++x, ++dst, cmp += csize) {
@@ -561,8 +579,8 @@ static bool _rasterMattedRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint
     if (surface->channelSize == sizeof(uint8_t)) {
         uint8_t src;
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf8[span->y * surface->stride + span->x];
-            auto cmp = &cbuffer[(span->y * surface->compositor->image.stride + span->x) * csize];
+            auto dst = surface->buf8At(span->x, span->y);
+            auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
             if (span->coverage == 255) src = a;
             else src = MULTIPLY(a, span->coverage);
             for (uint32_t x = 0; x < span->len; ++x, ++dst, cmp += csize) {
@@ -575,23 +593,28 @@ static bool _rasterMattedRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint
 }
 
 
-static bool _rasterBlendingRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+template<typename Blender>
+static bool _rasterBlendingRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a, Blender blender)
 {
     if (surface->channelSize != sizeof(uint32_t)) return false;
 
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    if (_simd == SwSimd::Avx2) return avxRasterBlendingRle(surface, rle, r, g, b, a, blender);
+#endif
+
     auto span = rle->spans;
     auto color = surface->join(r, g, b, a);
     auto ialpha = 255 - a;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+        auto dst = surface->buf32At(span->x, span->y);
         if (span->coverage == 255) {
             for (uint32_t x = 0; x < span->len; ++x, ++dst) {
-                *dst = surface->blender(color, *dst, ialpha);
+                *dst = blender(color, *dst, ialpha);
             }
         } else {
             for (uint32_t x = 0; x < span->len; ++x, ++dst) {
-                auto tmp = surface->blender(color, *dst, ialpha);
+                auto tmp = blender(color, *dst, ialpha);
                 *dst = INTERPOLATE(tmp, *dst, span->coverage);
             }
         }
@@ -603,9 +626,12 @@ static bool _rasterBlendingRle(SwSurface* surface, const SwRleData* rle, uint8_t
 static bool _rasterTranslucentRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
 {
 #if defined(THORVG_AVX_VECTOR_SUPPORT)
-    return avxRasterTranslucentRle(surface, rle, r, g, b, a);
+    if (_simd == SwSimd::Avx2) return avxRasterTranslucentRle(surface, rle, r, g, b, a);
+    if (_simd == SwSimd::Sse41) return sseRasterTranslucentRle(surface, rle, r, g, b, a);
+    return cRasterTranslucentRle(surface, rle, r, g, b, a);
 #elif defined(THORVG_NEON_VECTOR_SUPPORT)
-    return neonRasterTranslucentRle(surface, rle, r, g, b, a);
+    if (_simd == SwSimd::Neon) return neonRasterTranslucentRle(surface, rle, r, g, b, a);
+    return cRasterTranslucentRle(surface, rle, r, g, b, a);
 #else
     return cRasterTranslucentRle(surface, rle, r, g, b, a);
 #endif
@@ -614,6 +640,10 @@ static bool _rasterTranslucentRle(SwSurface* surface, const SwRleData* rle, uint
 
 static bool _rasterSolidRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b)
 {
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    if (_simd == SwSimd::Avx2) return avxRasterSolidRle(surface, rle, r, g, b);
+#endif
+
     auto span = rle->spans;
 
     //32bit channels
@@ -621,9 +651,9 @@ static bool _rasterSolidRle(SwSurface* surface, const SwRleData* rle, uint8_t r,
         auto color = surface->join(r, g, b, 255);
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
             if (span->coverage == 255) {
-                rasterPixel32(surface->buf32 + span->y * surface->stride, color, span->x, span->len);
+                rasterPixel32(surface->buf32At(span->x, span->y), color, 0, span->len);
             } else {
-                auto dst = &surface->buf32[span->y * surface->stride + span->x];
+                auto dst = surface->buf32At(span->x, span->y);
                 auto src = ALPHA_BLEND(color, span->coverage);
                 auto ialpha = 255 - span->coverage;
                 for (uint32_t x = 0; x < span->len; ++x, ++dst) {
@@ -635,9 +665,9 @@ static bool _rasterSolidRle(SwSurface* surface, const SwRleData* rle, uint8_t r,
     } else if (surface->channelSize == sizeof(uint8_t)) {
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
             if (span->coverage == 255) {
-                rasterGrayscale8(surface->buf8, span->coverage, span->y * surface->stride + span->x, span->len);
+                rasterGrayscale8(surface->buf8At(span->x, span->y), span->coverage, 0, span->len);
             } else {
-                auto dst = &surface->buf8[span->y * surface->stride + span->x];
+                auto dst = surface->buf8At(span->x, span->y);
                 auto ialpha = 255 - span->coverage;
                 for (uint32_t x = 0; x < span->len; ++x, ++dst) {
                     *dst = span->coverage + MULTIPLY(*dst, ialpha);
@@ -654,10 +684,10 @@ static bool _rasterRle(SwSurface* surface, SwRleData* rle, uint8_t r, uint8_t g,
     if (!rle) return false;
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterMattedRle(surface, rle, r, g, b, a);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterMattedRle(surface, rle, r, g, b, a, op); });
         else return _rasterMaskedRle(surface, rle, r, g, b, a);
     } else if (_blending(surface)) {
-        return _rasterBlendingRle(surface, rle, r, g, b, a);
+        return _blendingKernel(surface, [&](auto op) { return _rasterBlendingRle(surface, rle, r, g, b, a, op); });
     } else {
         if (a == 255) return _rasterSolidRle(surface, rle, r, g, b);
         else return _rasterTranslucentRle(surface, rle, r, g, b, a);
@@ -696,7 +726,7 @@ static bool _rasterCompositeScaledMaskedRleImage(SwSurface* surface, const SwIma
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         SCALED_IMAGE_RANGE_Y(span->y)
-        auto cmp = &surface->compositor->image.buf8[span->y * surface->compositor->image.stride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
         auto a = MULTIPLY(span->coverage, opacity);
         for (uint32_t x = static_cast<uint32_t>(span->x); x < static_cast<uint32_t>(span->x) + span->len; ++x, ++cmp) {
             SCALED_IMAGE_RANGE_X
@@ -718,8 +748,8 @@ static bool _rasterDirectScaledMaskedRleImage(SwSurface* surface, const SwImage*
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {        
         SCALED_IMAGE_RANGE_Y(span->y)
-        auto cmp = &surface->compositor->image.buf8[span->y * surface->compositor->image.stride + span->x];
-        auto dst = &surface->buf8[span->y * surface->stride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        auto dst = surface->buf8At(span->x, span->y);
         auto a = MULTIPLY(span->coverage, opacity);
         for (uint32_t x = static_cast<uint32_t>(span->x); x < static_cast<uint32_t>(span->x) + span->len; ++x, ++cmp, ++dst) {
             SCALED_IMAGE_RANGE_X
@@ -749,21 +779,21 @@ static bool _rasterScaledMaskedRleImage(SwSurface* surface, const SwImage* image
 }
 
 
-static bool _rasterScaledMattedRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
+template<typename Alpha>
+static bool _rasterScaledMattedRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity, Alpha alpha)
 {
     TVGLOG("SW_ENGINE", "Scaled Matted(%d) Rle Image", (int)surface->compositor->method);
 
     auto span = image->rle->spans;
     auto csize = surface->compositor->image.channelSize;
-    auto alpha = surface->alpha(surface->compositor->method);
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         SCALED_IMAGE_RANGE_Y(span->y)
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
-        auto cmp = &surface->compositor->image.buf8[(span->y * surface->compositor->image.stride + span->x) * csize];
+        auto dst = surface->buf32At(span->x, span->y);
+        auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
         auto a = MULTIPLY(span->coverage, opacity);
         for (uint32_t x = static_cast<uint32_t>(span->x); x < static_cast<uint32_t>(span->x) + span->len; ++x, ++dst, cmp += csize) {
             SCALED_IMAGE_RANGE_X
@@ -777,7 +807,8 @@ static bool _rasterScaledMattedRleImage(SwSurface* surface, const SwImage* image
 }
 
 
-static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
+template<typename Blender>
+static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity, Blender blender)
 {
     auto span = image->rle->spans;
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
@@ -786,13 +817,13 @@ static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* ima
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         SCALED_IMAGE_RANGE_Y(span->y)
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+        auto dst = surface->buf32At(span->x, span->y);
         auto alpha = MULTIPLY(span->coverage, opacity);
         if (alpha == 255) {
             for (uint32_t x = static_cast<uint32_t>(span->x); x < static_cast<uint32_t>(span->x) + span->len; ++x, ++dst) {
                 SCALED_IMAGE_RANGE_X
                 auto src = scaleMethod(image->buf32, image->stride, image->w, image->h, sx, sy, miny, maxy, sampleSize);
-                auto tmp = surface->blender(src, *dst, 255);
+                auto tmp = blender(src, *dst, 255);
                 *dst = INTERPOLATE(tmp, *dst, A(src));
             }
         } else {
@@ -800,7 +831,7 @@ static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* ima
                 SCALED_IMAGE_RANGE_X
                 auto src = scaleMethod(image->buf32, image->stride, image->w, image->h, sx, sy, miny, maxy, sampleSize);
                 if (opacity < 255) src = ALPHA_BLEND(src, opacity);
-                auto tmp = surface->blender(src, *dst, 255);
+                auto tmp = blender(src, *dst, 255);
                 *dst = INTERPOLATE(tmp, *dst, MULTIPLY(span->coverage, A(src)));
             }
         }
@@ -818,7 +849,7 @@ static bool _rasterScaledRleImage(SwSurface* surface, const SwImage* image, cons
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         SCALED_IMAGE_RANGE_Y(span->y)
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+        auto dst = surface->buf32At(span->x, span->y);
         auto alpha = MULTIPLY(span->coverage, opacity);
         for (uint32_t x = static_cast<uint32_t>(span->x); x < static_cast<uint32_t>(span->x) + span->len; ++x, ++dst) {
             SCALED_IMAGE_RANGE_X
@@ -845,10 +876,10 @@ static bool _scaledRleImage(SwSurface* surface, const SwImage* image, const Matr
     } else mathIdentity(&itransform);
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterScaledMattedRleImage(surface, image, &itransform, region, opacity);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterScaledMattedRleImage(surface, image, &itransform, region, opacity, op); });
         else return _rasterScaledMaskedRleImage(surface, image, &itransform, region, opacity);
     } else if (_blending(surface)) {
-        return _rasterScaledBlendingRleImage(surface, image, &itransform, region, opacity);
+        return _blendingKernel(surface, [&](auto op) { return _rasterScaledBlendingRleImage(surface, image, &itransform, region, opacity, op); });
     } else {
         return _rasterScaledRleImage(surface, image, &itransform, region, opacity);
     }
@@ -864,12 +895,10 @@ static bool _scaledRleImage(SwSurface* surface, const SwImage* image, const Matr
 static bool _rasterCompositeDirectMaskedRleImage(SwSurface* surface, const SwImage* image, SwMask maskOp, uint8_t opacity)
 {
     auto span = image->rle->spans;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto ctride = surface->compositor->image.stride;
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         auto src = image->buf8 + (span->y + image->oy) * image->stride + (span->x + image->ox);
-        auto cmp = &cbuffer[span->y * ctride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
         auto alpha = MULTIPLY(span->coverage, opacity);
         if (alpha == 255) {
             for (uint32_t x = 0; x < span->len; ++x, ++src, ++cmp) {
@@ -889,13 +918,11 @@ static bool _rasterCompositeDirectMaskedRleImage(SwSurface* surface, const SwIma
 static bool _rasterDirectDirectMaskedRleImage(SwSurface* surface, const SwImage* image, SwMask maskOp, uint8_t opacity)
 {
     auto span = image->rle->spans;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto ctride = surface->compositor->image.stride;
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
         auto src = image->buf8 + (span->y + image->oy) * image->stride + (span->x + image->ox);
-        auto cmp = &cbuffer[span->y * ctride + span->x];
-        auto dst = &surface->buf8[span->y * surface->stride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        auto dst = surface->buf8At(span->x, span->y);
         auto alpha = MULTIPLY(span->coverage, opacity);
         if (alpha == 255) {
             for (uint32_t x = 0; x < span->len; ++x, ++src, ++cmp, ++dst) {
@@ -929,18 +956,17 @@ static bool _rasterDirectMaskedRleImage(SwSurface* surface, const SwImage* image
 }
 
 
-static bool _rasterDirectMattedRleImage(SwSurface* surface, const SwImage* image, uint8_t opacity)
+template<typename Alpha>
+static bool _rasterDirectMattedRleImage(SwSurface* surface, const SwImage* image, uint8_t opacity, Alpha alpha)
 {
     TVGLOG("SW_ENGINE", "Direct Matted(%d) Rle Image", (int)surface->compositor->method);
 
     auto span = image->rle->spans;
     auto csize = surface->compositor->image.channelSize;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto alpha = surface->alpha(surface->compositor->method);
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
-        auto cmp = &cbuffer[(span->y * surface->compositor->image.stride + span->x) * csize];
+        auto dst = surface->buf32At(span->x, span->y);
+        auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
         auto img = image->buf32 + (span->y + image->oy) * image->stride + (span->x + image->ox);
         auto a = MULTIPLY(span->coverage, opacity);
         if (a == 255) {
@@ -959,27 +985,28 @@ static bool _rasterDirectMattedRleImage(SwSurface* surface, const SwImage* image
 }
 
 
-static bool _rasterDirectBlendingRleImage(SwSurface* surface, const SwImage* image, uint8_t opacity)
+template<typename Blender>
+static bool _rasterDirectBlendingRleImage(SwSurface* surface, const SwImage* image, uint8_t opacity, Blender blender)
 {
     auto span = image->rle->spans;
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+        auto dst = surface->buf32At(span->x, span->y);
         auto img = image->buf32 + (span->y + image->oy) * image->stride + (span->x + image->ox);
         auto alpha = MULTIPLY(span->coverage, opacity);
         if (alpha == 255) {
             for (uint32_t x = 0; x < span->len; ++x, ++dst, ++img) {
-                *dst = surface->blender(*img, *dst, IA(*img));
+                *dst = blender(*img, *dst, IA(*img));
             }
         } else if (opacity == 255) {
             for (uint32_t x = 0; x < span->len; ++x, ++dst, ++img) {
-                auto tmp = surface->blender(*img, *dst, 255);
+                auto tmp = blender(*img, *dst, 255);
                 *dst = INTERPOLATE(tmp, *dst, MULTIPLY(span->coverage, A(*img)));
             }
         } else {
             for (uint32_t x = 0; x < span->len; ++x, ++dst, ++img) {
                 auto src = ALPHA_BLEND(*img, opacity);
-                auto tmp = surface->blender(src, *dst, IA(src));
+                auto tmp = blender(src, *dst, IA(src));
                 *dst = INTERPOLATE(tmp, *dst, MULTIPLY(span->coverage, A(src)));
             }
         }
@@ -993,7 +1020,7 @@ static bool _rasterDirectRleImage(SwSurface* surface, const SwImage* image, uint
     auto span = image->rle->spans;
 
     for (uint32_t i = 0; i < image->rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+        auto dst = surface->buf32At(span->x, span->y);
         auto img = image->buf32 + (span->y + image->oy) * image->stride + (span->x + image->ox);
         auto alpha = MULTIPLY(span->coverage, opacity);
         if (alpha == 255) {
@@ -1019,10 +1046,10 @@ static bool _directRleImage(SwSurface* surface, const SwImage* image, uint8_t op
     }
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterDirectMattedRleImage(surface, image, opacity);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterDirectMattedRleImage(surface, image, opacity, op); });
         else return _rasterDirectMaskedRleImage(surface, image, opacity);
     } else if (_blending(surface)) {
-        return _rasterDirectBlendingRleImage(surface, image, opacity);
+        return _blendingKernel(surface, [&](auto op) { return _rasterDirectBlendingRleImage(surface, image, opacity, op); });
     } else {
         return _rasterDirectRleImage(surface, image, opacity);
     }
@@ -1040,7 +1067,7 @@ static bool _rasterCompositeScaledMaskedImage(SwSurface* surface, const SwImage*
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
     auto sampleSize = _sampleSize(image->scale);
     auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x);
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);
     int32_t miny = 0, maxy = 0;
 
     for (auto y = region.min.y; y < region.max.y; ++y) {
@@ -1063,8 +1090,8 @@ static bool _rasterDirectScaledMaskedImage(SwSurface* surface, const SwImage* im
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
     auto sampleSize = _sampleSize(image->scale);
     auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x);
-    auto dbuffer = surface->buf8 + (region.min.y * surface->stride + region.min.x);
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);
+    auto dbuffer = surface->buf8At(region.min.x, region.min.y);
     int32_t miny = 0, maxy = 0;
 
     for (auto y = region.min.y; y < region.max.y; ++y) {
@@ -1098,12 +1125,12 @@ static bool _rasterScaledMaskedImage(SwSurface* surface, const SwImage* image, c
 }
 
 
-static bool _rasterScaledMattedImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
+template<typename Alpha>
+static bool _rasterScaledMattedImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity, Alpha alpha)
 {
-    auto dbuffer = surface->buf32 + (region.min.y * surface->stride + region.min.x);
+    auto dbuffer = surface->buf32At(region.min.x, region.min.y);
     auto csize = surface->compositor->image.channelSize;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * surface->compositor->image.stride + region.min.x) * csize;
-    auto alpha = surface->alpha(surface->compositor->method);
+    auto cbuffer = surface->compositor->image.pixelAt(region.min.x, region.min.y);
 
     TVGLOG("SW_ENGINE", "Scaled Matted(%d) Image [Region: %lu %lu %lu %lu]", (int)surface->compositor->method, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
 
@@ -1128,9 +1155,10 @@ static bool _rasterScaledMattedImage(SwSurface* surface, const SwImage* image, c
 }
 
 
-static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
+template<typename Blender>
+static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity, Blender blender)
 {
-    auto dbuffer = surface->buf32 + (region.min.y * surface->stride + region.min.x);
+    auto dbuffer = surface->buf32At(region.min.x, region.min.y);
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
@@ -1142,7 +1170,7 @@ static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image,
             SCALED_IMAGE_RANGE_X
             auto src = scaleMethod(image->buf32, image->stride, image->w, image->h, sx, sy, miny, maxy, sampleSize);
             if (opacity < 255) ALPHA_BLEND(src, opacity);
-            auto tmp = surface->blender(src, *dst, 255);
+            auto tmp = blender(src, *dst, 255);
             *dst = INTERPOLATE(tmp, *dst, A(src));
         }
     }
@@ -1152,7 +1180,7 @@ static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image,
 
 static bool _rasterScaledImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
 {
-    auto dbuffer = surface->buf32 + (region.min.y * surface->stride + region.min.x);
+    auto dbuffer = surface->buf32At(region.min.x, region.min.y);
     auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
@@ -1185,10 +1213,10 @@ static bool _scaledImage(SwSurface* surface, const SwImage* image, const Matrix*
     } else mathIdentity(&itransform);
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterScaledMattedImage(surface, image, &itransform, region, opacity);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterScaledMattedImage(surface, image, &itransform, region, opacity, op); });
         else return _rasterScaledMaskedImage(surface, image, &itransform, region, opacity);
     } else if (_blending(surface)) {
-        return _rasterScaledBlendingImage(surface, image, &itransform, region, opacity);
+        return _blendingKernel(surface, [&](auto op) { return _rasterScaledBlendingImage(surface, image, &itransform, region, opacity, op); });
     } else {
         return _rasterScaledImage(surface, image, &itransform, region, opacity);
     }
@@ -1207,7 +1235,7 @@ static bool _rasterCompositeDirectMaskedImage(SwSurface* surface, const SwImage*
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto cstride = surface->compositor->image.stride;
 
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x); //compositor buffer
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y); //compositor buffer
     auto sbuffer = image->buf8 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
 
     for (uint32_t y = 0; y < h; ++y) {
@@ -1236,8 +1264,8 @@ static bool _rasterDirectDirectMaskedImage(SwSurface* surface, const SwImage* im
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto cstride = surface->compositor->image.stride;
 
-    auto cbuffer = surface->compositor->image.buf32 + (region.min.y * cstride + region.min.x); //compositor buffer
-    auto dbuffer = surface->buf8 + (region.min.y * surface->stride + region.min.x);            //destination buffer
+    auto cbuffer = surface->compositor->image.buf32At(region.min.x, region.min.y); //compositor buffer
+    auto dbuffer = surface->buf8At(region.min.x, region.min.y);            //destination buffer
     auto sbuffer = image->buf8 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
 
     for (uint32_t y = 0; y < h; ++y) {
@@ -1276,20 +1304,20 @@ static bool _rasterDirectMaskedImage(SwSurface* surface, const SwImage* image, c
 }
 
 
-static bool _rasterDirectMattedImage(SwSurface* surface, const SwImage* image, const SwBBox& region, uint8_t opacity)
+template<typename Alpha>
+static bool _rasterDirectMattedImage(SwSurface* surface, const SwImage* image, const SwBBox& region, uint8_t opacity, Alpha alpha)
 {
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto csize = surface->compositor->image.channelSize;
-    auto alpha = surface->alpha(surface->compositor->method);
     auto sbuffer = image->buf32 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * surface->compositor->image.stride + region.min.x) * csize; //compositor buffer
+    auto cbuffer = surface->compositor->image.pixelAt(region.min.x, region.min.y); //compositor buffer
 
     TVGLOG("SW_ENGINE", "Direct Matted(%d) Image  [Region: %lu %lu %u %u]", (int)surface->compositor->method, region.min.x, region.min.y, w, h);
 
     //32 bits
     if (surface->channelSize == sizeof(uint32_t)) {
-        auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf32At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = buffer;
             auto cmp = cbuffer;
@@ -1311,7 +1339,7 @@ static bool _rasterDirectMattedImage(SwSurface* surface, const SwImage* image, c
         }
     //8 bits
     } else if (surface->channelSize == sizeof(uint8_t)) {
-        auto buffer = surface->buf8 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf8At(region.min.x, region.min.y);
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = buffer;
             auto cmp = cbuffer;
@@ -1334,14 +1362,15 @@ static bool _rasterDirectMattedImage(SwSurface* surface, const SwImage* image, c
 }
 
 
-static bool _rasterDirectBlendingImage(SwSurface* surface, const SwImage* image, const SwBBox& region, uint8_t opacity)
+template<typename Blender>
+static bool _rasterDirectBlendingImage(SwSurface* surface, const SwImage* image, const SwBBox& region, uint8_t opacity, Blender blender)
 {
     if (surface->channelSize == sizeof(uint8_t)) {
         TVGERR("SW_ENGINE", "Not supported grayscale image!");
         return false;
     }
 
-    auto dbuffer = &surface->buf32[region.min.y * surface->stride + region.min.x];
+    auto dbuffer = surface->buf32At(region.min.x, region.min.y);
     auto sbuffer = image->buf32 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
 
     for (auto y = region.min.y; y < region.max.y; ++y) {
@@ -1349,13 +1378,13 @@ static bool _rasterDirectBlendingImage(SwSurface* surface, const SwImage* image,
         auto src = sbuffer;
         if (opacity == 255) {
             for (auto x = region.min.x; x < region.max.x; x++, dst++, src++) {
-                auto tmp = surface->blender(*src, *dst, 255);
+                auto tmp = blender(*src, *dst, 255);
                 *dst = INTERPOLATE(tmp, *dst, A(*src));
             }
         } else {
             for (auto x = region.min.x; x < region.max.x; ++x, ++dst, ++src) {
                 auto tmp = ALPHA_BLEND(*src, opacity);
-                auto tmp2 = surface->blender(tmp, *dst, 255);
+                auto tmp2 = blender(tmp, *dst, 255);
                 *dst = INTERPOLATE(tmp2, *dst, A(tmp));
             }
         }
@@ -1373,7 +1402,7 @@ static bool _rasterDirectImage(SwSurface* surface, const SwImage* image, const S
         return false;
     }
 
-    auto dbuffer = &surface->buf32[region.min.y * surface->stride + region.min.x];
+    auto dbuffer = surface->buf32At(region.min.x, region.min.y);
     auto sbuffer = image->buf32 + (region.min.y + image->oy) * image->stride + (region.min.x + image->ox);
 
     for (auto y = region.min.y; y < region.max.y; ++y) {
@@ -1400,10 +1429,10 @@ static bool _rasterDirectImage(SwSurface* surface, const SwImage* image, const S
 static bool _directImage(SwSurface* surface, const SwImage* image, const SwBBox& region, uint8_t opacity)
 {
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterDirectMattedImage(surface, image, region, opacity);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto op) { return _rasterDirectMattedImage(surface, image, region, opacity, op); });
         else return _rasterDirectMaskedImage(surface, image, region, opacity);
     } else if (_blending(surface)) {
-        return _rasterDirectBlendingImage(surface, image, region, opacity);
+        return _blendingKernel(surface, [&](auto op) { return _rasterDirectBlendingImage(surface, image, region, opacity, op); });
     } else {
         return _rasterDirectImage(surface, image, region, opacity);
     }
@@ -1414,6 +1443,14 @@ static bool _directImage(SwSurface* surface, const SwImage* image, const SwBBox&
 //Blenders for the following scenarios: [RLE / Whole] * [Direct / Scaled / Transformed]
 static bool _rasterImage(SwSurface* surface, SwImage* image, const Matrix* transform, const SwBBox& region, uint8_t opacity)
 {
+    //Downscaled image is sampled from its mipmap level
+    SwImage level;
+    Matrix levelTransform;
+    if (imageMipmap(image, transform, &level, &levelTransform)) {
+        image = &level;
+        transform = &levelTransform;
+    }
+
     //RLE Image
     if (image->rle) {
         if (image->direct) return _directRleImage(surface, image, opacity);
@@ -1432,30 +1469,30 @@ static bool _rasterImage(SwSurface* surface, SwImage* image, const Matrix* trans
 /* Rect Gradient                                                        */
 /************************************************************************/
 
-template<typename fillMethod>
-static bool _rasterCompositeGradientMaskedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, SwMask maskOp)
+template<typename fillMethod, typename MaskOp>
+static bool _rasterCompositeGradientMaskedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, MaskOp maskOp)
 {
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x);
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);
 
     for (uint32_t y = 0; y < h; ++y) {
         fillMethod()(fill, cbuffer, region.min.y + y, region.min.x, w, maskOp, 255);
-        cbuffer += surface->stride;
+        cbuffer += cstride;
     }
     return _compositeMaskImage(surface, &surface->compositor->image, surface->compositor->bbox);
 }
 
 
-template<typename fillMethod>
-static bool _rasterDirectGradientMaskedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, SwMask maskOp)
+template<typename fillMethod, typename MaskOp>
+static bool _rasterDirectGradientMaskedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, MaskOp maskOp)
 {
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * cstride + region.min.x);
-    auto dbuffer = surface->buf8 + (region.min.y * surface->stride + region.min.x);
+    auto cbuffer = surface->compositor->image.buf8At(region.min.x, region.min.y);
+    auto dbuffer = surface->buf8At(region.min.x, region.min.y);
 
     for (uint32_t y = 0; y < h; ++y) {
         fillMethod()(fill, dbuffer, region.min.y + y, region.min.x, w, cbuffer, maskOp, 255);
@@ -1469,54 +1506,51 @@ static bool _rasterDirectGradientMaskedRect(SwSurface* surface, const SwBBox& re
 template<typename fillMethod>
 static bool _rasterGradientMaskedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
 {
-    auto method = surface->compositor->method;
-
-    TVGLOG("SW_ENGINE", "Masked(%d) Gradient [Region: %lu %lu %lu %lu]", (int)method, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
-
-    auto maskOp = _getMaskOp(method);
+    //8bit masking channels composition
+    if (surface->channelSize != sizeof(uint8_t)) return false;
 
-    if (_direct(method)) return _rasterDirectGradientMaskedRect<fillMethod>(surface, region, fill, maskOp);
-    else return _rasterCompositeGradientMaskedRect<fillMethod>(surface, region, fill, maskOp);
+    TVGLOG("SW_ENGINE", "Masked(%d) Gradient [Region: %lu %lu %lu %lu]", (int)surface->compositor->method, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
 
-    return false;
+    return _maskingKernel(surface,
+        [&](auto op) { return _rasterCompositeGradientMaskedRect<fillMethod>(surface, region, fill, op); },
+        [&](auto op) { return _rasterDirectGradientMaskedRect<fillMethod>(surface, region, fill, op); });
 }
 
 
-template<typename fillMethod>
-static bool _rasterGradientMattedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
+template<typename fillMethod, typename Alpha>
+static bool _rasterGradientMattedRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, Alpha alpha)
 {
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto csize = surface->compositor->image.channelSize;
-    auto cbuffer = surface->compositor->image.buf8 + (region.min.y * surface->compositor->image.stride + region.min.x) * csize;
-    auto alpha = surface->alpha(surface->compositor->method);
+    auto cbuffer = surface->compositor->image.pixelAt(region.min.x, region.min.y);
 
     TVGLOG("SW_ENGINE", "Matted(%d) Gradient [Region: %lu %lu %u %u]", (int)surface->compositor->method, region.min.x, region.min.y, w, h);
 
     for (uint32_t y = 0; y < h; ++y) {
         fillMethod()(fill, buffer, region.min.y + y, region.min.x, w, cbuffer, alpha, csize, 255);
         buffer += surface->stride;
-        cbuffer += surface->stride * csize;
+        cbuffer += surface->compositor->image.stride * csize;
     }
     return true;
 }
 
 
-template<typename fillMethod>
-static bool _rasterBlendingGradientRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
+template<typename fillMethod, typename Blender>
+static bool _rasterBlendingGradientRect(SwSurface* surface, const SwBBox& region, const SwFill* fill, Blender blender)
 {
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
 
     if (fill->translucent) {
         for (uint32_t y = 0; y < h; ++y) {
-            fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, opBlendPreNormal, surface->blender, 255);
+            fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, BlendOp<opBlendPreNormal>(), blender, 255);
         }
     } else {
         for (uint32_t y = 0; y < h; ++y) {
-            fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, opBlendSrcOver, surface->blender, 255);
+            fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, BlendOp<opBlendSrcOver>(), blender, 255);
         }
     }
     return true;
@@ -1525,12 +1559,12 @@ static bool _rasterBlendingGradientRect(SwSurface* surface, const SwBBox& region
 template<typename fillMethod>
 static bool _rasterTranslucentGradientRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
 {
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
 
     for (uint32_t y = 0; y < h; ++y) {
-        fillMethod()(fill, buffer, region.min.y + y, region.min.x, w, opBlendPreNormal, 255);
+        fillMethod()(fill, buffer, region.min.y + y, region.min.x, w, BlendOp<opBlendPreNormal>(), 255);
         buffer += surface->stride;
     }
     return true;
@@ -1540,12 +1574,12 @@ static bool _rasterTranslucentGradientRect(SwSurface* surface, const SwBBox& reg
 template<typename fillMethod>
 static bool _rasterSolidGradientRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
 {
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
 
     for (uint32_t y = 0; y < h; ++y) {
-        fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, opBlendSrcOver, 255);
+        fillMethod()(fill, buffer + y * surface->stride, region.min.y + y, region.min.x, w, BlendOp<opBlendSrcOver>(), 255);
     }
     return true;
 }
@@ -1556,10 +1590,10 @@ static bool _rasterLinearGradientRect(SwSurface* surface, const SwBBox& region,
     if (fill->linear.len < FLT_EPSILON) return false;
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterGradientMattedRect<FillLinear>(surface, region, fill);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto alpha) { return _rasterGradientMattedRect<FillLinear>(surface, region, fill, alpha); });
         else return _rasterGradientMaskedRect<FillLinear>(surface, region, fill);
     } else if (_blending(surface)) {
-        return _rasterBlendingGradientRect<FillLinear>(surface, region, fill);
+        return _blendingKernel(surface, [&](auto op) { return _rasterBlendingGradientRect<FillLinear>(surface, region, fill, op); });
     } else {
         if (fill->translucent) return _rasterTranslucentGradientRect<FillLinear>(surface, region, fill);
         else _rasterSolidGradientRect<FillLinear>(surface, region, fill);
@@ -1571,10 +1605,10 @@ static bool _rasterLinearGradientRect(SwSurface* surface, const SwBBox& region,
 static bool _rasterRadialGradientRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
 {
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterGradientMattedRect<FillRadial>(surface, region, fill);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto alpha) { return _rasterGradientMattedRect<FillRadial>(surface, region, fill, alpha); });
         else return _rasterGradientMaskedRect<FillRadial>(surface, region, fill);
     } else if (_blending(surface)) {
-        return _rasterBlendingGradientRect<FillRadial>(surface, region, fill);
+        return _blendingKernel(surface, [&](auto op) { return _rasterBlendingGradientRect<FillRadial>(surface, region, fill, op); });
     } else {
         if (fill->translucent) return _rasterTranslucentGradientRect<FillRadial>(surface, region, fill);
         else _rasterSolidGradientRect<FillRadial>(surface, region, fill);
@@ -1587,32 +1621,27 @@ static bool _rasterRadialGradientRect(SwSurface* surface, const SwBBox& region,
 /* Rle Gradient                                                         */
 /************************************************************************/
 
-template<typename fillMethod>
-static bool _rasterCompositeGradientMaskedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, SwMask maskOp)
+template<typename fillMethod, typename MaskOp>
+static bool _rasterCompositeGradientMaskedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, MaskOp maskOp)
 {
     auto span = rle->spans;
-    auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto cmp = &cbuffer[span->y * cstride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
         fillMethod()(fill, cmp, span->y, span->x, span->len, maskOp, span->coverage);
     }
     return _compositeMaskImage(surface, &surface->compositor->image, surface->compositor->bbox);
 }
 
 
-template<typename fillMethod>
-static bool _rasterDirectGradientMaskedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, SwMask maskOp)
+template<typename fillMethod, typename MaskOp>
+static bool _rasterDirectGradientMaskedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, MaskOp maskOp)
 {
     auto span = rle->spans;
-    auto cstride = surface->compositor->image.stride;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto dbuffer = surface->buf8;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto cmp = &cbuffer[span->y * cstride + span->x];
-        auto dst = &dbuffer[span->y * surface->stride + span->x];
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        auto dst = surface->buf8At(span->x, span->y);
         fillMethod()(fill, dst, span->y, span->x, span->len, cmp, maskOp, span->coverage);
     }
     return true;
@@ -1622,45 +1651,42 @@ static bool _rasterDirectGradientMaskedRle(SwSurface* surface, const SwRleData*
 template<typename fillMethod>
 static bool _rasterGradientMaskedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill)
 {
-    auto method = surface->compositor->method;
-
-    TVGLOG("SW_ENGINE", "Masked(%d) Rle Linear Gradient", (int)method);
+    //8bit masking channels composition
+    if (surface->channelSize != sizeof(uint8_t)) return false;
 
-    auto maskOp = _getMaskOp(method);
+    TVGLOG("SW_ENGINE", "Masked(%d) Rle Linear Gradient", (int)surface->compositor->method);
 
-    if (_direct(method)) return _rasterDirectGradientMaskedRle<fillMethod>(surface, rle, fill, maskOp);
-    else return _rasterCompositeGradientMaskedRle<fillMethod>(surface, rle, fill, maskOp);
-    return false;
+    return _maskingKernel(surface,
+        [&](auto op) { return _rasterCompositeGradientMaskedRle<fillMethod>(surface, rle, fill, op); },
+        [&](auto op) { return _rasterDirectGradientMaskedRle<fillMethod>(surface, rle, fill, op); });
 }
 
 
-template<typename fillMethod>
-static bool _rasterGradientMattedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill)
+template<typename fillMethod, typename Alpha>
+static bool _rasterGradientMattedRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, Alpha alpha)
 {
     TVGLOG("SW_ENGINE", "Matted(%d) Rle Linear Gradient", (int)surface->compositor->method);
 
     auto span = rle->spans;
     auto csize = surface->compositor->image.channelSize;
-    auto cbuffer = surface->compositor->image.buf8;
-    auto alpha = surface->alpha(surface->compositor->method);
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
-        auto cmp = &cbuffer[(span->y * surface->compositor->image.stride + span->x) * csize];
+        auto dst = surface->buf32At(span->x, span->y);
+        auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
         fillMethod()(fill, dst, span->y, span->x, span->len, cmp, alpha, csize, span->coverage);
     }
     return true;
 }
 
 
-template<typename fillMethod>
-static bool _rasterBlendingGradientRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill)
+template<typename fillMethod, typename Blender>
+static bool _rasterBlendingGradientRle(SwSurface* surface, const SwRleData* rle, const SwFill* fill, Blender blender)
 {
     auto span = rle->spans;
 
     for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
-        fillMethod()(fill, dst, span->y, span->x, span->len, opBlendPreNormal, surface->blender, span->coverage);
+        auto dst = surface->buf32At(span->x, span->y);
+        fillMethod()(fill, dst, span->y, span->x, span->len, BlendOp<opBlendPreNormal>(), blender, span->coverage);
     }
     return true;
 }
@@ -1674,15 +1700,15 @@ static bool _rasterTranslucentGradientRle(SwSurface* surface, const SwRleData* r
     //32 bits
     if (surface->channelSize == sizeof(uint32_t)) {
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf32[span->y * surface->stride + span->x];
-            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, opBlendPreNormal, 255);
-            else fillMethod()(fill, dst, span->y, span->x, span->len, opBlendNormal, span->coverage);
+            auto dst = surface->buf32At(span->x, span->y);
+            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, BlendOp<opBlendPreNormal>(), 255);
+            else fillMethod()(fill, dst, span->y, span->x, span->len, BlendOp<opBlendNormal>(), span->coverage);
         }
     //8 bits
     } else if (surface->channelSize == sizeof(uint8_t)) {
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf8[span->y * surface->stride + span->x];
-            fillMethod()(fill, dst, span->y, span->x, span->len, _opMaskAdd, 255);
+            auto dst = surface->buf8At(span->x, span->y);
+            fillMethod()(fill, dst, span->y, span->x, span->len, MaskingOp<_opMaskAdd>(), 255);
         }
     }
     return true;
@@ -1697,16 +1723,16 @@ static bool _rasterSolidGradientRle(SwSurface* surface, const SwRleData* rle, co
     //32 bits
     if (surface->channelSize == sizeof(uint32_t)) {
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf32[span->y * surface->stride + span->x];
-            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, opBlendSrcOver, 255);
-            else fillMethod()(fill, dst, span->y, span->x, span->len, opBlendInterp, span->coverage);
+            auto dst = surface->buf32At(span->x, span->y);
+            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, BlendOp<opBlendSrcOver>(), 255);
+            else fillMethod()(fill, dst, span->y, span->x, span->len, BlendOp<opBlendInterp>(), span->coverage);
         }
     //8 bits
     } else if (surface->channelSize == sizeof(uint8_t)) {
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf8[span->y * surface->stride + span->x];
-            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, _opMaskNone, 255);
-            else fillMethod()(fill, dst, span->y, span->x, span->len, _opMaskAdd, span->coverage);
+            auto dst = surface->buf8At(span->x, span->y);
+            if (span->coverage == 255) fillMethod()(fill, dst, span->y, span->x, span->len, MaskingOp<_opMaskNone>(), 255);
+            else fillMethod()(fill, dst, span->y, span->x, span->len, MaskingOp<_opMaskAdd>(), span->coverage);
         }
     }
 
@@ -1719,10 +1745,10 @@ static bool _rasterLinearGradientRle(SwSurface* surface, const SwRleData* rle, c
     if (!rle) return false;
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterGradientMattedRle<FillLinear>(surface, rle, fill);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto alpha) { return _rasterGradientMattedRle<FillLinear>(surface, rle, fill, alpha); });
         else return _rasterGradientMaskedRle<FillLinear>(surface, rle, fill);
     } else if (_blending(surface)) {
-        return _rasterBlendingGradientRle<FillLinear>(surface, rle, fill);
+        return _blendingKernel(surface, [&](auto op) { return _rasterBlendingGradientRle<FillLinear>(surface, rle, fill, op); });
     } else {
         if (fill->translucent) return _rasterTranslucentGradientRle<FillLinear>(surface, rle, fill);
         else return _rasterSolidGradientRle<FillLinear>(surface, rle, fill);
@@ -1736,10 +1762,10 @@ static bool _rasterRadialGradientRle(SwSurface* surface, const SwRleData* rle, c
     if (!rle) return false;
 
     if (_compositing(surface)) {
-        if (_matting(surface)) return _rasterGradientMattedRle<FillRadial>(surface, rle, fill);
+        if (_matting(surface)) return _mattingKernel(surface, [&](auto alpha) { return _rasterGradientMattedRle<FillRadial>(surface, rle, fill, alpha); });
         else return _rasterGradientMaskedRle<FillRadial>(surface, rle, fill);
     } else if (_blending(surface)) {
-        _rasterBlendingGradientRle<FillRadial>(surface, rle, fill);
+        _blendingKernel(surface, [&](auto op) { return _rasterBlendingGradientRle<FillRadial>(surface, rle, fill, op); });
     } else {
         if (fill->translucent) _rasterTranslucentGradientRle<FillRadial>(surface, rle, fill);
         else return _rasterSolidGradientRle<FillRadial>(surface, rle, fill);
@@ -1748,14 +1774,50 @@ static bool _rasterRadialGradientRle(SwSurface* surface, const SwRleData* rle, c
 }
 
 
+//Whether the Red, Blue channels are placed in the opposite order
+static bool _flipped(ColorSpace from, ColorSpace to)
+{
+    auto abgr = [](ColorSpace cs) { return cs == ColorSpace::ABGR8888 || cs == ColorSpace::ABGR8888S; };
+    auto argb = [](ColorSpace cs) { return cs == ColorSpace::ARGB8888 || cs == ColorSpace::ARGB8888S; };
+    return (abgr(from) && argb(to)) || (argb(from) && abgr(to));
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
 
 
+SwSimd rasterSimd(SwSimd limit)
+{
+    //the best kernels supported by this cpu
+    auto simd = SwSimd::None;
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    simd = avxDetect();
+#elif defined(THORVG_NEON_VECTOR_SUPPORT)
+    simd = SwSimd::Neon;
+#endif
+    if (simd > limit) {
+        //the x86 instruction sets are supersets of each other
+        if (simd != SwSimd::Neon && limit != SwSimd::Neon) simd = limit;
+        else simd = SwSimd::None;
+    }
+    _simd = simd;
+    return _simd;
+}
+
+
+SwSimd rasterSimd()
+{
+    return _simd;
+}
+
+
 void rasterGrayscale8(uint8_t *dst, uint8_t val, uint32_t offset, int32_t len)
 {
-    //OPTIMIZE_ME: Support SIMD
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+    if (_simd == SwSimd::Avx2) return avxRasterPixel8(dst, val, offset, len);
+#endif
     cRasterPixels(dst, val, offset, len);
 }
 
@@ -1763,9 +1825,12 @@ void rasterGrayscale8(uint8_t *dst, uint8_t val, uint32_t offset, int32_t len)
 void rasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32_t len)
 {
 #if defined(THORVG_AVX_VECTOR_SUPPORT)
-    avxRasterPixel32(dst, val, offset, len);
+    if (_simd == SwSimd::Avx2) avxRasterPixel32(dst, val, offset, len);
+    else if (_simd == SwSimd::Sse41) sseRasterPixel32(dst, val, offset, len);
+    else cRasterPixels(dst, val, offset, len);
 #elif defined(THORVG_NEON_VECTOR_SUPPORT)
-    neonRasterPixel32(dst, val, offset, len);
+    if (_simd == SwSimd::Neon) neonRasterPixel32(dst, val, offset, len);
+    else cRasterPixels(dst, val, offset, len);
 #else
     cRasterPixels(dst, val, offset, len);
 #endif
@@ -1802,22 +1867,22 @@ bool rasterClear(SwSurface* surface, uint32_t x, uint32_t y, uint32_t w, uint32_
     if (surface->channelSize == sizeof(uint32_t)) {
         //full clear
         if (w == surface->stride) {
-            rasterPixel32(surface->buf32, 0x00000000, surface->stride * y, w * h);
+            rasterPixel32(surface->buf32At(x, y), 0x00000000, 0, w * h);
         //partial clear
         } else {
             for (uint32_t i = 0; i < h; i++) {
-                rasterPixel32(surface->buf32, 0x00000000, (surface->stride * y + x) + (surface->stride * i), w);
+                rasterPixel32(surface->buf32At(x, y + i), 0x00000000, 0, w);
             }
         }
     //8 bits
     } else if (surface->channelSize == sizeof(uint8_t)) {
         //full clear
         if (w == surface->stride) {
-            rasterGrayscale8(surface->buf8, 0x00, surface->stride * y, w * h);
+            rasterGrayscale8(surface->buf8At(x, y), 0x00, 0, w * h);
         //partial clear
         } else {
             for (uint32_t i = 0; i < h; i++) {
-                rasterGrayscale8(surface->buf8, 0x00, (surface->stride * y + x) + (surface->stride * i), w);
+                rasterGrayscale8(surface->buf8At(x, y + i), 0x00, 0, w);
             }
         }
     }
@@ -1825,29 +1890,29 @@ bool rasterClear(SwSurface* surface, uint32_t x, uint32_t y, uint32_t w, uint32_
 }
 
 
-void rasterUnpremultiply(Surface* surface)
+void rasterUnpremultiply(Surface* surface, uint32_t x, uint32_t y, uint32_t w, uint32_t h)
 {
     if (surface->channelSize != sizeof(uint32_t)) return;
 
-    TVGLOG("SW_ENGINE", "Unpremultiply [Size: %d x %d]", surface->w, surface->h);
+    TVGLOG("SW_ENGINE", "Unpremultiply [Region: %d %d %d %d]", x, y, w, h);
 
     //OPTIMIZE_ME: +SIMD
-    for (uint32_t y = 0; y < surface->h; y++) {
-        auto buffer = surface->buf32 + surface->stride * y;
-        for (uint32_t x = 0; x < surface->w; ++x) {
-            uint8_t a = buffer[x] >> 24;
+    for (uint32_t i = 0; i < h; i++) {
+        auto buffer = surface->buf32 + surface->stride * (y + i) + x;
+        for (uint32_t j = 0; j < w; ++j) {
+            uint8_t a = buffer[j] >> 24;
             if (a == 255) {
                 continue;
             } else if (a == 0) {
-                buffer[x] = 0x00ffffff;
+                buffer[j] = 0x00ffffff;
             } else {
-                uint16_t r = ((buffer[x] >> 8) & 0xff00) / a;
-                uint16_t g = ((buffer[x]) & 0xff00) / a;
-                uint16_t b = ((buffer[x] << 8) & 0xff00) / a;
+                uint16_t r = ((buffer[j] >> 8) & 0xff00) / a;
+                uint16_t g = ((buffer[j]) & 0xff00) / a;
+                uint16_t b = ((buffer[j] << 8) & 0xff00) / a;
                 if (r > 0xff) r = 0xff;
                 if (g > 0xff) g = 0xff;
                 if (b > 0xff) b = 0xff;
-                buffer[x] = (a << 24) | (r << 16) | (g << 8) | (b);
+                buffer[j] = (a << 24) | (r << 16) | (g << 8) | (b);
             }
         }
     }
@@ -1855,27 +1920,6 @@ void rasterUnpremultiply(Surface* surface)
 }
 
 
-void rasterPremultiply(Surface* surface)
-{
-    ScopedLock lock(surface->key);
-    if (surface->premultiplied || (surface->channelSize != sizeof(uint32_t))) return;
-    surface->premultiplied = true;
-
-    TVGLOG("SW_ENGINE", "Premultiply [Size: %d x %d]", surface->w, surface->h);
-
-    //OPTIMIZE_ME: +SIMD
-    auto buffer = surface->buf32;
-    for (uint32_t y = 0; y < surface->h; ++y, buffer += surface->stride) {
-        auto dst = buffer;
-        for (uint32_t x = 0; x < surface->w; ++x, ++dst) {
-            auto c = *dst;
-            auto a = (c >> 24);
-            *dst = (c & 0xff000000) + ((((c >> 8) & 0xff) * a) & 0xff00) + ((((c & 0x00ff00ff) * a) >> 8) & 0x00ff00ff);
-        }
-    }
-}
-
-
 bool rasterGradientShape(SwSurface* surface, SwShape* shape, unsigned id)
 {
     if (!shape->fill) return false;
@@ -1931,26 +1975,41 @@ bool rasterImage(SwSurface* surface, SwImage* image, const RenderMesh* mesh, con
     //Outside of the viewport, skip the rendering
     if (bbox.max.x < 0 || bbox.max.y < 0 || bbox.min.x >= static_cast<SwCoord>(surface->w) || bbox.min.y >= static_cast<SwCoord>(surface->h)) return true;
 
-    if (mesh && mesh->triangleCnt > 0) return _rasterTexmapPolygonMesh(surface, image, mesh, transform, &bbox, opacity);
-    else return _rasterImage(surface, image, transform, bbox, opacity);
+    if (mesh && mesh->triangleCnt > 0) {
+        //The uvs are normalized, the triangles are mapped to the mipmap level as they are to the image.
+        SwImage level;
+        Matrix levelTransform;
+        if (imageMipmap(image, transform, &level, &levelTransform)) image = &level;
+        return _rasterTexmapPolygonMesh(surface, image, mesh, transform, &bbox, opacity);
+    }
+    return _rasterImage(surface, image, transform, bbox, opacity);
 }
 
 
-bool rasterConvertCS(Surface* surface, ColorSpace to)
+bool rasterConvertCS(const Surface* source, uint32_t* dst, ColorSpace to)
 {
-    ScopedLock lock(surface->key);
-    if (surface->cs == to) return true;
+    if (source->channelSize != sizeof(uint32_t)) return false;
 
-    //TOOD: Support SIMD accelerations
-    auto from = surface->cs;
+    auto flip = _flipped(source->cs, to);
+    auto premultiply = !source->premultiplied;
 
-    if (((from == ColorSpace::ABGR8888) || (from == ColorSpace::ABGR8888S)) && ((to == ColorSpace::ARGB8888) || (to == ColorSpace::ARGB8888S))) {
-        surface->cs = to;
-        return cRasterABGRtoARGB(surface);
-    }
-    if (((from == ColorSpace::ARGB8888) || (from == ColorSpace::ARGB8888S)) && ((to == ColorSpace::ABGR8888) || (to == ColorSpace::ABGR8888S))) {
-        surface->cs = to;
-        return cRasterARGBtoABGR(surface);
+    TVGLOG("SW_ENGINE", "Convert ColorSpace %d - %d, Premultiply %d [Size: %d x %d]", source->cs, to, premultiply, source->w, source->h);
+
+    auto src = source->buf32;
+    for (uint32_t y = 0; y < source->h; ++y, src += source->stride, dst += source->w) {
+#if defined(THORVG_AVX_VECTOR_SUPPORT)
+        if (_simd == SwSimd::Avx2) avxRasterConvert(dst, src, source->w, flip, premultiply);
+        else cRasterConvert(dst, src, source->w, flip, premultiply);
+#else
+        cRasterConvert(dst, src, source->w, flip, premultiply);
+#endif
     }
-    return false;
+    return true;
+}
+
+
+bool rasterConvertible(const Surface* source, ColorSpace to)
+{
+    if (source->channelSize != sizeof(uint32_t)) return false;
+    return !source->premultiplied || _flipped(source->cs, to);
 }
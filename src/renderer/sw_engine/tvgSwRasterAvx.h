@@ -27,7 +27,7 @@
 #define N_32BITS_IN_128REG 4
 #define N_32BITS_IN_256REG 8
 
-static inline __m128i ALPHA_BLEND(__m128i c, __m128i a)
+SSE_TARGET static inline __m128i ALPHA_BLEND(__m128i c, __m128i a)
 {
     //1. set the masks for the A/G and R/B channels
     auto AG = _mm_set1_epi32(0xff00ff00);
@@ -62,7 +62,115 @@ static inline __m128i ALPHA_BLEND(__m128i c, __m128i a)
 }
 
 
-static void avxRasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32_t len)
+//The same steps as the 128 bits version with the octet registers.
+AVX_TARGET static inline __m256i ALPHA_BLEND(__m256i c, __m256i a)
+{
+    auto AG = _mm256_set1_epi32(0xff00ff00);
+    auto RB = _mm256_set1_epi32(0x00ff00ff);
+
+    auto even = _mm256_mullo_epi16(_mm256_and_si256(c, RB), _mm256_and_si256(a, RB));
+    even = _mm256_srli_epi16(_mm256_add_epi16(even, RB), 8);
+
+    auto odd = _mm256_mulhi_epu16(_mm256_and_si256(c, AG), _mm256_and_si256(a, AG));
+    odd = _mm256_and_si256(_mm256_add_epi16(odd, RB), AG);
+
+    return _mm256_or_si256(odd, even);
+}
+
+
+/************************************************************************/
+/* SSE4.1                                                               */
+/************************************************************************/
+
+SSE_TARGET static void sseRasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32_t len)
+{
+    uint32_t iterations = len / N_32BITS_IN_128REG;
+    uint32_t sseFilled = iterations * N_32BITS_IN_128REG;
+
+    dst += offset;
+
+    auto sseVal = _mm_set1_epi32(val);
+    for (uint32_t i = 0; i < iterations; ++i, dst += N_32BITS_IN_128REG) {
+        _mm_storeu_si128((__m128i*)dst, sseVal);
+    }
+
+    int32_t leftovers = len - sseFilled;
+    while (leftovers--) *dst++ = val;
+}
+
+
+SSE_TARGET static void sseRasterTranslucentSpan(uint32_t* dst, uint32_t len, uint32_t src, uint32_t ialpha)
+{
+    //1. fill the not aligned memory (for 128-bit registers a 16-bytes alignment is required)
+    auto notAligned = ((uintptr_t)dst & 0xf) / 4;
+    if (notAligned) {
+        notAligned = (N_32BITS_IN_128REG - notAligned > len ? len : N_32BITS_IN_128REG - notAligned);
+        for (uint32_t x = 0; x < notAligned; ++x, ++dst) {
+            *dst = src + ALPHA_BLEND(*dst, ialpha);
+        }
+    }
+
+    //2. fill the aligned memory - N_32BITS_IN_128REG pixels processed at once
+    uint32_t iterations = (len - notAligned) / N_32BITS_IN_128REG;
+    uint32_t sseFilled = iterations * N_32BITS_IN_128REG;
+    if (iterations > 0) {
+        auto sseSrc = _mm_set1_epi32(src);
+        auto sseIalpha = _mm_set1_epi8(ialpha);
+        auto sseDst = (__m128i*)dst;
+        for (uint32_t x = 0; x < iterations; ++x, ++sseDst) {
+            *sseDst = _mm_add_epi32(sseSrc, ALPHA_BLEND(*sseDst, sseIalpha));
+        }
+    }
+
+    //3. fill the remaining pixels
+    int32_t leftovers = len - notAligned - sseFilled;
+    dst += sseFilled;
+    while (leftovers--) {
+        *dst = src + ALPHA_BLEND(*dst, ialpha);
+        dst++;
+    }
+}
+
+
+SSE_TARGET static bool sseRasterTranslucentRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    if (surface->channelSize != sizeof(uint32_t)) return cRasterTranslucentRect(surface, region, r, g, b, a);
+
+    auto color = surface->join(r, g, b, a);
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
+    auto h = static_cast<uint32_t>(region.max.y - region.min.y);
+    auto w = static_cast<uint32_t>(region.max.x - region.min.x);
+    uint32_t ialpha = 255 - a;
+
+    for (uint32_t y = 0; y < h; ++y) {
+        sseRasterTranslucentSpan(&buffer[y * surface->stride], w, color, ialpha);
+    }
+    return true;
+}
+
+
+SSE_TARGET static bool sseRasterTranslucentRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    if (surface->channelSize != sizeof(uint32_t)) return cRasterTranslucentRle(surface, rle, r, g, b, a);
+
+    auto color = surface->join(r, g, b, a);
+    auto span = rle->spans;
+    uint32_t src;
+
+    for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+        if (span->coverage < 255) src = ALPHA_BLEND(color, span->coverage);
+        else src = color;
+        sseRasterTranslucentSpan(surface->buf32At(span->x, span->y), span->len, src, IA(src));
+    }
+    return true;
+}
+
+
+/************************************************************************/
+/* AVX2                                                                 */
+/************************************************************************/
+
+AVX_TARGET static void avxRasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32_t len)
 {
     //1. calculate how many iterations we need to cover the length
     uint32_t iterations = len / N_32BITS_IN_256REG;
@@ -72,8 +180,9 @@ static void avxRasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32
     dst += offset;
 
     //3. fill the octets
+    auto avxVal = _mm256_set1_epi32(val);
     for (uint32_t i = 0; i < iterations; ++i, dst += N_32BITS_IN_256REG) {
-        _mm256_storeu_si256((__m256i*)dst, _mm256_set1_epi32(val));
+        _mm256_storeu_si256((__m256i*)dst, avxVal);
     }
 
     //4. fill leftovers (in the first step we have to set the pointer to the place where the avx job is done)
@@ -82,110 +191,465 @@ static void avxRasterPixel32(uint32_t *dst, uint32_t val, uint32_t offset, int32
 }
 
 
-static bool avxRasterTranslucentRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+AVX_TARGET static void avxRasterTranslucentSpan(uint32_t* dst, uint32_t len, uint32_t src, uint32_t ialpha)
 {
-    if (surface->channelSize != sizeof(uint32_t)) {
-        TVGERR("SW_ENGINE", "Unsupported Channel Size = %d", surface->channelSize);
-        return false;
+    //1. N_32BITS_IN_256REG pixels processed at once, the unaligned access is cheap enough on the avx2 capable cpus
+    uint32_t iterations = len / N_32BITS_IN_256REG;
+    if (iterations > 0) {
+        auto avxSrc = _mm256_set1_epi32(src);
+        auto avxIalpha = _mm256_set1_epi8(ialpha);
+        for (uint32_t x = 0; x < iterations; ++x, dst += N_32BITS_IN_256REG) {
+            auto avxDst = _mm256_loadu_si256((__m256i*)dst);
+            _mm256_storeu_si256((__m256i*)dst, _mm256_add_epi32(avxSrc, ALPHA_BLEND(avxDst, avxIalpha)));
+        }
     }
 
+    //2. fill the remaining pixels
+    int32_t leftovers = len - iterations * N_32BITS_IN_256REG;
+    while (leftovers--) {
+        *dst = src + ALPHA_BLEND(*dst, ialpha);
+        dst++;
+    }
+}
+
+
+AVX_TARGET static bool avxRasterTranslucentRect(SwSurface* surface, const SwBBox& region, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    if (surface->channelSize != sizeof(uint32_t)) return cRasterTranslucentRect(surface, region, r, g, b, a);
+
     auto color = surface->join(r, g, b, a);
-    auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+    auto buffer = surface->buf32At(region.min.x, region.min.y);
     auto h = static_cast<uint32_t>(region.max.y - region.min.y);
     auto w = static_cast<uint32_t>(region.max.x - region.min.x);
-
     uint32_t ialpha = 255 - a;
 
-    auto avxColor = _mm_set1_epi32(color);
-    auto avxIalpha = _mm_set1_epi8(ialpha);
-
     for (uint32_t y = 0; y < h; ++y) {
-        auto dst = &buffer[y * surface->stride];
-
-        //1. fill the not aligned memory (for 128-bit registers a 16-bytes alignment is required)
-        auto notAligned = ((uintptr_t)dst & 0xf) / 4;
-        if (notAligned) {
-            notAligned = (N_32BITS_IN_128REG - notAligned > w ? w : N_32BITS_IN_128REG - notAligned);
-            for (uint32_t x = 0; x < notAligned; ++x, ++dst) {
-                *dst = color + ALPHA_BLEND(*dst, ialpha);
-            }
-        }
+        avxRasterTranslucentSpan(&buffer[y * surface->stride], w, color, ialpha);
+    }
+    return true;
+}
+
+
+//8 grayscale pixels -> 8 x 32 bits lanes
+AVX_TARGET static inline __m256i avxLoad8(const uint8_t* src)
+{
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)src));
+}
+
+
+//8 x 32 bits lanes -> 8 grayscale pixels, each lane is truncated to its low byte as the C kernels do.
+AVX_TARGET static inline void avxStore8(uint8_t* dst, __m256i v)
+{
+    auto lowBytes = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                     0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    v = _mm256_shuffle_epi8(v, lowBytes);
+    v = _mm256_permutevar8x32_epi32(v, _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1));
+    _mm_storel_epi64((__m128i*)dst, _mm256_castsi256_si128(v));
+}
+
+
+//MULTIPLY() of the 32 bits lanes holding 8 bits values
+AVX_TARGET static inline __m256i avxMultiply(__m256i c, __m256i a)
+{
+    return _mm256_srli_epi32(_mm256_add_epi32(_mm256_mullo_epi16(c, a), _mm256_set1_epi32(0xff)), 8);
+}
+
+
+//spread the 8 bits value of every 32 bits lane into its 4 bytes, as ALPHA_BLEND() requires
+AVX_TARGET static inline __m256i avxSpread(__m256i a)
+{
+    auto spread = _mm256_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12,
+                                   0, 0, 0, 0, 4, 4, 4, 4, 8, 8, 8, 8, 12, 12, 12, 12);
+    return _mm256_shuffle_epi8(a, spread);
+}
+
+
+//IA() of every pixel spread into its 4 bytes
+AVX_TARGET static inline __m256i avxSpreadIA(__m256i c)
+{
+    auto spread = _mm256_setr_epi8(3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15,
+                                   3, 3, 3, 3, 7, 7, 7, 7, 11, 11, 11, 11, 15, 15, 15, 15);
+    return _mm256_shuffle_epi8(_mm256_xor_si256(c, _mm256_set1_epi32(-1)), spread);
+}
+
+
+//The literal translation of INTERPOLATE(), the lanes wrap around identically to the 32 bits C arithmetic.
+AVX_TARGET static inline __m256i avxInterpolate(__m256i s, __m256i d, __m256i a)
+{
+    auto AG = _mm256_set1_epi32(0xff00ff00);
+    auto RB = _mm256_set1_epi32(0x00ff00ff);
+
+    auto t = _mm256_sub_epi32(_mm256_and_si256(_mm256_srli_epi32(s, 8), RB), _mm256_and_si256(_mm256_srli_epi32(d, 8), RB));
+    t = _mm256_add_epi32(_mm256_mullo_epi32(t, a), _mm256_and_si256(d, AG));
+    auto hi = _mm256_and_si256(t, AG);
+
+    t = _mm256_sub_epi32(_mm256_and_si256(s, RB), _mm256_and_si256(d, RB));
+    t = _mm256_srli_epi32(_mm256_mullo_epi32(t, a), 8);
+    auto lo = _mm256_and_si256(_mm256_add_epi32(t, _mm256_and_si256(d, RB)), RB);
+
+    return _mm256_add_epi32(hi, lo);
+}
+
+
+AVX_TARGET static void avxRasterPixel8(uint8_t *dst, uint8_t val, uint32_t offset, int32_t len)
+{
+    dst += offset;
+
+    auto avxVal = _mm256_set1_epi8(val);
+    while (len >= 32) {
+        _mm256_storeu_si256((__m256i*)dst, avxVal);
+        dst += 32;
+        len -= 32;
+    }
+    while (len-- > 0) *dst++ = val;
+}
 
-        //2. fill the aligned memory - N_32BITS_IN_128REG pixels processed at once
-        uint32_t iterations = (w - notAligned) / N_32BITS_IN_128REG;
-        uint32_t avxFilled = iterations * N_32BITS_IN_128REG;
-        auto avxDst = (__m128i*)dst;
-        for (uint32_t x = 0; x < iterations; ++x, ++avxDst) {
-            *avxDst = _mm_add_epi32(avxColor, ALPHA_BLEND(*avxDst, avxIalpha));
+
+//dst = src + MULTIPLY(dst, ialpha)
+AVX_TARGET static void avxRasterGrayscaleSpan(uint8_t* dst, uint32_t len, uint8_t src, uint8_t ialpha)
+{
+    auto x = 0U;
+    if (len >= 8) {
+        auto avxSrc = _mm256_set1_epi32(src);
+        auto avxIalpha = _mm256_set1_epi32(ialpha);
+        for (; x + 8 <= len; x += 8, dst += 8) {
+            avxStore8(dst, _mm256_add_epi32(avxSrc, avxMultiply(avxLoad8(dst), avxIalpha)));
         }
+    }
+    for (; x < len; ++x, ++dst) *dst = src + MULTIPLY(*dst, ialpha);
+}
+
+
+AVX_TARGET static bool avxRasterTranslucentRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    auto span = rle->spans;
 
-        //3. fill the remaining pixels
-        int32_t leftovers = w - notAligned - avxFilled;
-        dst += avxFilled;
-        while (leftovers--) {
-            *dst = color + ALPHA_BLEND(*dst, ialpha);
-            dst++;
+    //32bit channels
+    if (surface->channelSize == sizeof(uint32_t)) {
+        auto color = surface->join(r, g, b, a);
+        uint32_t src;
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            if (span->coverage < 255) src = ALPHA_BLEND(color, span->coverage);
+            else src = color;
+            avxRasterTranslucentSpan(surface->buf32At(span->x, span->y), span->len, src, IA(src));
+        }
+    //8bit grayscale
+    } else if (surface->channelSize == sizeof(uint8_t)) {
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            uint8_t src = (span->coverage < 255) ? MULTIPLY(span->coverage, a) : a;
+            avxRasterGrayscaleSpan(surface->buf8At(span->x, span->y), span->len, src, 255 - a);
         }
     }
     return true;
 }
 
 
-static bool avxRasterTranslucentRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+AVX_TARGET static bool avxRasterSolidRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b)
 {
-    if (surface->channelSize != sizeof(uint32_t)) {
-        TVGERR("SW_ENGINE", "Unsupported Channel Size = %d", surface->channelSize);
-        return false;
+    auto span = rle->spans;
+
+    //32bit channels
+    if (surface->channelSize == sizeof(uint32_t)) {
+        auto color = surface->join(r, g, b, 255);
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            if (span->coverage == 255) {
+                avxRasterPixel32(surface->buf32At(span->x, span->y), color, 0, span->len);
+            } else {
+                auto dst = surface->buf32At(span->x, span->y);
+                avxRasterTranslucentSpan(dst, span->len, ALPHA_BLEND(color, span->coverage), 255 - span->coverage);
+            }
+        }
+    //8bit grayscale
+    } else if (surface->channelSize == sizeof(uint8_t)) {
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            if (span->coverage == 255) {
+                avxRasterPixel8(surface->buf8At(span->x, span->y), span->coverage, 0, span->len);
+            } else {
+                auto dst = surface->buf8At(span->x, span->y);
+                avxRasterGrayscaleSpan(dst, span->len, span->coverage, 255 - span->coverage);
+            }
+        }
     }
+    return true;
+}
 
-    auto color = surface->join(r, g, b, a);
-    auto span = rle->spans;
-    uint32_t src;
 
-    for (uint32_t i = 0; i < rle->size; ++i) {
-        auto dst = &surface->buf32[span->y * surface->stride + span->x];
+//The vectorized _opMaskXXX(), see tvgSwRaster.cpp
+template<CompositeMethod METHOD>
+AVX_TARGET static inline __m256i avxMaskOp(__m256i s, __m256i d, __m256i a)
+{
+    auto inv = _mm256_set1_epi32(0xff);
+    if (METHOD == CompositeMethod::AddMask) return _mm256_add_epi32(s, avxMultiply(d, a));
+    if (METHOD == CompositeMethod::SubtractMask) return avxMultiply(s, _mm256_sub_epi32(inv, d));
+    if (METHOD == CompositeMethod::IntersectMask) return avxMultiply(s, d);
+    //DifferenceMask
+    return _mm256_add_epi32(avxMultiply(s, _mm256_sub_epi32(inv, d)), avxMultiply(d, a));
+}
 
-        if (span->coverage < 255) src = ALPHA_BLEND(color, span->coverage);
-        else src = color;
 
-	auto ialpha = IA(src);
+template<CompositeMethod METHOD>
+AVX_TARGET static void avxCompositeMaskedRle(SwSurface* surface, const SwRleData* rle, SwMask maskOp, uint8_t a)
+{
+    auto span = rle->spans;
 
-        //1. fill the not aligned memory (for 128-bit registers a 16-bytes alignment is required)
-        auto notAligned = ((uintptr_t)dst & 0xf) / 4;
-        if (notAligned) {
-            notAligned = (N_32BITS_IN_128REG - notAligned > span->len ? span->len : N_32BITS_IN_128REG - notAligned);
-            for (uint32_t x = 0; x < notAligned; ++x, ++dst) {
-                *dst = src + ALPHA_BLEND(*dst, ialpha);
+    for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        uint8_t src = (span->coverage == 255) ? a : MULTIPLY(a, span->coverage);
+        uint8_t ialpha = 255 - src;
+        auto x = 0;
+        if (span->len >= 8) {
+            auto avxSrc = _mm256_set1_epi32(src);
+            auto avxIalpha = _mm256_set1_epi32(ialpha);
+            for (; x + 8 <= span->len; x += 8, cmp += 8) {
+                avxStore8(cmp, avxMaskOp<METHOD>(avxSrc, avxLoad8(cmp), avxIalpha));
             }
         }
+        for (; x < span->len; ++x, ++cmp) {
+            *cmp = maskOp(src, *cmp, ialpha);
+        }
+    }
+}
 
-        //2. fill the aligned memory using avx - N_32BITS_IN_128REG pixels processed at once
-        //In order to avoid unneccessary avx variables declarations a check is made whether there are any iterations at all
-        uint32_t iterations = (span->len - notAligned) / N_32BITS_IN_128REG;
-        uint32_t avxFilled = 0;
-        if (iterations > 0) {
-            auto avxSrc = _mm_set1_epi32(src);
-            auto avxIalpha = _mm_set1_epi8(ialpha);
 
-            avxFilled = iterations * N_32BITS_IN_128REG;
-            auto avxDst = (__m128i*)dst;
-            for (uint32_t x = 0; x < iterations; ++x, ++avxDst) {
-                *avxDst = _mm_add_epi32(avxSrc, ALPHA_BLEND(*avxDst, avxIalpha));
+template<CompositeMethod METHOD>
+AVX_TARGET static void avxDirectMaskedRle(SwSurface* surface, const SwRleData* rle, SwMask maskOp, uint8_t a)
+{
+    auto span = rle->spans;
+    auto zero = _mm256_setzero_si256();
+    auto mask = _mm256_set1_epi32(0xff);
+
+    for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+        auto cmp = surface->compositor->image.buf8At(span->x, span->y);
+        auto dst = surface->buf8At(span->x, span->y);
+        uint8_t src = (span->coverage == 255) ? a : MULTIPLY(a, span->coverage);
+        auto x = 0;
+        if (span->len >= 8) {
+            auto avxSrc = _mm256_set1_epi32(src);
+            for (; x + 8 <= span->len; x += 8, cmp += 8, dst += 8) {
+                auto tmp = _mm256_and_si256(avxMaskOp<METHOD>(avxSrc, avxLoad8(cmp), zero), mask);
+                avxStore8(dst, _mm256_add_epi32(tmp, avxMultiply(avxLoad8(dst), _mm256_xor_si256(tmp, mask))));
             }
         }
+        for (; x < span->len; ++x, ++cmp, ++dst) {
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+    }
+}
 
-        //3. fill the remaining pixels
-        int32_t leftovers = span->len - notAligned - avxFilled;
-        dst += avxFilled;
-        while (leftovers--) {
-            *dst = src + ALPHA_BLEND(*dst, ialpha);
-            dst++;
+
+AVX_TARGET static bool avxRasterMaskedRle(SwSurface* surface, const SwRleData* rle, SwMask maskOp, uint8_t a)
+{
+    switch (surface->compositor->method) {
+        case CompositeMethod::AddMask: avxCompositeMaskedRle<CompositeMethod::AddMask>(surface, rle, maskOp, a); break;
+        case CompositeMethod::DifferenceMask: avxCompositeMaskedRle<CompositeMethod::DifferenceMask>(surface, rle, maskOp, a); break;
+        case CompositeMethod::SubtractMask: avxDirectMaskedRle<CompositeMethod::SubtractMask>(surface, rle, maskOp, a); return true;
+        case CompositeMethod::IntersectMask: avxDirectMaskedRle<CompositeMethod::IntersectMask>(surface, rle, maskOp, a); return true;
+        default: return false;
+    }
+    return _compositeMaskImage(surface, &surface->compositor->image, surface->compositor->bbox);
+}
+
+
+//The matting alpha values of 8 pixels in the 32 bits lanes, see SwSurface::alpha()
+struct AvxMatte
+{
+    SwAlpha alpha;
+    uint8_t csize;
+    enum : uint8_t {Any = 0, Alpha, ArgbLuma, AbgrLuma} type = Any;
+    bool invert = false;
+
+    AvxMatte(SwAlpha alpha, uint8_t csize) : alpha(alpha), csize(csize)
+    {
+        if (alpha == _alpha || alpha == _ialpha) {
+            type = Alpha;
+            invert = (alpha == _ialpha);
+        } else if (csize == sizeof(uint32_t)) {
+            if (alpha == _argbLuma || alpha == _argbInvLuma) type = ArgbLuma;
+            else if (alpha == _abgrLuma || alpha == _abgrInvLuma) type = AbgrLuma;
+            invert = (alpha == _argbInvLuma || alpha == _abgrInvLuma);
+        }
+    }
+
+    AVX_TARGET __m256i operator()(uint8_t* cmp) const
+    {
+        __m256i ret;
+        auto mask = _mm256_set1_epi32(0xff);
+        if (type == Alpha) {
+            if (csize == sizeof(uint8_t)) ret = avxLoad8(cmp);
+            else ret = _mm256_and_si256(_mm256_loadu_si256((__m256i*)cmp), mask);
+        } else if (type == ArgbLuma || type == AbgrLuma) {
+            auto c = _mm256_loadu_si256((__m256i*)cmp);
+            auto w0 = _mm256_set1_epi32(type == ArgbLuma ? 19 : 54);
+            auto w2 = _mm256_set1_epi32(type == ArgbLuma ? 54 : 19);
+            auto t = _mm256_mullo_epi16(_mm256_and_si256(c, mask), w0);
+            t = _mm256_add_epi32(t, _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(c, 8), mask), _mm256_set1_epi32(183)));
+            t = _mm256_add_epi32(t, _mm256_mullo_epi16(_mm256_and_si256(_mm256_srli_epi32(c, 16), mask), w2));
+            ret = _mm256_srli_epi32(t, 8);
+        } else {
+            alignas(32) uint32_t tmp[8];
+            for (int i = 0; i < 8; ++i, cmp += csize) tmp[i] = alpha(cmp);
+            return _mm256_load_si256((__m256i*)tmp);
         }
+        if (invert) ret = _mm256_xor_si256(ret, mask);
+        return ret;
+    }
+};
+
 
-        ++span;
+AVX_TARGET static bool avxRasterMattedRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+{
+    auto span = rle->spans;
+    auto csize = surface->compositor->image.channelSize;
+    auto alpha = surface->alpha(surface->compositor->method);
+    AvxMatte matte(alpha, csize);
+
+    //32bit channels
+    if (surface->channelSize == sizeof(uint32_t)) {
+        uint32_t src;
+        auto color = surface->join(r, g, b, a);
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            auto dst = surface->buf32At(span->x, span->y);
+            auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
+            if (span->coverage == 255) src = color;
+            else src = ALPHA_BLEND(color, span->coverage);
+            auto x = 0U;
+            if (span->len >= 8) {
+                auto avxSrc = _mm256_set1_epi32(src);
+                for (; x + 8 <= span->len; x += 8, dst += 8, cmp += 8 * csize) {
+                    auto tmp = ALPHA_BLEND(avxSrc, avxSpread(matte(cmp)));
+                    auto d = _mm256_loadu_si256((__m256i*)dst);
+                    _mm256_storeu_si256((__m256i*)dst, _mm256_add_epi32(tmp, ALPHA_BLEND(d, avxSpreadIA(tmp))));
+                }
+            }
+            for (; x < span->len; ++x, ++dst, cmp += csize) {
+                auto tmp = ALPHA_BLEND(src, alpha(cmp));
+                *dst = tmp + ALPHA_BLEND(*dst, IA(tmp));
+            }
+        }
+        return true;
+    }
+    //8bit grayscale
+    if (surface->channelSize == sizeof(uint8_t)) {
+        uint8_t src;
+        for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+            auto dst = surface->buf8At(span->x, span->y);
+            auto cmp = surface->compositor->image.pixelAt(span->x, span->y);
+            if (span->coverage == 255) src = a;
+            else src = MULTIPLY(a, span->coverage);
+            auto x = 0U;
+            if (span->len >= 8) {
+                auto avxSrc = _mm256_set1_epi32(src);
+                auto one = _mm256_set1_epi32(1);
+                auto round = _mm256_set1_epi32(0xff);
+                for (; x + 8 <= span->len; x += 8, dst += 8, cmp += 8 * csize) {
+                    //INTERPOLATE8(): d * ~a is evaluated in the signed int arithmetic
+                    auto m = matte(cmp);
+                    auto t = _mm256_sub_epi32(_mm256_setzero_si256(), _mm256_add_epi32(m, one));
+                    t = _mm256_srai_epi32(_mm256_add_epi32(_mm256_mullo_epi32(avxLoad8(dst), t), round), 8);
+                    avxStore8(dst, _mm256_add_epi32(avxMultiply(avxSrc, m), t));
+                }
+            }
+            for (; x < span->len; ++x, ++dst, cmp += csize) {
+                *dst = INTERPOLATE8(src, *dst, alpha(cmp));
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+
+//The blenders remain scalar, the coverage is applied on 8 pixels at once.
+template<typename Blender>
+AVX_TARGET static bool avxRasterBlendingRle(SwSurface* surface, const SwRleData* rle, uint8_t r, uint8_t g, uint8_t b, uint8_t a, Blender blender)
+{
+    if (surface->channelSize != sizeof(uint32_t)) return false;
+
+    auto span = rle->spans;
+    auto color = surface->join(r, g, b, a);
+    auto ialpha = 255 - a;
+    alignas(32) uint32_t tmp[8];
+
+    for (uint32_t i = 0; i < rle->size; ++i, ++span) {
+        auto dst = surface->buf32At(span->x, span->y);
+        if (span->coverage == 255) {
+            for (uint32_t x = 0; x < span->len; ++x, ++dst) {
+                *dst = blender(color, *dst, ialpha);
+            }
+        } else {
+            auto x = 0U;
+            auto coverage = _mm256_set1_epi32(span->coverage);
+            for (; x + 8 <= span->len; x += 8, dst += 8) {
+                for (int j = 0; j < 8; ++j) tmp[j] = blender(color, dst[j], ialpha);
+                auto d = _mm256_loadu_si256((__m256i*)dst);
+                _mm256_storeu_si256((__m256i*)dst, avxInterpolate(_mm256_load_si256((__m256i*)tmp), d, coverage));
+            }
+            for (; x < span->len; ++x, ++dst) {
+                auto t = blender(color, *dst, ialpha);
+                *dst = INTERPOLATE(t, *dst, span->coverage);
+            }
+        }
     }
     return true;
 }
 
 
+AVX_TARGET static void avxRasterConvert(uint32_t* dst, const uint32_t* src, uint32_t len, bool flip, bool premultiply)
+{
+    auto swap = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                                 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+    auto A = _mm256_set1_epi32(0xff000000);
+    auto G = _mm256_set1_epi32(0x0000ff00);
+    auto RB = _mm256_set1_epi32(0x00ff00ff);
+
+    auto x = 0U;
+    for (; x + N_32BITS_IN_256REG <= len; x += N_32BITS_IN_256REG) {
+        auto c = _mm256_loadu_si256((__m256i*)(src + x));
+        if (flip) c = _mm256_shuffle_epi8(c, swap);
+        if (premultiply) {
+            auto a = _mm256_srli_epi32(c, 24);
+            auto g = _mm256_and_si256(_mm256_mullo_epi32(_mm256_and_si256(c, G), a), _mm256_set1_epi32(0x00ff0000));
+            auto rb = _mm256_and_si256(_mm256_srli_epi32(_mm256_mullo_epi32(_mm256_and_si256(c, RB), a), 8), RB);
+            c = _mm256_add_epi32(_mm256_and_si256(c, A), _mm256_add_epi32(_mm256_srli_epi32(g, 8), rb));
+        }
+        _mm256_storeu_si256((__m256i*)(dst + x), c);
+    }
+    cRasterConvert(dst + x, src + x, len - x, flip, premultiply);
+}
+
+
+/************************************************************************/
+/* CPU Detection                                                        */
+/************************************************************************/
+
+#if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+#endif
+
+static SwSimd avxDetect()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    auto ids = info[0];
+    __cpuid(info, 1);
+    auto sse41 = (info[2] & (1 << 19)) != 0;
+    //avx registers must be enabled by the os as well (osxsave + xgetbv)
+    auto avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+    auto avx2 = false;
+    if (avx && ids >= 7) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if (avx2) return SwSimd::Avx2;
+    if (sse41) return SwSimd::Sse41;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SwSimd::Avx2;
+    if (__builtin_cpu_supports("sse4.1")) return SwSimd::Sse41;
+#endif
+    return SwSimd::None;
+}
+
 #endif
@@ -69,7 +69,7 @@ static bool inline cRasterTranslucentRle(SwSurface* surface, const SwRleData* rl
         auto color = surface->join(r, g, b, a);
         uint32_t src;
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf32[span->y * surface->stride + span->x];
+            auto dst = surface->buf32At(span->x, span->y);
             if (span->coverage < 255) src = ALPHA_BLEND(color, span->coverage);
             else src = color;
             auto ialpha = IA(src);
@@ -81,7 +81,7 @@ static bool inline cRasterTranslucentRle(SwSurface* surface, const SwRleData* rl
     } else if (surface->channelSize == sizeof(uint8_t)) {
         uint8_t src;
         for (uint32_t i = 0; i < rle->size; ++i, ++span) {
-            auto dst = &surface->buf8[span->y * surface->stride + span->x];
+            auto dst = surface->buf8At(span->x, span->y);
             if (span->coverage < 255) src = MULTIPLY(span->coverage, a);
             else src = a;
             auto ialpha = ~a;
@@ -102,7 +102,7 @@ static bool inline cRasterTranslucentRect(SwSurface* surface, const SwBBox& regi
     //32bits channels
     if (surface->channelSize == sizeof(uint32_t)) {
         auto color = surface->join(r, g, b, a);
-        auto buffer = surface->buf32 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf32At(region.min.x, region.min.y);
         auto ialpha = 255 - a;
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = &buffer[y * surface->stride];
@@ -112,7 +112,7 @@ static bool inline cRasterTranslucentRect(SwSurface* surface, const SwBBox& regi
         }
     //8bit grayscale
     } else if (surface->channelSize == sizeof(uint8_t)) {
-        auto buffer = surface->buf8 + (region.min.y * surface->stride) + region.min.x;
+        auto buffer = surface->buf8At(region.min.x, region.min.y);
         auto ialpha = ~a;
         for (uint32_t y = 0; y < h; ++y) {
             auto dst = &buffer[y * surface->stride];
@@ -125,39 +125,16 @@ static bool inline cRasterTranslucentRect(SwSurface* surface, const SwBBox& regi
 }
 
 
-static bool inline cRasterABGRtoARGB(Surface* surface)
+static void inline cRasterConvert(uint32_t* dst, const uint32_t* src, uint32_t len, bool flip, bool premultiply)
 {
-    TVGLOG("SW_ENGINE", "Convert ColorSpace ABGR - ARGB [Size: %d x %d]", surface->w, surface->h);
-
-    //64bits faster converting
-    if (surface->w % 2 == 0) {
-        auto buffer = reinterpret_cast<uint64_t*>(surface->buf32);
-        for (uint32_t y = 0; y < surface->h; ++y, buffer += surface->stride / 2) {
-            auto dst = buffer;
-            for (uint32_t x = 0; x < surface->w / 2; ++x, ++dst) {
-                auto c = *dst;
-                //flip Blue, Red channels
-                *dst = (c & 0xff000000ff000000) + ((c & 0x00ff000000ff0000) >> 16) + (c & 0x0000ff000000ff00) + ((c & 0x000000ff000000ff) << 16);
-            }
-        }
-    //default converting
-    } else {
-        auto buffer = surface->buf32;
-        for (uint32_t y = 0; y < surface->h; ++y, buffer += surface->stride) {
-            auto dst = buffer;
-            for (uint32_t x = 0; x < surface->w; ++x, ++dst) {
-                auto c = *dst;
-                //flip Blue, Red channels
-                *dst = (c & 0xff000000) + ((c & 0x00ff0000) >> 16) + (c & 0x0000ff00) + ((c & 0x000000ff) << 16);
-            }
+    for (uint32_t x = 0; x < len; ++x) {
+        auto c = src[x];
+        //flip Blue, Red channels
+        if (flip) c = (c & 0xff000000) + ((c & 0x00ff0000) >> 16) + (c & 0x0000ff00) + ((c & 0x000000ff) << 16);
+        if (premultiply) {
+            auto a = (c >> 24);
+            c = (c & 0xff000000) + ((((c >> 8) & 0xff) * a) & 0xff00) + ((((c & 0x00ff00ff) * a) >> 8) & 0x00ff00ff);
         }
+        dst[x] = c;
     }
-    return true;
-}
-
-
-static bool inline cRasterARGBtoABGR(Surface* surface)
-{
-    //exactly same with ABGRtoARGB
-    return cRasterABGRtoARGB(surface);
 }
\ No newline at end of file
@@ -0,0 +1,768 @@
+/*
+ * Copyright (c) 2020 - 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#define RADIAL_A_THRESHOLD 0.0005f
+#define FIXPT_BITS 8
+#define FIXPT_SIZE (1<<FIXPT_BITS)
+#define FILL_ANCHOR 32   //the radial coefficients are evaluated again at every anchor of a row, must be power of 2
+
+/* A gradient color depends on the pixel position only, not on where its span starts.
+   Thus the spans clipped by the damaged regions are identical to the whole ones. */
+
+/*
+ * quadratic equation with the following coefficients (rx and ry defined in the _calculateCoefficients()):
+ * A = a  // fill->radial.a
+ * B = 2 * (dr * fr + rx * dx + ry * dy)
+ * C = fr^2 - rx^2 - ry^2
+ * Derivatives are computed with respect to dx.
+ * This procedure aims to optimize and eliminate the need to calculate all values from the beginning
+ * for consecutive x values with a constant y. The Taylor series expansions are computed as long as
+ * its terms are non-zero.
+ */
+static void _calculateCoefficients(const SwFill* fill, uint32_t x, uint32_t y, float& b, float& deltaB, float& det, float& deltaDet, float& deltaDeltaDet)
+{
+    auto radial = &fill->radial;
+
+    auto rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
+    auto ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
+
+    b = (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy) * radial->invA;
+    deltaB = (radial->a11 * radial->dx + radial->a21 * radial->dy) * radial->invA;
+
+    auto rr = rx * rx + ry * ry;
+    auto deltaRr = 2.0f * (rx * radial->a11 + ry * radial->a21) * radial->invA;
+    auto deltaDeltaRr = 2.0f * (radial->a11 * radial->a11 + radial->a21 * radial->a21) * radial->invA;
+
+    det = b * b + (rr - radial->fr * radial->fr) * radial->invA;
+    deltaDet = 2.0f * b * deltaB + deltaB * deltaB + deltaRr + deltaDeltaRr;
+    deltaDeltaDet = 2.0f * deltaB * deltaB + deltaDeltaRr;
+}
+
+
+//the position of the linear gradient at the beginning of the row, t(x) = base + x * inc
+static float _linearBase(const SwFill* fill, uint32_t y, float& inc)
+{
+    inc = fill->linear.dx * (fill->ctable->size - 1);
+    return (fill->linear.dx * 0.5f + fill->linear.dy * (y + 0.5f) + fill->linear.offset) * (fill->ctable->size - 1);
+}
+
+
+static inline uint32_t _clamp(const SwFill* fill, int32_t pos)
+{
+    auto size = static_cast<int32_t>(fill->ctable->size);
+
+    switch (fill->spread) {
+        case FillSpread::Pad: {
+            if (pos >= size) pos = size - 1;
+            else if (pos < 0) pos = 0;
+            break;
+        }
+        case FillSpread::Repeat: {
+            pos = pos % size;
+            if (pos < 0) pos = size + pos;
+            break;
+        }
+        case FillSpread::Reflect: {
+            auto limit = size * 2;
+            pos = pos % limit;
+            if (pos < 0) pos = limit + pos;
+            if (pos >= size) pos = (limit - pos - 1);
+            break;
+        }
+    }
+    return pos;
+}
+
+
+static inline uint32_t _fixedPixel(const SwFill* fill, int32_t pos)
+{
+    int32_t i = (pos + (FIXPT_SIZE / 2)) >> FIXPT_BITS;
+    return fill->ctable->colors[_clamp(fill, i)];
+}
+
+
+static inline uint32_t _pixel(const SwFill* fill, float pos)
+{
+    auto i = static_cast<int32_t>(pos * (fill->ctable->size - 1) + 0.5f);
+    return fill->ctable->colors[_clamp(fill, i)];
+}
+
+
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+
+#include <immintrin.h>
+
+#define FILL_CHUNK 32   //the gradient colors generated at once, the multiple of 8
+
+//_clamp() of 8 positions, the modulo of the power of two table size is the bit mask.
+AVX_TARGET static inline __m256i _avxClamp(const SwFill* fill, __m256i pos)
+{
+    switch (fill->spread) {
+        case FillSpread::Pad: {
+            return _mm256_min_epi32(_mm256_max_epi32(pos, _mm256_setzero_si256()), _mm256_set1_epi32(fill->ctable->size - 1));
+        }
+        case FillSpread::Repeat: {
+            return _mm256_and_si256(pos, _mm256_set1_epi32(fill->ctable->size - 1));
+        }
+        default: {
+            auto limit = _mm256_set1_epi32(fill->ctable->size * 2 - 1);
+            pos = _mm256_and_si256(pos, limit);
+            return _mm256_min_epi32(pos, _mm256_sub_epi32(limit, pos));
+        }
+    }
+}
+
+
+//_fixedPixel() of the positions t, t + inc, t + inc * 2, ...
+AVX_TARGET static void _avxFixedPixels(const SwFill* fill, int32_t t, int32_t inc, uint32_t* dst, uint32_t cnt)
+{
+    auto pos = _mm256_add_epi32(_mm256_set1_epi32(t), _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(inc)));
+    auto step = _mm256_slli_epi32(_mm256_set1_epi32(inc), 3);
+    auto half = _mm256_set1_epi32(FIXPT_SIZE / 2);
+
+    for (uint32_t i = 0; i < cnt; i += 8, dst += 8) {
+        auto idx = _avxClamp(fill, _mm256_srai_epi32(_mm256_add_epi32(pos, half), FIXPT_BITS));
+        _mm256_storeu_si256((__m256i*)dst, _mm256_i32gather_epi32((const int*)fill->ctable->colors, idx, 4));
+        pos = _mm256_add_epi32(pos, step);
+    }
+}
+
+
+//_pixel() of 8 positions
+AVX_TARGET static inline void _avxPixels(const SwFill* fill, __m256 pos, uint32_t* dst)
+{
+    auto idx = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(pos, _mm256_set1_ps(fill->ctable->size - 1)), _mm256_set1_ps(0.5f)));
+    _mm256_storeu_si256((__m256i*)dst, _mm256_i32gather_epi32((const int*)fill->ctable->colors, _avxClamp(fill, idx), 4));
+}
+
+
+//sqrtf(det) - b, the sqrt is exact thus the result is identical to the scalar code.
+AVX_TARGET static void _avxRadialPixels(const SwFill* fill, const float* det, const float* b, uint32_t* dst, uint32_t cnt)
+{
+    for (uint32_t i = 0; i < cnt; i += 8) {
+        auto pos = _mm256_sub_ps(_mm256_sqrt_ps(_mm256_loadu_ps(det + i)), _mm256_loadu_ps(b + i));
+        _avxPixels(fill, pos, dst + i);
+    }
+}
+
+
+//x0 of the radial edge case, evaluated in the same order as the scalar code.
+AVX_TARGET static void _avxRadialEdgePixels(const SwFill* fill, const float* rx, const float* ry, uint32_t* dst, uint32_t cnt)
+{
+    auto radial = &fill->radial;
+    auto fr2 = _mm256_set1_ps(radial->fr * radial->fr);
+    auto drfr = _mm256_set1_ps(radial->dr * radial->fr);
+    auto dx = _mm256_set1_ps(radial->dx);
+    auto dy = _mm256_set1_ps(radial->dy);
+    auto half = _mm256_set1_ps(0.5f);
+
+    for (uint32_t i = 0; i < cnt; i += 8) {
+        auto x = _mm256_loadu_ps(rx + i);
+        auto y = _mm256_loadu_ps(ry + i);
+        auto n = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(x, x), _mm256_mul_ps(y, y)), fr2);
+        auto d = _mm256_add_ps(_mm256_add_ps(drfr, _mm256_mul_ps(x, dx)), _mm256_mul_ps(y, dy));
+        _avxPixels(fill, _mm256_div_ps(_mm256_mul_ps(half, n), d), dst + i);
+    }
+}
+
+#endif
+
+
+/* The gradient colors along a span. With the avx2 kernels, the colors are generated
+   in advance by the chunks, otherwise one by one. */
+struct FillPixels
+{
+    const SwFill* fill;
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+    uint32_t colors[FILL_CHUNK];
+    uint32_t idx = 0, cnt = 0;
+    uint32_t remains;
+    bool simd;
+
+    FillPixels(const SwFill* fill, uint32_t len) : fill(fill), remains(len)
+    {
+        simd = (rasterSimd() == SwSimd::Avx2);
+    }
+
+    //the number of the colors to generate, rounded up to the simd width
+    uint32_t chunk()
+    {
+        auto cnt = remains < FILL_CHUNK ? remains : FILL_CHUNK;
+        remains -= cnt;
+        if (cnt == 0) cnt = 1;
+        return (cnt + 7) & ~7;
+    }
+#else
+    FillPixels(const SwFill* fill, TVG_UNUSED uint32_t len) : fill(fill) {}
+#endif
+};
+
+
+//linear gradient in the fixed point math
+struct FillLinearPixels : FillPixels
+{
+    int32_t t, inc;
+
+    //the fixed point steps are exact, they start from the row base in the wrap around math.
+    FillLinearPixels(const SwFill* fill, float base, float inc, uint32_t x, uint32_t len) : FillPixels(fill, len)
+    {
+        this->inc = static_cast<int32_t>(inc * FIXPT_SIZE);
+        this->t = static_cast<int32_t>(static_cast<uint32_t>(static_cast<int64_t>(base * FIXPT_SIZE)) + static_cast<uint32_t>(this->inc) * x);
+    }
+
+    uint32_t next()
+    {
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+        if (simd) {
+            if (idx == cnt) {
+                cnt = chunk();
+                _avxFixedPixels(fill, t, inc, colors, cnt);
+                t = static_cast<int32_t>(static_cast<uint32_t>(t) + static_cast<uint32_t>(inc) * cnt);
+                idx = 0;
+            }
+            return colors[idx++];
+        }
+#endif
+        auto ret = _fixedPixel(fill, t);
+        t += inc;
+        return ret;
+    }
+};
+
+
+struct FillRadialPixels : FillPixels
+{
+    float b, deltaB, det, deltaDet, deltaDeltaDet;
+    uint32_t x, y;
+
+    //starts at the anchor before x
+    FillRadialPixels(const SwFill* fill, uint32_t x, uint32_t y, uint32_t len) : FillPixels(fill, len), x(x & ~(FILL_ANCHOR - 1)), y(y)
+    {
+        _calculateCoefficients(fill, this->x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
+        while (this->x < x) step();
+    }
+
+    void step()
+    {
+        if ((++x & (FILL_ANCHOR - 1)) == 0) {
+            _calculateCoefficients(fill, x, y, b, deltaB, det, deltaDet, deltaDeltaDet);
+            return;
+        }
+        det += deltaDet;
+        deltaDet += deltaDeltaDet;
+        b += deltaB;
+    }
+
+    uint32_t next()
+    {
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+        if (simd) {
+            if (idx == cnt) {
+                float dets[FILL_CHUNK], bs[FILL_CHUNK];
+                cnt = chunk();
+                for (uint32_t i = 0; i < cnt; ++i) {
+                    dets[i] = det;
+                    bs[i] = b;
+                    step();
+                }
+                _avxRadialPixels(fill, dets, bs, colors, cnt);
+                idx = 0;
+            }
+            return colors[idx++];
+        }
+#endif
+        auto ret = _pixel(fill, sqrtf(det) - b);
+        step();
+        return ret;
+    }
+};
+
+
+//radial gradient of the edge case (radial.a < RADIAL_A_THRESHOLD)
+struct FillRadialEdgePixels : FillPixels
+{
+    float rx, ry;
+    uint32_t x, y;
+
+    //starts at the anchor before x
+    FillRadialEdgePixels(const SwFill* fill, uint32_t x, uint32_t y, uint32_t len) : FillPixels(fill, len), x(x & ~(FILL_ANCHOR - 1)), y(y)
+    {
+        anchor();
+        while (this->x < x) step();
+    }
+
+    void anchor()
+    {
+        auto radial = &fill->radial;
+        rx = (x + 0.5f) * radial->a11 + (y + 0.5f) * radial->a12 + radial->a13 - radial->fx;
+        ry = (x + 0.5f) * radial->a21 + (y + 0.5f) * radial->a22 + radial->a23 - radial->fy;
+    }
+
+    void step()
+    {
+        if ((++x & (FILL_ANCHOR - 1)) == 0) {
+            anchor();
+            return;
+        }
+        rx += fill->radial.a11;
+        ry += fill->radial.a21;
+    }
+
+    uint32_t next()
+    {
+        auto radial = &fill->radial;
+#ifdef THORVG_AVX_VECTOR_SUPPORT
+        if (simd) {
+            if (idx == cnt) {
+                float rxs[FILL_CHUNK], rys[FILL_CHUNK];
+                cnt = chunk();
+                for (uint32_t i = 0; i < cnt; ++i) {
+                    rxs[i] = rx;
+                    rys[i] = ry;
+                    step();
+                }
+                _avxRadialEdgePixels(fill, rxs, rys, colors, cnt);
+                idx = 0;
+            }
+            return colors[idx++];
+        }
+#endif
+        auto x0 = 0.5f * (rx * rx + ry * ry - radial->fr * radial->fr) / (radial->dr * radial->fr + rx * radial->dx + ry * radial->dy);
+        step();
+        return _pixel(fill, x0);
+    }
+};
+
+
+/* The span kernels of the gradients. Like the other raster kernels, they are templates over the blending,
+   matting and masking operations which are resolved once per draw call (see _blendingKernel()). */
+
+template<typename Alpha>
+static void _fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, Alpha alpha, uint8_t csize, uint8_t opacity)
+{
+    //edge case
+    if (fill->radial.a < RADIAL_A_THRESHOLD) {
+        FillRadialEdgePixels pixels(fill, x, y, len);
+
+        if (opacity == 255) {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, alpha(cmp));
+            }
+        } else {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, MULTIPLY(opacity, alpha(cmp)));
+            }
+        }
+    } else {
+        FillRadialPixels pixels(fill, x, y, len);
+
+        if (opacity == 255) {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, alpha(cmp));
+            }
+        } else {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, MULTIPLY(opacity, alpha(cmp)));
+            }
+        }
+    }
+}
+
+
+template<typename Blender>
+static void _fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, Blender op, uint8_t a)
+{
+    if (fill->radial.a < RADIAL_A_THRESHOLD) {
+        FillRadialEdgePixels pixels(fill, x, y, len);
+        for (uint32_t i = 0; i < len; ++i, ++dst) {
+            *dst = op(pixels.next(), *dst, a);
+        }
+    } else {
+        FillRadialPixels pixels(fill, x, y, len);
+
+        for (uint32_t i = 0; i < len; ++i, ++dst) {
+            *dst = op(pixels.next(), *dst, a);
+        }
+    }
+}
+
+
+template<typename MaskOp>
+static void _fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, MaskOp maskOp, uint8_t a)
+{
+    if (fill->radial.a < RADIAL_A_THRESHOLD) {
+        FillRadialEdgePixels pixels(fill, x, y, len);
+        for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
+            auto src = MULTIPLY(a, A(pixels.next()));
+            *dst = maskOp(src, *dst, ~src);
+        }
+    } else {
+        FillRadialPixels pixels(fill, x, y, len);
+
+        for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
+            auto src = MULTIPLY(a, A(pixels.next()));
+            *dst = maskOp(src, *dst, ~src);
+        }
+    }
+}
+
+
+template<typename MaskOp>
+static void _fillRadial(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, MaskOp maskOp, uint8_t a)
+{
+    if (fill->radial.a < RADIAL_A_THRESHOLD) {
+        FillRadialEdgePixels pixels(fill, x, y, len);
+        for (uint32_t i = 0 ; i < len ; ++i, ++dst, ++cmp) {
+            auto src = MULTIPLY(A(A(pixels.next())), a);
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+    } else {
+        FillRadialPixels pixels(fill, x, y, len);
+
+        for (uint32_t i = 0 ; i < len ; ++i, ++dst, ++cmp) {
+            auto src = MULTIPLY(A(pixels.next()), a);
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+    }
+}
+
+
+template<typename Blender, typename Blender2>
+static void _fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, Blender op, Blender2 op2, uint8_t a)
+{
+    if (fill->radial.a < RADIAL_A_THRESHOLD) {
+        FillRadialEdgePixels pixels(fill, x, y, len);
+
+        if (a == 255) {
+            for (uint32_t i = 0; i < len; ++i, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                *dst = op2(tmp, *dst, 255);
+            }
+        } else {
+            for (uint32_t i = 0; i < len; ++i, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                auto tmp2 = op2(tmp, *dst, 255);
+                *dst = INTERPOLATE(tmp2, *dst, a);
+            }
+        }
+    } else {
+        FillRadialPixels pixels(fill, x, y, len);
+        if (a == 255) {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                *dst = op2(tmp, *dst, 255);
+            }
+        } else {
+            for (uint32_t i = 0 ; i < len ; ++i, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                auto tmp2 = op2(tmp, *dst, 255);
+                *dst = INTERPOLATE(tmp2, *dst, a);
+            }
+        }
+    }
+}
+
+
+template<typename Alpha>
+static void _fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, Alpha alpha, uint8_t csize, uint8_t opacity)
+{
+    //Rotation
+    float inc;
+    auto base = _linearBase(fill, y, inc);
+    auto t = base + x * inc;
+
+    if (opacity == 255) {
+        if (mathZero(inc)) {
+            auto color = _fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE));
+            for (uint32_t i = 0; i < len; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(color, *dst, alpha(cmp));
+            }
+            return;
+        }
+
+        auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+        auto vMin = -vMax;
+        auto v = t + (inc * len);
+
+        //we can use fixed point math
+        if (v < vMax && v > vMin) {
+            FillLinearPixels pixels(fill, base, inc, x, len);
+            for (uint32_t j = 0; j < len; ++j, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, alpha(cmp));
+            }
+        //we have to fallback to float math
+        } else {
+            uint32_t counter = 0;
+            while (counter++ < len) {
+                *dst = opBlendNormal(_pixel(fill, t / fill->ctable->size), *dst, alpha(cmp));
+                ++dst;
+                t = base + (++x) * inc;
+                cmp += csize;
+            }
+        }
+    } else {
+        if (mathZero(inc)) {
+            auto color = _fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE));
+            for (uint32_t i = 0; i < len; ++i, ++dst, cmp += csize) {
+                *dst = opBlendNormal(color, *dst, MULTIPLY(alpha(cmp), opacity));
+            }
+            return;
+        }
+
+        auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+        auto vMin = -vMax;
+        auto v = t + (inc * len);
+
+        //we can use fixed point math
+        if (v < vMax && v > vMin) {
+            FillLinearPixels pixels(fill, base, inc, x, len);
+            for (uint32_t j = 0; j < len; ++j, ++dst, cmp += csize) {
+                *dst = opBlendNormal(pixels.next(), *dst, MULTIPLY(alpha(cmp), opacity));
+            }
+        //we have to fallback to float math
+        } else {
+            uint32_t counter = 0;
+            while (counter++ < len) {
+                *dst = opBlendNormal(_pixel(fill, t / fill->ctable->size), *dst, MULTIPLY(opacity, alpha(cmp)));
+                ++dst;
+                t = base + (++x) * inc;
+                cmp += csize;
+            }
+        }
+    }
+}
+
+
+template<typename MaskOp>
+static void _fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, MaskOp maskOp, uint8_t a)
+{
+    //Rotation
+    float inc;
+    auto base = _linearBase(fill, y, inc);
+    auto t = base + x * inc;
+
+    if (mathZero(inc)) {
+        auto src = MULTIPLY(a, A(_fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE))));
+        for (uint32_t i = 0; i < len; ++i, ++dst) {
+            *dst = maskOp(src, *dst, ~src);
+        }
+        return;
+    }
+
+    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+    auto vMin = -vMax;
+    auto v = t + (inc * len);
+
+    //we can use fixed point math
+    if (v < vMax && v > vMin) {
+        FillLinearPixels pixels(fill, base, inc, x, len);
+        for (uint32_t j = 0; j < len; ++j, ++dst) {
+            auto src = MULTIPLY(pixels.next(), a);
+            *dst = maskOp(src, *dst, ~src);
+        }
+    //we have to fallback to float math
+    } else {
+        uint32_t counter = 0;
+        while (counter++ < len) {
+            auto src = MULTIPLY(_pixel(fill, t / fill->ctable->size), a);
+            *dst = maskOp(src, *dst, ~src);
+            ++dst;
+            t = base + (++x) * inc;
+        }
+    }
+}
+
+
+template<typename MaskOp>
+static void _fillLinear(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, MaskOp maskOp, uint8_t a)
+{
+    //Rotation
+    float inc;
+    auto base = _linearBase(fill, y, inc);
+    auto t = base + x * inc;
+
+    if (mathZero(inc)) {
+        auto src = A(_fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE)));
+        src = MULTIPLY(src, a);
+        for (uint32_t i = 0; i < len; ++i, ++dst, ++cmp) {
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+        return;
+    }
+
+    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+    auto vMin = -vMax;
+    auto v = t + (inc * len);
+
+    //we can use fixed point math
+    if (v < vMax && v > vMin) {
+        FillLinearPixels pixels(fill, base, inc, x, len);
+        for (uint32_t j = 0; j < len; ++j, ++dst, ++cmp) {
+            auto src = MULTIPLY(a, A(pixels.next()));
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+    //we have to fallback to float math
+    } else {
+        uint32_t counter = 0;
+        while (counter++ < len) {
+            auto src = MULTIPLY(A(_pixel(fill, t / fill->ctable->size)), a);
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+            ++dst;
+            ++cmp;
+            t = base + (++x) * inc;
+        }
+    }
+}
+
+
+template<typename Blender>
+static void _fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, Blender op, uint8_t a)
+{
+    //Rotation
+    float inc;
+    auto base = _linearBase(fill, y, inc);
+    auto t = base + x * inc;
+
+    if (mathZero(inc)) {
+        auto color = _fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE));
+        for (uint32_t i = 0; i < len; ++i, ++dst) {
+            *dst = op(color, *dst, a);
+        }
+        return;
+    }
+
+    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+    auto vMin = -vMax;
+    auto v = t + (inc * len);
+
+    //we can use fixed point math
+    if (v < vMax && v > vMin) {
+        FillLinearPixels pixels(fill, base, inc, x, len);
+        for (uint32_t j = 0; j < len; ++j, ++dst) {
+            *dst = op(pixels.next(), *dst, a);
+        }
+    //we have to fallback to float math
+    } else {
+        uint32_t counter = 0;
+        while (counter++ < len) {
+            *dst = op(_pixel(fill, t / fill->ctable->size), *dst, a);
+            ++dst;
+            t = base + (++x) * inc;
+        }
+    }
+}
+
+
+template<typename Blender, typename Blender2>
+static void _fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, Blender op, Blender2 op2, uint8_t a)
+{
+    //Rotation
+    float inc;
+    auto base = _linearBase(fill, y, inc);
+    auto t = base + x * inc;
+
+    if (mathZero(inc)) {
+        auto color = _fixedPixel(fill, static_cast<int32_t>(base * FIXPT_SIZE));
+        if (a == 255) {
+            for (uint32_t i = 0; i < len; ++i, ++dst) {
+                auto tmp = op(color, *dst, a);
+                *dst = op2(tmp, *dst, 255);
+            }
+        } else {
+            for (uint32_t i = 0; i < len; ++i, ++dst) {
+                auto tmp = op(color, *dst, a);
+                auto tmp2 = op2(tmp, *dst, 255);
+                *dst = INTERPOLATE(tmp2, *dst, a);
+            }
+        }
+        return;
+    }
+
+    auto vMax = static_cast<float>(INT32_MAX >> (FIXPT_BITS + 1));
+    auto vMin = -vMax;
+    auto v = t + (inc * len);
+
+    if (a == 255) {
+        //we can use fixed point math
+        if (v < vMax && v > vMin) {
+            FillLinearPixels pixels(fill, base, inc, x, len);
+            for (uint32_t j = 0; j < len; ++j, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                *dst = op2(tmp, *dst, 255);
+            }
+        //we have to fallback to float math
+        } else {
+            uint32_t counter = 0;
+            while (counter++ < len) {
+                auto tmp = op(_pixel(fill, t / fill->ctable->size), *dst, 255);
+                *dst = op2(tmp, *dst, 255);
+                ++dst;
+                t = base + (++x) * inc;
+            }
+        }
+    } else {
+        //we can use fixed point math
+        if (v < vMax && v > vMin) {
+            FillLinearPixels pixels(fill, base, inc, x, len);
+            for (uint32_t j = 0; j < len; ++j, ++dst) {
+                auto tmp = op(pixels.next(), *dst, 255);
+                auto tmp2 = op2(tmp, *dst, 255);
+                *dst = INTERPOLATE(tmp2, *dst, a);
+            }
+        //we have to fallback to float math
+        } else {
+            uint32_t counter = 0;
+            while (counter++ < len) {
+                auto tmp = op(_pixel(fill, t / fill->ctable->size), *dst, 255);
+                auto tmp2 = op2(tmp, *dst, 255);
+                *dst = INTERPOLATE(tmp2, *dst, a);
+                ++dst;
+                t = base + (++x) * inc;
+            }
+        }
+    }
+}
+
+
+struct FillLinear
+{
+    template<typename... Args>
+    void operator()(const SwFill* fill, Args... args)
+    {
+        _fillLinear(fill, args...);
+    }
+};
+
+
+struct FillRadial
+{
+    template<typename... Args>
+    void operator()(const SwFill* fill, Args... args)
+    {
+        _fillRadial(fill, args...);
+    }
+};
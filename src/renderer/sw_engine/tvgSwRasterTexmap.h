@@ -20,6 +20,8 @@
  * SOFTWARE.
  */
 
+#define TEXMAP_BAND_HEIGHT 32     //minimum scanlines of a band for the parallel rasterization
+
 struct AALine
 {
    int32_t x[2];
@@ -42,10 +44,14 @@ static inline void _swap(float& a, float& b, float& tmp)
 }
 
 
-//Careful! Shared resource, No support threading
-static float dudx, dvdx;
-static float dxdya, dxdyb, dudya, dvdya;
-static float xa, xb, ua, va;
+//Interpolation states of a polygon, stepped along the scanlines.
+struct TexmapContext
+{
+    float dudx, dvdx;
+    float dxdya, dxdyb, dudya, dvdya;
+    float xa, xb, ua, va;
+    int32_t top, bottom;        //band rows to draw, the rows above are stepped through only
+};
 
 
 //Y Range exception handling
@@ -70,16 +76,16 @@ static bool _arrange(const SwImage* image, const SwBBox* region, int& yStart, in
 }
 
 
-static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, uint8_t opacity, uint8_t dirFlag = 0)
+static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, TexmapContext& ctx, uint8_t opacity, uint8_t dirFlag = 0)
 {
     return false;
 
 #if 0 //Enable it when GRAYSCALE image is supported
     auto maskOp = _getMaskOp(surface->compositor->method);
     auto direct = _direct(surface->compositor->method);
-    float _dudx = dudx, _dvdx = dvdx;
-    float _dxdya = dxdya, _dxdyb = dxdyb, _dudya = dudya, _dvdya = dvdya;
-    float _xa = xa, _xb = xb, _ua = ua, _va = va;
+    float _dudx = ctx.dudx, _dvdx = ctx.dvdx;
+    float _dxdya = ctx.dxdya, _dxdyb = ctx.dxdyb, _dudya = ctx.dudya, _dvdya = ctx.dvdya;
+    float _xa = ctx.xa, _xb = ctx.xb, _ua = ctx.ua, _va = ctx.va;
     auto sbuf = image->buf8;
     int32_t sw = static_cast<int32_t>(image->stride);
     int32_t sh = image->h;
@@ -90,6 +96,7 @@ static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage*
     SwSpan* span = nullptr;         //used only when rle based.
 
     if (!_arrange(image, region, yStart, yEnd)) return false;
+    if (yEnd > ctx.bottom) yEnd = ctx.bottom;
 
     //Loop through all lines in the segment
     uint32_t spanIdx = 0;
@@ -127,11 +134,13 @@ static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage*
 
         //Anti-Aliasing frames
         ay = y - aaSpans->yStart;
-        if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
-        if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        if (y >= ctx.top) {
+            if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
+            if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        }
 
         //Range allowed
-        if ((x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
+        if (y >= ctx.top && (x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
 
             //Perform subtexel pre-stepping on UV
             dx = 1 - (_xa - x1);
@@ -140,8 +149,8 @@ static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage*
 
             x = x1;
 
-            auto cmp = &surface->compositor->image.buf8[y * surface->compositor->image.stride + x1];
-            auto dst = &surface->buf8[y * surface->stride + x1];
+            auto cmp = surface->compositor->image.buf8At(x1, y);
+            auto dst = surface->buf8At(x1, y);
 
             if (opacity == 255) {
                 //Draw horizontal line
@@ -256,26 +265,25 @@ static bool _rasterMaskedPolygonImageSegment(SwSurface* surface, const SwImage*
 
         ++y;
     }
-    xa = _xa;
-    xb = _xb;
-    ua = _ua;
-    va = _va;
+    ctx.xa = _xa;
+    ctx.xb = _xb;
+    ctx.ua = _ua;
+    ctx.va = _va;
 
     return true;
 #endif
 }
 
 
-static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, uint8_t opacity)
+template<typename Blender>
+static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, TexmapContext& ctx, uint8_t opacity, Blender blender)
 {
-    float _dudx = dudx, _dvdx = dvdx;
-    float _dxdya = dxdya, _dxdyb = dxdyb, _dudya = dudya, _dvdya = dvdya;
-    float _xa = xa, _xb = xb, _ua = ua, _va = va;
+    float _dudx = ctx.dudx, _dvdx = ctx.dvdx;
+    float _dxdya = ctx.dxdya, _dxdyb = ctx.dxdyb, _dudya = ctx.dudya, _dvdya = ctx.dvdya;
+    float _xa = ctx.xa, _xb = ctx.xb, _ua = ctx.ua, _va = ctx.va;
     auto sbuf = image->buf32;
-    auto dbuf = surface->buf32;
     int32_t sw = static_cast<int32_t>(image->stride);
     int32_t sh = image->h;
-    int32_t dw = surface->stride;
     int32_t x1, x2, x, y, ar, ab, iru, irv, px, ay;
     int32_t vv = 0, uu = 0;
     int32_t minx = INT32_MAX, maxx = INT32_MIN;
@@ -284,6 +292,7 @@ static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage
     SwSpan* span = nullptr;         //used only when rle based.
 
     if (!_arrange(image, region, yStart, yEnd)) return;
+    if (yEnd > ctx.bottom) yEnd = ctx.bottom;
 
     //Loop through all lines in the segment
     uint32_t spanIdx = 0;
@@ -321,18 +330,20 @@ static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage
 
         //Anti-Aliasing frames
         ay = y - aaSpans->yStart;
-        if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
-        if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        if (y >= ctx.top) {
+            if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
+            if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        }
 
         //Range allowed
-        if ((x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
+        if (y >= ctx.top && (x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
 
             //Perform subtexel pre-stepping on UV
             dx = 1 - (_xa - x1);
             u = _ua + dx * _dudx;
             v = _va + dx * _dvdx;
 
-            buf = dbuf + ((y * dw) + x1);
+            buf = surface->buf32At(x1, y);
 
             x = x1;
 
@@ -370,7 +381,7 @@ static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage
                         }
                         px = INTERPOLATE(px, px2, ab);
                     }
-                    *buf = surface->blender(px, *buf, IA(px));
+                    *buf = blender(px, *buf, IA(px));
                     ++buf;
 
                     //Step UV horizontally
@@ -414,7 +425,7 @@ static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage
                         px = INTERPOLATE(px, px2, ab);
                     }
                     auto src = ALPHA_BLEND(px, opacity);
-                    *buf = surface->blender(src, *buf, IA(src));
+                    *buf = blender(src, *buf, IA(src));
                     ++buf;
 
                     //Step UV horizontally
@@ -436,23 +447,22 @@ static void _rasterBlendingPolygonImageSegment(SwSurface* surface, const SwImage
 
         ++y;
     }
-    xa = _xa;
-    xb = _xb;
-    ua = _ua;
-    va = _va;
+    ctx.xa = _xa;
+    ctx.xb = _xb;
+    ctx.ua = _ua;
+    ctx.va = _va;
 }
 
 
-static void _rasterPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, uint8_t opacity, bool matting)
+template<typename Alpha>
+static void _rasterPolygonImageSegment(SwSurface* surface, const SwImage* image, const SwBBox* region, int yStart, int yEnd, AASpans* aaSpans, TexmapContext& ctx, uint8_t opacity, Alpha alpha, bool matting)
 {
-    float _dudx = dudx, _dvdx = dvdx;
-    float _dxdya = dxdya, _dxdyb = dxdyb, _dudya = dudya, _dvdya = dvdya;
-    float _xa = xa, _xb = xb, _ua = ua, _va = va;
+    float _dudx = ctx.dudx, _dvdx = ctx.dvdx;
+    float _dxdya = ctx.dxdya, _dxdyb = ctx.dxdyb, _dudya = ctx.dudya, _dvdya = ctx.dvdya;
+    float _xa = ctx.xa, _xb = ctx.xb, _ua = ctx.ua, _va = ctx.va;
     auto sbuf = image->buf32;
-    auto dbuf = surface->buf32;
     int32_t sw = static_cast<int32_t>(image->stride);
     int32_t sh = image->h;
-    int32_t dw = surface->stride;
     int32_t x1, x2, x, y, ar, ab, iru, irv, px, ay;
     int32_t vv = 0, uu = 0;
     int32_t minx = INT32_MAX, maxx = INT32_MIN;
@@ -462,10 +472,10 @@ static void _rasterPolygonImageSegment(SwSurface* surface, const SwImage* image,
 
     //for matting(composition)
     auto csize = matting ? surface->compositor->image.channelSize: 0;
-    auto alpha = matting ? surface->alpha(surface->compositor->method) : nullptr;
     uint8_t* cmp = nullptr;
 
     if (!_arrange(image, region, yStart, yEnd)) return;
+    if (yEnd > ctx.bottom) yEnd = ctx.bottom;
 
     //Loop through all lines in the segment
     uint32_t spanIdx = 0;
@@ -503,22 +513,24 @@ static void _rasterPolygonImageSegment(SwSurface* surface, const SwImage* image,
 
         //Anti-Aliasing frames
         ay = y - aaSpans->yStart;
-        if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
-        if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        if (y >= ctx.top) {
+            if (aaSpans->lines[ay].x[0] > x1) aaSpans->lines[ay].x[0] = x1;
+            if (aaSpans->lines[ay].x[1] < x2) aaSpans->lines[ay].x[1] = x2;
+        }
 
         //Range allowed
-        if ((x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
+        if (y >= ctx.top && (x2 - x1) >= 1 && (x1 < maxx) && (x2 > minx)) {
 
             //Perform subtexel pre-stepping on UV
             dx = 1 - (_xa - x1);
             u = _ua + dx * _dudx;
             v = _va + dx * _dvdx;
 
-            buf = dbuf + ((y * dw) + x1);
+            buf = surface->buf32At(x1, y);
 
             x = x1;
 
-            if (matting) cmp = &surface->compositor->image.buf8[(y * surface->compositor->image.stride + x1) * csize];
+            if (matting) cmp = surface->compositor->image.pixelAt(x1, y);
 
             if (opacity == 255) {
                 //Draw horizontal line
@@ -633,15 +645,15 @@ static void _rasterPolygonImageSegment(SwSurface* surface, const SwImage* image,
 
         ++y;
     }
-    xa = _xa;
-    xb = _xb;
-    ua = _ua;
-    va = _va;
+    ctx.xa = _xa;
+    ctx.xb = _xb;
+    ctx.ua = _ua;
+    ctx.va = _va;
 }
 
 
 /* This mapping algorithm is based on Mikael Kalms's. */
-static void _rasterPolygonImage(SwSurface* surface, const SwImage* image, const SwBBox* region, Polygon& polygon, AASpans* aaSpans, uint8_t opacity)
+static void _rasterPolygonImage(SwSurface* surface, const SwImage* image, const SwBBox* region, Polygon& polygon, AASpans* aaSpans, uint8_t opacity, int32_t top, int32_t bottom)
 {
     float x[3] = {polygon.vertex[0].pt.x, polygon.vertex[1].pt.x, polygon.vertex[2].pt.x};
     float y[3] = {polygon.vertex[0].pt.y, polygon.vertex[1].pt.y, polygon.vertex[2].pt.y};
@@ -680,6 +692,13 @@ static void _rasterPolygonImage(SwSurface* surface, const SwImage* image, const
     //Skip drawing if it's too thin to cover any pixels at all.
     if ((yi[0] == yi[1] && yi[0] == yi[2]) || ((int) x[0] == (int) x[1] && (int) x[0] == (int) x[2])) return;
 
+    //Out of the band
+    if (yi[2] <= top || yi[0] >= bottom) return;
+
+    TexmapContext ctx;
+    ctx.top = top;
+    ctx.bottom = bottom;
+
     //Calculate horizontal and vertical increments for UV axes (these calcs are certainly not optimal, although they're stable (handles any dy being 0)
     auto denom = ((x[2] - x[0]) * (y[1] - y[0]) - (x[1] - x[0]) * (y[2] - y[0]));
 
@@ -687,8 +706,8 @@ static void _rasterPolygonImage(SwSurface* surface, const SwImage* image, const
     if (mathZero(denom)) return;
 
     denom = 1 / denom;   //Reciprocal for speeding up
-    dudx = ((u[2] - u[0]) * (y[1] - y[0]) - (u[1] - u[0]) * (y[2] - y[0])) * denom;
-    dvdx = ((v[2] - v[0]) * (y[1] - y[0]) - (v[1] - v[0]) * (y[2] - y[0])) * denom;
+    ctx.dudx = ((u[2] - u[0]) * (y[1] - y[0]) - (u[1] - u[0]) * (y[2] - y[0])) * denom;
+    ctx.dvdx = ((v[2] - v[0]) * (y[1] - y[0]) - (v[1] - v[0]) * (y[2] - y[0])) * denom;
     auto dudy = ((u[1] - u[0]) * (x[2] - x[0]) - (u[2] - u[0]) * (x[1] - x[0])) * denom;
     auto dvdy = ((v[1] - v[0]) * (x[2] - x[0]) - (v[2] - v[0]) * (x[1] - x[0])) * denom;
 
@@ -707,113 +726,97 @@ static void _rasterPolygonImage(SwSurface* surface, const SwImage* image, const
     auto compositing = _compositing(surface);   //Composition required
     auto blending = _blending(surface);         //Blending required
 
+    //dirFlag is for the masking (see _rasterMaskedPolygonImageSegment())
+    auto segment = [&](int yStart, int yEnd, uint8_t dirFlag) {
+        if (compositing) {
+            if (_matting(surface)) _mattingKernel(surface, [&](auto alpha) { _rasterPolygonImageSegment(surface, image, region, yStart, yEnd, aaSpans, ctx, opacity, alpha, true); return true; });
+            else _rasterMaskedPolygonImageSegment(surface, image, region, yStart, yEnd, aaSpans, ctx, opacity, dirFlag);
+        } else if (blending) {
+            _blendingKernel(surface, [&](auto op) { _rasterBlendingPolygonImageSegment(surface, image, region, yStart, yEnd, aaSpans, ctx, opacity, op); return true; });
+        } else {
+            _rasterPolygonImageSegment(surface, image, region, yStart, yEnd, aaSpans, ctx, opacity, SwAlpha(nullptr), false);
+        }
+    };
+
     //Longer edge is on the left side
     if (!side) {
         //Calculate slopes along left edge
-        dxdya = dxdy[1];
-        dudya = dxdya * dudx + dudy;
-        dvdya = dxdya * dvdx + dvdy;
+        ctx.dxdya = dxdy[1];
+        ctx.dudya = ctx.dxdya * ctx.dudx + dudy;
+        ctx.dvdya = ctx.dxdya * ctx.dvdx + dvdy;
 
         //Perform subpixel pre-stepping along left edge
         auto dy = 1.0f - (y[0] - yi[0]);
-        xa = x[0] + dy * dxdya;
-        ua = u[0] + dy * dudya;
-        va = v[0] + dy * dvdya;
+        ctx.xa = x[0] + dy * ctx.dxdya;
+        ctx.ua = u[0] + dy * ctx.dudya;
+        ctx.va = v[0] + dy * ctx.dvdya;
 
         //Draw upper segment if possibly visible
         if (yi[0] < yi[1]) {
             off_y = y[0] < regionTop ? (regionTop - y[0]) : 0;
-            xa += (off_y * dxdya);
-            ua += (off_y * dudya);
-            va += (off_y * dvdya);
+            ctx.xa += (off_y * ctx.dxdya);
+            ctx.ua += (off_y * ctx.dudya);
+            ctx.va += (off_y * ctx.dvdya);
 
             // Set right edge X-slope and perform subpixel pre-stepping
-            dxdyb = dxdy[0];
-            xb = x[0] + dy * dxdyb + (off_y * dxdyb);
-
-            if (compositing) {
-                if (_matting(surface)) _rasterPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, true);
-                else _rasterMaskedPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, 1);
-            } else if (blending) {
-                _rasterBlendingPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity);
-            } else {
-                _rasterPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, false);
-            }
+            ctx.dxdyb = dxdy[0];
+            ctx.xb = x[0] + dy * ctx.dxdyb + (off_y * ctx.dxdyb);
+
+            segment(yi[0], yi[1], 1);
             upper = true;
         }
         //Draw lower segment if possibly visible
         if (yi[1] < yi[2]) {
             off_y = y[1] < regionTop ? (regionTop - y[1]) : 0;
             if (!upper) {
-                xa += (off_y * dxdya);
-                ua += (off_y * dudya);
-                va += (off_y * dvdya);
+                ctx.xa += (off_y * ctx.dxdya);
+                ctx.ua += (off_y * ctx.dudya);
+                ctx.va += (off_y * ctx.dvdya);
             }
             // Set right edge X-slope and perform subpixel pre-stepping
-            dxdyb = dxdy[2];
-            xb = x[1] + (1 - (y[1] - yi[1])) * dxdyb + (off_y * dxdyb);
-            if (compositing) {
-                if (_matting(surface)) _rasterPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, true);
-                else _rasterMaskedPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, 2);
-            } else if (blending) {
-                 _rasterBlendingPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity);
-            } else {
-                _rasterPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, false);
-            }
+            ctx.dxdyb = dxdy[2];
+            ctx.xb = x[1] + (1 - (y[1] - yi[1])) * ctx.dxdyb + (off_y * ctx.dxdyb);
+            segment(yi[1], yi[2], 2);
         }
     //Longer edge is on the right side
     } else {
         //Set right edge X-slope and perform subpixel pre-stepping
-        dxdyb = dxdy[1];
+        ctx.dxdyb = dxdy[1];
         auto dy = 1.0f - (y[0] - yi[0]);
-        xb = x[0] + dy * dxdyb;
+        ctx.xb = x[0] + dy * ctx.dxdyb;
 
         //Draw upper segment if possibly visible
         if (yi[0] < yi[1]) {
             off_y = y[0] < regionTop ? (regionTop - y[0]) : 0;
-            xb += (off_y *dxdyb);
+            ctx.xb += (off_y *ctx.dxdyb);
 
             // Set slopes along left edge and perform subpixel pre-stepping
-            dxdya = dxdy[0];
-            dudya = dxdya * dudx + dudy;
-            dvdya = dxdya * dvdx + dvdy;
-
-            xa = x[0] + dy * dxdya + (off_y * dxdya);
-            ua = u[0] + dy * dudya + (off_y * dudya);
-            va = v[0] + dy * dvdya + (off_y * dvdya);
-
-            if (compositing) {
-                if (_matting(surface)) _rasterPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, true);
-                else _rasterMaskedPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, 3);
-            } else if (blending) {
-                _rasterBlendingPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity);
-            } else {
-                _rasterPolygonImageSegment(surface, image, region, yi[0], yi[1], aaSpans, opacity, false);
-            }
+            ctx.dxdya = dxdy[0];
+            ctx.dudya = ctx.dxdya * ctx.dudx + dudy;
+            ctx.dvdya = ctx.dxdya * ctx.dvdx + dvdy;
+
+            ctx.xa = x[0] + dy * ctx.dxdya + (off_y * ctx.dxdya);
+            ctx.ua = u[0] + dy * ctx.dudya + (off_y * ctx.dudya);
+            ctx.va = v[0] + dy * ctx.dvdya + (off_y * ctx.dvdya);
+
+            segment(yi[0], yi[1], 3);
             upper = true;
         }
         //Draw lower segment if possibly visible
         if (yi[1] < yi[2]) {
             off_y = y[1] < regionTop ? (regionTop - y[1]) : 0;
-            if (!upper) xb += (off_y *dxdyb);
+            if (!upper) ctx.xb += (off_y *ctx.dxdyb);
 
             // Set slopes along left edge and perform subpixel pre-stepping
-            dxdya = dxdy[2];
-            dudya = dxdya * dudx + dudy;
-            dvdya = dxdya * dvdx + dvdy;
+            ctx.dxdya = dxdy[2];
+            ctx.dudya = ctx.dxdya * ctx.dudx + dudy;
+            ctx.dvdya = ctx.dxdya * ctx.dvdx + dvdy;
             dy = 1 - (y[1] - yi[1]);
-            xa = x[1] + dy * dxdya + (off_y * dxdya);
-            ua = u[1] + dy * dudya + (off_y * dudya);
-            va = v[1] + dy * dvdya + (off_y * dvdya);
-
-            if (compositing) {
-                if (_matting(surface)) _rasterPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, true);
-                else _rasterMaskedPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, 4);
-            } else if (blending) {
-                _rasterBlendingPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity);
-            } else {
-                _rasterPolygonImageSegment(surface, image, region, yi[1], yi[2], aaSpans, opacity, false);
-            }
+            ctx.xa = x[1] + dy * ctx.dxdya + (off_y * ctx.dxdya);
+            ctx.ua = u[1] + dy * ctx.dudya + (off_y * ctx.dudya);
+            ctx.va = v[1] + dy * ctx.dvdya + (off_y * ctx.dvdya);
+
+            segment(yi[1], yi[2], 4);
         }
     }
 }
@@ -1042,27 +1045,26 @@ static bool _apply(SwSurface* surface, AASpans* aaSpans)
         auto line = &aaSpans->lines[y - aaSpans->yStart];
         auto width = line->x[1] - line->x[0];
         if (width > 0) {
-            auto offset = y * surface->stride;
-
             //Left edge
-            dst = surface->buf32 + (offset + line->x[0]);
+            dst = surface->buf32At(line->x[0], y);
             if (line->x[0] > 1) pixel = *(dst - 1);
             else pixel = *dst;
 
+            //the edges must not leak out of the span
             pos = 1;
-            while (pos <= line->length[0]) {
+            while (pos <= line->length[0] && pos <= width) {
                 *dst = INTERPOLATE(*dst, pixel, line->coverage[0] * pos);
                 ++dst;
                 ++pos;
             }
 
             //Right edge
-            dst = surface->buf32 + (offset + line->x[1] - 1);
+            dst = surface->buf32At(line->x[1] - 1, y);
             if (line->x[1] < (int32_t)(surface->w - 1)) pixel = *(dst + 1);
             else pixel = *dst;
 
             pos = width;
-            while ((int32_t)(width - line->length[1]) < pos) {
+            while ((int32_t)(width - line->length[1]) < pos && pos > 0) {
                 *dst = INTERPOLATE(*dst, pixel, 255 - (line->coverage[1] * (line->length[1] - (width - pos))));
                 --dst;
                 --pos;
@@ -1078,6 +1080,93 @@ static bool _apply(SwSurface* surface, AASpans* aaSpans)
 }
 
 
+/* Large polygons are split into the bands of scanlines and rasterized in parallel.
+   Every band steps along the edges from the top of the polygons,
+   so that the result is identical to the serial rasterization. */
+struct TexmapBands
+{
+    SwSurface* surface;
+    const SwImage* image;
+    const SwBBox* region;
+    Polygon* polygons;
+    uint32_t polygonCnt;
+    AASpans* aaSpans;
+    int32_t height;             //band height
+    uint32_t cnt;               //band count
+    atomic<uint32_t> next{0};
+    uint8_t opacity;
+};
+
+
+static void _rasterTexmapBands(TexmapBands* job)
+{
+    uint32_t band;
+    while ((band = job->next.fetch_add(1, memory_order_relaxed)) < job->cnt) {
+        //the first and the last bands are open-ended, as in the serial rasterization.
+        auto top = (band == 0) ? INT32_MIN : job->aaSpans->yStart + static_cast<int32_t>(band) * job->height;
+        auto bottom = (band == job->cnt - 1) ? INT32_MAX : job->aaSpans->yStart + static_cast<int32_t>(band + 1) * job->height;
+        for (uint32_t i = 0; i < job->polygonCnt; ++i) {
+            _rasterPolygonImage(job->surface, job->image, job->region, job->polygons[i], job->aaSpans, job->opacity, top, bottom);
+        }
+    }
+}
+
+
+struct TexmapBandTask : Task
+{
+    TexmapBands* job = nullptr;
+
+    void run(unsigned tid) override
+    {
+        _rasterTexmapBands(job);
+    }
+};
+
+
+static void _rasterPolygons(SwSurface* surface, const SwImage* image, const SwBBox* region, Polygon* polygons, uint32_t polygonCnt, AASpans* aaSpans, uint8_t opacity)
+{
+    //A worker can't wait for the other workers, it rasterizes alone.
+    auto threads = TaskScheduler::worker() ? 0 : TaskScheduler::threads();
+    auto height = aaSpans->yEnd - aaSpans->yStart;
+
+    if (threads == 0 || height < TEXMAP_BAND_HEIGHT * 2) {
+        for (uint32_t i = 0; i < polygonCnt; ++i) {
+            _rasterPolygonImage(surface, image, region, polygons[i], aaSpans, opacity, INT32_MIN, INT32_MAX);
+        }
+        return;
+    }
+
+    TexmapBands job;
+    job.surface = surface;
+    job.image = image;
+    job.region = region;
+    job.polygons = polygons;
+    job.polygonCnt = polygonCnt;
+    job.aaSpans = aaSpans;
+    job.opacity = opacity;
+    job.cnt = (threads + 1) * 2;
+    job.height = (height + job.cnt - 1) / job.cnt;
+    if (job.height < TEXMAP_BAND_HEIGHT) job.height = TEXMAP_BAND_HEIGHT;
+    job.cnt = (height + job.height - 1) / job.height;
+
+    auto helpers = (job.cnt - 1) < threads ? (job.cnt - 1) : threads;
+    auto tasks = new TexmapBandTask[helpers];
+
+    for (uint32_t i = 0; i < helpers; ++i) {
+        tasks[i].job = &job;
+        TaskScheduler::request(&tasks[i]);
+    }
+
+    //the caller takes its share as well
+    _rasterTexmapBands(&job);
+
+    for (uint32_t i = 0; i < helpers; ++i) {
+        tasks[i].done();
+    }
+    delete[] tasks;
+}
+
+
 /*
     2 triangles constructs 1 mesh.
     below figure illustrates vert[4] index info.
@@ -1116,21 +1205,19 @@ static bool _rasterTexmapPolygon(SwSurface* surface, const SwImage* image, const
     auto aaSpans = _AASpans(ys, ye, image, region);
     if (!aaSpans) return true;
 
-    Polygon polygon;
-
-    //Draw the first polygon
-    polygon.vertex[0] = vertices[0];
-    polygon.vertex[1] = vertices[1];
-    polygon.vertex[2] = vertices[3];
+    Polygon polygons[2];
 
-    _rasterPolygonImage(surface, image, region, polygon, aaSpans, opacity);
+    //The first polygon
+    polygons[0].vertex[0] = vertices[0];
+    polygons[0].vertex[1] = vertices[1];
+    polygons[0].vertex[2] = vertices[3];
 
-    //Draw the second polygon
-    polygon.vertex[0] = vertices[1];
-    polygon.vertex[1] = vertices[2];
-    polygon.vertex[2] = vertices[3];
+    //The second polygon
+    polygons[1].vertex[0] = vertices[1];
+    polygons[1].vertex[1] = vertices[2];
+    polygons[1].vertex[2] = vertices[3];
 
-    _rasterPolygonImage(surface, image, region, polygon, aaSpans, opacity);
+    _rasterPolygons(surface, image, region, polygons, 2, aaSpans, opacity);
 
 #if 0
     if (_compositing(surface) && _masking(surface) && !_direct(surface->compositor->method)) {
@@ -1191,9 +1278,7 @@ static bool _rasterTexmapPolygonMesh(SwSurface* surface, const SwImage* image, c
 
     // Get AA spans and step polygons again to draw
     if (auto aaSpans = _AASpans(ys, ye, image, region)) {
-        for (uint32_t i = 0; i < mesh->triangleCnt; i++) {
-            _rasterPolygonImage(surface, image, region, transformedTris[i], aaSpans, opacity);
-        }
+        _rasterPolygons(surface, image, region, transformedTris, mesh->triangleCnt, aaSpans, opacity);
 #if 0
         if (_compositing(surface) && _masking(surface) && !_direct(surface->compositor->method)) {
             _compositeMaskImage(surface, &surface->compositor->image, surface->compositor->bbox);
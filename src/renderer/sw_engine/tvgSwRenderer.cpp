@@ -20,6 +20,8 @@
  * SOFTWARE.
  */
 
+#include <cstdlib>
+#include <cstring>
 #include "tvgMath.h"
 #include "tvgSwCommon.h"
 #include "tvgTaskScheduler.h"
@@ -32,18 +34,41 @@ static int32_t initEngineCnt = false;
 static int32_t rendererCnt = 0;
 static SwMpool* globalMpool = nullptr;
 static uint32_t threadsCnt = 0;
+static SwCanvas::Simd simdPolicy = SwCanvas::Simd::Default;    //raster kernels limited by the user
+
+static bool _overlap(const SwBBox& lhs, const SwBBox& rhs)
+{
+    return (lhs.min.x < rhs.max.x && rhs.min.x < lhs.max.x && lhs.min.y < rhs.max.y && rhs.min.y < lhs.max.y);
+}
+
+
+static void _unite(SwBBox& lhs, const SwBBox& rhs)
+{
+    if (rhs.max.x <= rhs.min.x || rhs.max.y <= rhs.min.y) return;
+    if (lhs.max.x <= lhs.min.x || lhs.max.y <= lhs.min.y) {
+        lhs = rhs;
+        return;
+    }
+    if (rhs.min.x < lhs.min.x) lhs.min.x = rhs.min.x;
+    if (rhs.min.y < lhs.min.y) lhs.min.y = rhs.min.y;
+    if (rhs.max.x > lhs.max.x) lhs.max.x = rhs.max.x;
+    if (rhs.max.y > lhs.max.y) lhs.max.y = rhs.max.y;
+}
+
 
 struct SwTask : Task
 {
     SwSurface* surface = nullptr;
     SwMpool* mpool = nullptr;
     SwBBox bbox = {{0, 0}, {0, 0}};       //Whole Rendering Region
+    SwBBox drawn = {{0, 0}, {0, 0}};      //Region drawn at the last time, the damaged region when it's updated
     Matrix* transform = nullptr;
     Array<RenderData> clips;
     RenderUpdateFlag flags = RenderUpdateFlag::None;
     uint8_t opacity;
     bool pushed = false;                  //Pushed into task list?
     bool disposed = false;                //Disposed task?
+    bool dirty = false;                   //Updated since the last drawing?
 
     RenderRegion bounds()
     {
@@ -64,7 +89,7 @@ struct SwTask : Task
     }
 
     virtual void dispose() = 0;
-    virtual bool clip(SwRleData* target) = 0;
+    virtual bool clip(SwRleData* target, unsigned tid) = 0;   //tid: the thread of the clipped task
     virtual SwRleData* rle() = 0;
 
     virtual ~SwTask()
@@ -81,6 +106,12 @@ struct SwShapeTask : SwTask
     bool cmpStroking = false;
     bool clipper = false;
 
+    //The generated rle, reusable if the shape is translated only
+    Matrix rleTransform;
+    SwBBox rleRegion;
+    SwRleStats* stats = nullptr;
+    bool reusable = false;
+
     /* We assume that if the stroke width is greater than 2,
        the shape's outline beneath the stroke could be adequately covered by the stroke drawing.
        Therefore, antialiasing is disabled under this condition.
@@ -105,10 +136,10 @@ struct SwShapeTask : SwTask
     }
 
 
-    bool clip(SwRleData* target) override
+    bool clip(SwRleData* target, unsigned tid) override
     {
-        if (shape.fastTrack) rleClipRect(target, &bbox);
-        else if (shape.rle) rleClipPath(target, shape.rle);
+        if (shape.fastTrack) rleClipRect(target, &bbox, mpool, tid);
+        else if (shape.rle) rleClipPath(target, shape.rle, mpool, tid);
         else return false;
 
         return true;
@@ -122,6 +153,44 @@ struct SwShapeTask : SwTask
         return shape.rle;
     }
 
+    /* Move the rle instead of generating it again if the shape is translated by the integer pixels.
+       The outline is truncated to the 26.6 fixed point, any sub-pixel phase change could alter it,
+       thus the tolerance only absorbs the float rounding of the translation.
+       It couldn't be reused if the rle was or would be clipped by the rendering region. */
+    bool translate(const SwBBox& clipRegion)
+    {
+        if (!reusable || flags != RenderUpdateFlag::Transform || clips.count > 0) return false;
+
+        Matrix m;
+        if (transform) m = *transform;
+        else mathIdentity(&m);
+
+        if (m.e11 != rleTransform.e11 || m.e12 != rleTransform.e12 || m.e21 != rleTransform.e21 || m.e22 != rleTransform.e22) return false;
+
+        auto dx = m.e13 - rleTransform.e13;
+        auto dy = m.e23 - rleTransform.e23;
+        auto x = static_cast<SwCoord>(roundf(dx));
+        auto y = static_cast<SwCoord>(roundf(dy));
+        if (fabsf(dx - x) > (1.0f / 4096.0f) || fabsf(dy - y) > (1.0f / 4096.0f)) return false;
+
+        SwBBox region = {{rleRegion.min.x + x, rleRegion.min.y + y}, {rleRegion.max.x + x, rleRegion.max.y + y}};
+        if (region.min.x <= clipRegion.min.x || region.min.y <= clipRegion.min.y || region.max.x >= clipRegion.max.x || region.max.y >= clipRegion.max.y) return false;
+
+        rleTranslate(shape.rle, x, y);
+        rleTranslate(shape.strokeRle, x, y);
+        shape.bbox.min.x += x;
+        shape.bbox.min.y += y;
+        shape.bbox.max.x += x;
+        shape.bbox.max.y += y;
+
+        bbox = rleRegion = region;
+        //the rle follows the integer moves only, the sub-pixel remainder must not add up over the frames
+        rleTransform.e13 += x;
+        rleTransform.e23 += y;
+
+        return true;
+    }
+
     void run(unsigned tid) override
     {
         if (opacity == 0 && !clipper) return;  //Invisible
@@ -134,6 +203,18 @@ struct SwShapeTask : SwTask
         auto prepareShape = false;
         if (!shapePrepared(&shape) && (flags & RenderUpdateFlag::Color)) prepareShape = true;
 
+        //Translated only
+        if (translate(clipRegion)) {
+            ++stats->reused;
+            if (shape.fill && rshape->fill) {
+                if (!shapeGenFillColors(&shape, rshape->fill, transform, surface, opacity, false)) goto err;
+            }
+            if (shape.strokeRle && shape.stroke->fill && rshape->strokeFill()) {
+                if (!shapeGenStrokeFillColors(&shape, rshape->strokeFill(), transform, surface, opacity, false)) goto err;
+            }
+            return;
+        }
+        ++stats->generated;
         //Shape
         if (flags & (RenderUpdateFlag::Path | RenderUpdateFlag::Transform) || prepareShape) {
             uint8_t alpha = 0;
@@ -148,12 +229,13 @@ struct SwShapeTask : SwTask
             }
         }
         //Fill
-        if (flags & (RenderUpdateFlag::Gradient | RenderUpdateFlag::Transform | RenderUpdateFlag::Color)) {
+        if (flags & (RenderUpdateFlag::Path | RenderUpdateFlag::Gradient | RenderUpdateFlag::Transform | RenderUpdateFlag::Color)) {
             if (visibleFill || clipper) {
-                if (!shapeGenRle(&shape, rshape, antialiasing(strokeWidth))) goto err;
+                if (!shapeGenRle(&shape, rshape, antialiasing(strokeWidth), mpool, tid)) goto err;
             }
             if (auto fill = rshape->fill) {
-                auto ctable = (flags & RenderUpdateFlag::Gradient) ? true : false;
+                //the color table is missing if the fill wasn't visible on the last update.
+                auto ctable = ((flags & RenderUpdateFlag::Gradient) || !shape.fill) ? true : false;
                 if (ctable) shapeResetFill(&shape);
                 if (!shapeGenFillColors(&shape, fill, transform, surface, opacity, ctable)) goto err;
             } else {
@@ -161,13 +243,16 @@ struct SwShapeTask : SwTask
             }
         }
         //Stroke
-        if (flags & (RenderUpdateFlag::Stroke | RenderUpdateFlag::Transform)) {
+        if (flags & (RenderUpdateFlag::Path | RenderUpdateFlag::Stroke | RenderUpdateFlag::Transform)) {
             if (strokeWidth > 0.0f) {
                 shapeResetStroke(&shape, rshape, transform);
                 if (!shapeGenStrokeRle(&shape, rshape, transform, clipRegion, bbox, mpool, tid)) goto err;
 
+                //The stroke region could be narrower than the fill region. ex) dashed, trimmed
+                if (shape.rle || shape.fastTrack) _unite(bbox, shape.bbox);
+
                 if (auto fill = rshape->strokeFill()) {
-                    auto ctable = (flags & RenderUpdateFlag::GradientStroke) ? true : false;
+                    auto ctable = ((flags & RenderUpdateFlag::GradientStroke) || !shape.stroke->fill) ? true : false;
                     if (ctable) shapeResetStrokeFill(&shape);
                     if (!shapeGenStrokeFillColors(&shape, fill, transform, surface, opacity, ctable)) goto err;
                 } else {
@@ -185,13 +270,22 @@ struct SwShapeTask : SwTask
         for (auto clip = clips.begin(); clip < clips.end(); ++clip) {
             auto clipper = static_cast<SwTask*>(*clip);
             //Clip shape rle
-            if (shape.rle && !clipper->clip(shape.rle)) goto err;
+            if (shape.rle && !clipper->clip(shape.rle, tid)) goto err;
             //Clip stroke rle
-            if (shape.strokeRle && !clipper->clip(shape.strokeRle)) goto err;
+            if (shape.strokeRle && !clipper->clip(shape.strokeRle, tid)) goto err;
+        }
+
+        //Nothing has been clipped by the rendering region?
+        reusable = (clips.count == 0 && bbox.min.x > clipRegion.min.x && bbox.min.y > clipRegion.min.y && bbox.max.x < clipRegion.max.x && bbox.max.y < clipRegion.max.y);
+        if (reusable) {
+            if (transform) rleTransform = *transform;
+            else mathIdentity(&rleTransform);
+            rleRegion = bbox;
         }
         return;
 
     err:
+        reusable = false;
         shapeReset(&shape);
         shapeDelOutline(&shape, mpool, tid);
     }
@@ -208,15 +302,15 @@ struct SwSceneTask : SwTask
     Array<RenderData> scene;    //list of paints render data (SwTask)
     SwRleData* sceneRle = nullptr;
 
-    bool clip(SwRleData* target) override
+    bool clip(SwRleData* target, unsigned tid) override
     {
         //Only one shape
         if (scene.count == 1) {
-            return static_cast<SwTask*>(*scene.data)->clip(target);
+            return static_cast<SwTask*>(*scene.data)->clip(target, tid);
         }
 
         //More than one shapes
-        if (sceneRle) rleClipPath(target, sceneRle);
+        if (sceneRle) rleClipPath(target, sceneRle, mpool, tid);
         else TVGLOG("SW_ENGINE", "No clippers in a scene?");
 
         return true;
@@ -239,12 +333,12 @@ struct SwSceneTask : SwTask
             auto clipper1 = static_cast<SwTask*>(*scene.data);
             auto clipper2 = static_cast<SwTask*>(*(scene.data + 1));
 
-            rleMerge(sceneRle, clipper1->rle(), clipper2->rle());
+            rleMerge(sceneRle, clipper1->rle(), clipper2->rle(), mpool, tid);
 
             //Unify the remained clippers
             for (auto rd = scene.begin() + 2; rd < scene.end(); ++rd) {
                 auto clipper = static_cast<SwTask*>(*rd);
-                rleMerge(sceneRle, sceneRle, clipper->rle());
+                rleMerge(sceneRle, sceneRle, clipper->rle(), mpool, tid);
             }
         }
     }
@@ -262,7 +356,7 @@ struct SwImageTask : SwTask
     Surface* source;                            //Image source
     const RenderMesh* mesh = nullptr;           //Should be valid ptr in action
 
-    bool clip(SwRleData* target) override
+    bool clip(SwRleData* target, unsigned tid) override
     {
         TVGERR("SW_ENGINE", "Image is used as ClipPath?");
         return true;
@@ -278,15 +372,17 @@ struct SwImageTask : SwTask
     {
         auto clipRegion = bbox;
 
-        //Convert colorspace if it's not aligned.
-        rasterConvertCS(source, surface->cs);
-        rasterPremultiply(source);
+        //The source pixels are changed
+        if (flags & RenderUpdateFlag::Image) {
+            imageFreePixels(&image);
+            imageFreeMipmap(&image);
+        }
 
-        image.data = source->data;
-        image.w = source->w;
-        image.h = source->h;
-        image.stride = source->stride;
-        image.channelSize = source->channelSize;
+        //Convert colorspace and premultiply if it's not aligned, only once per source.
+        if (!imageLoad(&image, source, surface->cs)) {
+            bbox.reset();
+            goto end;
+        }
 
         //Invisible shape turned to visible by alpha.
         if ((flags & (RenderUpdateFlag::Image | RenderUpdateFlag::Transform | RenderUpdateFlag::Color)) && (opacity > 0)) {
@@ -295,15 +391,18 @@ struct SwImageTask : SwTask
 
             if (!imagePrepare(&image, mesh, transform, clipRegion, bbox, mpool, tid)) goto end;
 
+            //Downscaled image is sampled from the half-resolution levels
+            if (!imageGenMipmap(&image, surface->cs)) goto end;
+
             // TODO: How do we clip the triangle mesh? Only clip non-meshed images for now
             if (mesh->triangleCnt == 0 && clips.count > 0) {
-                if (!imageGenRle(&image, bbox, false)) goto end;
+                if (!imageGenRle(&image, bbox, false, mpool, tid)) goto end;
                 if (image.rle) {
                     //Clear current task memorypool here if the clippers would use the same memory pool
                     imageDelOutline(&image, mpool, tid);
                     for (auto clip = clips.begin(); clip < clips.end(); ++clip) {
                         auto clipper = static_cast<SwTask*>(*clip);
-                        if (!clipper->clip(image.rle)) goto err;
+                        if (!clipper->clip(image.rle, tid)) goto err;
                     }
                     return;
                 }
@@ -323,6 +422,28 @@ struct SwImageTask : SwTask
 };
 
 
+//SwCanvas::simd() or THORVG_SIMD=none|sse4.1|avx2|neon caps the raster kernels, ie. for the benchmarks.
+static SwSimd _simdLimit()
+{
+    switch (simdPolicy) {
+        case SwCanvas::Simd::None: return SwSimd::None;
+        case SwCanvas::Simd::Sse41: return SwSimd::Sse41;
+        case SwCanvas::Simd::Avx2: return SwSimd::Avx2;
+        case SwCanvas::Simd::Neon: return SwSimd::Neon;
+        default: break;
+    }
+
+    auto env = getenv("THORVG_SIMD");
+    if (!env) return SwSimd::Neon;
+    if (!strcmp(env, "none") || !strcmp(env, "c")) return SwSimd::None;
+    if (!strcmp(env, "sse4.1")) return SwSimd::Sse41;
+    if (!strcmp(env, "avx2")) return SwSimd::Avx2;
+    if (!strcmp(env, "neon")) return SwSimd::Neon;
+    TVGLOG("SW_ENGINE", "Unknown THORVG_SIMD = \"%s\"", env);
+    return SwSimd::Neon;
+}
+
+
 static void _termEngine()
 {
     if (rendererCnt > 0) return;
@@ -332,39 +453,331 @@ static void _termEngine()
 }
 
 
-static void _renderFill(SwShapeTask* task, SwSurface* surface, uint8_t opacity)
+static void _renderFill(const RenderShape* rshape, SwShape* shape, SwSurface* surface, uint8_t opacity)
 {
     uint8_t r, g, b, a;
-    if (auto fill = task->rshape->fill) {
-        rasterGradientShape(surface, &task->shape, fill->identifier());
+    if (auto fill = rshape->fill) {
+        rasterGradientShape(surface, shape, fill->identifier());
     } else {
-        task->rshape->fillColor(&r, &g, &b, &a);
+        rshape->fillColor(&r, &g, &b, &a);
         a = MULTIPLY(opacity, a);
-        if (a > 0) rasterShape(surface, &task->shape, r, g, b, a);
+        if (a > 0) rasterShape(surface, shape, r, g, b, a);
     }
 }
 
-static void _renderStroke(SwShapeTask* task, SwSurface* surface, uint8_t opacity)
+static void _renderStroke(const RenderShape* rshape, SwShape* shape, SwSurface* surface, uint8_t opacity)
 {
     uint8_t r, g, b, a;
-    if (auto strokeFill = task->rshape->strokeFill()) {
-        rasterGradientStroke(surface, &task->shape, strokeFill->identifier());
+    if (auto strokeFill = rshape->strokeFill()) {
+        rasterGradientStroke(surface, shape, strokeFill->identifier());
     } else {
-        if (task->rshape->strokeFill(&r, &g, &b, &a)) {
+        if (rshape->strokeFill(&r, &g, &b, &a)) {
             a = MULTIPLY(opacity, a);
-            if (a > 0) rasterStroke(surface, &task->shape, r, g, b, a);
+            if (a > 0) rasterStroke(surface, shape, r, g, b, a);
         }
     }
 }
 
+
+static void _renderShape(const RenderShape* rshape, SwShape* shape, SwSurface* surface, uint8_t opacity)
+{
+    if (rshape->stroke && rshape->stroke->strokeFirst) {
+        _renderStroke(rshape, shape, surface, opacity);
+        _renderFill(rshape, shape, surface, opacity);
+    } else {
+        _renderFill(rshape, shape, surface, opacity);
+        _renderStroke(rshape, shape, surface, opacity);
+    }
+}
+
+
+/* Banded Rasterization:
+   The raster commands are recorded with the surface states during the draw(),
+   then each band replays them in order within its own scanlines.
+   Since the raster operations never touch the pixels of the other scanlines,
+   the result is identical to the immediate rasterization.
+   The damaged regions of the partial redraw are replayed in the same manner. */
+
+struct SwRasterCmd
+{
+    enum Type : uint8_t {Shape = 0, Image, Clear, Composite};
+
+    SwSurface* target;                    //render target
+    pixel_t* data;                        //target buffer at the recording time
+    uint32_t stride;                      //target stride at the recording time
+    int32_t ox, oy;                       //target buffer offset at the recording time
+    uint8_t channelSize;                  //target channel size at the recording time
+    SwBBox bound;                         //writable region of the target
+    SwTask* task;                         //Shape, Image
+    SwCompositor cmp;                     //compositor states at the recording time
+    SwImage image;                        //Composite: source image
+    SwBBox region;                        //Clear, Composite: target region
+    SwBlender blender;
+    BlendMethod blendMethod;
+    uint8_t opacity;
+    uint8_t type;
+    bool masking;                         //rendered with the compositor
+    bool serial;                          //it can't be split into the bands. ex) texture mapping
+};
+
+
+//Raster cache of a paint subtree, the image is addressed by the target coordinates within its region.
+struct SwCache
+{
+    INLIST_ITEM(SwCache);
+    SwSurface* surface = nullptr;         //offscreen target of the subtree
+    SwCompositor owner;                   //cached image, region and buffer
+    SwBBox drawn = {{0, 0}, {0, 0}};      //target region drawn by the cached image
+    uint32_t frame = 0;                   //drawing count when the cache was used last
+    uint8_t opacity = 0;
+    bool recording = false;               //recording state of the renderer to recover
+    bool dirty = false;                   //the image has been rasterized again since the last drawing
+};
+
+
+struct SwBandJob
+{
+    SwRasterCmd* begin;
+    SwRasterCmd* end;
+    SwBBox clip;                          //raster region
+    uint32_t height;                      //band height
+    uint32_t cnt;                         //band count
+    atomic<uint32_t> next{0};
+};
+
+
+static uint32_t _lowerSpan(const SwRleData* rle, SwCoord y)
+{
+    uint32_t lo = 0, hi = rle->size;
+    while (lo < hi) {
+        auto mid = (lo + hi) / 2;
+        if (rle->spans[mid].y < y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+
+/* The spans are sorted by y, the view shares the spans of the rle unless it needs to be clipped horizontally.
+   Note that the gradient colors depend on the pixel positions only, so the clipped spans keep them. */
+static SwRleData* _clipRle(SwRleData* rle, const SwBBox& clip, bool horizontal, SwRleData* view, Array<SwSpan>& buffer)
+{
+    if (!rle) return nullptr;
+    auto begin = rle->spans + _lowerSpan(rle, clip.min.y);
+    auto end = rle->spans + _lowerSpan(rle, clip.max.y);
+
+    if (!horizontal) {
+        view->spans = begin;
+        view->size = view->alloc = end - begin;
+        return view;
+    }
+
+    buffer.clear();
+    buffer.reserve(end - begin);
+    for (auto span = begin; span < end; ++span) {
+        auto x1 = span->x > clip.min.x ? span->x : clip.min.x;
+        auto x2 = (span->x + span->len) < clip.max.x ? (span->x + span->len) : clip.max.x;
+        if (x2 <= x1) continue;
+        buffer.push({static_cast<uint16_t>(x1), span->y, static_cast<uint16_t>(x2 - x1), span->coverage});
+    }
+    view->spans = buffer.data;
+    view->size = view->alloc = buffer.count;
+    return view;
+}
+
+
+static void _clipBox(SwBBox& bbox, const SwBBox& clip)
+{
+    if (bbox.min.x < clip.min.x) bbox.min.x = clip.min.x;
+    if (bbox.min.y < clip.min.y) bbox.min.y = clip.min.y;
+    if (bbox.max.x > clip.max.x) bbox.max.x = clip.max.x;
+    if (bbox.max.y > clip.max.y) bbox.max.y = clip.max.y;
+    if (bbox.max.x < bbox.min.x) bbox.max.x = bbox.min.x;
+    if (bbox.max.y < bbox.min.y) bbox.max.y = bbox.min.y;
+}
+
+
+//The compositor buffers are reused by the power of two size classes.
+static size_t _sizeClass(size_t size)
+{
+    size_t cls = 4096;
+    while (cls < size) cls <<= 1;
+    return cls;
+}
+
+
+/* The composition targets are as large as their regions, and the masks are valid within their regions.
+   Any pixel beyond them must not be touched. */
+static SwBBox _bound(const SwSurface* surface)
+{
+    SwBBox bound = {{0, 0}, {static_cast<SwCoord>(surface->w), static_cast<SwCoord>(surface->h)}};
+    if (surface->owner) _clipBox(bound, surface->owner->bbox);
+    if (surface->compositor) _clipBox(bound, surface->compositor->bbox);
+    return bound;
+}
+
+
+static bool _contained(const SwBBox& bbox, const SwBBox& bound)
+{
+    return (bbox.min.x >= bound.min.x && bbox.min.y >= bound.min.y && bbox.max.x <= bound.max.x && bbox.max.y <= bound.max.y);
+}
+
+
+static void _capture(SwRasterCmd* cmd, uint8_t type, SwSurface* target)
+{
+    cmd->type = type;
+    cmd->target = target;
+    cmd->data = target->data;
+    cmd->stride = target->stride;
+    cmd->ox = target->ox;
+    cmd->oy = target->oy;
+    cmd->channelSize = target->channelSize;
+    cmd->bound = _bound(target);
+    cmd->task = nullptr;
+    cmd->blender = target->blender;
+    cmd->blendMethod = target->blendMethod;
+    cmd->masking = false;
+    cmd->serial = false;
+
+    if (target->compositor) {
+        cmd->cmp = *target->compositor;
+        cmd->masking = true;
+    }
+}
+
+
+static void _rasterRegion(SwRasterCmd* cmd, const SwBBox& region)
+{
+    auto clip = region;
+    _clipBox(clip, cmd->bound);
+    if (clip.max.x <= clip.min.x || clip.max.y <= clip.min.y) return;
+
+    //Recover the surface states at the recording time, a composition target could be reused since then.
+    SwSurface surface(cmd->target);
+    surface.data = cmd->data;
+    surface.stride = cmd->stride;
+    surface.ox = cmd->ox;
+    surface.oy = cmd->oy;
+    surface.channelSize = cmd->channelSize;
+    surface.blender = cmd->blender;
+    surface.blendMethod = cmd->blendMethod;
+    surface.compositor = nullptr;
+
+    SwCompositor cmp;
+    if (cmd->masking) {
+        cmp = cmd->cmp;
+        _clipBox(cmp.bbox, clip);
+        surface.compositor = &cmp;
+    }
+
+    //The bands cover the whole scanlines, the spans are clipped horizontally only if they exceed the clip.
+    auto horizontal = false;
+    if (cmd->task) horizontal = (cmd->task->bbox.min.x < clip.min.x || cmd->task->bbox.max.x > clip.max.x);
+
+    switch (cmd->type) {
+        case SwRasterCmd::Shape: {
+            auto task = static_cast<SwShapeTask*>(cmd->task);
+            auto shape = task->shape;
+            SwRleData rle, strokeRle;
+            Array<SwSpan> spans, strokeSpans;
+            shape.rle = _clipRle(shape.rle, clip, horizontal, &rle, spans);
+            shape.strokeRle = _clipRle(shape.strokeRle, clip, horizontal, &strokeRle, strokeSpans);
+            _clipBox(shape.bbox, clip);
+            _renderShape(task->rshape, &shape, &surface, task->opacity);
+            break;
+        }
+        case SwRasterCmd::Image: {
+            auto task = static_cast<SwImageTask*>(cmd->task);
+            auto image = task->image;
+            auto bbox = task->bbox;
+            SwRleData rle;
+            Array<SwSpan> spans;
+            image.rle = _clipRle(image.rle, clip, horizontal, &rle, spans);
+            _clipBox(bbox, clip);
+            if (bbox.max.x > bbox.min.x && bbox.max.y > bbox.min.y) {
+                rasterImage(&surface, &image, task->mesh, task->transform, bbox, task->opacity);
+            }
+            break;
+        }
+        case SwRasterCmd::Clear: {
+            auto region = cmd->region;
+            _clipBox(region, clip);
+            if (region.max.x > region.min.x && region.max.y > region.min.y) {
+                rasterClear(&surface, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
+            }
+            break;
+        }
+        case SwRasterCmd::Composite: {
+            auto region = cmd->region;
+            _clipBox(region, clip);
+            if (region.max.x > region.min.x && region.max.y > region.min.y) {
+                rasterImage(&surface, &cmd->image, nullptr, nullptr, region, cmd->opacity);
+            }
+            break;
+        }
+    }
+}
+
+
+static void _rasterBands(SwBandJob* job)
+{
+    uint32_t band;
+    while ((band = job->next.fetch_add(1, memory_order_relaxed)) < job->cnt) {
+        auto clip = job->clip;
+        clip.min.y += band * job->height;
+        if (clip.min.y + static_cast<SwCoord>(job->height) < clip.max.y) clip.max.y = clip.min.y + job->height;
+        for (auto cmd = job->begin; cmd < job->end; ++cmd) {
+            _rasterRegion(cmd, clip);
+        }
+    }
+}
+
+
+//Merge the overlapped regions, so that any pixel is redrawn only once.
+static void _mergeDamages(Array<SwBBox>& regions)
+{
+    auto merged = true;
+    while (merged) {
+        merged = false;
+        for (uint32_t i = 0; i < regions.count; ++i) {
+            for (uint32_t j = i + 1; j < regions.count; ++j) {
+                if (!_overlap(regions[i], regions[j])) continue;
+                _unite(regions[i], regions[j]);
+                regions[j] = regions.last();
+                regions.pop();
+                --j;
+                merged = true;
+            }
+        }
+    }
+}
+
+
+struct SwBandTask : Task
+{
+    SwBandJob* job = nullptr;
+
+    void run(unsigned tid) override
+    {
+        _rasterBands(job);
+    }
+};
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
 
 SwRenderer::~SwRenderer()
 {
+    for (auto task = bandTasks.begin(); task < bandTasks.end(); ++task) {
+        delete(*task);
+    }
+
     clearCompositors();
 
+    while (caches.head) evict(caches.head);
+
     delete(surface);
 
     if (!sharedMpool) mpoolTerm(mpool);
@@ -377,6 +790,8 @@ SwRenderer::~SwRenderer()
 
 bool SwRenderer::clear()
 {
+    //The damaged regions are cleared before they are redrawn.
+    if (partialRedraw) return surface ? true : false;
     if (surface) return rasterClear(surface, 0, 0, surface->w, surface->h);
     return false;
 }
@@ -419,6 +834,9 @@ bool SwRenderer::target(pixel_t* data, uint32_t stride, uint32_t w, uint32_t h,
 
     clearCompositors();
 
+    //The cached images must be rasterized for the new target again.
+    while (caches.head) evict(caches.head);
+
     if (!surface) surface = new SwSurface;
 
     surface->data = data;
@@ -433,6 +851,9 @@ bool SwRenderer::target(pixel_t* data, uint32_t stride, uint32_t w, uint32_t h,
     vport.w = surface->w;
     vport.h = surface->h;
 
+    //The new target must be drawn entirely.
+    damage({{0, 0}, {static_cast<SwCoord>(w), static_cast<SwCoord>(h)}});
+
     return rasterCompositor(surface);
 }
 
@@ -445,6 +866,12 @@ bool SwRenderer::preRender()
         vport.h = surface->h;
     }
 
+    //The raster commands are replayed either by bands or by the damaged regions.
+    recording = surface && (partialRedraw || (banding && TaskScheduler::threads() > 0 && !TaskScheduler::worker()));
+    cmds.clear();
+
+    ++frame;
+
     return true;
 }
 
@@ -453,19 +880,198 @@ void SwRenderer::clearCompositors()
 {
     //Free Composite Caches
     for (auto comp = compositors.begin(); comp < compositors.end(); ++comp) {
-        free((*comp)->compositor->image.data);
-        delete((*comp)->compositor);
+        free((*comp)->owner->buffer);
+        delete((*comp)->owner);
         delete(*comp);
     }
     compositors.reset();
 }
 
 
+SwRasterCmd* SwRenderer::record(uint8_t type, SwSurface* target)
+{
+    cmds.grow(1);
+    auto cmd = cmds.end();
+    ++cmds.count;
+
+    _capture(cmd, type, target);
+
+    return cmd;
+}
+
+
+void SwRenderer::damage(const SwBBox& region)
+{
+    if (!partialRedraw || region.max.x <= region.min.x || region.max.y <= region.min.y) return;
+    dirties.push(region);
+}
+
+
+void SwRenderer::drawn(SwTask* task, const SwBBox& region)
+{
+    if (!task->dirty) return;
+    task->drawn = region;
+    task->dirty = false;
+    damage(region);
+}
+
+
+void SwRenderer::rasterize(const SwBBox& clip)
+{
+    //A worker can't wait for the other workers, it rasterizes alone.
+    auto threads = (banding && !TaskScheduler::worker()) ? TaskScheduler::threads() : 0;
+    auto cmd = cmds.begin();
+
+    while (cmd < cmds.end()) {
+        //Texture mapping can't be split by these bands due to its anti-aliasing, it runs its own bands instead.
+        if (cmd->serial) {
+            _rasterRegion(cmd, clip);
+            ++cmd;
+            continue;
+        }
+
+        SwBandJob job;
+        job.begin = cmd;
+        job.end = cmd;
+        job.clip = clip;
+        while (job.end < cmds.end() && !job.end->serial) ++job.end;
+
+        //more bands than the threads for the balanced work loads
+        auto height = static_cast<uint32_t>(clip.max.y - clip.min.y);
+        job.cnt = threads > 0 ? (threads + 1) * 4 : 1;
+        job.height = (height + job.cnt - 1) / job.cnt;
+        if (job.height < 16) job.height = 16;
+        job.cnt = (height + job.height - 1) / job.height;
+
+        auto helpers = (job.cnt - 1) < threads ? (job.cnt - 1) : threads;
+        while (bandTasks.count < helpers) bandTasks.push(new SwBandTask);
+
+        for (uint32_t i = 0; i < helpers; ++i) {
+            bandTasks[i]->job = &job;
+            TaskScheduler::request(bandTasks[i]);
+        }
+
+        //the caller takes its share as well
+        _rasterBands(&job);
+
+        for (uint32_t i = 0; i < helpers; ++i) {
+            bandTasks[i]->done();
+        }
+
+        cmd = job.end;
+    }
+}
+
+
+void SwRenderer::redraw()
+{
+    redrawn.clear();
+
+    SwBBox bound;
+    bound.min.x = mathMax(static_cast<SwCoord>(0), static_cast<SwCoord>(vport.x));
+    bound.min.y = mathMax(static_cast<SwCoord>(0), static_cast<SwCoord>(vport.y));
+    bound.max.x = mathMin(static_cast<SwCoord>(surface->w), static_cast<SwCoord>(vport.x + vport.w));
+    bound.max.y = mathMin(static_cast<SwCoord>(surface->h), static_cast<SwCoord>(vport.y + vport.h));
+
+    Array<SwBBox> regions;
+    regions.reserve(dirties.count);
+    for (auto region = dirties.begin(); region < dirties.end(); ++region) {
+        auto clipped = *region;
+        _clipBox(clipped, bound);
+        if (clipped.max.x > clipped.min.x && clipped.max.y > clipped.min.y) regions.push(clipped);
+    }
+    dirties.clear();
+
+    //Too many fragments, a single region is cheaper than merging them.
+    if (regions.count > 64) {
+        for (auto region = regions.begin() + 1; region < regions.end(); ++region) {
+            _unite(regions.first(), *region);
+        }
+        regions.count = 1;
+    }
+
+    //A texture mapped image must be contained in a region entirely, it can't be clipped partially.
+    auto grown = true;
+    while (grown) {
+        _mergeDamages(regions);
+        grown = false;
+        for (auto cmd = cmds.begin(); cmd < cmds.end(); ++cmd) {
+            if (!cmd->serial) continue;
+            auto bbox = cmd->task->bbox;
+            _clipBox(bbox, bound);
+            for (auto region = regions.begin(); region < regions.end(); ++region) {
+                if (!_overlap(*region, bbox)) continue;
+                if (bbox.min.x < region->min.x || bbox.min.y < region->min.y || bbox.max.x > region->max.x || bbox.max.y > region->max.y) {
+                    _unite(*region, bbox);
+                    grown = true;
+                }
+            }
+        }
+    }
+
+    for (auto region = regions.begin(); region < regions.end(); ++region) {
+        auto w = region->max.x - region->min.x;
+        auto h = region->max.y - region->min.y;
+        rasterClear(surface, region->min.x, region->min.y, w, h);
+        rasterize(*region);
+        redrawn.push({static_cast<int32_t>(region->min.x), static_cast<int32_t>(region->min.y), static_cast<int32_t>(w), static_cast<int32_t>(h)});
+    }
+}
+
+
+bool SwRenderer::banded(bool on)
+{
+    banding = on;
+    return true;
+}
+
+
+bool SwRenderer::partial(bool on)
+{
+    if (partialRedraw == on) return true;
+    partialRedraw = on;
+    dirties.clear();
+    redrawn.clear();
+
+    //Starts with drawing the whole target.
+    if (surface) damage({{0, 0}, {static_cast<SwCoord>(surface->w), static_cast<SwCoord>(surface->h)}});
+
+    return true;
+}
+
+
+uint32_t SwRenderer::damages(const RenderRegion** regions) const
+{
+    if (regions) *regions = redrawn.data;
+    return redrawn.count;
+}
+
+
+void SwRenderer::stats(uint32_t* reused, uint32_t* generated) const
+{
+    if (reused) *reused = rleStats.reused;
+    if (generated) *generated = rleStats.generated;
+}
+
+
 bool SwRenderer::postRender()
 {
+    if (recording) {
+        if (partialRedraw) redraw();
+        else rasterize({{0, 0}, {static_cast<SwCoord>(surface->w), static_cast<SwCoord>(surface->h)}});
+        cmds.clear();
+        recording = false;
+    }
+
     //Unmultiply alpha if needed
     if (surface->cs == ColorSpace::ABGR8888S || surface->cs == ColorSpace::ARGB8888S) {
-        rasterUnpremultiply(surface);
+        if (partialRedraw) {
+            for (auto region = redrawn.begin(); region < redrawn.end(); ++region) {
+                rasterUnpremultiply(surface, region->x, region->y, region->w, region->h);
+            }
+        } else {
+            rasterUnpremultiply(surface, 0, 0, surface->w, surface->h);
+        }
     }
 
     for (auto task = tasks.begin(); task < tasks.end(); ++task) {
@@ -485,6 +1091,24 @@ bool SwRenderer::renderImage(RenderData data)
 
     if (task->opacity == 0) return true;
 
+    drawn(task, task->bbox);
+
+    if (recording) {
+        auto cmd = record(SwRasterCmd::Image, surface);
+        cmd->task = task;
+        cmd->serial = (task->mesh && task->mesh->triangleCnt > 0) || (!task->image.direct && !task->image.scaled);
+        return true;
+    }
+
+    auto bound = _bound(surface);
+    if (!_contained(task->bbox, bound)) {
+        SwRasterCmd cmd;
+        _capture(&cmd, SwRasterCmd::Image, surface);
+        cmd.task = task;
+        _rasterRegion(&cmd, bound);
+        return true;
+    }
+
     return rasterImage(surface, &task->image, task->mesh, task->transform, task->bbox, task->opacity);
 }
 
@@ -498,15 +1122,26 @@ bool SwRenderer::renderShape(RenderData data)
 
     if (task->opacity == 0) return true;
 
-    //Main raster stage
-    if (task->rshape->stroke && task->rshape->stroke->strokeFirst) {
-        _renderStroke(task, surface, task->opacity);
-        _renderFill(task, surface, task->opacity);
-    } else {
-        _renderFill(task, surface, task->opacity);
-        _renderStroke(task, surface, task->opacity);
+    drawn(task, task->bbox);
+
+    if (recording) {
+        record(SwRasterCmd::Shape, surface)->task = task;
+        return true;
     }
 
+    //The contents exceed the composition region
+    auto bound = _bound(surface);
+    if (!_contained(task->bbox, bound)) {
+        SwRasterCmd cmd;
+        _capture(&cmd, SwRasterCmd::Shape, surface);
+        cmd.task = task;
+        _rasterRegion(&cmd, bound);
+        return true;
+    }
+
+    //Main raster stage
+    _renderShape(task->rshape, &task->shape, surface, task->opacity);
+
     return true;
 }
 
@@ -617,16 +1252,41 @@ Compositor* SwRenderer::target(const RenderRegion& region, ColorSpace cs)
     auto sw = static_cast<int32_t>(surface->w);
     auto sh = static_cast<int32_t>(surface->h);
 
+    //Boundary Check
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > sw) w = (sw - x);
+    if (y + h > sh) h = (sh - y);
+
+    //The pixels beyond the current target are invisible.
+    SwBBox bbox = {{x, y}, {x + w, y + h}};
+    if (surface->owner) _clipBox(bbox, surface->owner->bbox);
+
     //Out of boundary
-    if (x >= sw || y >= sh || x + w < 0 || y + h < 0) return nullptr;
+    if (bbox.max.x <= bbox.min.x || bbox.max.y <= bbox.min.y) return nullptr;
 
-    SwSurface* cmp = nullptr;
+    x = bbox.min.x;
+    y = bbox.min.y;
+    w = bbox.max.x - bbox.min.x;
+    h = bbox.max.y - bbox.min.y;
 
-    auto reqChannelSize = CHANNEL_SIZE(cs);
+    auto csize = CHANNEL_SIZE(cs);
+    auto size = _sizeClass((static_cast<size_t>(w) * h + 2) * csize);
 
-    //Use cached data
+    /* The bands replay the recorded commands concurrently, each of them at its own rows.
+       A buffer addressed by another region in the same frame would be shared across the bands. */
+    auto reusable = !(recording && banding);
+
+    //Use cached data in the same size class
+    SwSurface* cmp = nullptr;
     for (auto p = compositors.begin(); p < compositors.end(); ++p) {
-        if ((*p)->compositor->valid && (*p)->compositor->image.channelSize == reqChannelSize) {
+        if ((*p)->owner->valid && (*p)->owner->size == size && (reusable || (*p)->owner->frame != frame)) {
             cmp = *p;
             break;
         }
@@ -636,41 +1296,51 @@ Compositor* SwRenderer::target(const RenderRegion& region, ColorSpace cs)
     if (!cmp) {
         //Inherits attributes from main surface
         cmp = new SwSurface(surface);
-        cmp->compositor = new SwCompositor;
-
-        //TODO: We can optimize compositor surface size from (surface->stride x surface->h) to Parameter(w x h)
-        cmp->compositor->image.data = (pixel_t*)malloc(reqChannelSize * surface->stride * surface->h);
-        cmp->channelSize = cmp->compositor->image.channelSize = reqChannelSize;
-
+        cmp->owner = cmp->compositor = new SwCompositor;
+        cmp->owner->buffer = malloc(size);
+        cmp->owner->size = size;
         compositors.push(cmp);
     }
 
-    //Boundary Check
-    if (x + w > sw) w = (sw - x);
-    if (y + h > sh) h = (sh - y);
-
-    cmp->compositor->recoverSfc = surface;
-    cmp->compositor->recoverCmp = surface->compositor;
-    cmp->compositor->valid = false;
-    cmp->compositor->bbox.min.x = x;
-    cmp->compositor->bbox.min.y = y;
-    cmp->compositor->bbox.max.x = x + w;
-    cmp->compositor->bbox.max.y = y + h;
-    cmp->compositor->image.stride = surface->stride;
-    cmp->compositor->image.w = surface->w;
-    cmp->compositor->image.h = surface->h;
-    cmp->compositor->image.direct = true;
-
-    cmp->data = cmp->compositor->image.data;
-    cmp->w = cmp->compositor->image.w;
-    cmp->h = cmp->compositor->image.h;
-
-    rasterClear(cmp, x, y, w, h);
+    /* The buffer covers the region only, it's addressed by the target coordinates with the offset of the region.
+       A guard pixel is placed at both ends for the neighbor pixels access of the texture mapping. */
+    auto p = cmp->owner;
+    p->recoverSfc = surface;
+    p->recoverCmp = surface->compositor;
+    p->frame = frame;
+    p->valid = false;
+    p->bbox = bbox;
+    p->image.buf8 = static_cast<uint8_t*>(p->buffer) + csize;
+    p->image.ox = -x;
+    p->image.oy = -y;
+    p->image.stride = w;
+    p->image.w = surface->w;
+    p->image.h = surface->h;
+    p->image.channelSize = csize;
+    p->image.direct = true;
+
+    cmp->data = p->image.data;
+    cmp->ox = p->image.ox;
+    cmp->oy = p->image.oy;
+    cmp->stride = p->image.stride;
+    cmp->w = p->image.w;
+    cmp->h = p->image.h;
+    cmp->channelSize = csize;
+
+    if (recording) {
+        auto cmd = record(SwRasterCmd::Clear, cmp);
+        cmd->region.min.x = x;
+        cmd->region.min.y = y;
+        cmd->region.max.x = x + w;
+        cmd->region.max.y = y + h;
+    } else {
+        rasterClear(cmp, x, y, w, h);
+    }
 
     //Switch render target
     surface = cmp;
 
-    return cmp->compositor;
+    return p;
 }
 
 
@@ -687,9 +1357,200 @@ bool SwRenderer::endComposite(Compositor* cmp)
 
     //Default is alpha blending
     if (p->method == CompositeMethod::None) {
-        return rasterImage(surface, &p->image, nullptr, nullptr, p->bbox, p->opacity);
+        if (recording) {
+            auto cmd = record(SwRasterCmd::Composite, surface);
+            cmd->image = p->image;
+            cmd->region = p->bbox;
+            cmd->opacity = p->opacity;
+            return true;
+        }
+        auto bbox = p->bbox;
+        _clipBox(bbox, _bound(surface));
+        if (bbox.max.x <= bbox.min.x || bbox.max.y <= bbox.min.y) return true;
+        return rasterImage(surface, &p->image, nullptr, nullptr, bbox, p->opacity);
+    }
+
+    return true;
+}
+
+
+void SwRenderer::evict(SwCache* cache)
+{
+    if (!cache->owner.buffer) return;
+    caches.remove(cache);
+    cacheSize -= cache->owner.size;
+    free(cache->owner.buffer);
+    cache->owner.buffer = nullptr;
+    cache->owner.size = 0;
+}
+
+
+bool SwRenderer::beginCache(RenderData* data, const RenderRegion& region)
+{
+    if (!surface) return false;
+
+    auto cache = static_cast<SwCache*>(*data);
+
+    //The previous drawing of the image must be redrawn.
+    if (cache) {
+        damage(cache->drawn);
+        cache->drawn.reset();
+    }
+
+    //The image must have the whole subtree since it could be moved, the clipped one by the target can't be cached.
+    if (region.x <= mathMax(0, vport.x) || region.y <= mathMax(0, vport.y) ||
+        region.x + region.w >= mathMin(static_cast<int32_t>(surface->w), vport.x + vport.w) ||
+        region.y + region.h >= mathMin(static_cast<int32_t>(surface->h), vport.y + vport.h)) {
+        if (cache) evict(cache);
+        return false;
+    }
+
+    auto csize = CHANNEL_SIZE(surface->cs);
+    auto size = static_cast<size_t>(region.w) * region.h * csize;
+
+    if (!cache) {
+        cache = new SwCache;
+        *data = cache;
+    }
+
+    if (cache->owner.size < size) {
+        evict(cache);
+        if (size > cacheLimit) return false;
+
+        //The least recently drawn caches give their room, but the ones drawn in this frame are still in use.
+        while (cacheSize + size > cacheLimit) {
+            if (caches.head->frame == frame) return false;
+            evict(caches.head);
+        }
+
+        cache->owner.buffer = malloc(size);
+        if (!cache->owner.buffer) return false;
+        cache->owner.size = size;
+        cacheSize += size;
+        caches.back(cache);
     }
 
+    if (!cache->surface) cache->surface = new SwSurface(surface);
+
+    auto p = &cache->owner;
+    p->bbox = {{region.x, region.y}, {region.x + region.w, region.y + region.h}};
+    p->image.buf8 = static_cast<uint8_t*>(p->buffer);
+    p->image.ox = -region.x;
+    p->image.oy = -region.y;
+    p->image.stride = region.w;
+    p->image.w = surface->w;
+    p->image.h = surface->h;
+    p->image.channelSize = csize;
+    p->image.direct = true;
+    p->recoverSfc = surface;
+    p->valid = true;
+
+    auto cmp = cache->surface;
+    cmp->data = p->image.data;
+    cmp->ox = p->image.ox;
+    cmp->oy = p->image.oy;
+    cmp->stride = p->image.stride;
+    cmp->w = p->image.w;
+    cmp->h = p->image.h;
+    cmp->cs = surface->cs;
+    cmp->channelSize = csize;
+    cmp->owner = p;
+    cmp->compositor = nullptr;
+
+    rasterClear(cmp, region.x, region.y, region.w, region.h);
+
+    //The subtree is rasterized immediately, the image is ready before the recorded commands are replayed.
+    cache->recording = recording;
+    recording = false;
+    cache->dirty = true;
+
+    //Switch render target
+    surface = cmp;
+
+    return true;
+}
+
+
+bool SwRenderer::endCache(RenderData data)
+{
+    auto cache = static_cast<SwCache*>(data);
+    if (!cache) return false;
+
+    //Recover Context
+    surface = cache->owner.recoverSfc;
+    recording = cache->recording;
+
+    return true;
+}
+
+
+bool SwRenderer::renderCache(RenderData data, int32_t x, int32_t y, uint8_t opacity)
+{
+    auto cache = static_cast<SwCache*>(data);
+    if (!cache || !cache->owner.buffer) return false;
+
+    //The most recently drawn one
+    cache->frame = frame;
+    caches.remove(cache);
+    caches.back(cache);
+
+    auto region = cache->owner.bbox;
+    region.min.x += x;
+    region.min.y += y;
+    region.max.x += x;
+    region.max.y += y;
+
+    if (cache->dirty || cache->opacity != opacity || region.min.x != cache->drawn.min.x || region.min.y != cache->drawn.min.y ||
+        region.max.x != cache->drawn.max.x || region.max.y != cache->drawn.max.y) {
+        damage(cache->drawn);
+        damage(region);
+        cache->drawn = region;
+        cache->opacity = opacity;
+        cache->dirty = false;
+    }
+
+    if (opacity == 0) return true;
+
+    auto image = cache->owner.image;
+    image.ox -= x;
+    image.oy -= y;
+
+    if (recording) {
+        auto cmd = record(SwRasterCmd::Composite, surface);
+        cmd->image = image;
+        cmd->region = region;
+        cmd->opacity = opacity;
+        return true;
+    }
+
+    _clipBox(region, _bound(surface));
+    if (region.max.x <= region.min.x || region.max.y <= region.min.y) return true;
+    return rasterImage(surface, &image, nullptr, nullptr, region, opacity);
+}
+
+
+bool SwRenderer::cached(RenderData data)
+{
+    auto cache = static_cast<SwCache*>(data);
+    return (cache && cache->owner.buffer);
+}
+
+
+void SwRenderer::disposeCache(RenderData data)
+{
+    auto cache = static_cast<SwCache*>(data);
+    if (!cache) return;
+    damage(cache->drawn);
+    evict(cache);
+    delete(cache->surface);
+    delete(cache);
+}
+
+
+bool SwRenderer::cacheBudget(uint32_t size)
+{
+    cacheLimit = size;
+    while (cacheSize > cacheLimit) evict(caches.head);
     return true;
 }
 
@@ -707,13 +1568,14 @@ void SwRenderer::dispose(RenderData data)
     if (!task) return;
     task->done();
     task->dispose();
+    damage(task->drawn);
 
     if (task->pushed) task->disposed = true;
     else delete(task);
 }
 
 
-void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform, const Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags)
+void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform, const Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags, const Array<RenderData>* scene)
 {
     if (!surface) return task;
     if (flags == RenderUpdateFlag::None) return task;
@@ -721,12 +1583,10 @@ void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform,
     //Finish previous task if it has duplicated request.
     task->done();
 
-    //TODO: Failed threading them. It would be better if it's possible.
-    //See: https://github.com/thorvg/thorvg/issues/1409
-    //Guarantee composition targets get ready.
-    for (auto clip = clips.begin(); clip < clips.end(); ++clip) {
-        static_cast<SwTask*>(*clip)->done();
-    }
+    //The previous drawing region must be redrawn.
+    damage(task->drawn);
+    task->drawn.reset();
+    task->dirty = true;
 
     task->clips = clips;
 
@@ -758,7 +1618,19 @@ void* SwRenderer::prepareCommon(SwTask* task, const RenderTransform* transform,
         tasks.push(task);
     }
 
-    TaskScheduler::request(task);
+    //Composition targets and scene members must get ready before the task runs.
+    deps.clear();
+    deps.reserve(clips.count + (scene ? scene->count : 0));
+    for (auto clip = clips.begin(); clip < clips.end(); ++clip) {
+        deps.push(static_cast<SwTask*>(*clip));
+    }
+    if (scene) {
+        for (auto member = scene->begin(); member < scene->end(); ++member) {
+            deps.push(static_cast<SwTask*>(*member));
+        }
+    }
+
+    TaskScheduler::request(task, deps.data, deps.count);
 
     return task;
 }
@@ -782,13 +1654,7 @@ RenderData SwRenderer::prepare(const Array<RenderData>& scene, RenderData data,
     if (!task) task = new SwSceneTask;
     task->scene = scene;
 
-    //TODO: Failed threading them. It would be better if it's possible.
-    //See: https://github.com/thorvg/thorvg/issues/1409
-    //Guarantee composition targets get ready.
-    for (auto task = scene.begin(); task < scene.end(); ++task) {
-        static_cast<SwTask*>(*task)->done();
-    }
-    return prepareCommon(task, transform, clips, opacity, flags);
+    return prepareCommon(task, transform, clips, opacity, flags, &scene);
 }
 
 
@@ -799,6 +1665,7 @@ RenderData SwRenderer::prepare(const RenderShape& rshape, RenderData data, const
     if (!task) {
         task = new SwShapeTask;
         task->rshape = &rshape;
+        task->stats = &rleStats;
     }
     task->clipper = clipper;
 
@@ -817,6 +1684,10 @@ bool SwRenderer::init(uint32_t threads)
 
     threadsCnt = threads;
 
+    //Pick up the raster kernels for this cpu
+    rasterSimd(_simdLimit());
+    TVGLOG("SW_ENGINE", "Raster kernels = %d", (int) rasterSimd());
+
     //Share the memory pool among the renderer
     globalMpool = mpoolInit(threads);
     if (!globalMpool) {
@@ -834,6 +1705,15 @@ int32_t SwRenderer::init()
 }
 
 
+void SwRenderer::simd(SwCanvas::Simd limit)
+{
+    simdPolicy = limit;
+
+    //Otherwise, it's applied on the initialization
+    if (initEngineCnt > 0) rasterSimd(_simdLimit());
+}
+
+
 bool SwRenderer::term()
 {
     if ((--initEngineCnt) > 0) return true;
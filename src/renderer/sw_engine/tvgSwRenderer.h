@@ -23,16 +23,31 @@
 #ifndef _TVG_SW_RENDERER_H_
 #define _TVG_SW_RENDERER_H_
 
+#include <atomic>
 #include "tvgRender.h"
+#include "tvgInlist.h"
 
 struct SwSurface;
 struct SwTask;
 struct SwCompositor;
 struct SwMpool;
+struct SwRasterCmd;
+struct SwBandTask;
+struct SwBBox;
+struct SwCache;
 
 namespace tvg
 {
 
+struct Task;
+
+//The updates of the shapes, counted since the renderer was created
+struct SwRleStats
+{
+    std::atomic<uint32_t> reused{0};      //the shapes translated without regenerating the rle
+    std::atomic<uint32_t> generated{0};   //the shapes generated the rle
+};
+
 class SwRenderer : public RenderMethod
 {
 public:
@@ -54,29 +69,61 @@ public:
     bool sync() override;
     bool target(pixel_t* data, uint32_t stride, uint32_t w, uint32_t h, ColorSpace cs);
     bool mempool(bool shared);
+    bool banded(bool on);
+    bool partial(bool on);
+    uint32_t damages(const RenderRegion** regions) const;
+    void stats(uint32_t* reused, uint32_t* generated) const;
 
     Compositor* target(const RenderRegion& region, ColorSpace cs) override;
     bool beginComposite(Compositor* cmp, CompositeMethod method, uint8_t opacity) override;
     bool endComposite(Compositor* cmp) override;
     void clearCompositors();
 
+    bool beginCache(RenderData* cache, const RenderRegion& region) override;
+    bool endCache(RenderData cache) override;
+    bool renderCache(RenderData cache, int32_t x, int32_t y, uint8_t opacity) override;
+    bool cached(RenderData cache) override;
+    void disposeCache(RenderData cache) override;
+    bool cacheBudget(uint32_t size);
+
     static SwRenderer* gen();
     static bool init(uint32_t threads);
     static int32_t init();
     static bool term();
+    static void simd(SwCanvas::Simd limit);
 
 private:
     SwSurface*           surface = nullptr;           //active surface
     Array<SwTask*>       tasks;                       //async task list
+    Array<Task*>         deps;                        //dependencies of the task being prepared
     Array<SwSurface*>    compositors;                 //render targets cache list
     SwMpool*             mpool;                       //private memory pool
-    RenderRegion         vport;                       //viewport
+    RenderRegion         vport = {0, 0, 0, 0};        //viewport
     bool                 sharedMpool = true;          //memory-pool behavior policy
+    Array<SwRasterCmd>   cmds;                        //recorded raster commands for the banded rasterization
+    Array<SwBandTask*>   bandTasks;                   //band rasterization helpers
+    bool                 banding = false;             //raster policy: run the raster stage by bands across the threads
+    bool                 recording = false;           //the raster commands are being recorded in this frame
+    Array<SwBBox>        dirties;                     //damaged regions since the last drawing
+    Array<RenderRegion>  redrawn;                     //regions redrawn by the last drawing
+    bool                 partialRedraw = false;       //redraw the damaged regions only
+    Inlist<SwCache>      caches;                      //raster caches of the paints, the least recently drawn one comes first
+    size_t               cacheSize = 0;               //memory of the raster caches in bytes
+    size_t               cacheLimit = 32 * 1024 * 1024;  //memory budget of the raster caches in bytes
+    uint32_t             frame = 0;                   //drawing count, it tells the raster caches in use
+    SwRleStats           rleStats;                    //the rle reused or generated by the shapes
 
     SwRenderer();
     ~SwRenderer();
 
-    RenderData prepareCommon(SwTask* task, const RenderTransform* transform, const Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags);
+    SwRasterCmd* record(uint8_t type, SwSurface* target);
+    void rasterize(const SwBBox& clip);
+    void redraw();
+    void damage(const SwBBox& region);
+    void drawn(SwTask* task, const SwBBox& region);
+    void evict(SwCache* cache);
+
+    RenderData prepareCommon(SwTask* task, const RenderTransform* transform, const Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags, const Array<RenderData>* scene = nullptr);
 };
 
 }
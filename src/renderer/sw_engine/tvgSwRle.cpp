@@ -191,6 +191,8 @@
 #include <setjmp.h>
 #include <limits.h>
 #include <memory.h>
+#include <float.h>
+#include "tvgMath.h"
 #include "tvgSwCommon.h"
 
 /************************************************************************/
@@ -200,6 +202,8 @@
 constexpr auto MAX_SPANS = 256;
 constexpr auto PIXEL_BITS = 8;   //must be at least 6 bits!
 constexpr auto ONE_PIXEL = (1L << PIXEL_BITS);
+constexpr auto ACC_POOL_LIMIT = 4L * 1024L * 1024L;   //the max memory of the accumulated cells
+constexpr auto ACC_COST_RATIO = 2L;                   //cost of a cell search per crossing vs. a cell sweep
 
 using Area = long;
 
@@ -216,6 +220,13 @@ struct Cell
     Cell *next;
 };
 
+//A cell of the dense accumulation buffer, see _accumulate()
+struct AccCell
+{
+    int32_t cover;
+    int32_t area;
+};
+
 struct RleWorker
 {
     SwRleData* rle;
@@ -255,6 +266,8 @@ struct RleWorker
     Cell** yCells;
     SwCoord yCnt;
 
+    AccCell* accCells;    //not null if the cells are accumulated densely
+
     bool invalid;
     bool antiAlias;
 };
@@ -432,6 +445,34 @@ static void _sweep(RleWorker& rw)
 }
 
 
+//The prefix sum of the accumulated covers, the same coverage as _sweep() generates.
+static void _sweepAccCells(RleWorker& rw)
+{
+    rw.spansCnt = 0;
+    rw.ySpan = 0;
+
+    auto cell = rw.accCells;
+
+    for (int y = 0; y < rw.yCnt; ++y) {
+        SwCoord cover = (cell++)->cover;   //cells on the left of the region
+        SwCoord x = 0;
+
+        for (SwCoord i = 0; i < rw.cellXCnt; ++i, ++cell) {
+            if (!(cell->cover | cell->area)) continue;
+            if (i > x && cover != 0) _horizLine(rw, x, y, cover * (ONE_PIXEL * 2), i - x);
+            cover += cell->cover;
+            auto area = cover * (ONE_PIXEL * 2) - cell->area;
+            if (area != 0) _horizLine(rw, i, y, area, 1);
+            x = i + 1;
+        }
+
+        if (cover != 0) _horizLine(rw, x, y, cover * (ONE_PIXEL * 2), rw.cellXCnt - x);
+    }
+
+    if (rw.spansCnt > 0) _genSpan(rw.rle, rw.spans, rw.spansCnt);
+}
+
+
 static Cell* _findCell(RleWorker& rw)
 {
     auto x = rw.cellPos.x;
@@ -462,6 +503,14 @@ static Cell* _findCell(RleWorker& rw)
 static void _recordCell(RleWorker& rw)
 {
     if (rw.area | rw.cover) {
+        //the first column takes all the cells on the left of the region
+        if (rw.accCells) {
+            auto x = (rw.cellPos.x < 0) ? 0 : (rw.cellPos.x + 1);
+            auto cell = rw.accCells + rw.cellPos.y * (rw.cellXCnt + 1) + x;
+            cell->area += rw.area;
+            cell->cover += rw.cover;
+            return;
+        }
         auto cell = _findCell(rw);
         cell->area += rw.area;
         cell->cover += rw.cover;
@@ -891,11 +940,266 @@ static SwSpan* _mergeSpansRegion(const SwRleData *clip1, const SwRleData *clip2,
 }
 
 
-void _replaceClipSpan(SwRleData *rle, SwSpan* clippedSpans, uint32_t size)
+//The clipped spans are kept in the rle's memory, it's reused when the rle is generated again.
+static bool _copyClipSpan(SwRleData *rle, const SwSpan* clippedSpans, uint32_t size)
+{
+    if (rle->alloc < size) {
+        auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * size));
+        if (!spans) return false;
+        free(rle->spans);
+        rle->spans = spans;
+        rle->alloc = size;
+    }
+    if (rle->spans != clippedSpans) memcpy(rle->spans, clippedSpans, sizeof(SwSpan) * size);
+    rle->size = size;
+    return true;
+}
+
+
+/* The cells are searched in the sorted lists and the bands are split and regenerated when the cells
+   overflow the render pool. It costs a lot for the paths that cross a row many times, such as the
+   glyphs and the maps. Instead, the cells of the whole region could be accumulated into a dense
+   buffer without any search and swept once by their prefix sums. It costs the region area though,
+   thus it's chosen when the outline is long enough in comparison with the area. */
+static bool _accumulable(const SwOutline* outline, const SwBBox& region, long poolSize)
+{
+    auto w = static_cast<long>(region.max.x - region.min.x);
+    auto h = static_cast<long>(region.max.y - region.min.y);
+    if (w <= 0 || h <= 0) return false;
+
+    auto size = (w + 1) * h * static_cast<long>(sizeof(AccCell));
+
+    //no extra memory is required
+    if (size <= poolSize) return true;
+    if (size > ACC_POOL_LIMIT) return false;
+
+    /* the cells are searched by the crossings per row (len / h) in average, thus worth it if
+       len * len >= ACC_COST_RATIO * w * h * h. The length is compared in 26.6 without the squares,
+       and it's not summed up further once it's over, the long paths could overflow it. */
+    auto limit = sqrt(static_cast<double>(ACC_COST_RATIO) * w * h * h) * 64.0;
+
+    //the length of the outline, roughly.
+    double len = 0.0;
+    auto pt = outline->pts.data;
+    for (uint32_t i = 1; i < outline->pts.count; ++i, ++pt) {
+        len += fabs(static_cast<double>(pt[1].x) - pt[0].x) + fabs(static_cast<double>(pt[1].y) - pt[0].y);
+        if (len >= limit) return true;
+    }
+    return false;
+}
+
+
+static bool _accumulate(RleWorker& rw, void* pool, long poolSize, SwMpool* mpool, unsigned tid)
+{
+    auto size = (rw.cellXCnt + 1) * rw.cellYCnt * static_cast<long>(sizeof(AccCell));
+
+    if (size <= poolSize) rw.accCells = static_cast<AccCell*>(pool);
+    else if (!(rw.accCells = static_cast<AccCell*>(mpoolReqArena(mpool, tid, size)))) return false;
+    memset(rw.accCells, 0, size);
+
+    rw.yCnt = rw.cellYCnt;
+    rw.invalid = true;
+
+    _decomposeOutline(rw);
+    if (!rw.invalid) _recordCell(rw);
+    _sweepAccCells(rw);
+
+    if (rw.accCells != pool) mpoolRetArena(mpool, tid, rw.accCells);
+    rw.accCells = nullptr;
+
+    return true;
+}
+
+
+/* The hairlines are thinner than a pixel, thus their joins and caps hardly make any difference.
+   Instead of the stroke outline, every line segment is directly covered column by column (or
+   row by row along its major axis) by its area, and the covers are accumulated in the region. */
+struct HairlineWorker
+{
+    uint8_t* covers;          //only the covered range of each row is initialized
+    int32_t* xMin;            //the covered range per row
+    int32_t* xMax;
+    int32_t w, h;
+    float width;
+};
+
+
+static void _hairlineCover(HairlineWorker& hw, int32_t x, int32_t y, float coverage)
+{
+    auto c = static_cast<int32_t>(coverage * 255.0f + 0.5f);
+    if (c <= 0) return;
+
+    auto row = hw.covers + y * hw.w;
+
+    //extend the covered range of the row
+    if (hw.xMax[y] < 0) {
+        row[x] = 0;
+        hw.xMin[y] = hw.xMax[y] = x;
+    } else if (x < hw.xMin[y]) {
+        memset(row + x, 0, hw.xMin[y] - x);
+        hw.xMin[y] = x;
+    } else if (x > hw.xMax[y]) {
+        memset(row + hw.xMax[y] + 1, 0, x - hw.xMax[y]);
+        hw.xMax[y] = x;
+    }
+
+    c += row[x];
+    row[x] = (c > 255) ? 255 : c;
+}
+
+
+static void _hairlineLine(HairlineWorker& hw, Point p0, Point p1)
+{
+    auto dx = p1.x - p0.x;
+    auto dy = p1.y - p0.y;
+    auto len = sqrtf(dx * dx + dy * dy);
+    if (len < FLT_EPSILON) return;
+
+    //step along the major axis, swap the axes to handle it as the x-axis.
+    auto xMajor = fabsf(dx) >= fabsf(dy);
+    if (!xMajor) {
+        std::swap(p0.x, p0.y);
+        std::swap(p1.x, p1.y);
+        std::swap(dx, dy);
+    }
+    if (dx < 0) {
+        std::swap(p0, p1);
+        dx = -dx;
+        dy = -dy;
+    }
+
+    auto majorCnt = static_cast<float>(xMajor ? hw.w : hw.h);
+    auto minorCnt = xMajor ? hw.h : hw.w;
+    auto slope = dy / dx;
+    auto half = 0.5f * hw.width * len / dx;    //half thickness across the major axis
+
+    //clip the major range by the region
+    auto begin = (p0.x > 0.0f) ? p0.x : 0.0f;
+    auto end = (p1.x < majorCnt) ? p1.x : majorCnt;
+    if (mathZero(slope)) {
+        if (p0.y + half < 0.0f || p0.y - half > minorCnt) return;
+    } else {
+        auto x1 = p0.x + (-half - 1.0f - p0.y) / slope;
+        auto x2 = p0.x + (minorCnt + half + 1.0f - p0.y) / slope;
+        if (x1 > x2) std::swap(x1, x2);
+        if (x1 > begin) begin = x1;
+        if (x2 < end) end = x2;
+    }
+
+    for (auto m = static_cast<int32_t>(floorf(begin)); m < end; ++m) {
+        auto a = (begin > m) ? begin : static_cast<float>(m);
+        auto b = (end < m + 1) ? end : static_cast<float>(m + 1);
+        if (b <= a) continue;
+
+        //the covered range across the major axis at the center of this step
+        auto c = p0.y + ((a + b) * 0.5f - p0.x) * slope;
+        auto lo = c - half;
+        auto hi = c + half;
+
+        for (auto n = static_cast<int32_t>(floorf(lo)); n < hi; ++n) {
+            if (n < 0) continue;
+            if (n >= minorCnt) break;
+            auto overlap = ((hi < n + 1) ? hi : n + 1) - ((lo > n) ? lo : n);
+            if (overlap <= 0.0f) continue;
+            if (xMajor) _hairlineCover(hw, m, n, (b - a) * overlap);
+            else _hairlineCover(hw, n, m, (b - a) * overlap);
+        }
+    }
+}
+
+
+//The line count to flatten the curve within 1/8 pixel by the Wang's formula
+static uint32_t _hairlineCubicCnt(const Point& p0, const Point& p1, const Point& p2, const Point& p3)
+{
+    auto ddx = std::max(fabsf(p0.x - 2.0f * p1.x + p2.x), fabsf(p1.x - 2.0f * p2.x + p3.x));
+    auto ddy = std::max(fabsf(p0.y - 2.0f * p1.y + p2.y), fabsf(p1.y - 2.0f * p2.y + p3.y));
+    auto cnt = static_cast<int>(ceilf(sqrtf(6.0f * sqrtf(ddx * ddx + ddy * ddy))));
+    if (cnt < 1) return 1;
+    if (cnt > 256) return 256;
+    return cnt;
+}
+
+
+static Point* _hairlineCubic(Point* pts, uint32_t cnt, const Point& p0, const Point& p1, const Point& p2, const Point& p3)
 {
-    free(rle->spans);
-    rle->spans = clippedSpans;
-    rle->size = rle->alloc = size;
+    for (uint32_t i = 1; i <= cnt; ++i) {
+        auto t = static_cast<float>(i) / cnt;
+        auto it = 1.0f - t;
+        auto a = it * it * it;
+        auto b = 3.0f * it * it * t;
+        auto c = 3.0f * it * t * t;
+        auto d = t * t * t;
+        *pts++ = {a * p0.x + b * p1.x + c * p2.x + d * p3.x, a * p0.y + b * p1.y + c * p2.y + d * p3.y};
+    }
+    return pts;
+}
+
+
+static inline bool _samePoint(const Point& a, const Point& b)
+{
+    return mathEqual(a.x, b.x) && mathEqual(a.y, b.y);
+}
+
+
+//The square and round caps extend the open ends by the half width, they draw the dots for the zero length contours.
+static void _hairlineContour(HairlineWorker& hw, Point* pts, uint32_t cnt, bool caps)
+{
+    if (cnt == 0) return;
+
+    auto first = pts[0];
+    auto last = pts[cnt - 1];
+
+    if (caps && !(cnt > 2 && _samePoint(first, last))) {
+        auto half = hw.width * 0.5f;
+
+        //the first and last points of the non-zero length
+        uint32_t i = 1;
+        while (i < cnt && _samePoint(pts[i], first)) ++i;
+        auto j = cnt - 1;
+        while (j > 0 && _samePoint(pts[j - 1], last)) --j;
+
+        if (i == cnt) {
+            _hairlineLine(hw, {first.x - half, first.y}, {first.x + half, first.y});
+            return;
+        }
+
+        auto d = first - pts[i];
+        pts[0] = first + d * (half / sqrtf(d.x * d.x + d.y * d.y));
+        d = last - pts[j - 1];
+        pts[cnt - 1] = last + d * (half / sqrtf(d.x * d.x + d.y * d.y));
+    }
+
+    for (uint32_t i = 1; i < cnt; ++i) {
+        _hairlineLine(hw, pts[i - 1], pts[i]);
+    }
+}
+
+
+static void _hairlineSweep(HairlineWorker& hw, SwRleData* rle, const SwBBox& region)
+{
+    SwSpan spans[MAX_SPANS];
+    auto span = spans;
+
+    for (int32_t y = 0; y < hw.h; ++y) {
+        auto covers = hw.covers + y * hw.w;
+        for (auto x = hw.xMin[y]; x <= hw.xMax[y]; ++x) {
+            auto coverage = covers[x];
+            if (coverage == 0) continue;
+            auto begin = x;
+            while (x < hw.xMax[y] && covers[x + 1] == coverage) ++x;
+
+            if (span == spans + MAX_SPANS) {
+                _genSpan(rle, spans, MAX_SPANS);
+                span = spans;
+            }
+            span->x = static_cast<uint16_t>(region.min.x + begin);
+            span->y = static_cast<uint16_t>(region.min.y + y);
+            span->len = static_cast<uint16_t>(x - begin + 1);
+            span->coverage = coverage;
+            ++span;
+        }
+    }
+    if (span > spans) _genSpan(rle, spans, span - spans);
 }
 
 
@@ -903,7 +1207,7 @@ void _replaceClipSpan(SwRleData *rle, SwSpan* clippedSpans, uint32_t size)
 /* External Class Implementation                                        */
 /************************************************************************/
 
-SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias)
+SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias, SwMpool* mpool, unsigned tid)
 {
     constexpr auto RENDER_POOL_SIZE = 16384L;
     constexpr auto BAND_SIZE = 40;
@@ -931,10 +1235,13 @@ SwRleData* rleRender(SwRleData* rle, const SwOutline* outline, const SwBBox& ren
     rw.bandSize = rw.bufferSize / (sizeof(Cell) * 8);  //bandSize: 64
     rw.bandShoot = 0;
     rw.antiAlias = antiAlias;
+    rw.accCells = nullptr;
 
     if (!rle) rw.rle = reinterpret_cast<SwRleData*>(calloc(1, sizeof(SwRleData)));
     else rw.rle = rle;
 
+    if (_accumulable(outline, renderRegion, rw.bufferSize) && _accumulate(rw, rw.buffer, rw.bufferSize, mpool, tid)) return rw.rle;
+
     //Generate RLE
     Band bands[BAND_SIZE];
     Band* band;
@@ -1049,6 +1356,88 @@ SwRleData* rleRender(const SwBBox* bbox)
 }
 
 
+SwRleData* rleRenderHairline(SwRleData* rle, const SwOutline* outline, const SwBBox& renderRegion, float width, bool caps, SwMpool* mpool, unsigned tid)
+{
+    HairlineWorker hw;
+    hw.w = static_cast<int32_t>(renderRegion.max.x - renderRegion.min.x);
+    hw.h = static_cast<int32_t>(renderRegion.max.y - renderRegion.min.y);
+    hw.width = width;
+    if (hw.w <= 0 || hw.h <= 0) return rle;
+
+    hw.covers = static_cast<uint8_t*>(mpoolReqArena(mpool, tid, hw.w * hw.h));
+    if (!hw.covers) return nullptr;
+    hw.xMin = static_cast<int32_t*>(mpoolReqArena(mpool, tid, sizeof(int32_t) * hw.h * 2));
+    if (!hw.xMin) {
+        mpoolRetArena(mpool, tid, hw.covers);
+        return nullptr;
+    }
+    hw.xMax = hw.xMin + hw.h;
+    for (int32_t y = 0; y < hw.h; ++y) {
+        hw.xMin[y] = hw.w;
+        hw.xMax[y] = -1;
+    }
+
+    if (!rle) rle = static_cast<SwRleData*>(calloc(1, sizeof(SwRleData)));
+
+    //in pixels, relative to the region
+    auto offset = Point{static_cast<float>(renderRegion.min.x), static_cast<float>(renderRegion.min.y)};
+    auto point = [&](const SwPoint& pt) { return Point{TO_FLOAT(pt.x), TO_FLOAT(pt.y)} - offset; };
+
+    uint32_t first = 0;
+
+    for (auto cntr = outline->cntrs.begin(); cntr < outline->cntrs.end(); ++cntr) {
+        auto last = *cntr;
+
+        //the curves could end at the start point implicitly
+        auto to = [&](uint32_t i) { return (i + 2 <= last) ? outline->pts[i + 2] : outline->pts[first]; };
+
+        //count the flattened points first to take them from the arena at once
+        uint32_t cnt = 1;
+        auto prev = point(outline->pts[first]);
+        for (auto i = first + 1; i <= last; ++i) {
+            if (outline->types[i] == SW_CURVE_TYPE_CUBIC) {
+                auto end = point(to(i));
+                cnt += _hairlineCubicCnt(prev, point(outline->pts[i]), point(outline->pts[i + 1]), end);
+                prev = end;
+                i += 2;
+            } else {
+                prev = point(outline->pts[i]);
+                ++cnt;
+            }
+        }
+
+        auto pts = static_cast<Point*>(mpoolReqArena(mpool, tid, sizeof(Point) * cnt));
+        if (!pts) break;
+
+        auto pt = pts;
+        *pt++ = point(outline->pts[first]);
+        for (auto i = first + 1; i <= last; ++i) {
+            if (outline->types[i] == SW_CURVE_TYPE_CUBIC) {
+                auto p0 = pt[-1];
+                auto p1 = point(outline->pts[i]);
+                auto p2 = point(outline->pts[i + 1]);
+                auto p3 = point(to(i));
+                pt = _hairlineCubic(pt, _hairlineCubicCnt(p0, p1, p2, p3), p0, p1, p2, p3);
+                i += 2;
+            } else {
+                *pt++ = point(outline->pts[i]);
+            }
+        }
+        _hairlineContour(hw, pts, cnt, caps);
+
+        mpoolRetArena(mpool, tid, pts);
+        first = last + 1;
+    }
+
+    _hairlineSweep(hw, rle, renderRegion);
+
+    mpoolRetArena(mpool, tid, hw.xMin);
+    mpoolRetArena(mpool, tid, hw.covers);
+
+    return rle;
+}
+
+
 void rleReset(SwRleData* rle)
 {
     if (!rle) return;
@@ -1064,7 +1453,7 @@ void rleFree(SwRleData* rle)
 }
 
 
-void rleMerge(SwRleData* rle, SwRleData* clip1, SwRleData* clip2)
+void rleMerge(SwRleData* rle, SwRleData* clip1, SwRleData* clip2, SwMpool* mpool, unsigned tid)
 {
     if (!rle || (!clip1 && !clip2)) return;
     if (clip1 && clip1->size == 0 && clip2 && clip2->size == 0) return;
@@ -1073,56 +1462,61 @@ void rleMerge(SwRleData* rle, SwRleData* clip1, SwRleData* clip2)
 
     //clip1 is empty, just copy clip2
     if (!clip1 || clip1->size == 0) {
-        if (clip2) {
-            auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * (clip2->size)));
-            memcpy(spans, clip2->spans, clip2->size);
-            _replaceClipSpan(rle, spans, clip2->size);
-        } else {
-            _replaceClipSpan(rle, nullptr, 0);
-        }
+        if (clip2) _copyClipSpan(rle, clip2->spans, clip2->size);
+        else rle->size = 0;
         return;
     }
 
     //clip2 is empty, just copy clip1
     if (!clip2 || clip2->size == 0) {
-        if (clip1) {
-            auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * (clip1->size)));
-            memcpy(spans, clip1->spans, clip1->size);
-            _replaceClipSpan(rle, spans, clip1->size);
-        } else {
-            _replaceClipSpan(rle, nullptr, 0);
-        }
+        _copyClipSpan(rle, clip1->spans, clip1->size);
         return;
     }
 
     auto spanCnt = clip1->size + clip2->size;
-    auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * spanCnt));
+    auto spans = static_cast<SwSpan*>(mpoolReqArena(mpool, tid, sizeof(SwSpan) * spanCnt));
+    if (!spans) return;
     auto spansEnd = _mergeSpansRegion(clip1, clip2, spans);
 
-    _replaceClipSpan(rle, spans, spansEnd - spans);
+    _copyClipSpan(rle, spans, spansEnd - spans);
+    mpoolRetArena(mpool, tid, spans);
 }
 
 
-void rleClipPath(SwRleData *rle, const SwRleData *clip)
+void rleClipPath(SwRleData *rle, const SwRleData *clip, SwMpool* mpool, unsigned tid)
 {
     if (rle->size == 0 || clip->size == 0) return;
     auto spanCnt = rle->size > clip->size ? rle->size : clip->size;
-    auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * (spanCnt)));
+    auto spans = static_cast<SwSpan*>(mpoolReqArena(mpool, tid, sizeof(SwSpan) * spanCnt));
+    if (!spans) return;
     auto spansEnd = _intersectSpansRegion(clip, rle, spans, spanCnt);
 
-    _replaceClipSpan(rle, spans, spansEnd - spans);
+    _copyClipSpan(rle, spans, spansEnd - spans);
+    mpoolRetArena(mpool, tid, spans);
 
     TVGLOG("SW_ENGINE", "Using ClipPath!");
 }
 
 
-void rleClipRect(SwRleData *rle, const SwBBox* clip)
+void rleClipRect(SwRleData *rle, const SwBBox* clip, SwMpool* mpool, unsigned tid)
 {
     if (rle->size == 0) return;
-    auto spans = static_cast<SwSpan*>(malloc(sizeof(SwSpan) * (rle->size)));
+    auto spans = static_cast<SwSpan*>(mpoolReqArena(mpool, tid, sizeof(SwSpan) * rle->size));
+    if (!spans) return;
     auto spansEnd = _intersectSpansRect(clip, rle, spans, rle->size);
 
-    _replaceClipSpan(rle, spans, spansEnd - spans);
+    _copyClipSpan(rle, spans, spansEnd - spans);
+    mpoolRetArena(mpool, tid, spans);
 
     TVGLOG("SW_ENGINE", "Using ClipRect!");
-}
\ No newline at end of file
+}
+
+void rleTranslate(SwRleData* rle, SwCoord x, SwCoord y)
+{
+    if (!rle) return;
+
+    for (auto span = rle->spans; span < rle->spans + rle->size; ++span) {
+        span->x += x;
+        span->y += y;
+    }
+}
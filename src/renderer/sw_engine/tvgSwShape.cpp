@@ -249,7 +249,8 @@ static SwOutline* _genDashOutline(const RenderShape* rshape, const Matrix* trans
         //looping
         } else dash.cnt += 3;
 
-        dash.pattern = (float*)malloc(sizeof(float) * dash.cnt);
+        dash.pattern = static_cast<float*>(mpoolReqArena(mpool, tid, sizeof(float) * dash.cnt));
+        if (!dash.pattern) return nullptr;
 
         if (dash.cnt == 2) {
             dash.pattern[0] = end - begin;
@@ -318,7 +319,7 @@ static SwOutline* _genDashOutline(const RenderShape* rshape, const Matrix* trans
 
     _outlineEnd(*dash.outline);
 
-    if (trimmed) free(dash.pattern);
+    if (trimmed) mpoolRetArena(mpool, tid, dash.pattern);
 
     return dash.outline;
 }
@@ -435,6 +436,21 @@ static bool _genOutline(SwShape* shape, const RenderShape* rshape, const Matrix*
 }
 
 
+//The outline bbox with the anti-aliased pixels around
+static bool _hairlineBBox(const SwOutline* outline, const SwBBox& clipRegion, SwBBox& renderRegion)
+{
+    auto region = clipRegion;
+    region.min = region.min - SwPoint{1, 1};
+    region.max = region.max + SwPoint{1, 1};
+
+    if (!mathUpdateOutlineBBox(outline, region, renderRegion, false)) return false;
+
+    renderRegion.min = renderRegion.min - SwPoint{1, 1};
+    renderRegion.max = renderRegion.max + SwPoint{1, 1};
+    return mathClipBBox(clipRegion, renderRegion);
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -464,7 +480,7 @@ bool shapePrepared(const SwShape* shape)
 }
 
 
-bool shapeGenRle(SwShape* shape, TVG_UNUSED const RenderShape* rshape, bool antiAlias)
+bool shapeGenRle(SwShape* shape, TVG_UNUSED const RenderShape* rshape, bool antiAlias, SwMpool* mpool, unsigned tid)
 {
     //FIXME: Should we draw it?
     //Case: Stroke Line
@@ -474,7 +490,7 @@ bool shapeGenRle(SwShape* shape, TVG_UNUSED const RenderShape* rshape, bool anti
     if (shape->fastTrack) return true;
 
     //Case B: Normal Shape RLE Drawing
-    if ((shape->rle = rleRender(shape->rle, shape->outline, shape->bbox, antiAlias))) return true;
+    if ((shape->rle = rleRender(shape->rle, shape->outline, shape->bbox, antiAlias, mpool, tid))) return true;
 
     return false;
 }
@@ -555,6 +571,17 @@ bool shapeGenStrokeRle(SwShape* shape, const RenderShape* rshape, const Matrix*
         shapeOutline = shape->outline;
     }
 
+    //Hairline: not thicker than a pixel, the lines are covered directly without the stroke outline.
+    if (rshape->strokeWidth() * std::max(shape->stroke->sx, shape->stroke->sy) <= 1.0f) {
+        if (!_hairlineBBox(shapeOutline, clipRegion, renderRegion)) {
+            ret = false;
+            goto clear;
+        }
+        auto width = rshape->strokeWidth() * sqrtf(shape->stroke->sx * shape->stroke->sy);
+        shape->strokeRle = rleRenderHairline(shape->strokeRle, shapeOutline, renderRegion, width, rshape->strokeCap() != StrokeCap::Butt, mpool, tid);
+        goto clear;
+    }
+
     if (!strokeParseOutline(shape->stroke, *shapeOutline)) {
         ret = false;
         goto clear;
@@ -567,7 +594,7 @@ bool shapeGenStrokeRle(SwShape* shape, const RenderShape* rshape, const Matrix*
         goto clear;
     }
 
-    shape->strokeRle = rleRender(shape->strokeRle, strokeOutline, renderRegion, true);
+    shape->strokeRle = rleRender(shape->strokeRle, strokeOutline, renderRegion, true, mpool, tid);
 
 clear:
     if (dashStroking) mpoolRetDashOutline(mpool, tid);
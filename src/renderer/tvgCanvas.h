@@ -116,7 +116,8 @@ struct Canvas::Impl
             if (paint->pImpl->render(renderer)) rendered = true;
         }
 
-        if (!rendered || !renderer->postRender()) return Result::InsufficientCondition;
+        //The renderer must be finished even if nothing is drawn. ex) the damaged regions of the removed paints
+        if (!renderer->postRender() || !rendered) return Result::InsufficientCondition;
 
         drawing = true;
 
@@ -31,7 +31,11 @@ namespace tvg
 class FrameModule: public ImageLoader
 {
 public:
-    FrameModule(FileType type) : ImageLoader(type) {}
+    //each animation has its own frame
+    FrameModule(FileType type) : ImageLoader(type)
+    {
+        shareable = false;
+    }
     virtual ~FrameModule() {}
 
     virtual bool frame(float no) = 0;       //set the current frame number
@@ -41,6 +41,7 @@ struct LoadModule
     uint16_t sharing = 0;                           //reference count
     bool readied = false;                           //read done already.
     bool pathcache = false;                         //cached by path
+    bool shareable = true;                          //could be shared by the requests of the same source
 
     LoadModule(FileType type) : type(type) {}
     virtual ~LoadModule()
@@ -179,6 +179,7 @@ static LoadModule* _findByPath(const string& path)
     if (!ext.compare("svg")) return _find(FileType::Svg);
     if (!ext.compare("json")) return _find(FileType::Lottie);
     if (!ext.compare("lottie")) return _find(FileType::Lottie);
+    if (!ext.compare("lotb")) return _find(FileType::Lottie);
     if (!ext.compare("png")) return _find(FileType::Png);
     if (!ext.compare("jpg")) return _find(FileType::Jpg);
     if (!ext.compare("webp")) return _find(FileType::Webp);
@@ -219,7 +220,7 @@ static LoadModule* _findFromCache(const string& path)
     auto loader = _activeLoaders.head;
 
     while (loader) {
-        if (loader->pathcache && !strcmp(loader->hashpath, path.c_str())) {
+        if (loader->shareable && loader->pathcache && !strcmp(loader->hashpath, path.c_str())) {
             ++loader->sharing;
             return loader;
         }
@@ -240,7 +241,7 @@ static LoadModule* _findFromCache(const char* data, uint32_t size, const string&
     auto key = HASH_KEY(data);
 
     while (loader) {
-        if (loader->type == type && loader->hashkey == key) {
+        if (loader->shareable && loader->type == type && loader->hashkey == key) {
             ++loader->sharing;
             return loader;
         }
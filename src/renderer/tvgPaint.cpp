@@ -106,8 +106,62 @@ static bool _compFastTrack(Paint* cmpTarget, const RenderTransform* pTransform,
 }
 
 
+/* Inspects the subtree whether any of the paints has been changed since the last update.
+   The signature accumulates the subtree structure, which isn't tracked by the update flags. */
+static bool _changed(Paint* paint, uint32_t& signature)
+{
+    auto p = paint->pImpl;
+
+    signature = (signature ^ static_cast<uint32_t>(reinterpret_cast<uintptr_t>(paint))) * 16777619;
+
+    if (p->renderFlag != RenderUpdateFlag::None) return true;
+
+    if (p->compData) {
+        signature = (signature ^ static_cast<uint32_t>(p->compData->method)) * 16777619;
+        if (_changed(p->compData->target, signature)) return true;
+    }
+
+    switch (p->id) {
+        case TVG_CLASS_ID_SHAPE: {
+            if (P(static_cast<Shape*>(paint))->flag != RenderUpdateFlag::None) return true;
+            break;
+        }
+        case TVG_CLASS_ID_PICTURE: {
+            auto picture = P(static_cast<Picture*>(paint));
+            if (picture->resizing) return true;
+            if (picture->loader) {
+                if (!picture->paint && !picture->surface) return true;
+                //Wait for the asynchronous loading, which might update the descendants.
+                picture->loader->sync();
+            }
+            break;
+        }
+        case TVG_CLASS_ID_TEXT: {
+            auto text = P(static_cast<Text*>(paint));
+            if (text->changed) return true;
+            if (text->paint && _changed(text->paint, signature)) return true;
+            break;
+        }
+    }
+
+    auto changed = false;
+    if (auto it = p->iterator()) {
+        while (auto child = it->next()) {
+            if ((changed = _changed(const_cast<Paint*>(child), signature))) break;
+        }
+        delete(it);
+    }
+    return changed;
+}
+
+
 RenderRegion Paint::Impl::bounds(RenderMethod* renderer) const
 {
+    //The cached image might have been moved since the descendants were updated.
+    if (cache && cache->active && cache->valid) {
+        return {cache->region.x + cache->x, cache->region.y + cache->y, cache->region.w, cache->region.h};
+    }
+
     RenderRegion ret;
     PAINT_METHOD(ret, bounds(renderer));
     return ret;
@@ -195,8 +249,7 @@ bool Paint::Impl::render(RenderMethod* renderer)
     /* Note: only ClipPath is processed in update() step.
         Create a composition image. */
     if (compData && compData->method != CompositeMethod::ClipPath && !(compData->target->pImpl->ctxFlag & ContextFlag::FastTrack)) {
-        RenderRegion region;
-        PAINT_METHOD(region, bounds(renderer));
+        auto region = bounds(renderer);
 
         if (MASK_REGION_MERGING(compData->method)) region.add(P(compData->target)->bounds(renderer));
         if (region.w == 0 || region.h == 0) return true;
@@ -211,7 +264,8 @@ bool Paint::Impl::render(RenderMethod* renderer)
     renderer->blend(blendMethod);
 
     bool ret;
-    PAINT_METHOD(ret, render(renderer));
+    if (cache && cache->active) ret = renderCache(renderer);
+    else PAINT_METHOD(ret, render(renderer));
 
     if (cmp) renderer->endComposite(cmp);
 
@@ -219,6 +273,90 @@ bool Paint::Impl::render(RenderMethod* renderer)
 }
 
 
+//Returns true if the cached image is reused, the descendants don't need to be updated then.
+bool Paint::Impl::updateCache(RenderMethod* renderer, const Matrix& m, uint8_t opacity, RenderUpdateFlag& flag, bool clipped)
+{
+    uint32_t signature = 2166136261;
+    auto changed = _changed(paint, signature);
+
+    /* Only the translation by the whole pixels and the opacity are applied to the cached image.
+       The sub-pixel phase is kept within the precision of the outlines (26.6 fixed point). */
+    auto dx = m.e13 - cache->transform.e13;
+    auto dy = m.e23 - cache->transform.e23;
+    auto x = nearbyintf(dx);
+    auto y = nearbyintf(dy);
+
+    if (!clipped && !changed && cache->valid && signature == cache->signature && !(flag & ~(RenderUpdateFlag::Transform | RenderUpdateFlag::Color)) &&
+        mathEqual(m.e11, cache->transform.e11) && mathEqual(m.e12, cache->transform.e12) &&
+        mathEqual(m.e21, cache->transform.e21) && mathEqual(m.e22, cache->transform.e22) &&
+        fabsf(dx - x) <= (0.5f / 64.0f) && fabsf(dy - y) <= (0.5f / 64.0f) && renderer->cached(cache->rd)) {
+        cache->x = static_cast<int32_t>(x);
+        cache->y = static_cast<int32_t>(y);
+        cache->opacity = opacity;
+        return true;
+    }
+
+    //The descendants are drawn opaquely within the cache, otherwise with the opacity.
+    if (cache->active == clipped) flag = static_cast<RenderUpdateFlag>(flag | RenderUpdateFlag::Color);
+
+    //The descendants haven't followed the cached image movements.
+    if (!mathEqual(m, cache->transform)) flag = static_cast<RenderUpdateFlag>(flag | RenderUpdateFlag::Transform);
+
+    //A clipped subtree can't be cached, it's drawn directly.
+    if (clipped && cache->rd) {
+        renderer->disposeCache(cache->rd);
+        cache->rd = nullptr;
+    }
+
+    cache->transform = m;
+    cache->signature = signature;
+    cache->x = cache->y = 0;
+    cache->opacity = opacity;
+    cache->active = !clipped;
+    cache->valid = false;
+
+    return false;
+}
+
+
+bool Paint::Impl::renderCache(RenderMethod* renderer)
+{
+    bool ret = true;
+
+    if (!cache->valid) {
+        cache->region = bounds(renderer);
+
+        //Nothing to draw, the previous image must be erased.
+        if (cache->region.w <= 0 || cache->region.h <= 0) {
+            renderer->disposeCache(cache->rd);
+            cache->rd = nullptr;
+            return true;
+        }
+
+        if (renderer->beginCache(&cache->rd, cache->region)) {
+            PAINT_METHOD(ret, render(renderer));
+            renderer->endCache(cache->rd);
+            cache->valid = true;
+        } else {
+            //Out of the budget or exceeding the target, the subtree is composed with the opacity directly.
+            Compositor* cmp = nullptr;
+            if (cache->opacity < 255) {
+                cmp = renderer->target(cache->region, renderer->colorSpace());
+                renderer->beginComposite(cmp, CompositeMethod::None, cache->opacity);
+            }
+            PAINT_METHOD(ret, render(renderer));
+            if (cmp) renderer->endComposite(cmp);
+            return ret;
+        }
+        renderer->blend(blendMethod);
+    }
+
+    if (!renderer->renderCache(cache->rd, cache->x, cache->y, cache->opacity)) return false;
+
+    return ret;
+}
+
+
 RenderData Paint::Impl::update(RenderMethod* renderer, const RenderTransform* pTransform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag pFlag, bool clipper)
 {
     if (this->renderer != renderer) {
@@ -282,7 +420,20 @@ RenderData Paint::Impl::update(RenderMethod* renderer, const RenderTransform* pT
 
     RenderData rd = nullptr;
     RenderTransform outTransform(pTransform, rTransform);
-    PAINT_METHOD(rd, update(renderer, &outTransform, clips, opacity, newFlag, clipper));
+
+    if (cache && updateCache(renderer, outTransform.m, opacity, newFlag, compFastTrack || clipper || clips.count > 0 || cache->disabled)) {
+        rd = cache->content;
+    } else {
+        if (cache) {
+            if (cache->active) opacity = 255;
+            else if (cache->disabled) {
+                delete(cache);
+                cache = nullptr;
+            }
+        }
+        PAINT_METHOD(rd, update(renderer, &outTransform, clips, opacity, newFlag, clipper));
+        if (cache) cache->content = rd;
+    }
 
     /* 3. Composition Post Processing */
     if (compFastTrack) renderer->viewport(viewport);
@@ -458,6 +609,26 @@ Result Paint::blend(BlendMethod method) const noexcept
 }
 
 
+Result Paint::cache(bool on) noexcept
+{
+    auto cache = pImpl->cache;
+
+    if (on) {
+        if (cache) cache->disabled = false;
+        else pImpl->cache = new PaintCache;
+    } else if (cache) {
+        //The descendants must be updated with their own opacity and transform again, it's released on the next update.
+        if (pImpl->renderer) cache->disabled = true;
+        else {
+            delete(cache);
+            pImpl->cache = nullptr;
+        }
+    }
+
+    return Result::Success;
+}
+
+
 BlendMethod Paint::blend() const noexcept
 {
     return pImpl->blendMethod;
@@ -45,11 +45,27 @@ namespace tvg
         CompositeMethod method;
     };
 
+    //Raster cache of the paint subtree, it's reused as long as the subtree is translated or faded only.
+    struct PaintCache
+    {
+        RenderData rd = nullptr;          //engine cache data
+        RenderData content = nullptr;     //paint render data on the last update
+        Matrix transform = {1, 0, 0, 0, 1, 0, 0, 0, 1};  //transform of the descendants on the last update
+        RenderRegion region;              //cached region in the target coordinates
+        uint32_t signature = 0;           //structure of the subtree on the last update
+        int32_t x = 0, y = 0;             //translation of the cached image
+        uint8_t opacity = 255;
+        bool active = false;              //the paint is drawn through the cache
+        bool valid = false;               //the cached image is up to date
+        bool disabled = false;            //the cache is released on the next update
+    };
+
     struct Paint::Impl
     {
         Paint* paint = nullptr;
         RenderTransform* rTransform = nullptr;
         Composite* compData = nullptr;
+        PaintCache* cache = nullptr;
         RenderMethod* renderer = nullptr;
         BlendMethod blendMethod = BlendMethod::Normal;   //uint8_t
         uint8_t renderFlag = RenderUpdateFlag::None;
@@ -67,6 +83,10 @@ namespace tvg
                 free(compData);
             }
             delete(rTransform);
+            if (cache) {
+                if (renderer) renderer->disposeCache(cache->rd);
+                delete(cache);
+            }
             if (renderer && (renderer->unref() == 0)) delete(renderer);
         }
 
@@ -139,6 +159,8 @@ namespace tvg
         bool bounds(float* x, float* y, float* w, float* h, bool transformed, bool stroking);
         RenderData update(RenderMethod* renderer, const RenderTransform* pTransform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag pFlag, bool clipper = false);
         bool render(RenderMethod* renderer);
+        bool updateCache(RenderMethod* renderer, const Matrix& m, uint8_t opacity, RenderUpdateFlag& flag, bool clipped);
+        bool renderCache(RenderMethod* renderer);
         Paint* duplicate();
     };
 }
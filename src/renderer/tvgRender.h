@@ -47,6 +47,33 @@ enum ColorSpace : uint8_t
     Unsupported        //TODO: Change to the default, At the moment, we put it in the last to align with SwCanvas::Colorspace.
 };
 
+//The pixels of a surface converted to another colorspace, shared by the users of the surface.
+struct SurfaceCopy
+{
+    SurfaceCopy* next = nullptr;
+    uint32_t* data = nullptr;
+    uint32_t w = 0, h = 0;
+    ColorSpace cs = ColorSpace::Unsupported;
+    uint32_t refCnt = 1;            //the surface and the users, it could outlive the surface
+    Key key;
+
+    void ref()
+    {
+        ScopedLock lock(key);
+        ++refCnt;
+    }
+
+    void unref()
+    {
+        {
+            ScopedLock lock(key);
+            if (--refCnt > 0) return;
+        }
+        free(data);
+        delete(this);
+    }
+};
+
 struct Surface
 {
     union {
@@ -55,6 +82,7 @@ struct Surface
         uint8_t*  buf8;             //for explicit 8bits grayscale
     };
     Key key;                        //a reserved lock for the thread safety
+    SurfaceCopy* copies = nullptr;  //converted by the render engines, guarded by the key
     uint32_t stride = 0;
     uint32_t w = 0, h = 0;
     ColorSpace cs = ColorSpace::Unsupported;
@@ -75,6 +103,15 @@ struct Surface
         channelSize = rhs->channelSize;
         premultiplied = rhs->premultiplied;
     }
+
+    ~Surface()
+    {
+        while (copies) {
+            auto next = copies->next;
+            copies->unref();
+            copies = next;
+        }
+    }
 };
 
 struct Compositor
@@ -297,6 +334,12 @@ public:
     virtual Compositor* target(const RenderRegion& region, ColorSpace cs) = 0;
     virtual bool beginComposite(Compositor* cmp, CompositeMethod method, uint8_t opacity) = 0;
     virtual bool endComposite(Compositor* cmp) = 0;
+
+    virtual bool beginCache(RenderData* cache, const RenderRegion& region) = 0;
+    virtual bool endCache(RenderData cache) = 0;
+    virtual bool renderCache(RenderData cache, int32_t x, int32_t y, uint8_t opacity) = 0;
+    virtual bool cached(RenderData cache) = 0;
+    virtual void disposeCache(RenderData cache) = 0;
 };
 
 static inline bool MASK_REGION_MERGING(CompositeMethod method)
@@ -79,6 +79,101 @@ Result SwCanvas::mempool(MempoolPolicy policy) noexcept
 }
 
 
+Result SwCanvas::raster(RasterPolicy policy) noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    //We know renderer type, avoid dynamic_cast for performance.
+    auto renderer = static_cast<SwRenderer*>(Canvas::pImpl->renderer);
+    if (!renderer) return Result::MemoryCorruption;
+
+    //It can't change the policy during the drawing.
+    if (Canvas::pImpl->drawing) return Result::InsufficientCondition;
+
+    renderer->banded(policy == RasterPolicy::Banded);
+
+    return Result::Success;
+#endif
+    return Result::NonSupport;
+}
+
+
+Result SwCanvas::partial(bool on) noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    //We know renderer type, avoid dynamic_cast for performance.
+    auto renderer = static_cast<SwRenderer*>(Canvas::pImpl->renderer);
+    if (!renderer) return Result::MemoryCorruption;
+
+    //It can't change the behavior during the drawing.
+    if (Canvas::pImpl->drawing) return Result::InsufficientCondition;
+
+    renderer->partial(on);
+
+    return Result::Success;
+#endif
+    return Result::NonSupport;
+}
+
+
+uint32_t SwCanvas::damages(const Region** regions) const noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    //We know renderer type, avoid dynamic_cast for performance.
+    auto renderer = static_cast<SwRenderer*>(Canvas::pImpl->renderer);
+    if (!renderer) return 0;
+
+    const RenderRegion* data = nullptr;
+    auto cnt = renderer->damages(&data);
+    if (regions) *regions = reinterpret_cast<const Region*>(data);
+    return cnt;
+#endif
+    return 0;
+}
+
+
+Result SwCanvas::stats(uint32_t* reused, uint32_t* generated) const noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    //We know renderer type, avoid dynamic_cast for performance.
+    auto renderer = static_cast<SwRenderer*>(Canvas::pImpl->renderer);
+    if (!renderer) return Result::MemoryCorruption;
+
+    renderer->stats(reused, generated);
+
+    return Result::Success;
+#endif
+    return Result::NonSupport;
+}
+
+
+Result SwCanvas::cacheBudget(uint32_t size) noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    //We know renderer type, avoid dynamic_cast for performance.
+    auto renderer = static_cast<SwRenderer*>(Canvas::pImpl->renderer);
+    if (!renderer) return Result::MemoryCorruption;
+
+    //It can't change the budget during the drawing.
+    if (Canvas::pImpl->drawing) return Result::InsufficientCondition;
+
+    renderer->cacheBudget(size);
+
+    return Result::Success;
+#endif
+    return Result::NonSupport;
+}
+
+
+Result SwCanvas::simd(Simd limit) noexcept
+{
+#ifdef THORVG_SW_RASTER_SUPPORT
+    SwRenderer::simd(limit);
+    return Result::Success;
+#endif
+    return Result::NonSupport;
+}
+
+
 Result SwCanvas::target(uint32_t* buffer, uint32_t stride, uint32_t w, uint32_t h, Colorspace cs) noexcept
 {
 #ifdef THORVG_SW_RASTER_SUPPORT
@@ -21,17 +21,19 @@
  */
 
 #include "tvgArray.h"
-#include "tvgInlist.h"
 #include "tvgTaskScheduler.h"
 
 #ifdef THORVG_THREAD_SUPPORT
     #include <thread>
-    #include <atomic>
+    #include <mutex>
+    #include <condition_variable>
+    #ifdef __linux__
+        #include <unistd.h>
+        #include <sys/syscall.h>
+        #include <linux/futex.h>
+    #endif
 #endif
 
-/************************************************************************/
-/* Internal Class Implementation                                        */
-/************************************************************************/
 
 namespace tvg {
 
@@ -41,79 +43,273 @@ static TaskSchedulerImpl* inst = nullptr;
 #ifdef THORVG_THREAD_SUPPORT
 
 static thread_local bool _async = true;
+static thread_local int32_t _worker = -1;        //worker index of the current thread, -1 if it's not a worker.
 
-struct TaskQueue {
-    Inlist<Task>             taskDeque;
-    mutex                    mtx;
-    condition_variable       ready;
-    bool                     done = false;
+#define INJECTOR_SIZE 4096                       //must be power of 2
+#define DEQUE_INIT_SIZE 64                       //must be power of 2
+#define SPIN_CNT 64                              //stealing attempts before a worker goes to sleep
+#define WAIT_SPIN_CNT 128                        //polling attempts before a task waiter blocks
 
-    bool tryPop(Task** task)
-    {
-        unique_lock<mutex> lock{mtx, try_to_lock};
-        if (!lock || taskDeque.empty()) return false;
-        *task = taskDeque.front();
-        return true;
+#ifndef __linux__
+//no futex, the blocked waiters of all the tasks share one. it's only touched once a waiter announced itself.
+static mutex _waitMtx;
+static condition_variable _waitCv;
+#endif
+
+
+void Task::wait()
+{
+    //the task is likely finished soon, spin a while before blocking.
+    for (uint32_t i = 0; i < WAIT_SPIN_CNT; ++i) {
+        if (state.load(memory_order_acquire) == Done) return;
+    }
+
+    while (true) {
+        auto cur = state.load(memory_order_acquire);
+        if (cur == Done) return;
+        //announce a waiter so that the runner calls wake()
+        if (cur == Pending && !state.compare_exchange_weak(cur, Waiting, memory_order_acquire)) continue;
+#ifdef __linux__
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&state), FUTEX_WAIT_PRIVATE, Waiting, nullptr, nullptr, 0);
+#else
+        //the runner takes the lock after it's done, so the state can't change unnoticed in between.
+        unique_lock<mutex> lock(_waitMtx);
+        while (state.load(memory_order_acquire) == Waiting) _waitCv.wait(lock);
+#endif
+    }
+}
+
+
+void Task::wake(atomic<uint32_t>* addr)
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(addr), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+    //the task may be gone already, only the shared ones are touched.
+    { lock_guard<mutex> lock(_waitMtx); }
+    _waitCv.notify_all();
+#endif
+}
+
+
+bool Task::follow(Task* successor)
+{
+    lock();
+    //already finished, no need to wait for.
+    if (finished) {
+        unlock();
+        return false;
     }
+    successors.push(successor);
+    unlock();
+    return true;
+}
 
-    bool tryPush(Task* task)
+
+/* A Chase-Lev work-stealing deque (Le et al., "Correct and Efficient Work-Stealing for Weak Memory Models").
+   Only the owner thread pushes and pops at the bottom, any other threads steal at the top. */
+struct TaskDeque
+{
+    struct Buffer
     {
+        atomic<Task*>* data;
+        int64_t size;
+        Buffer* prev;                            //retired buffers, freed when the deque is destroyed.
+
+        Buffer(int64_t size, Buffer* prev) : size(size), prev(prev)
         {
-            unique_lock<mutex> lock{mtx, try_to_lock};
-            if (!lock) return false;
-            taskDeque.back(task);
+            data = new atomic<Task*>[size];
         }
-        ready.notify_one();
-        return true;
+
+        ~Buffer()
+        {
+            delete[](data);
+        }
+
+        Task* get(int64_t i)
+        {
+            return data[i & (size - 1)].load(memory_order_relaxed);
+        }
+
+        void put(int64_t i, Task* task)
+        {
+            data[i & (size - 1)].store(task, memory_order_relaxed);
+        }
+    };
+
+    atomic<int64_t> top{0};
+    char pad[64];                                //keep the thieves and the owner on the different cache lines.
+    atomic<int64_t> bottom{0};
+    atomic<Buffer*> buffer;
+
+    TaskDeque()
+    {
+        buffer.store(new Buffer(DEQUE_INIT_SIZE, nullptr), memory_order_relaxed);
     }
 
-    void complete()
+    ~TaskDeque()
     {
-        {
-            lock_guard<mutex> lock{mtx};
-            done = true;
+        auto buf = buffer.load(memory_order_relaxed);
+        while (buf) {
+            auto prev = buf->prev;
+            delete(buf);
+            buf = prev;
         }
-        ready.notify_all();
     }
 
-    bool pop(Task** task)
+    Buffer* grow(Buffer* buf, int64_t b, int64_t t)
     {
-        unique_lock<mutex> lock{mtx};
+        auto nbuf = new Buffer(buf->size * 2, buf);
+        for (auto i = t; i < b; ++i) nbuf->put(i, buf->get(i));
+        buffer.store(nbuf, memory_order_release);
+        return nbuf;
+    }
+
+    //owner only
+    void push(Task* task)
+    {
+        auto b = bottom.load(memory_order_relaxed);
+        auto t = top.load(memory_order_acquire);
+        auto buf = buffer.load(memory_order_relaxed);
+        if (b - t > buf->size - 1) buf = grow(buf, b, t);
+        buf->put(b, task);
+        atomic_thread_fence(memory_order_release);
+        bottom.store(b + 1, memory_order_relaxed);
+    }
 
-        while (taskDeque.empty() && !done) {
-            ready.wait(lock);
+    //owner only
+    Task* pop()
+    {
+        auto b = bottom.load(memory_order_relaxed) - 1;
+        auto buf = buffer.load(memory_order_relaxed);
+        bottom.store(b, memory_order_relaxed);
+        atomic_thread_fence(memory_order_seq_cst);
+        auto t = top.load(memory_order_relaxed);
+
+        Task* task = nullptr;
+
+        if (t <= b) {
+            task = buf->get(b);
+            //the last one, race against the thieves
+            if (t == b) {
+                if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) task = nullptr;
+                bottom.store(b + 1, memory_order_relaxed);
+            }
+        } else {
+            bottom.store(b + 1, memory_order_relaxed);
         }
+        return task;
+    }
+
+    //any threads
+    Task* steal()
+    {
+        auto t = top.load(memory_order_acquire);
+        atomic_thread_fence(memory_order_seq_cst);
+        auto b = bottom.load(memory_order_acquire);
 
-        if (taskDeque.empty()) return false;
+        if (t >= b) return nullptr;
+
+        auto task = buffer.load(memory_order_acquire)->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, memory_order_seq_cst, memory_order_relaxed)) return nullptr;
+        return task;
+    }
+};
+
+
+/* A bounded lock-free multi-producer/multi-consumer queue (D. Vyukov).
+   Tasks requested by non-worker threads are injected here, then the idle workers pick them up. */
+struct TaskInjector
+{
+    struct Cell
+    {
+        atomic<uint64_t> seq;
+        Task* task;
+    };
+
+    Cell cells[INJECTOR_SIZE];
+    atomic<uint64_t> head{0};
+    char pad[64];                                //keep the consumers and the producers on the different cache lines.
+    atomic<uint64_t> tail{0};
+
+    TaskInjector()
+    {
+        for (uint64_t i = 0; i < INJECTOR_SIZE; ++i) cells[i].seq.store(i, memory_order_relaxed);
+    }
+
+    bool push(Task* task)
+    {
+        auto pos = tail.load(memory_order_relaxed);
+        Cell* cell;
 
-        *task = taskDeque.front();
+        while (true) {
+            cell = &cells[pos & (INJECTOR_SIZE - 1)];
+            auto diff = static_cast<int64_t>(cell->seq.load(memory_order_acquire) - pos);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;   //full
+            } else {
+                pos = tail.load(memory_order_relaxed);
+            }
+        }
+        cell->task = task;
+        cell->seq.store(pos + 1, memory_order_release);
         return true;
     }
 
-    void push(Task* task)
+    Task* pop()
     {
-        {
-            lock_guard<mutex> lock{mtx};
-            taskDeque.back(task);
+        auto pos = head.load(memory_order_relaxed);
+        Cell* cell;
+
+        while (true) {
+            cell = &cells[pos & (INJECTOR_SIZE - 1)];
+            auto diff = static_cast<int64_t>(cell->seq.load(memory_order_acquire) - (pos + 1));
+            if (diff == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return nullptr;  //empty
+            } else {
+                pos = head.load(memory_order_relaxed);
+            }
         }
-        ready.notify_one();
+        auto task = cell->task;
+        cell->seq.store(pos + INJECTOR_SIZE, memory_order_release);
+        return task;
     }
 };
 
 
+/* Each priority has its own lane. The workers always drain the higher lanes first. */
+struct TaskLane
+{
+    Array<TaskDeque*>              deques;
+    TaskInjector                   injector;
+    atomic<uint32_t>               depth{0};     //queued tasks, not started yet.
+};
+
+
 struct TaskSchedulerImpl
 {
     Array<thread*>                 threads;
-    Array<TaskQueue*>              taskQueues;
-    atomic<uint32_t>               idx{0};
+    TaskLane                       lanes[static_cast<int>(TaskPriority::Count)];
+
+    //sleeping workers wait here, the lock is never taken on the task dispatching path.
+    mutex                          mtx;
+    condition_variable             ready;
+    atomic<uint32_t>               sleepers{0};
+    bool                           done = false;
 
     TaskSchedulerImpl(uint32_t threadCnt)
     {
         threads.reserve(threadCnt);
-        taskQueues.reserve(threadCnt);
 
+        for (auto lane = lanes; lane < lanes + static_cast<int>(TaskPriority::Count); ++lane) {
+            lane->deques.reserve(threadCnt);
+            for (uint32_t i = 0; i < threadCnt; ++i) lane->deques.push(new TaskDeque);
+        }
         for (uint32_t i = 0; i < threadCnt; ++i) {
-            taskQueues.push(new TaskQueue);
             threads.push(new thread);
         }
         for (uint32_t i = 0; i < threadCnt; ++i) {
@@ -123,59 +319,154 @@ struct TaskSchedulerImpl
 
     ~TaskSchedulerImpl()
     {
-        for (auto tq = taskQueues.begin(); tq < taskQueues.end(); ++tq) {
-            (*tq)->complete();
+        {
+            lock_guard<mutex> lock{mtx};
+            done = true;
         }
+        ready.notify_all();
+
         for (auto thread = threads.begin(); thread < threads.end(); ++thread) {
             (*thread)->join();
             delete(*thread);
         }
-        for (auto tq = taskQueues.begin(); tq < taskQueues.end(); ++tq) {
-            delete(*tq);
+        for (auto lane = lanes; lane < lanes + static_cast<int>(TaskPriority::Count); ++lane) {
+            for (auto dq = lane->deques.begin(); dq < lane->deques.end(); ++dq) {
+                delete(*dq);
+            }
         }
     }
 
+    Task* fetch(TaskLane& lane, unsigned i)
+    {
+        //1. the local tasks which were requested by this worker
+        if (auto task = lane.deques[i]->pop()) return task;
+
+        //2. the tasks requested by the outside of the workers
+        if (auto task = lane.injector.pop()) return task;
+
+        //3. steal from the busy workers
+        for (uint32_t n = 1; n < threads.count; ++n) {
+            if (auto task = lane.deques[(i + n) % threads.count]->steal()) return task;
+        }
+        return nullptr;
+    }
+
+    Task* fetch(unsigned i)
+    {
+        for (auto lane = lanes; lane < lanes + static_cast<int>(TaskPriority::Count); ++lane) {
+            if (auto task = fetch(*lane, i)) {
+                lane->depth.fetch_sub(1, memory_order_relaxed);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void wake()
+    {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (sleepers.load(memory_order_relaxed) == 0) return;
+        lock_guard<mutex> lock{mtx};
+        ready.notify_one();
+    }
+
     void run(unsigned i)
     {
-        Task* task;
+        _worker = i;
 
         //Thread Loop
         while (true) {
-            auto success = false;
-            for (uint32_t x = 0; x < threads.count * 2; ++x) {
-                if (taskQueues[(i + x) % threads.count]->tryPop(&task)) {
-                    success = true;
-                    break;
-                }
+            Task* task = nullptr;
+
+            for (uint32_t x = 0; x < SPIN_CNT && !task; ++x) {
+                task = fetch(i);
+                if (!task) this_thread::yield();
             }
 
-            if (!success && !taskQueues[i]->pop(&task)) break;
+            //nothing to do, go to sleep.
+            if (!task) {
+                unique_lock<mutex> lock{mtx};
+                sleepers.fetch_add(1, memory_order_seq_cst);
+                while (!(task = fetch(i)) && !done) ready.wait(lock);
+                sleepers.fetch_sub(1, memory_order_relaxed);
+            }
+
+            if (!task) break;
             (*task)(i + 1);
         }
     }
 
-    void request(Task* task)
+    void schedule(Task* task)
+    {
+        auto& lane = lanes[static_cast<int>(task->priority)];
+        lane.depth.fetch_add(1, memory_order_relaxed);
+
+        //a worker keeps its own requests for the locality, the others may steal them.
+        if (_worker >= 0 && _worker < (int32_t) threads.count) {
+            lane.deques[_worker]->push(task);
+        //the injector is full, run the task on this thread.
+        } else if (!lane.injector.push(task)) {
+            lane.depth.fetch_sub(1, memory_order_relaxed);
+            (*task)(0);
+            return;
+        }
+        wake();
+    }
+
+    void request(Task* task, Task** deps, uint32_t cnt, TaskPriority priority)
     {
         //Async
         if (threads.count > 0 && _async) {
             task->prepare();
-            auto i = idx++;
-            for (uint32_t n = 0; n < threads.count; ++n) {
-                if (taskQueues[(i + n) % threads.count]->tryPush(task)) return;
+            task->priority = priority;
+            //one extra count holds the task until all the dependencies are registered.
+            task->unresolved.store(cnt + 1, memory_order_relaxed);
+            for (uint32_t i = 0; i < cnt; ++i) {
+                if (!deps[i]->follow(task)) task->unresolved.fetch_sub(1, memory_order_relaxed);
             }
-            taskQueues[i % threads.count]->push(task);
+            if (task->unresolved.fetch_sub(1, memory_order_acq_rel) == 1) schedule(task);
         //Sync
         } else {
+            for (uint32_t i = 0; i < cnt; ++i) deps[i]->done();
             task->run(0);
         }
     }
 
+    uint32_t queued(TaskPriority priority)
+    {
+        return lanes[static_cast<int>(priority)].depth.load(memory_order_relaxed);
+    }
+
     uint32_t threadCnt()
     {
         return threads.count;
     }
+
+    bool worker()
+    {
+        return _worker >= 0;
+    }
 };
 
+
+void Task::operator()(unsigned tid)
+{
+    run(tid);
+
+    //Release the successors, any follow() after this regards this task as finished.
+    lock();
+    finished = true;
+    for (auto successor = successors.begin(); successor < successors.end(); ++successor) {
+        if ((*successor)->unresolved.fetch_sub(1, memory_order_acq_rel) == 1) inst->schedule(*successor);
+    }
+    successors.clear();
+    unlock();
+
+    //The waiters may destroy this task as soon as it's done, don't touch it after this.
+    auto addr = &state;
+    if (state.exchange(Done, memory_order_release) == Waiting) wake(addr);
+}
+
 #else //THORVG_THREAD_SUPPORT
 
 static bool _async = true;
@@ -183,8 +474,10 @@ static bool _async = true;
 struct TaskSchedulerImpl
 {
     TaskSchedulerImpl(TVG_UNUSED uint32_t threadCnt) {}
-    void request(Task* task) { task->run(0); }
+    void request(Task* task, TVG_UNUSED Task** deps, TVG_UNUSED uint32_t cnt, TVG_UNUSED TaskPriority priority) { task->run(0); }
+    uint32_t queued(TVG_UNUSED TaskPriority priority) { return 0; }
     uint32_t threadCnt() { return 0; }
+    bool worker() { return false; }
 };
 
 #endif //THORVG_THREAD_SUPPORT
@@ -209,9 +502,16 @@ void TaskScheduler::term()
 }
 
 
-void TaskScheduler::request(Task* task)
+void TaskScheduler::request(Task* task, Task** deps, uint32_t cnt, TaskPriority priority)
+{
+    if (inst) inst->request(task, deps, cnt, priority);
+}
+
+
+uint32_t TaskScheduler::queued(TaskPriority priority)
 {
-    if (inst) inst->request(task);
+    if (inst) return inst->queued(priority);
+    return 0;
 }
 
 
@@ -222,6 +522,13 @@ uint32_t TaskScheduler::threads()
 }
 
 
+bool TaskScheduler::worker()
+{
+    if (inst) return inst->worker();
+    return false;
+}
+
+
 void TaskScheduler::async(bool on)
 {
     //toggle async tasking for each thread on/off
@@ -23,55 +23,73 @@
 #ifndef _TVG_TASK_SCHEDULER_H_
 #define _TVG_TASK_SCHEDULER_H_
 
-#include <mutex>
-#include <condition_variable>
+#include <atomic>
 
 #include "tvgCommon.h"
-#include "tvgInlist.h"
+#include "tvgArray.h"
 
 namespace tvg {
 
+enum class TaskPriority : uint8_t
+{
+    High = 0,    //latency-critical jobs such as the frame rendering
+    Low,         //background jobs such as the loading and the saving
+    Count
+};
+
 #ifdef THORVG_THREAD_SUPPORT
 
 struct Task
 {
 private:
-    mutex                   mtx;
-    condition_variable      cv;
-    bool                    ready = true;
-    bool                    pending = false;
+    enum : uint32_t {Done = 0, Pending, Waiting};     //Waiting: pending and someone is blocked on it.
 
-public:
-    INLIST_ITEM(Task);
+    atomic<uint32_t>        state{Done};
+    atomic<uint32_t>        unresolved{0};            //count of the predecessors not finished yet
+    atomic_flag             key = ATOMIC_FLAG_INIT;   //guards the successors
+    Array<Task*>            successors;               //tasks waiting for this task
+    bool                    finished = true;          //successors are released, no more follow.
+    TaskPriority            priority = TaskPriority::High;
+
+    void wait();                                      //slow path of done()
+    static void wake(atomic<uint32_t>* addr);
+    bool follow(Task* successor);
 
+    void lock()
+    {
+        while (key.test_and_set(memory_order_acquire));
+    }
+
+    void unlock()
+    {
+        key.clear(memory_order_release);
+    }
+
+public:
     virtual ~Task() = default;
 
     void done()
     {
-        if (!pending) return;
-
-        unique_lock<mutex> lock(mtx);
-        while (!ready) cv.wait(lock);
-        pending = false;
+        //fast path: the task has been finished already.
+        if (state.load(memory_order_relaxed) == Done) {
+            atomic_thread_fence(memory_order_acquire);
+            return;
+        }
+        wait();
     }
 
 protected:
     virtual void run(unsigned tid) = 0;
 
 private:
-    void operator()(unsigned tid)
-    {
-        run(tid);
-
-        lock_guard<mutex> lock(mtx);
-        ready = true;
-        cv.notify_one();
-    }
+    void operator()(unsigned tid);
 
     void prepare()
     {
-        ready = false;
-        pending = true;
+        state.store(Pending, memory_order_relaxed);
+        lock();
+        finished = false;
+        unlock();
     }
 
     friend struct TaskSchedulerImpl;
@@ -82,8 +100,6 @@ private:
 struct Task
 {
 public:
-    INLIST_ITEM(Task);
-
     virtual ~Task() = default;
     void done() {}
 
@@ -100,9 +116,13 @@ private:
 struct TaskScheduler
 {
     static uint32_t threads();
+    static bool worker();                            //true if the caller is running on a worker thread
     static void init(uint32_t threads);
     static void term();
-    static void request(Task* task);
+    //the task is queued after all the given tasks(deps) are finished.
+    static void request(Task* task, Task** deps = nullptr, uint32_t cnt = 0, TaskPriority priority = TaskPriority::High);
+    static void request(Task* task, TaskPriority priority) { request(task, nullptr, 0, priority); }
+    static uint32_t queued(TaskPriority priority);   //the number of the tasks waiting for a worker in the lane
     static void async(bool on);
 };
 
@@ -368,6 +368,36 @@ bool WgRenderer::endComposite(TVG_UNUSED Compositor* cmp)
 }
 
 
+bool WgRenderer::beginCache(TVG_UNUSED RenderData* cache, TVG_UNUSED const RenderRegion& region)
+{
+    //TODO: Not supported yet, the paints are rendered directly.
+    return false;
+}
+
+
+bool WgRenderer::endCache(TVG_UNUSED RenderData cache)
+{
+    return false;
+}
+
+
+bool WgRenderer::renderCache(TVG_UNUSED RenderData cache, TVG_UNUSED int32_t x, TVG_UNUSED int32_t y, TVG_UNUSED uint8_t opacity)
+{
+    return false;
+}
+
+
+bool WgRenderer::cached(TVG_UNUSED RenderData cache)
+{
+    return false;
+}
+
+
+void WgRenderer::disposeCache(TVG_UNUSED RenderData cache)
+{
+}
+
+
 WgRenderer* WgRenderer::gen()
 {
     return new WgRenderer();
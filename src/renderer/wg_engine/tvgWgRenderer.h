@@ -56,6 +56,12 @@ public:
     bool beginComposite(Compositor* cmp, CompositeMethod method, uint8_t opacity);
     bool endComposite(Compositor* cmp);
 
+    bool beginCache(RenderData* cache, const RenderRegion& region);
+    bool endCache(RenderData cache);
+    bool renderCache(RenderData cache, int32_t x, int32_t y, uint8_t opacity);
+    bool cached(RenderData cache);
+    void disposeCache(RenderData cache);
+
     static WgRenderer* gen();
     static bool init(uint32_t threads);
     static bool term();
@@ -144,7 +144,7 @@ bool GifSaver::save(Animation* animation, Paint* bg, const string& path, TVG_UNU
     if (bg) this->bg = bg->duplicate();
     this->fps = static_cast<float>(fps);
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -805,7 +805,7 @@ bool TvgSaver::save(Paint* paint, Paint* bg, const string& path, TVG_UNUSED uint
         this->paint = paint;
     }
 
-    TaskScheduler::request(this);
+    TaskScheduler::request(this, TaskPriority::Low);
 
     return true;
 }
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <string.h>
+#include <vector>
+#include <thorvg.h>
+#include <thorvg_lottie.h>
+#ifdef _WIN32
+    #include <windows.h>
+    #ifndef PATH_MAX
+        #define PATH_MAX MAX_PATH
+    #endif
+#else
+    #include <dirent.h>
+    #include <unistd.h>
+    #include <limits.h>
+    #include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace tvg;
+
+
+struct App
+{
+private:
+   char full[PATH_MAX];    //full path
+
+   void helpMsg()
+   {
+      cout << "Usage: \n   lottie2lotb [Lottie file] or [Lottie folder]\n\nExamples: \n    $ lottie2lotb input.json\n    $ lottie2lotb lottiefolder\n\n";
+   }
+
+   bool validate(string& lottieName)
+   {
+      string extn = ".json";
+
+      if (lottieName.size() <= extn.size() || lottieName.substr(lottieName.size() - extn.size()) != extn) {
+         cout << "Error: \"" << lottieName << "\" is invalid." << endl;
+         return false;
+      }
+      return true;
+   }
+
+   bool convert(string& in, string& out)
+   {
+      if (Initializer::init(0, CanvasEngine::Sw) != Result::Success) return false;
+
+      auto result = false;
+
+      //scope the animation to release it before the termination
+      {
+         auto animation = LottieAnimation::gen();
+         auto picture = animation->picture();
+         if (picture->load(in) == Result::Success) {
+            result = (animation->save(out.c_str()) == Result::Success);
+         }
+      }
+
+      if (Initializer::term(CanvasEngine::Sw) != Result::Success) return false;
+
+      return result;
+   }
+
+   void convert(string& lottieName)
+   {
+      //Get lotb file
+      auto lotbName = lottieName;
+      lotbName.replace(lotbName.length() - 4, 4, "lotb");
+
+      if (convert(lottieName, lotbName)) {
+         cout << "Generated Lotb file : " << lotbName << endl;
+      } else {
+         cout << "Failed Converting Lotb file : " << lottieName << endl;
+      }
+   }
+
+   const char* realPath(const char* path)
+   {
+#ifdef _WIN32
+      return _fullpath(full, path, PATH_MAX);
+#else
+      return realpath(path, full);
+#endif
+   }
+
+   bool isDirectory(const char* path)
+   {
+#ifdef _WIN32
+      DWORD attr = GetFileAttributes(path);
+      if (attr == INVALID_FILE_ATTRIBUTES) return false;
+      return attr & FILE_ATTRIBUTE_DIRECTORY;
+#else
+      struct stat buf;
+      if (stat(path, &buf) != 0) return false;
+      return S_ISDIR(buf.st_mode);
+#endif
+   }
+
+   bool handleDirectory(const string& path)
+   {
+#ifdef _WIN32
+        //open directory
+        WIN32_FIND_DATA fd;
+        HANDLE h = FindFirstFileEx((path + "\\*").c_str(), FindExInfoBasic, &fd, FindExSearchNameMatch, NULL, 0);
+        if (h == INVALID_HANDLE_VALUE) {
+            cout << "Couldn't open directory \"" << path.c_str() << "\"." << endl;
+            return false;
+        }
+        //List directories
+        do {
+            if (*fd.cFileName == '.' || *fd.cFileName == '$') continue;
+            //sub directory
+            if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+                string subpath = string(path);
+                subpath += '\\';
+                subpath += fd.cFileName;
+                if (!handleDirectory(subpath)) continue;
+            //file
+            } else {
+                string lottieName(fd.cFileName);
+                if (!validate(lottieName)) continue;
+                lottieName = string(path);
+                lottieName += '\\';
+                lottieName += fd.cFileName;
+                convert(lottieName);
+            }
+        } while (FindNextFile(h, &fd));
+
+        FindClose(h);
+#else
+        //open directory
+        auto dir = opendir(path.c_str());
+        if (!dir) {
+            cout << "Couldn't open directory \"" << path.c_str() << "\"." << endl;
+            return false;
+        }
+        //List directories
+        while (auto entry = readdir(dir)) {
+            if (*entry->d_name == '.' || *entry->d_name == '$') continue;
+            //sub directory
+            if (entry->d_type == DT_DIR) {
+                string subpath = string(path);
+                subpath += '/';
+                subpath += entry->d_name;
+                if (!handleDirectory(subpath)) continue;
+            //file
+            } else {
+                string svgName(entry->d_name);
+                if (!validate(svgName)) continue;
+                svgName = string(path);
+                svgName += '/';
+                svgName += entry->d_name;
+                convert(svgName);
+            }
+        }
+#endif
+        return true;
+    }
+
+public:
+   int setup(int argc, char** argv)
+   {
+      //Collect input files
+      vector<const char*> inputs;
+
+      for (int i = 1; i < argc; ++i) {
+         const char* p = argv[i];
+         if (*p == '-') {
+            cout << "Warning: Unknown flag (" << p << ")." << endl;
+         } else {
+            inputs.push_back(argv[i]);
+         }
+      }
+
+      //No Input Lottie
+      if (inputs.empty()) {
+         helpMsg();
+         return 0;
+      }
+
+      for (auto input : inputs) {
+
+         auto path = realPath(input);
+         if (!path) {
+            cout << "Invalid file or path name: \"" << input << "\"" << endl;
+            continue;
+         }
+
+         if (isDirectory(path)) {
+            //load from directory
+            cout << "Directory: \"" << path << "\"" << endl;
+            if (!handleDirectory(path)) break;
+         }
+         else {
+            string lottieName(input);
+            if (!validate(lottieName)) continue;
+            convert(lottieName);
+         }
+      }
+      return 0;
+   }
+};
+
+
+int main(int argc, char **argv)
+{
+   App app;
+   return app.setup(argc, argv);
+}
\ No newline at end of file
@@ -0,0 +1,705 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <thread>
+#include <vector>
+#include <thorvg.h>
+
+using namespace std;
+using namespace tvg;
+
+/* Micro benchmarks of the software rasterizer. Each case draws the same scene repeatedly and reports
+   the average time per frame. To compare an implementation with another, run this against the builds
+   of both, e.g. with LD_LIBRARY_PATH pointing to each of them. */
+
+static const char* blendNames[] = {"Normal", "Add", "Screen", "Multiply", "Overlay", "Difference", "Exclusion", "SrcOver", "Darken", "Lighten", "ColorDodge", "ColorBurn", "HardLight", "SoftLight"};
+static const char* compositeNames[] = {"None", "ClipPath", "AlphaMask", "InvAlphaMask", "LumaMask", "InvLumaMask", "AddMask", "SubtractMask", "IntersectMask", "DifferenceMask"};
+
+
+struct App
+{
+private:
+   uint32_t width = 800;
+   uint32_t height = 800;
+   uint32_t iterations = 100;
+   uint32_t threads = 0;
+   uint32_t seed = 1;
+   vector<uint32_t> buffer;
+   vector<uint32_t> image;
+   vector<const char*> svgs;
+   vector<const char*> lotties;
+
+   void helpMsg()
+   {
+      cout << "Usage: \n   tvgbench [suite...] [-r resolution] [-i iterations] [-t threads]\n\nSuites: \n    blend       every blending method with the shapes and the images\n    composite   every matting and masking method\n    path        the path rasterization (rle generation) of the icons, the maps and the charts, and the given svg files\n    lottie      the frame updates of the long keyframe tracks and the given lottie files, in the playback and in the seeking\n    threads     the frame preparing of the small shapes with 1 to N threads, in the default and in the banded raster\n\nExamples: \n    $ tvgbench\n    $ tvgbench blend -r 1024x1024 -i 200\n    $ tvgbench composite -t 4\n    $ tvgbench path icon1.svg icon2.svg map.svg\n    $ tvgbench lottie anim1.json anim2.json\n    $ tvgbench threads -r 1024x1024\n\n";
+   }
+
+   //a translucent checker board with the gradient
+   void genImage()
+   {
+      image.resize(256 * 256);
+      for (uint32_t y = 0; y < 256; ++y) {
+         for (uint32_t x = 0; x < 256; ++x) {
+            uint32_t a = ((x / 32 + y / 32) % 2) ? 255 : 160;
+            uint32_t r = x * a / 255;
+            uint32_t g = y * a / 255;
+            uint32_t b = (255 - x) * a / 255;
+            image[y * 256 + x] = (a << 24) | (r << 16) | (g << 8) | b;
+         }
+      }
+   }
+
+   //rects, anti-aliased circles, linear and radial gradients, a direct and a scaled image
+   void content(Scene* scene, uint8_t opacity, BlendMethod method)
+   {
+      auto w = static_cast<float>(width);
+      auto h = static_cast<float>(height);
+
+      Fill::ColorStop stops[3] = {{0.0f, 255, 0, 0, opacity}, {0.5f, 0, 255, 100, 255}, {1.0f, 50, 50, 255, opacity}};
+
+      auto linear = LinearGradient::gen();
+      linear->linear(0, 0, w, h);
+      linear->colorStops(stops, 3);
+      auto rect = Shape::gen();
+      rect->appendRect(w * 0.1f, h * 0.5f, w * 0.8f, h * 0.3f, w * 0.05f, h * 0.05f);
+      rect->fill(std::move(linear));
+      rect->blend(method);
+      scene->push(std::move(rect));
+
+      auto radial = RadialGradient::gen();
+      radial->radial(w * 0.6f, h * 0.4f, w * 0.3f);
+      radial->colorStops(stops, 3);
+      auto circle = Shape::gen();
+      circle->appendCircle(w * 0.6f, h * 0.4f, w * 0.3f, h * 0.3f);
+      circle->fill(std::move(radial));
+      circle->blend(method);
+      scene->push(std::move(circle));
+
+      for (int i = 0; i < 8; ++i) {
+         auto rect = Shape::gen();
+         rect->appendRect(w * 0.05f * i, h * 0.04f * i, w * 0.5f, h * 0.3f);
+         rect->fill(30 * i, 255 - 30 * i, 128, opacity);
+         rect->blend(method);
+         scene->push(std::move(rect));
+
+         auto circle = Shape::gen();
+         circle->appendCircle(w * (0.3f + 0.05f * i), h * (0.6f - 0.03f * i), w * 0.25f, h * 0.2f);
+         circle->fill(255 - 30 * i, 100, 30 * i, opacity);
+         circle->blend(method);
+         scene->push(std::move(circle));
+      }
+
+      auto picture = Picture::gen();
+      picture->load(image.data(), 256, 256, true, false);
+      picture->translate(10, h - 266);
+      picture->blend(method);
+      scene->push(std::move(picture));
+
+      picture = Picture::gen();
+      picture->load(image.data(), 256, 256, true, false);
+      picture->size(w * 0.6f, h * 0.6f);
+      picture->translate(w * 0.35f, h * 0.35f);
+      picture->opacity(opacity);
+      picture->blend(method);
+      scene->push(std::move(picture));
+   }
+
+   //deterministic pseudo random numbers in [0, 1)
+   float random()
+   {
+      seed = seed * 1103515245 + 12345;
+      return static_cast<float>((seed >> 8) & 0xffff) / 65536.0f;
+   }
+
+   //a grid of small glyph-like paths: gears with holes, rounded stars and stroked ribbons
+   void icons(Scene* scene)
+   {
+      const float size = 40.0f;
+
+      for (float y = 0; y + size <= height; y += size) {
+         for (float x = 0; x + size <= width; x += size) {
+            auto cx = x + size * 0.5f;
+            auto cy = y + size * 0.5f;
+            auto shape = Shape::gen();
+
+            switch (static_cast<int>(random() * 3)) {
+               case 0: {
+                  auto teeth = 8 + static_cast<int>(random() * 8);
+                  for (int i = 0; i < teeth * 2; ++i) {
+                     auto r = size * ((i % 2) ? 0.45f : 0.35f);
+                     auto a = static_cast<float>(i) * M_PI / teeth;
+                     if (i == 0) shape->moveTo(cx + r * cosf(a), cy + r * sinf(a));
+                     else shape->lineTo(cx + r * cosf(a), cy + r * sinf(a));
+                  }
+                  shape->close();
+                  shape->appendCircle(cx, cy, size * 0.15f, size * 0.15f);
+                  shape->fill(FillRule::EvenOdd);
+                  break;
+               }
+               case 1: {
+                  auto points = 5 + static_cast<int>(random() * 5);
+                  shape->moveTo(cx + size * 0.45f, cy);
+                  for (int i = 1; i <= points * 2; ++i) {
+                     auto r = size * ((i % 2) ? 0.18f : 0.45f);
+                     auto a = static_cast<float>(i) * M_PI / points;
+                     auto c = static_cast<float>(i - 0.5f) * M_PI / points;
+                     shape->cubicTo(cx + size * 0.3f * cosf(c), cy + size * 0.3f * sinf(c), cx + size * 0.3f * cosf(c), cy + size * 0.3f * sinf(c), cx + r * cosf(a), cy + r * sinf(a));
+                  }
+                  shape->close();
+                  break;
+               }
+               default: {
+                  shape->moveTo(x + 4, y + size - 6);
+                  for (int i = 0; i < 4; ++i) {
+                     auto ty = y + size * (0.75f - 0.2f * i);
+                     shape->cubicTo(x + size * random(), ty - 10, x + size * random(), ty + 10, x + 4 + (size - 8) * (i % 2), ty);
+                  }
+                  shape->strokeWidth(2.5f);
+                  shape->strokeFill(40, 40, 40, 255);
+                  break;
+               }
+            }
+            shape->fill(static_cast<uint8_t>(random() * 255), 90, 160, 255);
+            scene->push(std::move(shape));
+         }
+      }
+   }
+
+   //a few large regions with jagged borders, concentric contour lines and stroked roads
+   void map(Scene* scene)
+   {
+      auto w = static_cast<float>(width);
+      auto h = static_cast<float>(height);
+
+      for (int i = 0; i < 6; ++i) {
+         auto region = Shape::gen();
+         auto cx = w * (0.2f + 0.6f * random());
+         auto cy = h * (0.2f + 0.6f * random());
+         for (int j = 0; j < 2000; ++j) {
+            auto a = static_cast<float>(j) * 2.0f * M_PI / 2000.0f;
+            auto r = (0.2f + 0.08f * random()) * w;
+            if (j == 0) region->moveTo(cx + r * cosf(a), cy + r * sinf(a));
+            else region->lineTo(cx + r * cosf(a), cy + r * sinf(a));
+         }
+         region->close();
+         region->fill(60 + i * 30, 180 - i * 20, 90, 160);
+         region->fill(FillRule::EvenOdd);
+         scene->push(std::move(region));
+      }
+
+      auto contours = Shape::gen();
+      for (int i = 1; i <= 30; ++i) {
+         for (int j = 0; j < 300; ++j) {
+            auto a = static_cast<float>(j) * 2.0f * M_PI / 300.0f;
+            auto r = i * 0.015f * w * (1.0f + 0.1f * sinf(a * 7.0f + i));
+            if (j == 0) contours->moveTo(w * 0.5f + r * cosf(a), h * 0.5f + r * sinf(a));
+            else contours->lineTo(w * 0.5f + r * cosf(a), h * 0.5f + r * sinf(a));
+         }
+         contours->close();
+      }
+      contours->fill(120, 80, 40, 200);
+      contours->fill(FillRule::EvenOdd);
+      scene->push(std::move(contours));
+
+      for (int i = 0; i < 40; ++i) {
+         auto road = Shape::gen();
+         auto x = w * random();
+         auto y = h * random();
+         road->moveTo(x, y);
+         for (int j = 0; j < 200; ++j) {
+            x += w * 0.02f * (random() - 0.5f);
+            y += h * 0.02f * (random() - 0.5f);
+            road->lineTo(x, y);
+         }
+         road->strokeWidth(2.0f);
+         road->strokeFill(250, 250, 250, 255);
+         scene->push(std::move(road));
+      }
+   }
+
+   //gridlines and plots of 100k line segments, thin as a pixel or less
+   void chart(Scene* scene)
+   {
+      auto w = static_cast<float>(width);
+      auto h = static_cast<float>(height);
+
+      auto grid = Shape::gen();
+      for (int i = 1; i < 20; ++i) {
+         grid->moveTo(w * i / 20.0f, 0);
+         grid->lineTo(w * i / 20.0f, h);
+         grid->moveTo(0, h * i / 20.0f);
+         grid->lineTo(w, h * i / 20.0f);
+      }
+      grid->strokeWidth(1.0f);
+      grid->strokeFill(200, 200, 200, 255);
+      float dashes[] = {4.0f, 2.0f};
+      grid->strokeDash(dashes, 2);
+      scene->push(std::move(grid));
+
+      for (int i = 0; i < 10; ++i) {
+         auto plot = Shape::gen();
+         auto y = h * 0.5f;
+         plot->moveTo(0, y);
+         for (int j = 1; j <= 10000; ++j) {
+            y += h * 0.02f * (random() - 0.5f);
+            if (y < 0) y = 0;
+            else if (y > h) y = h;
+            plot->lineTo(w * j / 10000.0f, y);
+         }
+         plot->strokeWidth(i % 2 ? 1.0f : 0.5f);
+         plot->strokeFill(25 * i, 100, 255 - 25 * i, 255);
+         scene->push(std::move(plot));
+      }
+   }
+
+   //hundreds of small shapes which is the common case of the ui scenes
+   void shapes(Scene* scene)
+   {
+      for (uint32_t i = 0; i < 1000; ++i) {
+         auto x = static_cast<float>((i * 37) % width);
+         auto y = static_cast<float>((i * 91) % height);
+         auto shape = Shape::gen();
+         shape->moveTo(x, y);
+         shape->cubicTo(x + 20, y - 10, x + 40, y + 30, x + 30, y + 50);
+         shape->lineTo(x - 10, y + 40);
+         shape->close();
+         shape->appendCircle(x + 15, y + 15, 10, 14);
+         shape->fill(i % 255, (i * 3) % 255, (i * 7) % 255, 200);
+         shape->strokeWidth(2);
+         shape->strokeFill(0, 0, 0, 255);
+         scene->push(std::move(shape));
+      }
+   }
+
+   //a lottie keyframe track of the dims values
+   string keyframes(uint32_t cnt, uint32_t seed, uint32_t dims, float range)
+   {
+      string track = "{\"a\":1,\"k\":[";
+      for (uint32_t i = 0; i < cnt; ++i) {
+         track += "{\"i\":{\"x\":0.5,\"y\":1},\"o\":{\"x\":0.5,\"y\":0},\"t\":" + to_string(i * 2) + ",\"s\":[";
+         for (uint32_t d = 0; d < dims; ++d) {
+            if (d > 0) track += ",";
+            track += to_string(static_cast<float>((i * 7 + d * 13 + seed * 31) % 100) * range * 0.01f);
+         }
+         track += "]}";
+         if (i + 1 < cnt) track += ",";
+      }
+      return track + "]}";
+   }
+
+   //a lottie keyframe track of a closed bezier path
+   string pathKeyframes(uint32_t cnt, uint32_t seed)
+   {
+      string track = "{\"a\":1,\"k\":[";
+      for (uint32_t i = 0; i < cnt; ++i) {
+         auto r = to_string(10 + (i * 7 + seed) % 20);
+         track += "{\"i\":{\"x\":0.5,\"y\":1},\"o\":{\"x\":0.5,\"y\":0},\"t\":" + to_string(i * 2) + ",\"s\":[{\"c\":true,";
+         track += "\"v\":[[0,-" + r + "],[" + r + ",0],[0," + r + "],[-" + r + ",0]],";
+         track += "\"i\":[[-5,0],[0,-5],[5,0],[0,5]],\"o\":[[5,0],[0,5],[-5,0],[0,-5]]}]}";
+         if (i + 1 < cnt) track += ",";
+      }
+      return track + "]}";
+   }
+
+   //every layer has the animated transform, path and color over the whole frames
+   string lottie(uint32_t layers, uint32_t cnt)
+   {
+      auto frames = to_string(cnt * 2);
+      string json = "{\"v\":\"5.7.0\",\"fr\":60,\"ip\":0,\"op\":" + frames + ",\"w\":512,\"h\":512,\"layers\":[";
+
+      for (uint32_t i = 0; i < layers; ++i) {
+         json += "{\"ty\":4,\"ind\":" + to_string(i + 1) + ",\"ip\":0,\"op\":" + frames + ",\"st\":0,\"ks\":{";
+         json += "\"p\":" + keyframes(cnt, i, 2, 512.0f) + ",";
+         json += "\"r\":" + keyframes(cnt, i + 1, 1, 360.0f) + ",";
+         json += "\"o\":{\"a\":0,\"k\":100},\"s\":{\"a\":0,\"k\":[100,100]},\"a\":{\"a\":0,\"k\":[0,0]}},";
+         json += "\"shapes\":[{\"ty\":\"sh\",\"ks\":" + pathKeyframes(cnt, i) + "},";
+         json += "{\"ty\":\"fl\",\"c\":" + keyframes(cnt, i + 2, 3, 1.0f) + ",\"o\":{\"a\":0,\"k\":100}}]}";
+         if (i + 1 < layers) json += ",";
+      }
+      return json + "]}";
+   }
+
+   unique_ptr<Shape> background()
+   {
+      auto bg = Shape::gen();
+      bg->appendRect(0, 0, width, height);
+      bg->fill(80, 120, 200, 255);
+      return bg;
+   }
+
+   struct Time
+   {
+      double avg = 0.0;
+      double min = 0.0;
+   };
+
+   //the time per frame in milliseconds, the fastest one is less affected by the system noise
+   Time run(SwCanvas* canvas)
+   {
+      //warming up, the paints are prepared once thus the rasterization is measured only.
+      canvas->update();
+      canvas->draw();
+      canvas->sync();
+
+      Time time;
+      for (uint32_t i = 0; i < iterations; ++i) {
+         auto begin = chrono::high_resolution_clock::now();
+         canvas->clear(false);
+         canvas->draw();
+         canvas->sync();
+         auto elapsed = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - begin).count();
+         time.avg += elapsed;
+         if (i == 0 || elapsed < time.min) time.min = elapsed;
+      }
+      time.avg /= iterations;
+      return time;
+   }
+
+   //the time per frame in milliseconds, the paths are regenerated by a transform every frame
+   Time runUpdate(SwCanvas* canvas, Scene* scene)
+   {
+      canvas->update();
+      canvas->draw();
+      canvas->sync();
+
+      Time time;
+      for (uint32_t i = 0; i < iterations; ++i) {
+         auto begin = chrono::high_resolution_clock::now();
+         scene->rotate((i % 2) ? 0.0f : 0.01f);
+         canvas->update(scene);
+         canvas->clear(false);
+         canvas->draw();
+         canvas->sync();
+         auto elapsed = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - begin).count();
+         time.avg += elapsed;
+         if (i == 0 || elapsed < time.min) time.min = elapsed;
+      }
+      time.avg /= iterations;
+      return time;
+   }
+
+   //the time per update in milliseconds, at every half frame in the playback or at the random frames in the seeking
+   Time runFrames(Animation* animation, bool seeking)
+   {
+      auto total = animation->totalFrame();
+      uint32_t updates = 0;
+
+      //rewind, the playback starts from the next one of the first frame.
+      animation->frame(0.0f);
+
+      Time time;
+      auto frame = 0.0f;
+      for (float no = 0.5f; no < total; no += 0.5f, ++updates) {
+         //the same frame is not updated again, jump to another one.
+         if (seeking) {
+            auto prev = frame;
+            while (frame == prev) frame = static_cast<float>(static_cast<uint32_t>(random() * total)) + 0.5f;
+         } else frame = no;
+         auto begin = chrono::high_resolution_clock::now();
+         animation->frame(frame);
+         auto elapsed = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - begin).count();
+         time.avg += elapsed;
+         if (updates == 0 || elapsed < time.min) time.min = elapsed;
+      }
+      if (updates > 0) time.avg /= updates;
+      return time;
+   }
+
+   unique_ptr<SwCanvas> canvas()
+   {
+      auto canvas = SwCanvas::gen();
+      canvas->target(buffer.data(), width, width, height, SwCanvas::ARGB8888S);
+      canvas->push(background());
+      return canvas;
+   }
+
+   void report(const char* name, const Time& time)
+   {
+      cout << "  " << left << setw(16) << name << right << fixed << setprecision(3) << setw(10) << time.avg << " ms (avg)" << setw(10) << time.min << " ms (min)" << endl;
+   }
+
+   //the content in the opaque and the translucent
+   unique_ptr<SwCanvas> blendCanvas(BlendMethod method)
+   {
+      auto canvas = this->canvas();
+      for (uint8_t opacity : {255, 180}) {
+         auto scene = Scene::gen();
+         content(scene.get(), opacity, method);
+         canvas->push(std::move(scene));
+      }
+      return canvas;
+   }
+
+   unique_ptr<SwCanvas> compositeCanvas(CompositeMethod method)
+   {
+      auto canvas = this->canvas();
+      auto scene = Scene::gen();
+      content(scene.get(), 200, BlendMethod::Normal);
+
+      auto mask = Shape::gen();
+      mask->appendCircle(width * 0.5f, height * 0.5f, width * 0.45f, height * 0.4f);
+      mask->fill(200, 255, 100, 220);
+      auto mask2 = Shape::gen();
+      mask2->appendRect(width * 0.1f, height * 0.2f, width * 0.6f, height * 0.7f);
+      mask2->fill(255, 100, 100, 180);
+
+      //the masking methods are applied between the masks
+      if (method >= CompositeMethod::AddMask) {
+         mask->composite(std::move(mask2), method);
+         scene->composite(std::move(mask), CompositeMethod::AlphaMask);
+      } else {
+         scene->composite(std::move(mask), method);
+      }
+      canvas->push(std::move(scene));
+      return canvas;
+   }
+
+   void blend()
+   {
+      cout << "Blending (" << width << "x" << height << ", " << iterations << " iterations)" << endl;
+
+      for (int i = (int)BlendMethod::Normal; i <= (int)BlendMethod::SoftLight; ++i) {
+         report(blendNames[i], run(blendCanvas((BlendMethod)i).get()));
+      }
+   }
+
+   void composite()
+   {
+      cout << "Compositing (" << width << "x" << height << ", " << iterations << " iterations)" << endl;
+
+      for (int i = (int)CompositeMethod::AlphaMask; i <= (int)CompositeMethod::DifferenceMask; ++i) {
+         report(compositeNames[i], run(compositeCanvas((CompositeMethod)i).get()));
+      }
+   }
+
+   bool restart(uint32_t threads)
+   {
+      Initializer::term(CanvasEngine::Sw);
+      return Initializer::init(threads, CanvasEngine::Sw) == Result::Success;
+   }
+
+   //the frame updates of the scene graph, the keyframes are looked up in the playback order and in the random order
+   void lottie()
+   {
+      cout << "Lottie (the updates at every half frame of the timeline, in the playback and in the seeking)" << endl;
+
+      //the frame updates are performed on the calling thread.
+      if (!restart(0)) {
+         cout << "Error: Failed to initialize the engine." << endl;
+         return;
+      }
+
+      //the long keyframe tracks, then the given files
+      for (int i = -1; i < (int)lotties.size(); ++i) {
+         auto animation = Animation::gen();
+         auto picture = animation->picture();
+         string name;
+         if (i < 0) {
+            auto json = lottie(100, 1000);
+            if (picture->load(json.c_str(), json.size(), "lottie", "", true) != Result::Success) {
+               cout << "Warning: Lottie is not supported." << endl;
+               break;
+            }
+            name = "100 layers of 1000 keyframes";
+         } else {
+            if (picture->load(lotties[i]) != Result::Success) {
+               cout << "Warning: Failed to load (" << lotties[i] << ")." << endl;
+               continue;
+            }
+            auto p = strrchr(lotties[i], '/');
+            name = p ? p + 1 : lotties[i];
+         }
+
+         cout << "  " << name << " (" << static_cast<uint32_t>(animation->totalFrame()) << " frames)" << endl;
+         report("  playback", runFrames(animation.get(), false));
+         report("  seeking", runFrames(animation.get(), true));
+      }
+      restart(threads);
+   }
+
+   //the outlines and the rles are regenerated by the tasks every frame, the worker threads are doubled up to the cores
+   void threading()
+   {
+      auto cores = thread::hardware_concurrency();
+      if (cores == 0) cores = 1;
+
+      cout << "Threads (" << width << "x" << height << ", " << iterations << " iterations, the fastest frames of the default and the banded raster)" << endl;
+
+      double base = 0.0;
+
+      for (uint32_t cnt = 1; ; cnt = (cnt * 2 < cores) ? cnt * 2 : cores) {
+         if (!restart(cnt)) {
+            cout << "Error: Failed to initialize the engine." << endl;
+            return;
+         }
+         Time times[2];
+         for (int banded = 0; banded < 2; ++banded) {
+            auto canvas = this->canvas();
+            if (banded) canvas->raster(SwCanvas::RasterPolicy::Banded);
+            auto scene = Scene::gen();
+            auto p = scene.get();
+            shapes(p);
+            canvas->push(std::move(scene));
+            times[banded] = runUpdate(canvas.get(), p);
+         }
+         if (base == 0.0) base = times[0].min;
+         auto name = to_string(cnt) + (cnt == 1 ? " thread" : " threads");
+         cout << "  " << left << setw(16) << name << right << fixed << setprecision(3) << setw(10) << times[0].min << " ms" << setw(10) << times[1].min << " ms" << setprecision(2) << setw(8) << base / times[0].min << "x" << endl;
+         if (cnt == cores) break;
+      }
+      restart(threads);
+   }
+
+   void path()
+   {
+      cout << "Path (" << width << "x" << height << ", " << iterations << " iterations)" << endl;
+
+      const char* names[] = {"icons", "map", "chart"};
+
+      for (int i = 0; i < 3; ++i) {
+         auto canvas = this->canvas();
+         auto scene = Scene::gen();
+         auto p = scene.get();
+         if (i == 0) icons(p);
+         else if (i == 1) map(p);
+         else chart(p);
+         canvas->push(std::move(scene));
+         report(names[i], runUpdate(canvas.get(), p));
+      }
+
+      for (auto svg : svgs) {
+         auto canvas = this->canvas();
+         auto picture = Picture::gen();
+         if (picture->load(svg) != Result::Success) {
+            cout << "Warning: Failed to load (" << svg << ")." << endl;
+            continue;
+         }
+         picture->size(width, height);
+         auto scene = Scene::gen();
+         auto p = scene.get();
+         scene->push(std::move(picture));
+         canvas->push(std::move(scene));
+         auto name = strrchr(svg, '/');
+         report(name ? name + 1 : svg, runUpdate(canvas.get(), p));
+      }
+   }
+
+public:
+   int setup(int argc, char** argv)
+   {
+      vector<const char*> suites;
+
+      for (int i = 1; i < argc; ++i) {
+         const char* p = argv[i];
+         if (*p == '-') {
+            const char* p_arg = (i + 1 < argc) ? argv[++i] : nullptr;
+
+            //canvas resolution
+            if (p[1] == 'r') {
+               if (!p_arg) {
+                  cout << "Error: Missing resolution attribute. Expected eg. -r 800x800." << endl;
+                  return 1;
+               }
+
+               const char* x = strchr(p_arg, 'x');
+               int w = 0, h = 0;
+               if (x) {
+                  w = atoi(p_arg);
+                  h = atoi(x + 1);
+               }
+               if (!x || w <= 0 || h <= 0) {
+                  cout << "Error: Resolution (" << p_arg << ") is corrupted. Expected eg. -r 800x800." << endl;
+                  return 1;
+               }
+               width = w;
+               height = h;
+            //iterations
+            } else if (p[1] == 'i') {
+               if (!p_arg || atoi(p_arg) <= 0) {
+                  cout << "Error: Missing iterations. Expected eg. -i 100." << endl;
+                  return 1;
+               }
+               iterations = atoi(p_arg);
+            //threads
+            } else if (p[1] == 't') {
+               if (!p_arg) {
+                  cout << "Error: Missing threads count. Expected eg. -t 4." << endl;
+                  return 1;
+               }
+               threads = atoi(p_arg);
+            } else if (p[1] == 'h') {
+               helpMsg();
+               return 0;
+            } else {
+               cout << "Warning: Unknown flag (" << p << ")." << endl;
+            }
+         } else if (strstr(p, ".svg")) {
+            svgs.push_back(p);
+         } else if (strstr(p, ".json") || strstr(p, ".lot")) {
+            lotties.push_back(p);
+         } else {
+            suites.push_back(p);
+         }
+      }
+
+      if (suites.empty()) {
+         if (!svgs.empty()) suites.push_back("path");
+         if (!lotties.empty()) suites.push_back("lottie");
+         if (suites.empty()) suites = {"blend", "composite"};
+      }
+
+      if (Initializer::init(threads, CanvasEngine::Sw) != Result::Success) {
+         cout << "Error: Failed to initialize the engine." << endl;
+         return 1;
+      }
+
+      buffer.resize(width * height);
+      genImage();
+
+      for (auto suite : suites) {
+         if (!strcmp(suite, "blend")) blend();
+         else if (!strcmp(suite, "composite")) composite();
+         else if (!strcmp(suite, "path")) path();
+         else if (!strcmp(suite, "lottie")) lottie();
+         else if (!strcmp(suite, "threads")) threading();
+         else cout << "Warning: Unknown suite (" << suite << ")." << endl;
+      }
+
+      Initializer::term(CanvasEngine::Sw);
+
+      return 0;
+   }
+};
+
+
+int main(int argc, char **argv)
+{
+   App app;
+   return app.setup(argc, argv);
+}
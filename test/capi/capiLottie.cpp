@@ -22,6 +22,7 @@
 
 #include <thorvg_capi.h>
 #include <string.h>
+#include <stdio.h>
 #include "config.h"
 #include "../catch.hpp"
 
@@ -69,4 +70,45 @@ TEST_CASE("Lottie Slot", "[capiLottie]")
     REQUIRE(tvg_engine_term(TVG_ENGINE_SW) == TVG_RESULT_SUCCESS);
 }
 
+TEST_CASE("Lottie Binary", "[capiLottie]")
+{
+    REQUIRE(tvg_engine_init(TVG_ENGINE_SW, 0) == TVG_RESULT_SUCCESS);
+
+    Tvg_Animation* animation = tvg_lottie_animation_new();
+    REQUIRE(animation);
+
+    Tvg_Paint* picture = tvg_animation_get_picture(animation);
+    REQUIRE(picture);
+
+    //Save before loaded
+    REQUIRE(tvg_lottie_animation_save(animation, TEST_DIR"/test.lotb") == TVG_RESULT_INSUFFICIENT_CONDITION);
+
+    REQUIRE(tvg_picture_load(picture, TEST_DIR"/lottieslot.json") == TVG_RESULT_SUCCESS);
+
+    //Invalid arguments
+    REQUIRE(tvg_lottie_animation_save(nullptr, TEST_DIR"/test.lotb") == TVG_RESULT_INVALID_ARGUMENT);
+    REQUIRE(tvg_lottie_animation_save(animation, nullptr) == TVG_RESULT_INVALID_ARGUMENT);
+
+    REQUIRE(tvg_lottie_animation_save(animation, TEST_DIR"/test.lotb") == TVG_RESULT_SUCCESS);
+
+    float totalFrame, totalFrame2;
+    REQUIRE(tvg_animation_get_total_frame(animation, &totalFrame) == TVG_RESULT_SUCCESS);
+
+    //Load the precompiled data
+    Tvg_Animation* animation2 = tvg_lottie_animation_new();
+    REQUIRE(animation2);
+
+    Tvg_Paint* picture2 = tvg_animation_get_picture(animation2);
+    REQUIRE(tvg_picture_load(picture2, TEST_DIR"/test.lotb") == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_animation_get_total_frame(animation2, &totalFrame2) == TVG_RESULT_SUCCESS);
+    REQUIRE(totalFrame == totalFrame2);
+
+    REQUIRE(tvg_animation_del(animation2) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_animation_del(animation) == TVG_RESULT_SUCCESS);
+
+    remove(TEST_DIR"/test.lotb");
+
+    REQUIRE(tvg_engine_term(TVG_ENGINE_SW) == TVG_RESULT_SUCCESS);
+}
+
 #endif
\ No newline at end of file
@@ -135,6 +135,20 @@ TEST_CASE("Paint Opacity", "[capiPaint]")
     REQUIRE(tvg_paint_del(paint) == TVG_RESULT_SUCCESS);
 }
 
+TEST_CASE("Paint Cache", "[capiPaint]")
+{
+    Tvg_Paint* paint = tvg_shape_new();
+    REQUIRE(paint);
+
+    REQUIRE(tvg_paint_set_cache(NULL, true) == TVG_RESULT_INVALID_ARGUMENT);
+    REQUIRE(tvg_paint_set_cache(paint, true) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_paint_set_cache(paint, true) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_paint_set_cache(paint, false) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_paint_set_cache(paint, true) == TVG_RESULT_SUCCESS);
+
+    REQUIRE(tvg_paint_del(paint) == TVG_RESULT_SUCCESS);
+}
+
 TEST_CASE("Paint Bounds", "[capiPaint]")
 {
     Tvg_Paint* paint = tvg_shape_new();
@@ -62,6 +62,20 @@ TEST_CASE("Canvas initialization", "[capiSwCanvas]")
 
     REQUIRE(tvg_swcanvas_set_mempool(canvas, TVG_MEMPOOL_POLICY_DEFAULT) == TVG_RESULT_SUCCESS);
 
+    REQUIRE(tvg_swcanvas_set_raster_policy(canvas, TVG_RASTER_POLICY_BANDED) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_swcanvas_set_raster_policy(canvas, TVG_RASTER_POLICY_DEFAULT) == TVG_RESULT_SUCCESS);
+
+    uint32_t cnt = 1;
+    REQUIRE(tvg_swcanvas_set_partial(canvas, true) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_swcanvas_get_damages(canvas, NULL, &cnt) == TVG_RESULT_SUCCESS);
+    REQUIRE(cnt == 0);
+    REQUIRE(tvg_swcanvas_get_damages(canvas, NULL, NULL) == TVG_RESULT_INVALID_ARGUMENT);
+    REQUIRE(tvg_swcanvas_get_damages(NULL, NULL, &cnt) == TVG_RESULT_INVALID_ARGUMENT);
+    REQUIRE(tvg_swcanvas_set_partial(canvas, false) == TVG_RESULT_SUCCESS);
+
+    REQUIRE(tvg_swcanvas_set_cache_budget(canvas, 1024 * 1024) == TVG_RESULT_SUCCESS);
+    REQUIRE(tvg_swcanvas_set_cache_budget(NULL, 1024 * 1024) == TVG_RESULT_INVALID_ARGUMENT);
+
     REQUIRE(tvg_canvas_destroy(canvas) == TVG_RESULT_SUCCESS);
 
     REQUIRE(tvg_engine_term(TVG_ENGINE_SW) == TVG_RESULT_SUCCESS);
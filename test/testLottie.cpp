@@ -68,4 +68,284 @@ TEST_CASE("Lottie Slot", "[tvgLottie]")
     REQUIRE(Initializer::term() == Result::Success);
 }
 
+
+TEST_CASE("Lottie Frame Update", "[tvgLottie]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    const char* files[] = {TEST_DIR"/test5.json", TEST_DIR"/test7.json"};
+    const float frames[] = {0.0f, 1.0f, 2.0f, 3.0f, 8.0f, 21.0f, 55.0f, 2.0f, 0.0f, 7.25f};
+    const uint32_t size = 100;
+
+    auto buffer = new uint32_t[size * size];
+    auto buffer2 = new uint32_t[size * size];
+
+    for (auto file : files) {
+        ifstream file2(file);
+        REQUIRE(file2.is_open());
+        string data((istreambuf_iterator<char>(file2)), istreambuf_iterator<char>());
+
+        //The animation is updated frame by frame on the same canvas
+        auto animation = Animation::gen();
+        auto picture = animation->picture();
+        REQUIRE(picture->load(file) == Result::Success);
+        REQUIRE(picture->size(size, size) == Result::Success);
+
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        REQUIRE(canvas->push(tvg::cast<Picture>(picture)) == Result::Success);
+
+        for (auto frame : frames) {
+            if (frame >= animation->totalFrame()) frame = animation->totalFrame() - 1;
+            animation->frame(frame);
+            memset(buffer, 0, sizeof(uint32_t) * size * size);
+            REQUIRE(canvas->update() == Result::Success);
+            REQUIRE(canvas->draw() == Result::Success);
+            REQUIRE(canvas->sync() == Result::Success);
+
+            //Must be identical to the one drawn at the frame directly
+            auto animation2 = Animation::gen();
+            auto picture2 = animation2->picture();
+            REQUIRE(picture2->load(data.c_str(), data.size(), "lottie", TEST_DIR, true) == Result::Success);
+            REQUIRE(picture2->size(size, size) == Result::Success);
+            animation2->frame(frame);
+
+            auto canvas2 = SwCanvas::gen();
+            REQUIRE(canvas2->target(buffer2, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+            REQUIRE(canvas2->push(tvg::cast<Picture>(picture2)) == Result::Success);
+            memset(buffer2, 0, sizeof(uint32_t) * size * size);
+            REQUIRE(canvas2->draw() == Result::Success);
+            REQUIRE(canvas2->sync() == Result::Success);
+
+            REQUIRE(memcmp(buffer, buffer2, sizeof(uint32_t) * size * size) == 0);
+        }
+    }
+
+    delete[] buffer;
+    delete[] buffer2;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Lottie Slot Update", "[tvgLottie]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    const char* slotJson = R"({"gradient_fill":{"p":{"a":0,"k":[0,0.1,0.1,0.2,1,1,0.1,0.2,0.1,1]}}})";
+    const uint32_t size = 100;
+
+    uint32_t buffer[size * size];
+    uint32_t buffer2[size * size];
+
+    auto animation = LottieAnimation::gen();
+    auto picture = animation->picture();
+    REQUIRE(picture->load(TEST_DIR"/lottieslot.json") == Result::Success);
+    REQUIRE(picture->size(size, size) == Result::Success);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    REQUIRE(canvas->push(tvg::cast<Picture>(picture)) == Result::Success);
+
+    auto draw = [&](uint32_t* buffer) {
+        REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        memset(buffer, 0, sizeof(uint32_t) * size * size);
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    };
+
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    draw(buffer);
+
+    //The slot overriding must take effect even after the contents have been built
+    REQUIRE(animation->override(slotJson) == Result::Success);
+    REQUIRE(animation->frame(2.0f) == Result::Success);
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    draw(buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) != 0);
+
+    //Slot revert
+    REQUIRE(animation->override(nullptr) == Result::Success);
+    REQUIRE(animation->frame(2.0f) == Result::Success);
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    draw(buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+TEST_CASE("Lottie Shared Composition", "[tvgLottie]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    const char* slotJson = R"({"gradient_fill":{"p":{"a":0,"k":[0,0.1,0.1,0.2,1,1,0.1,0.2,0.1,1]}}})";
+    const uint32_t size = 100;
+
+    uint32_t buffer[size * size];
+    uint32_t buffer2[size * size];
+
+    //The animations of the same data play on their own
+    auto animation = LottieAnimation::gen();
+    auto picture = animation->picture();
+    REQUIRE(picture->load(TEST_DIR"/lottieslot.json") == Result::Success);
+    REQUIRE(picture->size(size, size) == Result::Success);
+
+    auto animation2 = LottieAnimation::gen();
+    auto picture2 = animation2->picture();
+    REQUIRE(picture2->load(TEST_DIR"/lottieslot.json") == Result::Success);
+    REQUIRE(picture2->size(size, size) == Result::Success);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->push(tvg::cast<Picture>(picture)) == Result::Success);
+
+    auto canvas2 = SwCanvas::gen();
+    REQUIRE(canvas2->push(tvg::cast<Picture>(picture2)) == Result::Success);
+
+    auto draw = [&](SwCanvas* canvas, uint32_t* buffer) {
+        REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        memset(buffer, 0, sizeof(uint32_t) * size * size);
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    };
+
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    REQUIRE(animation2->frame(1.0f) == Result::Success);
+    draw(canvas.get(), buffer);
+    draw(canvas2.get(), buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    REQUIRE(animation2->frame(10.0f) == Result::Success);
+    REQUIRE(animation->curFrame() == 1.0f);
+    draw(canvas.get(), buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    //The slot overriding applies to the given animation only
+    REQUIRE(animation2->override(slotJson) == Result::Success);
+    REQUIRE(animation2->frame(1.0f) == Result::Success);
+    draw(canvas2.get(), buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) != 0);
+
+    REQUIRE(animation->frame(2.0f) == Result::Success);
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    draw(canvas.get(), buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Lottie Binary", "[tvgLottie]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    const char* slotJson = R"({"gradient_fill":{"p":{"a":0,"k":[0,0.1,0.1,0.2,1,1,0.1,0.2,0.1,1]}}})";
+    const uint32_t size = 100;
+
+    uint32_t buffer[size * size];
+    uint32_t buffer2[size * size];
+
+    //Not loaded yet
+    auto animation = LottieAnimation::gen();
+    REQUIRE(animation->save(TEST_DIR"/test.lotb") == Result::InsufficientCondition);
+
+    auto picture = animation->picture();
+    REQUIRE(picture->load(TEST_DIR"/lottieslot.json") == Result::Success);
+    REQUIRE(picture->size(size, size) == Result::Success);
+    REQUIRE(animation->save(nullptr) == Result::InvalidArguments);
+    REQUIRE(animation->save(TEST_DIR"/test.lotb") == Result::Success);
+
+    //The precompiled data plays the same as the original
+    auto animation2 = LottieAnimation::gen();
+    auto picture2 = animation2->picture();
+    REQUIRE(picture2->load(TEST_DIR"/test.lotb") == Result::Success);
+    REQUIRE(picture2->size(size, size) == Result::Success);
+    REQUIRE(animation2->totalFrame() == animation->totalFrame());
+    REQUIRE(animation2->duration() == animation->duration());
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->push(tvg::cast<Picture>(picture)) == Result::Success);
+
+    auto canvas2 = SwCanvas::gen();
+    REQUIRE(canvas2->push(tvg::cast<Picture>(picture2)) == Result::Success);
+
+    auto draw = [&](SwCanvas* canvas, uint32_t* buffer) {
+        REQUIRE(canvas->target(buffer, size, size, size, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        memset(buffer, 0, sizeof(uint32_t) * size * size);
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+    };
+
+    for (auto frame : {1.0f, 5.5f, 10.0f, 0.0f}) {
+        REQUIRE(animation->frame(frame) == Result::Success);
+        REQUIRE(animation2->frame(frame) == Result::Success);
+        draw(canvas.get(), buffer);
+        draw(canvas2.get(), buffer2);
+        REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+    }
+
+    //The slots are kept in the precompiled data
+    REQUIRE(animation->override(slotJson) == Result::Success);
+    REQUIRE(animation2->override(slotJson) == Result::Success);
+    REQUIRE(animation->frame(1.0f) == Result::Success);
+    REQUIRE(animation2->frame(1.0f) == Result::Success);
+    draw(canvas.get(), buffer);
+    draw(canvas2.get(), buffer2);
+    REQUIRE(memcmp(buffer, buffer2, sizeof(buffer)) == 0);
+
+    //The broken data must be rejected
+    ifstream file(TEST_DIR"/test.lotb", ios::in | ios::binary);
+    REQUIRE(file.is_open());
+    string data((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+    file.close();
+
+    auto picture3 = Picture::gen();
+    REQUIRE(picture3->load(data.c_str(), data.size(), "lottie", TEST_DIR, true) == Result::Success);
+
+    auto picture4 = Picture::gen();
+    REQUIRE(picture4->load(data.c_str(), data.size() / 2, "lottie", TEST_DIR, true) != Result::Success);
+
+    //The corrupted payload must be rejected, or be played safely
+    auto rejected = 0;
+    for (size_t i = 64; i < data.size(); i += 5) {
+        auto corrupted = data;
+        corrupted[i] ^= 0xff;
+        auto animation3 = Animation::gen();
+        if (animation3->picture()->load(corrupted.c_str(), corrupted.size(), "lottie", TEST_DIR, true) != Result::Success) {
+            ++rejected;
+            continue;
+        }
+        animation3->frame(animation3->totalFrame() * 0.5f);
+    }
+    REQUIRE(rejected > 0);
+
+    remove(TEST_DIR"/test.lotb");
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+TEST_CASE("Lottie Static Contents", "[tvgLottie]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto animation = LottieAnimation::gen();
+    REQUIRE(animation->stats(nullptr, nullptr, nullptr, nullptr) == Result::InsufficientCondition);
+
+    //The keyframes of the same color stops or text document don't animate the contents
+    REQUIRE(animation->picture()->load(TEST_DIR"/lottiestatic.json") == Result::Success);
+
+    uint32_t layers, staticLayers, objects, staticObjects;
+    REQUIRE(animation->stats(&layers, &staticLayers, &objects, &staticObjects) == Result::Success);
+    REQUIRE(layers == 3);
+    REQUIRE(staticLayers == 2);
+    REQUIRE(objects == 5);
+    REQUIRE(staticObjects == 4);
+
+    REQUIRE(animation->stats(&layers, nullptr, nullptr, nullptr) == Result::Success);
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
 #endif
\ No newline at end of file
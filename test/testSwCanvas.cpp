@@ -21,6 +21,7 @@
  */
 
 #include <thorvg.h>
+#include <cstring>
 #include "config.h"
 #include "catch.hpp"
 
@@ -94,3 +95,133 @@ TEST_CASE("Memory Pool", "[tvgSwCanvas]")
 
     REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
 }
+
+TEST_CASE("Partial Redraw", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(0, CanvasEngine::Sw) == Result::Success);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+
+    uint32_t buffer[100*100];
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    REQUIRE(canvas->partial(true) == Result::Success);
+
+    auto bg = Shape::gen();
+    REQUIRE(bg->appendRect(0, 0, 100, 100) == Result::Success);
+    REQUIRE(bg->fill(0, 0, 255, 255) == Result::Success);
+    REQUIRE(canvas->push(std::move(bg)) == Result::Success);
+
+    auto shape = Shape::gen();
+    auto shape2 = shape.get();
+    REQUIRE(shape->appendRect(10, 10, 10, 10) == Result::Success);
+    REQUIRE(shape->fill(255, 0, 0, 255) == Result::Success);
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+    //The first drawing covers the whole target
+    const SwCanvas::Region* regions = nullptr;
+    REQUIRE(canvas->update() == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(canvas->damages(&regions) == 1);
+    REQUIRE(regions[0].x == 0);
+    REQUIRE(regions[0].y == 0);
+    REQUIRE(regions[0].w == 100);
+    REQUIRE(regions[0].h == 100);
+    REQUIRE(buffer[15 * 100 + 15] == 0xffff0000);
+
+    //Nothing changed
+    REQUIRE(canvas->update() == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(canvas->damages(nullptr) == 0);
+
+    //Both the old and the new regions of the moved shape are redrawn
+    REQUIRE(shape2->translate(50, 50) == Result::Success);
+    REQUIRE(canvas->clear(false) == Result::Success);
+    REQUIRE(canvas->update(shape2) == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(canvas->damages(&regions) == 2);
+    REQUIRE(regions[0].w * regions[0].h + regions[1].w * regions[1].h == 200);
+    REQUIRE(buffer[15 * 100 + 15] == 0xff0000ff);
+    REQUIRE(buffer[65 * 100 + 65] == 0xffff0000);
+    REQUIRE(buffer[5 * 100 + 5] == 0xff0000ff);
+
+    //Not allowed during the drawing
+    REQUIRE(canvas->update() == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->partial(false) == Result::InsufficientCondition);
+    REQUIRE(canvas->sync() == Result::Success);
+    REQUIRE(canvas->partial(false) == Result::Success);
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
+
+TEST_CASE("Partial Redraw Gradients", "[tvgSwCanvas]")
+{
+    REQUIRE(Initializer::init(0, CanvasEngine::Sw) == Result::Success);
+
+    //translucent gradients under a small moving shape, the damaged regions cut them horizontally.
+    auto scene = [](Canvas* canvas, Shape** mover) {
+        Fill::ColorStop stops[3] = {{0.0f, 255, 0, 0, 120}, {0.5f, 0, 255, 0, 200}, {1.0f, 0, 0, 255, 160}};
+
+        auto linear = LinearGradient::gen();
+        linear->linear(3.3f, 7.1f, 187.7f, 91.9f);
+        linear->colorStops(stops, 3);
+        auto shape = Shape::gen();
+        shape->appendRect(1.5f, 2.5f, 197.0f, 195.0f);
+        shape->fill(std::move(linear));
+        canvas->push(std::move(shape));
+
+        auto radial = RadialGradient::gen();
+        radial->radial(97.3f, 103.7f, 141.1f);
+        radial->colorStops(stops, 3);
+        radial->spread(FillSpread::Reflect);
+        auto shape2 = Shape::gen();
+        shape2->appendCircle(100.0f, 100.0f, 97.0f, 93.0f);
+        shape2->fill(std::move(radial));
+        canvas->push(std::move(shape2));
+
+        auto shape3 = Shape::gen();
+        shape3->appendRect(0.0f, 0.0f, 23.0f, 17.0f);
+        shape3->fill(255, 255, 255, 100);
+        *mover = shape3.get();
+        canvas->push(std::move(shape3));
+    };
+
+    uint32_t expected[200*200], buffer[200*200];
+    Shape* mover;
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    REQUIRE(canvas->partial(true) == Result::Success);
+    scene(canvas.get(), &mover);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    auto reference = SwCanvas::gen();
+    REQUIRE(reference->target(expected, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    Shape* mover2;
+    scene(reference.get(), &mover2);
+
+    for (int i = 1; i < 8; ++i) {
+        auto x = 37.0f * i - 3.0f * i * i, y = 23.0f * i;
+        mover->translate(x, y);
+        REQUIRE(canvas->update(mover) == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+        REQUIRE(canvas->damages(nullptr) > 0);
+
+        //the full drawing of the same scene
+        mover2->translate(x, y);
+        memset(expected, 0, sizeof(expected));
+        REQUIRE(reference->update() == Result::Success);
+        REQUIRE(reference->draw() == Result::Success);
+        REQUIRE(reference->sync() == Result::Success);
+
+        REQUIRE(memcmp(expected, buffer, sizeof(buffer)) == 0);
+    }
+
+    REQUIRE(Initializer::term(CanvasEngine::Sw) == Result::Success);
+}
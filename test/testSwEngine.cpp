@@ -22,6 +22,8 @@
 
 #include <thorvg.h>
 #include <fstream>
+#include <cstring>
+#include <cstdlib>
 #include "config.h"
 #include "catch.hpp"
 
@@ -1479,4 +1481,1033 @@ TEST_CASE("Blending with Gradient Filling", "[tvgSwEngine]")
     REQUIRE(Initializer::term() == Result::Success);
 }
 
+
+//The shapes, the gradients, the strokes, the blending, the masks, the scene composition, the texture mapping and the mesh
+static void _mixedPaints(Canvas* canvas)
+{
+    Fill::ColorStop cs[2] = {{0.0f, 255, 0, 0, 255}, {1.0f, 0, 0, 255, 127}};
+
+    for (int i = 0; i < 12; ++i) {
+        auto shape = tvg::Shape::gen();
+        if (i % 2) shape->appendRect(i * 20, i * 20, 80, 60);
+        else shape->appendCircle(i * 20 + 30, i * 20 + 30, 40, 25);
+
+        if (i % 3 == 0) {
+            auto fill = LinearGradient::gen();
+            fill->linear(0.0f, 0.0f, 300.0f, 300.0f);
+            fill->colorStops(cs, 2);
+            shape->fill(std::move(fill));
+        } else {
+            shape->fill(i * 20, 255 - i * 20, 100, 200);
+        }
+        shape->strokeWidth(3.0f);
+        shape->strokeFill(0, 0, 0, 255);
+
+        if (i % 4 == 1) shape->blend(BlendMethod::Multiply);
+        if (i % 5 == 2) {
+            auto mask = tvg::Shape::gen();
+            mask->appendCircle(i * 20 + 30, i * 20 + 30, 30, 30);
+            mask->fill(255, 255, 255, 255);
+            shape->composite(std::move(mask), CompositeMethod::AlphaMask);
+        }
+        REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+    }
+
+    //Scene composition
+    auto scene = Scene::gen();
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(TEST_DIR"/test.png") == Result::Success);
+    picture->size(200, 200);
+    picture->translate(50, 50);
+    scene->push(std::move(picture));
+    scene->opacity(127);
+    REQUIRE(canvas->push(std::move(scene)) == Result::Success);
+
+    //Texture mapping
+    auto picture2 = Picture::gen();
+    REQUIRE(picture2->load(TEST_DIR"/test.png") == Result::Success);
+    picture2->size(200, 200);
+    picture2->translate(150, 0);
+    picture2->rotate(30);
+    REQUIRE(canvas->push(std::move(picture2)) == Result::Success);
+
+    auto picture3 = Picture::gen();
+    REQUIRE(picture3->load(TEST_DIR"/test.png") == Result::Success);
+    Polygon triangles[2] = {
+        {{{{0.0f, 0.0f}, {0.0f, 0.0f}}, {{200.0f, 20.0f}, {1.0f, 0.0f}}, {{0.0f, 250.0f}, {0.0f, 1.0f}}}},
+        {{{{200.0f, 20.0f}, {1.0f, 0.0f}}, {{180.0f, 280.0f}, {1.0f, 1.0f}}, {{0.0f, 250.0f}, {0.0f, 1.0f}}}}
+    };
+    REQUIRE(picture3->mesh(triangles, 2) == Result::Success);
+    picture3->opacity(200);
+    REQUIRE(canvas->push(std::move(picture3)) == Result::Success);
+}
+
+
+//Draws the paints which the given function pushes into a new canvas of the buffer (size x size) from the scratch.
+template<typename Paints>
+static void _draw(uint32_t* buffer, uint32_t size, Paints paints, SwCanvas::Colorspace cs = SwCanvas::ARGB8888, SwCanvas::RasterPolicy policy = SwCanvas::RasterPolicy::Default)
+{
+    memset(buffer, 0, sizeof(uint32_t) * size * size);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas);
+    REQUIRE(canvas->target(buffer, size, size, size, cs) == Result::Success);
+    REQUIRE(canvas->raster(policy) == Result::Success);
+
+    paints(canvas.get());
+
+    REQUIRE(canvas->update() == Result::Success);
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+}
+
+
+TEST_CASE("Banded Rasterization", "[tvgSwEngine]")
+{
+    auto expected = new uint32_t[300*300];
+    auto buffer = new uint32_t[300*300];
+
+    REQUIRE(Initializer::init(0) == Result::Success);
+    _draw(expected, 300, _mixedPaints);
+    REQUIRE(Initializer::term() == Result::Success);
+
+    REQUIRE(Initializer::init(4) == Result::Success);
+    _draw(buffer, 300, _mixedPaints, SwCanvas::ARGB8888, SwCanvas::RasterPolicy::Banded);
+    REQUIRE(Initializer::term() == Result::Success);
+
+    //The bands must produce the identical result.
+    REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 300 * 300) == 0);
+
+    delete[] expected;
+    delete[] buffer;
+}
+
+
+TEST_CASE("Composition Regions", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto buffer = new uint32_t[100*100]();
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    //Translucent scene partially out of the canvas
+    auto scene = Scene::gen();
+    auto shape = Shape::gen();
+    REQUIRE(shape->appendRect(-20, -20, 50, 50) == Result::Success);
+    REQUIRE(shape->fill(255, 0, 0, 255) == Result::Success);
+    REQUIRE(scene->push(std::move(shape)) == Result::Success);
+    REQUIRE(scene->opacity(128) == Result::Success);
+    REQUIRE(canvas->push(std::move(scene)) == Result::Success);
+
+    //Mask larger than the masked shape, nested in a translucent scene
+    auto scene2 = Scene::gen();
+    auto shape2 = Shape::gen();
+    REQUIRE(shape2->appendRect(60, 60, 30, 30) == Result::Success);
+    REQUIRE(shape2->fill(0, 0, 255, 255) == Result::Success);
+    auto mask = Shape::gen();
+    REQUIRE(mask->appendRect(-50, 0, 200, 200) == Result::Success);
+    REQUIRE(mask->fill(255, 255, 255, 255) == Result::Success);
+    auto mask2 = Shape::gen();
+    REQUIRE(mask2->appendRect(0, 0, 75, 150) == Result::Success);
+    REQUIRE(mask2->fill(255, 255, 255, 255) == Result::Success);
+    REQUIRE(mask->composite(std::move(mask2), CompositeMethod::InvAlphaMask) == Result::Success);
+    REQUIRE(shape2->composite(std::move(mask), CompositeMethod::AlphaMask) == Result::Success);
+    REQUIRE(scene2->push(std::move(shape2)) == Result::Success);
+    REQUIRE(scene2->opacity(200) == Result::Success);
+    REQUIRE(canvas->push(std::move(scene2)) == Result::Success);
+
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    REQUIRE(buffer[10 * 100 + 10] == 0x80800000);
+    REQUIRE(buffer[50 * 100 + 50] == 0);
+    REQUIRE(buffer[70 * 100 + 70] == 0);
+    REQUIRE((buffer[80 * 100 + 80] & 0x00ffff00) == 0);
+    REQUIRE((buffer[80 * 100 + 80] >> 24) > 0xc0);
+    REQUIRE(buffer[95 * 100 + 95] == 0);
+
+    REQUIRE(Initializer::term() == Result::Success);
+
+    delete[] buffer;
+}
+
+TEST_CASE("Shared Gradient Tables", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto expected = new uint32_t[100*100];
+    auto buffer = new uint32_t[100*100];
+    auto buffer2 = new uint32_t[100*100];
+
+    Fill::ColorStop stops[3] = {{0.0f, 255, 0, 0, 255}, {0.5f, 0, 255, 0, 128}, {1.0f, 0, 0, 255, 255}};
+    Fill::ColorStop stops2[2] = {{0.0f, 0, 0, 0, 255}, {1.0f, 255, 255, 255, 255}};
+
+    auto gradientShape = [&](float x, float y, float size, uint8_t opacity) {
+        auto shape = Shape::gen();
+        shape->appendRect(x, y, 50, 50);
+        shape->opacity(opacity);
+        auto fill = LinearGradient::gen();
+        fill->linear(x, y, x + size, y + size);
+        fill->colorStops(stops, 3);
+        shape->fill(std::move(fill));
+        return shape;
+    };
+
+    //the reference of the gradient shape drawn alone
+    _draw(expected, 100, [&](Canvas* canvas) { REQUIRE(canvas->push(gradientShape(0, 0, 50, 255)) == Result::Success); }, SwCanvas::ABGR8888);
+
+    //the same gradients with the different opacities, extents and colorspaces in the other canvases
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ABGR8888) == Result::Success);
+    REQUIRE(canvas->push(gradientShape(0, 0, 50, 255)) == Result::Success);
+    auto shape = gradientShape(50, 0, 50, 100);
+    auto shape2 = shape.get();
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+    REQUIRE(canvas->push(gradientShape(0, 50, 5, 255)) == Result::Success);
+
+    for (int i = 0; i < 2; ++i) {
+        memset(buffer, 0, sizeof(uint32_t) * 100 * 100);
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        for (int y = 0; y < 50; ++y) {
+            REQUIRE(memcmp(expected + y * 100, buffer + y * 100, sizeof(uint32_t) * 50) == 0);
+        }
+
+        //the colors of a shape don't affect the others
+        auto fill = LinearGradient::gen();
+        fill->linear(50, 0, 100, 50);
+        fill->colorStops(stops2, 2);
+        REQUIRE(shape2->fill(std::move(fill)) == Result::Success);
+    }
+
+    //ABGR vs ARGB
+    _draw(buffer2, 100, [&](Canvas* canvas) { REQUIRE(canvas->push(gradientShape(0, 0, 50, 255)) == Result::Success); });
+
+    for (int y = 0; y < 50; ++y) {
+        for (int x = 0; x < 50; ++x) {
+            auto c = buffer2[y * 100 + x];
+            REQUIRE(expected[y * 100 + x] == ((c & 0xff00ff00) | ((c & 0x00ff0000) >> 16) | ((c & 0x000000ff) << 16)));
+        }
+    }
+
+    delete[] expected;
+    delete[] buffer;
+    delete[] buffer2;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Translated Shapes", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto expected = new uint32_t[200*200];
+    auto buffer = new uint32_t[200*200];
+
+    //integer, sub-pixel, clipped by the canvas and scaled movements, the reused rle count (-1: depends on the clipping)
+    struct {float x, y, scale; int reused;} frames[] = {{0, 0, 1, 0}, {5, 3, 1, 4}, {-7, 2, 1, 4}, {10.5f, 0, 1, 0}, {12.5f, -1, 1, -1}, {-30, 0, 1, -1}, {-25, 4, 1, -1}, {3, 3, 1, -1}, {3, 3, 1.2f, 0}, {8, 1, 1.2f, -1}};
+    uint32_t reused = 0, generated = 0;
+
+    auto paints = [](Canvas* canvas, Shape** shapes) {
+        Fill::ColorStop cs[2] = {{0.0f, 255, 0, 0, 255}, {1.0f, 0, 0, 255, 127}};
+        float dash[2] = {7.0f, 3.0f};
+
+        for (int i = 0; i < 4; ++i) {
+            auto shape = Shape::gen();
+            switch (i) {
+                case 0: {
+                    shape->appendCircle(40.3f, 40.7f, 25.0f, 18.0f);
+                    auto fill = LinearGradient::gen();
+                    fill->linear(15.0f, 20.0f, 65.0f, 60.0f);
+                    fill->colorStops(cs, 2);
+                    shape->fill(std::move(fill));
+                    shape->strokeWidth(3.0f);
+                    shape->strokeFill(0, 0, 0, 255);
+                    break;
+                }
+                case 1: {
+                    shape->appendRect(100.0f, 20.0f, 50.0f, 40.0f);
+                    shape->fill(0, 255, 0, 200);
+                    break;
+                }
+                case 2: {
+                    shape->appendRect(30.0f, 100.0f, 80.0f, 50.0f, 10.0f, 10.0f);
+                    shape->fill(255, 255, 0, 255);
+                    shape->strokeWidth(4.0f);
+                    shape->strokeDash(dash, 2);
+                    auto fill = RadialGradient::gen();
+                    fill->radial(70.0f, 125.0f, 40.0f);
+                    fill->colorStops(cs, 2);
+                    shape->strokeFill(std::move(fill));
+                    break;
+                }
+                default: {
+                    shape->moveTo(150.25f, 100.0f);
+                    shape->cubicTo(190.1f, 90.2f, 170.6f, 160.3f, 140.0f, 150.5f);
+                    shape->close();
+                    shape->fill(0, 0, 255, 150);
+                    shape->blend(BlendMethod::Multiply);
+                    break;
+                }
+            }
+            shapes[i] = shape.get();
+            REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+        }
+    };
+
+    Shape* shapes[4];
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    paints(canvas.get(), shapes);
+
+    for (auto& frame : frames) {
+        //from the scratch
+        _draw(expected, 200, [&](Canvas* canvas) {
+            Shape* shapes2[4];
+            paints(canvas, shapes2);
+            for (int i = 0; i < 4; ++i) {
+                shapes2[i]->scale(frame.scale);
+                shapes2[i]->translate(frame.x, frame.y);
+            }
+        });
+
+        //updated
+        memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+        for (int i = 0; i < 4; ++i) {
+            shapes[i]->scale(frame.scale);
+            shapes[i]->translate(frame.x, frame.y);
+        }
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 200 * 200) == 0);
+
+        uint32_t reused2, generated2;
+        REQUIRE(canvas->stats(&reused2, &generated2) == Result::Success);
+        if (frame.reused >= 0) {
+            REQUIRE(reused2 - reused == (uint32_t) frame.reused);
+            if (reused2 > reused) REQUIRE(generated2 == generated);
+        }
+        REQUIRE(reused2 + generated2 > reused + generated);
+        reused = reused2;
+        generated = generated2;
+    }
+    REQUIRE(reused > 0);
+    REQUIRE(canvas->stats(nullptr, nullptr) == Result::Success);
+
+    delete[] expected;
+    delete[] buffer;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Translated Shapes Drift", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto expected = new uint32_t[200*200];
+    auto buffer = new uint32_t[200*200];
+
+    //the whole pixel steps reuse the rle, the sub-pixel ones must not be lost over the frames
+    auto paint = [](Canvas* canvas) {
+        auto shape = Shape::gen();
+        shape->appendCircle(30.0f, 30.0f, 20.0f, 15.0f);
+        shape->fill(255, 0, 0, 255);
+        auto p = shape.get();
+        canvas->push(std::move(shape));
+        return p;
+    };
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    auto shape = paint(canvas.get());
+
+    auto x = 10.3f, y = 10.6f;
+    uint32_t reused = 0;
+
+    for (int i = 0; i < 100; ++i, x += (i % 2) ? 1.0f : 1.007f, y += (i % 2) ? 2.0f : 0.993f) {
+        _draw(expected, 200, [&](Canvas* canvas) {
+            paint(canvas)->translate(x, y);
+        });
+
+        memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+        shape->translate(x, y);
+        REQUIRE(canvas->update() == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 200 * 200) == 0);
+    }
+    REQUIRE(canvas->stats(&reused, nullptr) == Result::Success);
+    REQUIRE(reused >= 40);
+
+    delete[] expected;
+    delete[] buffer;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Path Crossings", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    uint32_t buffer[220 * 220];
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 220, 220, 220, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    //Nested squares, every row crosses the path many times
+    for (auto rule : {FillRule::EvenOdd, FillRule::Winding}) {
+        memset(buffer, 0, sizeof(buffer));
+
+        auto shape = Shape::gen();
+        for (int i = 0; i < 20; ++i) {
+            shape->appendRect(10 + 5 * i, 10 + 5 * i, 200 - 10 * i, 200 - 10 * i);
+        }
+        shape->fill(0, 0, 255, 255);
+        shape->fill(rule);
+
+        REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+        REQUIRE(canvas->draw() == Result::Success);
+        REQUIRE(canvas->sync() == Result::Success);
+
+        for (int i = 0; i < 20; ++i) {
+            auto filled = (rule == FillRule::Winding || i % 2 == 0);
+            auto expected = filled ? 0xff0000ff : 0x00000000;
+            REQUIRE(buffer[110 * 220 + 12 + 5 * i] == expected);
+            REQUIRE(buffer[(12 + 5 * i) * 220 + 110] == expected);
+            REQUIRE(buffer[110 * 220 + 207 - 5 * i] == expected);
+        }
+        REQUIRE(buffer[110 * 220 + 110] == ((rule == FillRule::Winding) ? 0xff0000ff : 0x00000000));
+        REQUIRE(buffer[5 * 220 + 5] == 0);
+
+        REQUIRE(canvas->clear() == Result::Success);
+    }
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Hairlines", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    uint32_t buffer[100 * 100];
+    memset(buffer, 0, sizeof(buffer));
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 100, 100, 100, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    //pixel aligned, a full pixel row
+    auto shape = Shape::gen();
+    shape->moveTo(10, 10.5f);
+    shape->lineTo(50, 10.5f);
+    shape->strokeWidth(1.0f);
+    shape->strokeFill(0, 0, 255, 255);
+    shape->strokeCap(StrokeCap::Butt);
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+    //half a pixel thin
+    shape = Shape::gen();
+    shape->moveTo(10, 20.5f);
+    shape->lineTo(50, 20.5f);
+    shape->strokeWidth(0.5f);
+    shape->strokeFill(0, 0, 255, 255);
+    shape->strokeCap(StrokeCap::Butt);
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+    //dashed, the caps extend the dashes by the half width
+    shape = Shape::gen();
+    shape->moveTo(10.5f, 30.5f);
+    shape->lineTo(90.5f, 30.5f);
+    shape->strokeWidth(1.0f);
+    shape->strokeFill(0, 0, 255, 255);
+    shape->strokeCap(StrokeCap::Round);
+    float dashes[] = {4.0f, 6.0f};
+    shape->strokeDash(dashes, 2);
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+    //diagonal, covers its area
+    shape = Shape::gen();
+    shape->moveTo(10, 40);
+    shape->lineTo(90, 90);
+    shape->strokeWidth(1.0f);
+    shape->strokeFill(0, 0, 255, 255);
+    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    for (int x = 10; x < 50; ++x) {
+        REQUIRE(buffer[10 * 100 + x] == 0xff0000ff);
+        REQUIRE(buffer[9 * 100 + x] == 0);
+        REQUIRE(buffer[11 * 100 + x] == 0);
+        auto alpha = buffer[20 * 100 + x] >> 24;
+        REQUIRE(alpha >= 126);
+        REQUIRE(alpha <= 129);
+    }
+    REQUIRE(buffer[10 * 100 + 9] == 0);
+    REQUIRE(buffer[10 * 100 + 50] == 0);
+
+    for (int x = 10; x < 90; ++x) {
+        if (x % 10 < 5) REQUIRE(buffer[30 * 100 + x] == 0xff0000ff);
+        else REQUIRE(buffer[30 * 100 + x] == 0);
+    }
+
+    uint32_t area = 0;
+    for (int y = 35; y < 95; ++y) {
+        for (int x = 0; x < 100; ++x) area += buffer[y * 100 + x] >> 24;
+    }
+    auto expected = sqrtf(80.0f * 80.0f + 50.0f * 50.0f) * 255.0f;
+    REQUIRE(float(area) > expected * 0.98f);
+    REQUIRE(float(area) < expected * 1.02f);
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Clipped Updates", "[tvgSwEngine]")
+{
+    auto expected = new uint32_t[200*200];
+    auto buffer = new uint32_t[200*200];
+
+    //The shapes grow and shrink, the transient buffers are reused across the frames and the threads.
+    struct {float x, y, scale;} frames[] = {{0, 0, 1}, {5, 3, 1.5f}, {-7, 2, 0.5f}, {10.5f, 0, 1}, {-30, 0, 2}, {3, 3, 0.2f}, {0, 0, 1}};
+
+    auto paints = [](Canvas* canvas, Shape** shapes) {
+        float dashes[] = {6.0f, 3.0f};
+
+        //clipped by a path, with a hairline
+        auto shape = Shape::gen();
+        shape->appendCircle(60, 60, 45, 35);
+        shape->fill(255, 0, 0, 200);
+        shape->strokeWidth(0.8f);
+        shape->strokeFill(0, 0, 0, 255);
+        auto clip = Shape::gen();
+        clip->appendCircle(70, 50, 40, 40);
+        shape->composite(std::move(clip), CompositeMethod::ClipPath);
+        shapes[0] = shape.get();
+        canvas->push(std::move(shape));
+
+        //clipped by a rectangle, with the dashed strokes
+        shape = Shape::gen();
+        shape->appendRect(100, 20, 80, 70, 10, 10);
+        shape->fill(0, 255, 0, 200);
+        shape->strokeWidth(3.0f);
+        shape->strokeFill(0, 0, 255, 255);
+        shape->strokeDash(dashes, 2);
+        clip = Shape::gen();
+        clip->appendRect(90, 30, 70, 50);
+        shape->composite(std::move(clip), CompositeMethod::ClipPath);
+        shapes[1] = shape.get();
+        canvas->push(std::move(shape));
+
+        shape = Shape::gen();
+        shape->appendCircle(140, 140, 40, 40);
+        shape->strokeWidth(2.0f);
+        shape->strokeFill(255, 0, 255, 255);
+        shape->strokeDash(dashes, 2);
+        shapes[2] = shape.get();
+        canvas->push(std::move(shape));
+
+        //clipped by the merged shapes
+        shape = Shape::gen();
+        shape->appendRect(20, 110, 80, 80);
+        shape->fill(0, 128, 255, 255);
+        shape->strokeWidth(1.0f);
+        shape->strokeFill(0, 0, 0, 255);
+        shape->strokeDash(dashes, 2);
+        auto clipper = Scene::gen();
+        for (int i = 0; i < 3; ++i) {
+            clip = Shape::gen();
+            clip->appendCircle(35 + i * 25, 150, 15, 30);
+            clipper->push(std::move(clip));
+        }
+        shape->composite(std::move(clipper), CompositeMethod::ClipPath);
+        shapes[3] = shape.get();
+        canvas->push(std::move(shape));
+    };
+
+    for (auto threads : {0, 4}) {
+        REQUIRE(Initializer::init(threads) == Result::Success);
+
+        Shape* shapes[4];
+        auto canvas = SwCanvas::gen();
+        REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+        paints(canvas.get(), shapes);
+
+        for (auto& frame : frames) {
+            _draw(expected, 200, [&](Canvas* canvas) {
+                Shape* shapes2[4];
+                paints(canvas, shapes2);
+                for (int i = 0; i < 4; ++i) {
+                    shapes2[i]->scale(frame.scale);
+                    shapes2[i]->translate(frame.x, frame.y);
+                }
+            });
+
+            memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+            for (int i = 0; i < 4; ++i) {
+                shapes[i]->scale(frame.scale);
+                shapes[i]->translate(frame.x, frame.y);
+            }
+            REQUIRE(canvas->update() == Result::Success);
+            REQUIRE(canvas->draw() == Result::Success);
+            REQUIRE(canvas->sync() == Result::Success);
+
+            REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 200 * 200) == 0);
+
+            //inside and outside of the clippers
+            if (frame.x == 0 && frame.scale == 1) {
+                REQUIRE(buffer[60 * 200 + 70] == 0xc8c80000);
+                REQUIRE(buffer[60 * 200 + 20] == 0);
+                REQUIRE(buffer[150 * 200 + 60] == 0xff0080ff);
+                REQUIRE(buffer[125 * 200 + 47] == 0);
+            }
+        }
+
+        REQUIRE(Initializer::term() == Result::Success);
+    }
+
+    delete[] expected;
+    delete[] buffer;
+}
+
+
+TEST_CASE("Image Colorspaces", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    //Un-premultiplied source shared by the pictures of the different colorspaces
+    uint32_t data[16 * 4];
+    for (int i = 0; i < 16 * 4; ++i) data[i] = 0x80ff8040;
+
+    uint32_t buffer1[20 * 20];
+    uint32_t buffer2[20 * 20];
+    memset(buffer1, 0, sizeof(buffer1));
+    memset(buffer2, 0, sizeof(buffer2));
+
+    auto canvas1 = SwCanvas::gen();
+    REQUIRE(canvas1->target(buffer1, 20, 20, 20, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+    auto canvas2 = SwCanvas::gen();
+    REQUIRE(canvas2->target(buffer2, 20, 20, 20, SwCanvas::Colorspace::ABGR8888) == Result::Success);
+
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(data, 16, 4, false, false) == Result::Success);
+    REQUIRE(canvas1->push(std::move(picture)) == Result::Success);
+
+    picture = Picture::gen();
+    REQUIRE(picture->load(data, 16, 4, false, false) == Result::Success);
+    //the duplicate shares the converted pixels too
+    auto dup = tvg::cast<Picture>(picture->duplicate());
+    REQUIRE(dup->translate(0, 10) == Result::Success);
+    REQUIRE(canvas2->push(std::move(picture)) == Result::Success);
+    REQUIRE(canvas2->push(std::move(dup)) == Result::Success);
+
+    for (int i = 0; i < 2; ++i) {
+        REQUIRE(canvas1->draw() == Result::Success);
+        REQUIRE(canvas2->draw() == Result::Success);
+        REQUIRE(canvas1->sync() == Result::Success);
+        REQUIRE(canvas2->sync() == Result::Success);
+
+        //the loaded data is untouched
+        for (int j = 0; j < 16 * 4; ++j) REQUIRE(data[j] == 0x80ff8040);
+
+        for (int y = 0; y < 4; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                REQUIRE(buffer1[y * 20 + x] == 0x807f4020);
+                REQUIRE(buffer2[y * 20 + x] == 0x8020407f);
+                REQUIRE(buffer2[(y + 10) * 20 + x] == 0x8020407f);
+            }
+        }
+        REQUIRE(buffer1[4 * 20] == 0);
+        REQUIRE(buffer2[16] == 0);
+        REQUIRE(buffer2[4 * 20] == 0);
+
+        memset(buffer1, 0, sizeof(buffer1));
+        memset(buffer2, 0, sizeof(buffer2));
+        REQUIRE(canvas1->update() == Result::Success);
+        REQUIRE(canvas2->update() == Result::Success);
+    }
+
+    //the shared copies are released along with their last users
+    REQUIRE(canvas1->clear() == Result::Success);
+    REQUIRE(canvas2->draw() == Result::Success);
+    REQUIRE(canvas2->sync() == Result::Success);
+    REQUIRE(buffer2[0] == 0x8020407f);
+    REQUIRE(buffer2[13 * 20 + 15] == 0x8020407f);
+    REQUIRE(canvas2->clear() == Result::Success);
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Downscaled Images", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    //1 pixel checkerboard, it must turn to gray by downscaling.
+    auto data = new uint32_t[400*400];
+    for (int y = 0; y < 400; ++y) {
+        for (int x = 0; x < 400; ++x) {
+            data[y * 400 + x] = ((x + y) % 2) ? 0xffffffff : 0xff000000;
+        }
+    }
+
+    auto buffer = new uint32_t[200*200];
+    memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+
+    auto canvas = SwCanvas::gen();
+    REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+
+    //scaled
+    auto picture = Picture::gen();
+    REQUIRE(picture->load(data, 400, 400, true, false) == Result::Success);
+    picture->translate(20, 20);
+    picture->scale(0.125f);
+    REQUIRE(canvas->push(std::move(picture)) == Result::Success);
+
+    //texture mapped
+    picture = Picture::gen();
+    REQUIRE(picture->load(data, 400, 400, true, false) == Result::Success);
+    picture->translate(130, 60);
+    picture->rotate(30.0f);
+    picture->scale(0.1f);
+    REQUIRE(canvas->push(std::move(picture)) == Result::Success);
+
+    //mesh
+    Polygon triangles[2] = {
+        {{{{0, 0}, {0, 0}}, {{400, 0}, {1, 0}}, {{400, 400}, {1, 1}}}},
+        {{{{0, 0}, {0, 0}}, {{400, 400}, {1, 1}}, {{0, 400}, {0, 1}}}}
+    };
+    picture = Picture::gen();
+    REQUIRE(picture->load(data, 400, 400, true, false) == Result::Success);
+    REQUIRE(picture->mesh(triangles, 2) == Result::Success);
+    picture->translate(20, 130);
+    picture->scale(0.125f);
+    REQUIRE(canvas->push(std::move(picture)) == Result::Success);
+
+    REQUIRE(canvas->draw() == Result::Success);
+    REQUIRE(canvas->sync() == Result::Success);
+
+    auto gray = [&](int x0, int y0, int x1, int y1) {
+        for (int y = y0; y < y1; ++y) {
+            for (int x = x0; x < x1; ++x) {
+                auto c = buffer[y * 200 + x];
+                if ((c >> 24) != 0xff) return false;
+                for (int i = 0; i < 24; i += 8) {
+                    auto v = (c >> i) & 0xff;
+                    if (v < 112 || v > 144) return false;
+                }
+            }
+        }
+        return true;
+    };
+
+    REQUIRE(gray(22, 22, 68, 68));
+    REQUIRE(gray(131, 81, 143, 93));
+    REQUIRE(gray(22, 132, 68, 178));
+
+    delete[] data;
+    delete[] buffer;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("Cached Paints", "[tvgSwEngine]")
+{
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    auto expected = new uint32_t[200*200];
+    auto buffer = new uint32_t[200*200];
+
+    //moved, faded, changed, clipped by the canvas and scaled
+    struct {float x, y, scale; uint8_t opacity; bool change;} frames[] = {
+        {0, 0, 1, 255, false}, {5, 3, 1, 255, false}, {-7, 2, 1, 128, false}, {10, 20, 1, 128, false}, {10.4f, 20, 1, 200, false},
+        {10, 20, 1, 200, true}, {30, 30, 1, 255, false}, {-60, 0, 1, 255, false}, {-10, -5, 1, 60, false}, {3, 3, 1.2f, 255, false},
+        {8, 1, 1.2f, 255, true}, {0, 0, 1, 255, false}, {6, 4, 1, 255, false}};
+
+    auto paints = [](Canvas* canvas, Shape** shapes, bool cached) {
+        Fill::ColorStop cs[2] = {{0.0f, 255, 0, 0, 255}, {1.0f, 0, 0, 255, 128}};
+
+        //background
+        auto shape = Shape::gen();
+        shape->appendRect(20.0f, 20.0f, 100.0f, 100.0f);
+        shape->fill(0, 128, 255, 255);
+        REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+
+        auto scene = Scene::gen();
+
+        shape = Shape::gen();
+        shape->appendCircle(70.3f, 60.7f, 25.0f, 18.0f);
+        auto fill = LinearGradient::gen();
+        fill->linear(45.0f, 40.0f, 95.0f, 80.0f);
+        fill->colorStops(cs, 2);
+        shape->fill(std::move(fill));
+        shape->strokeWidth(3.0f);
+        shape->strokeFill(0, 0, 0, 255);
+        shapes[0] = shape.get();
+        scene->push(std::move(shape));
+
+        shape = Shape::gen();
+        shape->appendRect(80.0f, 50.0f, 50.0f, 40.0f);
+        shape->fill(0, 255, 0, 200);
+        shapes[1] = shape.get();
+        scene->push(std::move(shape));
+
+        shape = Shape::gen();
+        shape->appendRect(60.0f, 80.0f, 60.0f, 40.0f, 10.0f, 10.0f);
+        shape->fill(255, 255, 0, 255);
+        shape->opacity(100);
+        shapes[2] = shape.get();
+        scene->push(std::move(shape));
+
+        auto ret = scene.get();
+        if (cached) REQUIRE(scene->cache(true) == Result::Success);
+        REQUIRE(canvas->push(std::move(scene)) == Result::Success);
+
+        return ret;
+    };
+
+    for (int partial = 0; partial < 2; ++partial) {
+        for (int budget = 0; budget < 2; ++budget) {
+            Shape* shapes[3];
+            auto canvas = SwCanvas::gen();
+            REQUIRE(canvas->target(buffer, 200, 200, 200, SwCanvas::Colorspace::ARGB8888) == Result::Success);
+            REQUIRE(canvas->partial(partial) == Result::Success);
+            if (budget) REQUIRE(canvas->cacheBudget(1024) == Result::Success);
+            auto scene = paints(canvas.get(), shapes, true);
+
+            uint8_t color = 0;
+            for (auto& frame : frames) {
+                if (frame.change) color += 100;
+
+                //uncached
+                _draw(expected, 200, [&](Canvas* canvas) {
+                    Shape* shapes2[3];
+                    auto scene2 = paints(canvas, shapes2, false);
+                    scene2->scale(frame.scale);
+                    scene2->translate(frame.x, frame.y);
+                    scene2->opacity(frame.opacity);
+                    shapes2[1]->fill(color, 255, 0, 200);
+                });
+
+                //cached
+                if (!partial) memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+                scene->scale(frame.scale);
+                scene->translate(frame.x, frame.y);
+                scene->opacity(frame.opacity);
+                if (frame.change) shapes[1]->fill(color, 255, 0, 200);
+                REQUIRE(canvas->update() == Result::Success);
+                REQUIRE(canvas->draw() == Result::Success);
+                REQUIRE(canvas->sync() == Result::Success);
+
+                //The blending order of the cached image could differ by a rounding error.
+                auto diff = 0;
+                for (int i = 0; i < 200 * 200; ++i) {
+                    for (int c = 0; c < 32; c += 8) {
+                        auto d = abs(int((expected[i] >> c) & 0xff) - int((buffer[i] >> c) & 0xff));
+                        if (d > diff) diff = d;
+                    }
+                }
+                REQUIRE(diff <= 2);
+            }
+
+            //removed descendants
+            _draw(expected, 200, [&](Canvas* canvas) {
+                Shape* shapes2[3];
+                REQUIRE(paints(canvas, shapes2, false)->clear() == Result::Success);
+            });
+            if (!partial) memset(buffer, 0, sizeof(uint32_t) * 200 * 200);
+            scene->translate(20, 10);
+            REQUIRE(scene->clear() == Result::Success);
+            REQUIRE(canvas->update() == Result::Success);
+            REQUIRE(canvas->draw() == Result::Success);
+            REQUIRE(canvas->sync() == Result::Success);
+            REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 200 * 200) == 0);
+        }
+    }
+
+    delete[] expected;
+    delete[] buffer;
+
+    REQUIRE(Initializer::term() == Result::Success);
+}
+
+
+TEST_CASE("SIMD Kernels", "[tvgSwEngine]")
+{
+    auto composite = [](Canvas* canvas) {
+        //every pair of the composite methods with the anti-aliased, translucent and nested masks
+        for (int i = (int)CompositeMethod::ClipPath; i <= (int)CompositeMethod::DifferenceMask; ++i) {
+            for (int j = (int)CompositeMethod::AlphaMask; j <= (int)CompositeMethod::DifferenceMask; ++j) {
+                auto x = float(i - 1) * 33.0f;
+                auto y = float(j - 2) * 30.0f;
+
+                auto shape = Shape::gen();
+                REQUIRE(shape->appendCircle(x + 16, y + 15, 15, 12) == Result::Success);
+                REQUIRE(shape->fill(200, 100, 50, 180 + i * 5) == Result::Success);
+
+                auto mask = Shape::gen();
+                REQUIRE(mask->appendCircle(x + 13, y + 14, 13, 15) == Result::Success);
+                REQUIRE(mask->fill(i * 25, 255 - j * 20, 128, 160 + j * 10) == Result::Success);
+
+                auto mask2 = Shape::gen();
+                REQUIRE(mask2->appendRect(x + 5, y + 4, 20, 22, 3, 3) == Result::Success);
+                REQUIRE(mask2->fill(j * 20, 255, 255 - i * 20, 200) == Result::Success);
+                REQUIRE(mask->composite(std::move(mask2), (CompositeMethod)j) == Result::Success);
+
+                REQUIRE(shape->composite(std::move(mask), (CompositeMethod)i) == Result::Success);
+                REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+            }
+        }
+
+        //matting over the preceding content of a mask scene
+        for (int i = (int)CompositeMethod::AlphaMask; i <= (int)CompositeMethod::InvLumaMask; ++i) {
+            auto x = float(i - 2) * 75.0f;
+
+            auto shape = Shape::gen();
+            REQUIRE(shape->appendRect(x, 240, 70, 25) == Result::Success);
+            REQUIRE(shape->fill(0, 200, 100, 255) == Result::Success);
+
+            auto mask = Scene::gen();
+            auto under = Shape::gen();
+            REQUIRE(under->appendRect(x + 5, 242, 60, 21) == Result::Success);
+            REQUIRE(under->fill(255, 255, 255, 120) == Result::Success);
+            REQUIRE(mask->push(std::move(under)) == Result::Success);
+            auto over = Shape::gen();
+            REQUIRE(over->appendCircle(x + 35, 252, 30, 10) == Result::Success);
+            REQUIRE(over->fill(255, 255, 255, 200) == Result::Success);
+            auto matte = Shape::gen();
+            REQUIRE(matte->appendCircle(x + 30, 250, 25, 12) == Result::Success);
+            REQUIRE(matte->fill(100, 150, 200, 180) == Result::Success);
+            REQUIRE(over->composite(std::move(matte), (CompositeMethod)i) == Result::Success);
+            REQUIRE(mask->push(std::move(over)) == Result::Success);
+
+            REQUIRE(shape->composite(std::move(mask), CompositeMethod::AlphaMask) == Result::Success);
+            REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+        }
+
+        //blending with the partial coverage
+        for (int i = (int)BlendMethod::Multiply; i <= (int)BlendMethod::Exclusion; ++i) {
+            auto shape = Shape::gen();
+            REQUIRE(shape->appendCircle(i * 25, 285, 30, 14) == Result::Success);
+            REQUIRE(shape->fill(50, 150, 250, 200) == Result::Success);
+            REQUIRE(shape->blend((BlendMethod)i) == Result::Success);
+            REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+        }
+    };
+
+    auto gradient = [](Canvas* canvas) {
+        Fill::ColorStop stops[3] = {{0.0f, 255, 0, 0, 255}, {0.5f, 0, 255, 100, 150}, {1.0f, 20, 50, 255, 220}};
+
+        auto fill = [&](int type, FillSpread spread, float x, float y) -> Fill* {
+            Fill* ret;
+            if (type == 0) {
+                auto linear = LinearGradient::gen();
+                REQUIRE(linear->linear(x + 9, y + 5, x + 17, y + 11) == Result::Success);
+                ret = linear.release();
+            } else {
+                auto radial = RadialGradient::gen();
+                REQUIRE(radial->radial(x + 13, y + 20, 7) == Result::Success);
+                ret = radial.release();
+            }
+            REQUIRE(ret->colorStops(stops, 3) == Result::Success);
+            REQUIRE(ret->spread(spread) == Result::Success);
+            return ret;
+        };
+
+        //linear/radial gradients of every spread with the opacity, the mattes, the masks and the blending
+        for (int type = 0; type < 2; ++type) {
+            for (int spread = (int)FillSpread::Pad; spread <= (int)FillSpread::Repeat; ++spread) {
+                auto y = float(type * 3 + spread) * 45.0f;
+                for (int i = 0; i < 10; ++i) {
+                    auto x = float(i) * 30.0f;
+
+                    auto shape = Shape::gen();
+                    REQUIRE(shape->appendCircle(x + 14, y + 20, 13.5f, 19.5f) == Result::Success);
+                    REQUIRE(shape->fill(std::unique_ptr<Fill>(fill(type, (FillSpread)spread, x, y))) == Result::Success);
+
+                    if (i == 1) {
+                        REQUIRE(shape->opacity(150) == Result::Success);
+                    } else if (i >= 2 && i <= 7) {
+                        auto mask = Shape::gen();
+                        REQUIRE(mask->appendRect(x + 3, y + 8, 22, 30, 4, 4) == Result::Success);
+                        if (i <= 3) {
+                            REQUIRE(mask->fill(200, 100, 50, 200) == Result::Success);
+                            REQUIRE(shape->opacity(200) == Result::Success);
+                            REQUIRE(shape->composite(std::move(mask), i == 2 ? CompositeMethod::AlphaMask : CompositeMethod::InvLumaMask) == Result::Success);
+                        } else {
+                            //the gradient drawn into the mask
+                            REQUIRE(mask->fill(100, 200, 50, 180) == Result::Success);
+                            REQUIRE(shape->fill(std::unique_ptr<Fill>(fill(1 - type, (FillSpread)spread, x, y))) == Result::Success);
+                            auto mask2 = Shape::gen();
+                            REQUIRE(mask2->appendCircle(x + 15, y + 22, 12, 16) == Result::Success);
+                            REQUIRE(mask2->fill(std::unique_ptr<Fill>(fill(type, (FillSpread)spread, x, y))) == Result::Success);
+                            REQUIRE(mask->composite(std::move(mask2), (CompositeMethod)(i - 4 + (int)CompositeMethod::AddMask)) == Result::Success);
+                            REQUIRE(shape->composite(std::move(mask), CompositeMethod::AlphaMask) == Result::Success);
+                        }
+                    } else if (i >= 8) {
+                        REQUIRE(shape->blend(i == 8 ? BlendMethod::Multiply : BlendMethod::Overlay) == Result::Success);
+                        if (i == 9) REQUIRE(shape->opacity(180) == Result::Success);
+                    }
+                    REQUIRE(canvas->push(std::move(shape)) == Result::Success);
+                }
+            }
+        }
+
+        //the focal points on the end circles
+        const char* svg = "<svg viewBox=\"0 0 300 30\" xmlns=\"http://www.w3.org/2000/svg\"><defs>"
+            "<radialGradient id=\"pad\" cx=\"0.5\" cy=\"0.5\" r=\"0.3\" fx=\"1.5\" fy=\"0.5\"><stop offset=\"0\" stop-color=\"red\"/><stop offset=\"1\" stop-color=\"blue\" stop-opacity=\"0.5\"/></radialGradient>"
+            "<radialGradient id=\"reflect\" href=\"#pad\" spreadMethod=\"reflect\"/>"
+            "<radialGradient id=\"repeat\" href=\"#pad\" spreadMethod=\"repeat\"/></defs>"
+            "<rect x=\"0\" y=\"0\" width=\"90\" height=\"30\" fill=\"url(#pad)\"/>"
+            "<rect x=\"100\" y=\"0\" width=\"90\" height=\"30\" fill=\"url(#reflect)\" opacity=\"0.6\"/>"
+            "<circle cx=\"245\" cy=\"15\" r=\"45\" fill=\"url(#repeat)\"/></svg>";
+
+        auto picture = Picture::gen();
+        REQUIRE(picture->load(svg, strlen(svg), "svg", "", true) == Result::Success);
+        REQUIRE(picture->size(300, 30) == Result::Success);
+        REQUIRE(picture->translate(0, 270) == Result::Success);
+        REQUIRE(canvas->push(std::move(picture)) == Result::Success);
+    };
+
+    auto expected = new uint32_t[300*300];
+    auto buffer = new uint32_t[300*300];
+
+    REQUIRE(Initializer::init(0) == Result::Success);
+
+    //The kernels of every instruction set must produce the identical result with the C version.
+    SwCanvas::Simd levels[] = {SwCanvas::Simd::Sse41, SwCanvas::Simd::Avx2};
+    SwCanvas::Colorspace colorspaces[] = {SwCanvas::ARGB8888, SwCanvas::ABGR8888};
+    void (*contents[])(Canvas*) = {_mixedPaints, composite, gradient};
+
+    for (auto cs : colorspaces) {
+        for (auto paints : contents) {
+            REQUIRE(SwCanvas::simd(SwCanvas::Simd::None) == Result::Success);
+            _draw(expected, 300, paints, cs);
+
+            for (auto level : levels) {
+                REQUIRE(SwCanvas::simd(level) == Result::Success);
+                _draw(buffer, 300, paints, cs);
+                REQUIRE(memcmp(expected, buffer, sizeof(uint32_t) * 300 * 300) == 0);
+            }
+        }
+    }
+    REQUIRE(SwCanvas::simd(SwCanvas::Simd::Default) == Result::Success);
+
+    REQUIRE(Initializer::term() == Result::Success);
+
+    delete[] expected;
+    delete[] buffer;
+}
+
 #endif
\ No newline at end of file
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <thread>
+#include "config.h"
+#include "tvgTaskScheduler.h"
+#include "catch.hpp"
+
+//The scheduler is internal, it's built into tvgSchedulerTests (see meson.build)
+
+#ifdef THORVG_THREAD_SUPPORT
+    static const uint32_t threadCnts[] = {0, 4};
+#else
+    static const uint32_t threadCnts[] = {0};
+#endif
+
+static atomic<uint32_t> order{0};   //the execution order of the tasks
+
+
+struct TestTask : Task
+{
+    Task* dep = nullptr;              //the task which must be finished before this
+    atomic<bool>* gate = nullptr;     //holds the task until it's opened
+    thread::id caller;                //the thread which ran this task
+    uint32_t seq = 0;                 //the execution order, 0 if it's not run yet
+    unsigned tid = UINT32_MAX;
+    bool followed = true;             //the dependency was finished before this started
+
+    void run(unsigned tid) override
+    {
+        if (gate) {
+            while (!gate->load()) this_thread::yield();
+        }
+        if (dep) followed = (static_cast<TestTask*>(dep)->seq > 0);
+        this->tid = tid;
+        caller = this_thread::get_id();
+        seq = ++order;
+    }
+};
+
+
+TEST_CASE("Task Scheduler Wait", "[tvgTaskScheduler]")
+{
+    for (auto threads : threadCnts) {
+        TaskScheduler::init(threads);
+        order = 0;
+
+        //never requested, nothing to wait for
+        TestTask idle;
+        idle.done();
+        REQUIRE(idle.seq == 0);
+
+        //the waiters are blocked until the task is finished, then all of them are woken up.
+        atomic<bool> gate{threads == 0};
+        TestTask task;
+        task.gate = &gate;
+
+        //the same task is requested again once it's done
+        for (uint32_t round = 1; round <= 3; ++round) {
+            TaskScheduler::request(&task);
+
+            atomic<uint32_t> woken{0};
+            thread waiters[4];
+            for (auto& waiter : waiters) {
+                waiter = thread([&] {
+                    task.done();
+                    if (task.seq == round) ++woken;
+                });
+            }
+            this_thread::sleep_for(chrono::milliseconds(10));
+            if (threads > 0) REQUIRE(woken == 0);
+
+            gate = true;
+            task.done();
+            REQUIRE(task.seq == round);
+
+            for (auto& waiter : waiters) waiter.join();
+            REQUIRE(woken == 4);
+
+            gate = (threads == 0);
+        }
+
+        TaskScheduler::term();
+    }
+}
+
+
+TEST_CASE("Task Scheduler Dependencies", "[tvgTaskScheduler]")
+{
+    for (auto threads : threadCnts) {
+        TaskScheduler::init(threads);
+        REQUIRE(TaskScheduler::threads() == threads);
+        order = 0;
+
+        //a chain, the first one is held until all the others are requested
+        atomic<bool> gate{threads == 0};
+        TestTask tasks[8];
+        tasks[0].gate = &gate;
+        TaskScheduler::request(&tasks[0]);
+
+        for (int i = 1; i < 8; ++i) {
+            Task* deps[] = {&tasks[i - 1]};
+            tasks[i].dep = &tasks[i - 1];
+            TaskScheduler::request(&tasks[i], deps, 1);
+        }
+        gate = true;
+        tasks[7].done();
+
+        for (int i = 0; i < 8; ++i) {
+            REQUIRE(tasks[i].seq == uint32_t(i + 1));
+            REQUIRE(tasks[i].followed);
+        }
+
+        //the finished dependencies are not waited for
+        TestTask task;
+        Task* deps[] = {&tasks[0], &tasks[7]};
+        task.dep = &tasks[7];
+        TaskScheduler::request(&task, deps, 2);
+        task.done();
+        REQUIRE(task.seq == 9);
+        REQUIRE(task.followed);
+
+        //many tasks on a shared dependency
+        TestTask root, leaves[64];
+        atomic<bool> gate2{threads == 0};
+        root.gate = &gate2;
+        TaskScheduler::request(&root);
+        for (auto& leaf : leaves) {
+            Task* deps[] = {&root};
+            leaf.dep = &root;
+            TaskScheduler::request(&leaf, deps, 1);
+        }
+        gate2 = true;
+        for (auto& leaf : leaves) {
+            leaf.done();
+            REQUIRE(leaf.followed);
+        }
+
+        TaskScheduler::term();
+        REQUIRE(TaskScheduler::threads() == 0);
+    }
+}
+
+
+TEST_CASE("Task Scheduler Sync Mode", "[tvgTaskScheduler]")
+{
+    for (auto threads : threadCnts) {
+        TaskScheduler::init(threads);
+        order = 0;
+
+        //the dependency is running on a worker, the sync request waits for it on this thread.
+        atomic<bool> gate{threads == 0};
+        TestTask dep;
+        dep.gate = &gate;
+        TaskScheduler::request(&dep);
+
+        TaskScheduler::async(false);
+
+        thread opener([&] {
+            this_thread::sleep_for(chrono::milliseconds(10));
+            gate = true;
+        });
+
+        TestTask task;
+        Task* deps[] = {&dep};
+        task.dep = &dep;
+        TaskScheduler::request(&task, deps, 1);
+        opener.join();
+
+        //ran immediately on this thread without the workers
+        REQUIRE(task.seq == 2);
+        REQUIRE(task.followed);
+        REQUIRE(task.tid == 0);
+        REQUIRE(task.caller == this_thread::get_id());
+        REQUIRE(TaskScheduler::queued(TaskPriority::High) == 0);
+
+        TaskScheduler::async(true);
+        dep.done();
+        TaskScheduler::term();
+    }
+}
+
+
+#ifdef THORVG_THREAD_SUPPORT
+
+TEST_CASE("Task Scheduler Priority", "[tvgTaskScheduler]")
+{
+    //one worker is held by a task, the others wait in the lanes.
+    TaskScheduler::init(1);
+    order = 0;
+
+    atomic<bool> gate{false};
+    TestTask blocker;
+    blocker.gate = &gate;
+    TaskScheduler::request(&blocker);
+    while (TaskScheduler::queued(TaskPriority::High) > 0) this_thread::yield();
+
+    TestTask low[16], high[16];
+    for (int i = 0; i < 16; ++i) {
+        TaskScheduler::request(&low[i], TaskPriority::Low);
+        REQUIRE(TaskScheduler::queued(TaskPriority::Low) == uint32_t(i + 1));
+    }
+    for (int i = 0; i < 16; ++i) {
+        TaskScheduler::request(&high[i], TaskPriority::High);
+        REQUIRE(TaskScheduler::queued(TaskPriority::High) == uint32_t(i + 1));
+    }
+    REQUIRE(TaskScheduler::queued(TaskPriority::Low) == 16);
+
+    gate = true;
+    for (int i = 0; i < 16; ++i) {
+        low[i].done();
+        high[i].done();
+    }
+
+    //the high lane is drained first, then the low lane in the requested order.
+    REQUIRE(blocker.seq == 1);
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(high[i].seq == uint32_t(i + 2));
+        REQUIRE(low[i].seq == uint32_t(i + 18));
+    }
+    REQUIRE(TaskScheduler::queued(TaskPriority::High) == 0);
+    REQUIRE(TaskScheduler::queued(TaskPriority::Low) == 0);
+
+    TaskScheduler::term();
+}
+
+
+TEST_CASE("Task Scheduler Injector Overflow", "[tvgTaskScheduler]")
+{
+    //the capacity of the queue for the requests from the outside of the workers (see INJECTOR_SIZE)
+    constexpr uint32_t capacity = 4096;
+
+    TaskScheduler::init(1);
+    order = 0;
+
+    atomic<bool> gate{false};
+    TestTask blocker;
+    blocker.gate = &gate;
+    TaskScheduler::request(&blocker);
+    while (TaskScheduler::queued(TaskPriority::High) > 0) this_thread::yield();
+
+    auto tasks = new TestTask[capacity + 1];
+    for (uint32_t i = 0; i < capacity; ++i) {
+        TaskScheduler::request(&tasks[i]);
+    }
+    REQUIRE(TaskScheduler::queued(TaskPriority::High) == capacity);
+
+    //no more room, it runs on this thread instead.
+    TaskScheduler::request(&tasks[capacity]);
+    REQUIRE(tasks[capacity].seq == 1);
+    REQUIRE(tasks[capacity].tid == 0);
+    REQUIRE(tasks[capacity].caller == this_thread::get_id());
+    REQUIRE(TaskScheduler::queued(TaskPriority::High) == capacity);
+
+    gate = true;
+    for (uint32_t i = 0; i < capacity; ++i) {
+        tasks[i].done();
+        REQUIRE(tasks[i].tid == 1);
+    }
+    REQUIRE(TaskScheduler::queued(TaskPriority::High) == 0);
+
+    delete[] tasks;
+
+    TaskScheduler::term();
+}
+
+#endif